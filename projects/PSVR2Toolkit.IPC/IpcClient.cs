@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Diagnostics;
 using System.Net.Sockets;
 using System.Runtime.InteropServices;
@@ -8,7 +9,7 @@ using System.Threading.Tasks;
 namespace PSVR2Toolkit.CAPI {
     public class IpcClient {
         private const ushort IPC_SERVER_PORT = 3364;
-        private const ushort k_unIpcVersion = 1;
+        private const ushort k_unIpcVersion = 3;
 
         private static IpcClient m_pInstance;
 
@@ -21,7 +22,18 @@ namespace PSVR2Toolkit.CAPI {
         private TaskCompletionSource<CommandDataServerGazeDataResult>? m_gazeTask;
         private CancellationTokenSource m_forceShutdownToken;
         private int m_gazePumpPeriodMs = 8; // 120Hz
-        private CommandDataServerGazeDataResult? m_lastGazeState = null;
+        private CommandDataServerGazeDataResult2? m_lastGazeState = null;
+        private volatile bool m_gazeSubscribed = false; // Once subscribed, the server pushes gaze samples and we stop polling.
+        private readonly ConcurrentQueue<CommandDataServerGazeDataResult2> m_gazeHistory = new ConcurrentQueue<CommandDataServerGazeDataResult2>();
+        private CommandDataServerGazeCalibrationStatus? m_lastGazeCalibrationStatus = null;
+        private CommandDataServerGazePredictionResult? m_lastGazePrediction = null;
+        private readonly ConcurrentQueue<GazeEvent> m_gazeEvents = new ConcurrentQueue<GazeEvent>();
+        private CommandDataServerGazeRecordingStatus? m_lastGazeRecordingStatus = null;
+        private CommandDataServerGazeReplayStatus? m_lastGazeReplayStatus = null;
+        private CommandDataServerGazeStats? m_lastGazeStats = null;
+        private CommandDataServerGazeClockStatus? m_lastGazeClockStatus = null;
+        private CommandDataServerGazeVergenceResult? m_lastGazeVergence = null;
+        private CommandDataServerGazeFoveationResult? m_lastGazeFoveation = null;
 
         public static IpcClient Instance() {
             if ( m_pInstance == null ) {
@@ -59,6 +71,7 @@ namespace PSVR2Toolkit.CAPI {
             }
 
             m_running = false;
+            m_gazeSubscribed = false;
             m_forceShutdownToken.Cancel();
 
             lock ( m_gazeStateLock ) {
@@ -84,6 +97,7 @@ namespace PSVR2Toolkit.CAPI {
 
         private void ReceiveLoop(CancellationToken token) {
             byte[] buffer = new byte[1024];
+            int bufferedLen = 0;
 
             try {
                 var clientSocket = m_client!.Client;
@@ -99,36 +113,55 @@ namespace PSVR2Toolkit.CAPI {
                 long nextPumpMs = sw.ElapsedMilliseconds;
 
                 while ( m_running && !token.IsCancellationRequested ) {
-                    // query gaze state every so often
-                    var now = sw.ElapsedMilliseconds;
-                    if ( now >= nextPumpMs ) {
-                        SendIpcCommand(ECommandType.ClientRequestGazeData);
-                        nextPumpMs = now + m_gazePumpPeriodMs;
+                    // query gaze state every so often, unless the server is pushing it to us
+                    if ( !m_gazeSubscribed ) {
+                        var now = sw.ElapsedMilliseconds;
+                        if ( now >= nextPumpMs ) {
+                            SendIpcCommand(ECommandType.ClientRequestGazeData);
+                            nextPumpMs = now + m_gazePumpPeriodMs;
+                        }
                     }
 
-                    bool readable = clientSocket.Poll(1000 /* 1ms */, SelectMode.SelectRead);
+                    bool readable = clientSocket.Poll(m_gazeSubscribed ? 100000 /* 100ms */ : 1000 /* 1ms */, SelectMode.SelectRead);
                     if ( readable && clientSocket.Available > 0 ) {
                         int available = clientSocket.Available;
-                        if ( available > buffer.Length ) {
-                            buffer = new byte[Math.Max(available, buffer.Length * 2)];
+                        if ( bufferedLen + available > buffer.Length ) {
+                            Array.Resize(ref buffer, Math.Max(bufferedLen + available, buffer.Length * 2));
                         }
 
-                        int bytesRead = m_stream.Read(buffer, 0, Math.Min(buffer.Length, available));
+                        int bytesRead = m_stream.Read(buffer, bufferedLen, available);
                         if ( bytesRead <= 0 ) {
                             Console.WriteLine("[IPC_CLIENT] Disconnected from server.");
                             break;
                         }
+                        bufferedLen += bytesRead;
+
+                        // Pushed samples can arrive back to back, so handle every complete command we have.
+                        int headerSize = Marshal.SizeOf<CommandHeader>();
+                        int offset = 0;
+                        while ( bufferedLen - offset >= headerSize ) {
+                            CommandHeader header = ByteArrayToStructure<CommandHeader>(buffer, offset);
+                            if ( header.dataLen < 0 ) {
+                                Console.WriteLine("[IPC_CLIENT] Received invalid command header.");
+                                offset = bufferedLen;
+                                break;
+                            }
+                            if ( bufferedLen - offset < headerSize + header.dataLen ) {
+                                break;
+                            }
 
-                        if ( bytesRead < Marshal.SizeOf<CommandHeader>() ) {
-                            Console.WriteLine("[IPC_CLIENT] Received invalid command header size.");
-                            continue;
+                            HandleIpcCommand(buffer, offset);
+                            offset += headerSize + header.dataLen;
                         }
 
-                        HandleIpcCommand(buffer, bytesRead);
+                        Buffer.BlockCopy(buffer, offset, buffer, 0, bufferedLen - offset);
+                        bufferedLen -= offset;
                         continue;
                     }
 
-                    Thread.Sleep(1);
+                    if ( !m_gazeSubscribed ) {
+                        Thread.Sleep(1);
+                    }
                 }
             } catch ( OperationCanceledException ) {
                 // nothing special, this is from shutdown most likely
@@ -139,8 +172,9 @@ namespace PSVR2Toolkit.CAPI {
             }
         }
 
-        private void HandleIpcCommand(byte[] pBuffer, int bytesReceived) {
-            CommandHeader header = ByteArrayToStructure<CommandHeader>(pBuffer, 0);
+        private void HandleIpcCommand(byte[] pBuffer, int offset) {
+            CommandHeader header = ByteArrayToStructure<CommandHeader>(pBuffer, offset);
+            int dataOffset = offset + Marshal.SizeOf<CommandHeader>();
 
             switch ( header.type ) {
                 case ECommandType.ServerPong: {
@@ -150,10 +184,19 @@ namespace PSVR2Toolkit.CAPI {
 
                 case ECommandType.ServerHandshakeResult: {
                         if ( header.dataLen == Marshal.SizeOf<CommandDataServerHandshakeResult>() ) {
-                            CommandDataServerHandshakeResult response = ByteArrayToStructure<CommandDataServerHandshakeResult>(pBuffer, Marshal.SizeOf<CommandHeader>());
+                            CommandDataServerHandshakeResult response = ByteArrayToStructure<CommandDataServerHandshakeResult>(pBuffer, dataOffset);
                             switch ( response.result ) {
                                 case EHandshakeResult.Success: {
                                         Console.WriteLine("[IPC_CLIENT] Handshake successful!");
+
+                                        // Servers older than IPC version 2 ignore the subscription, keep polling them.
+                                        if ( response.ipcVersion >= 2 ) {
+                                            CommandDataClientSubscribeGaze subscribeGaze = new CommandDataClientSubscribeGaze() {
+                                                decimation = 1,
+                                            };
+                                            SendIpcCommand(ECommandType.ClientSubscribeGaze, subscribeGaze);
+                                            m_gazeSubscribed = true;
+                                        }
                                         break;
                                     }
                                 case EHandshakeResult.Failed: {
@@ -169,10 +212,81 @@ namespace PSVR2Toolkit.CAPI {
                         break;
                     }
                 case ECommandType.ServerGazeDataResult: {
-                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeDataResult>() ) {
-                            CommandDataServerGazeDataResult response = ByteArrayToStructure<CommandDataServerGazeDataResult>(pBuffer, Marshal.SizeOf<CommandHeader>());
-                            m_lastGazeState = response;
-
+                        // Servers older than IPC version 3 still send the version 1 result.
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeDataResult2>() ) {
+                            m_lastGazeState = ByteArrayToStructure<CommandDataServerGazeDataResult2>(pBuffer, dataOffset);
+                        } else if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeDataResult>() ) {
+                            CommandDataServerGazeDataResult response = ByteArrayToStructure<CommandDataServerGazeDataResult>(pBuffer, dataOffset);
+                            m_lastGazeState = new CommandDataServerGazeDataResult2() {
+                                leftEye = response.leftEye,
+                                rightEye = response.rightEye,
+                            };
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeHistoryResult: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeHistoryResult>() ) {
+                            CommandDataServerGazeHistoryResult response = ByteArrayToStructure<CommandDataServerGazeHistoryResult>(pBuffer, dataOffset);
+                            for ( int i = 0; i < response.sampleCount; i++ ) {
+                                m_gazeHistory.Enqueue(response.samples[i]);
+                            }
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeEvents: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeEvents>() ) {
+                            CommandDataServerGazeEvents response = ByteArrayToStructure<CommandDataServerGazeEvents>(pBuffer, dataOffset);
+                            for ( int i = 0; i < response.eventCount; i++ ) {
+                                m_gazeEvents.Enqueue(response.events[i]);
+                            }
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazePredictionResult: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazePredictionResult>() ) {
+                            m_lastGazePrediction = ByteArrayToStructure<CommandDataServerGazePredictionResult>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeRecordingStatus: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeRecordingStatus>() ) {
+                            m_lastGazeRecordingStatus = ByteArrayToStructure<CommandDataServerGazeRecordingStatus>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeReplayStatus: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeReplayStatus>() ) {
+                            m_lastGazeReplayStatus = ByteArrayToStructure<CommandDataServerGazeReplayStatus>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeStats: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeStats>() ) {
+                            m_lastGazeStats = ByteArrayToStructure<CommandDataServerGazeStats>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeClockStatus: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeClockStatus>() ) {
+                            m_lastGazeClockStatus = ByteArrayToStructure<CommandDataServerGazeClockStatus>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeVergenceResult: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeVergenceResult>() ) {
+                            m_lastGazeVergence = ByteArrayToStructure<CommandDataServerGazeVergenceResult>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeFoveationResult: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeFoveationResult>() ) {
+                            m_lastGazeFoveation = ByteArrayToStructure<CommandDataServerGazeFoveationResult>(pBuffer, dataOffset);
+                        }
+                        break;
+                    }
+                case ECommandType.ServerGazeCalibrationStatus: {
+                        if ( header.dataLen == Marshal.SizeOf<CommandDataServerGazeCalibrationStatus>() ) {
+                            m_lastGazeCalibrationStatus = ByteArrayToStructure<CommandDataServerGazeCalibrationStatus>(pBuffer, dataOffset);
                         }
                         break;
                     }
@@ -245,12 +359,243 @@ namespace PSVR2Toolkit.CAPI {
         }
 
         public CommandDataServerGazeDataResult RequestEyeTrackingData() {
+            CommandDataServerGazeDataResult2 gazeState = RequestEyeTrackingData2();
+            return new CommandDataServerGazeDataResult() {
+                leftEye = gazeState.leftEye,
+                rightEye = gazeState.rightEye,
+            };
+        }
+
+        // Includes the sequence number, timestamps and the combined gaze ray. Only the eyes are filled in when talking to an older server.
+        public CommandDataServerGazeDataResult2 RequestEyeTrackingData2() {
+
+            if ( !m_running ) {
+                return new CommandDataServerGazeDataResult2();
+            }
 
+            return m_lastGazeState ?? new CommandDataServerGazeDataResult2();
+        }
+
+        // Asks the server for every gaze sample newer than afterSequence, the samples are queued as they arrive.
+        public void RequestGazeHistory(ulong afterSequence) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientRequestGazeHistory request = new CommandDataClientRequestGazeHistory() {
+                afterSequence = afterSequence,
+            };
+            SendIpcCommand(ECommandType.ClientRequestGazeHistory, request);
+        }
+
+        public bool TryDequeueGazeHistorySample(out CommandDataServerGazeDataResult2 sample) {
+            return m_gazeHistory.TryDequeue(out sample);
+        }
+
+        // Asks for the combined gaze extrapolated to a host QPC time in microseconds, or to the next vsync if 0.
+        public void RequestGazePrediction(long targetHostTimestampUs) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientRequestGazePrediction request = new CommandDataClientRequestGazePrediction() {
+                targetHostTimestampUs = targetHostTimestampUs,
+            };
+            SendIpcCommand(ECommandType.ClientRequestGazePrediction, request);
+        }
+
+        // The answer to the most recent prediction request, null until one has arrived.
+        public CommandDataServerGazePredictionResult? GetGazePrediction() {
+            return m_lastGazePrediction;
+        }
+
+        // Fixation and saccade events are queued as the server classifies them, starting from the subscription.
+        public void SubscribeGazeEvents() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientSubscribeGazeEvents);
+        }
+
+        public void UnsubscribeGazeEvents() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientUnsubscribeGazeEvents);
+        }
+
+        public bool TryDequeueGazeEvent(out GazeEvent gazeEvent) {
+            return m_gazeEvents.TryDequeue(out gazeEvent);
+        }
+
+        // Records raw and calibrated gaze into a file on the driver's side, see the gazeRecordingDirectory setting.
+        public void StartGazeRecording() {
             if ( !m_running ) {
-                return new CommandDataServerGazeDataResult();
+                return;
             }
 
-            return m_lastGazeState ?? new CommandDataServerGazeDataResult();
+            SendIpcCommand(ECommandType.ClientStartGazeRecording);
+        }
+
+        public void StopGazeRecording() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientStopGazeRecording);
+        }
+
+        public void RequestGazeRecordingStatus() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientRequestGazeRecordingStatus);
+        }
+
+        // The answer to the most recent recording command, null until one has arrived.
+        public CommandDataServerGazeRecordingStatus? GetGazeRecordingStatus() {
+            return m_lastGazeRecordingStatus;
+        }
+
+        // Replays a recording in place of the headset, path is a full path or the file name of a recording.
+        public void StartGazeReplay(string path, bool asFastAsPossible) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientStartGazeReplay request = new CommandDataClientStartGazeReplay() {
+                asFastAsPossible = asFastAsPossible,
+                path = path,
+            };
+            SendIpcCommand(ECommandType.ClientStartGazeReplay, request);
+        }
+
+        public void StopGazeReplay() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientStopGazeReplay);
+        }
+
+        public void RequestGazeReplayStatus() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientRequestGazeReplayStatus);
+        }
+
+        // The answer to the most recent replay command, null until one has arrived.
+        public CommandDataServerGazeReplayStatus? GetGazeReplayStatus() {
+            return m_lastGazeReplayStatus;
+        }
+
+        // Stage latencies of the driver's gaze pipeline, reset clears them once they've been read.
+        public void RequestGazeStats(bool reset = false) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientRequestGazeStats request = new CommandDataClientRequestGazeStats() {
+                reset = reset,
+            };
+            SendIpcCommand(ECommandType.ClientRequestGazeStats, request);
+        }
+
+        // Writes the full histograms to a CSV file in the driver's gaze recording directory.
+        public void DumpGazeStats() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientDumpGazeStats);
+        }
+
+        // The answer to the most recent stats command, null until one has arrived.
+        public CommandDataServerGazeStats? GetGazeStats() {
+            return m_lastGazeStats;
+        }
+
+        public void RequestGazeClockStatus() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientRequestGazeClockStatus);
+        }
+
+        // The answer to the most recent clock status request, null until one has arrived.
+        public CommandDataServerGazeClockStatus? GetGazeClockStatus() {
+            return m_lastGazeClockStatus;
+        }
+
+        // 3D fixation point and depth from the vergence of the two eyes.
+        public void RequestGazeVergence() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientRequestGazeVergence);
+        }
+
+        // The answer to the most recent vergence request, null until one has arrived.
+        public CommandDataServerGazeVergenceResult? GetGazeVergence() {
+            return m_lastGazeVergence;
+        }
+
+        // Gaze point and fovea rectangle on each eye's image, for setting up foveated rendering.
+        public void RequestGazeFoveation() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientRequestGazeFoveation);
+        }
+
+        // The answer to the most recent foveation request, null until one has arrived.
+        public CommandDataServerGazeFoveationResult? GetGazeFoveation() {
+            return m_lastGazeFoveation;
+        }
+
+        public void StartGazeCalibration() {
+            if ( !m_running ) {
+                return;
+            }
+
+            SendIpcCommand(ECommandType.ClientStartGazeCalibration);
+        }
+
+        // Call once the target is showing, samples are collected for it until the next point or the stop.
+        public void SetGazeCalibrationPoint(float targetX, float targetY) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientSetGazeCalibrationPoint request = new CommandDataClientSetGazeCalibrationPoint() {
+                targetX = targetX,
+                targetY = targetY,
+            };
+            SendIpcCommand(ECommandType.ClientSetGazeCalibrationPoint, request);
+        }
+
+        public void StopGazeCalibration(bool apply) {
+            if ( !m_running ) {
+                return;
+            }
+
+            CommandDataClientStopGazeCalibration request = new CommandDataClientStopGazeCalibration() {
+                apply = apply,
+            };
+            SendIpcCommand(ECommandType.ClientStopGazeCalibration, request);
+        }
+
+        // The answer to the most recent calibration command, null until one has arrived.
+        public CommandDataServerGazeCalibrationStatus? GetGazeCalibrationStatus() {
+            return m_lastGazeCalibrationStatus;
         }
 
         public void TriggerEffectDisable(EVRControllerType controllerType) {
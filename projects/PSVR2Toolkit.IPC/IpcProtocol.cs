@@ -9,7 +9,7 @@ namespace PSVR2Toolkit.CAPI {
         ServerHandshakeResult, // CommandDataServerHandshakeResult
 
         ClientRequestGazeData, // No command data.
-        ServerGazeDataResult, // CommandDataServerGazeDataResult
+        ServerGazeDataResult, // CommandDataServerGazeDataResult, or CommandDataServerGazeDataResult2 from IPC version 3. Also pushed to clients subscribed to gaze.
 
         ClientTriggerEffectOff, // CommandDataClientTriggerEffectOff
         ClientTriggerEffectFeedback, // CommandDataClientTriggerEffectFeedback
@@ -18,6 +18,53 @@ namespace PSVR2Toolkit.CAPI {
         ClientTriggerEffectMultiplePositionFeedback, // CommandDataClientTriggerEffectMultiplePositionFeedback
         ClientTriggerEffectSlopeFeedback, // CommandDataClientTriggerEffectSlopeFeedback
         ClientTriggerEffectMultiplePositionVibration, // CommandDataClientTriggerEffectMultiplePositionVibration
+
+        ClientSubscribeGaze, // CommandDataClientSubscribeGaze, or no command data to receive every sample. Requires IPC version 2.
+        ClientUnsubscribeGaze, // No command data.
+
+        ClientRequestGazeHistory, // CommandDataClientRequestGazeHistory, requires IPC version 3.
+        ServerGazeHistoryResult, // CommandDataServerGazeHistoryResult, one or more per request.
+
+        // Calibration session, each command is answered with ServerGazeCalibrationStatus.
+        // Only one client can run a session at a time, it is cancelled if that client disconnects.
+        ClientStartGazeCalibration, // No command data.
+        ClientSetGazeCalibrationPoint, // CommandDataClientSetGazeCalibrationPoint, no command data means the origin.
+        ClientStopGazeCalibration, // CommandDataClientStopGazeCalibration, no command data means discard.
+        ServerGazeCalibrationStatus, // CommandDataServerGazeCalibrationStatus
+
+        ClientRequestGazePrediction, // CommandDataClientRequestGazePrediction, no command data means the next vsync.
+        ServerGazePredictionResult, // CommandDataServerGazePredictionResult
+
+        ClientSubscribeGazeEvents, // No command data.
+        ClientUnsubscribeGazeEvents, // No command data.
+        ServerGazeEvents, // CommandDataServerGazeEvents, pushed to clients subscribed to gaze events.
+
+        // Each command is answered with ServerGazeRecordingStatus, start and stop once the file is opened or finalized.
+        ClientStartGazeRecording, // No command data.
+        ClientStopGazeRecording, // No command data.
+        ClientRequestGazeRecordingStatus, // No command data.
+        ServerGazeRecordingStatus, // CommandDataServerGazeRecordingStatus
+
+        // Feeds a recording through the gaze pipeline in place of the headset, live gaze is ignored while it runs.
+        // Each command is answered with ServerGazeReplayStatus.
+        ClientStartGazeReplay, // CommandDataClientStartGazeReplay
+        ClientStopGazeReplay, // No command data.
+        ClientRequestGazeReplayStatus, // No command data.
+        ServerGazeReplayStatus, // CommandDataServerGazeReplayStatus
+
+        // Latency of every gaze pipeline stage, both commands are answered with ServerGazeStats.
+        ClientRequestGazeStats, // CommandDataClientRequestGazeStats, no command data means keep the histograms.
+        ClientDumpGazeStats, // No command data. Writes the full histograms next to the gaze recordings.
+        ServerGazeStats, // CommandDataServerGazeStats
+
+        ClientRequestGazeClockStatus, // No command data.
+        ServerGazeClockStatus, // CommandDataServerGazeClockStatus
+
+        ClientRequestGazeVergence, // No command data.
+        ServerGazeVergenceResult, // CommandDataServerGazeVergenceResult
+
+        ClientRequestGazeFoveation, // No command data.
+        ServerGazeFoveationResult, // CommandDataServerGazeFoveationResult
     };
 
     public enum EHandshakeResult : byte {
@@ -32,6 +79,43 @@ namespace PSVR2Toolkit.CAPI {
         Both,
     };
 
+    public enum EGazeCalibrationState : byte {
+        Idle,
+        Running,
+        Busy, // Another client is running a session, the command was ignored.
+    };
+
+    public enum EGazeEventType : byte {
+        FixationStart, // Sent once the fixation has lasted the minimum fixation duration.
+        FixationEnd,
+        SaccadeStart,
+        SaccadeEnd,
+    };
+
+    public enum EGazeEventSource : byte {
+        LeftEye,
+        RightEye,
+        Combined,
+    };
+
+    // In the order a gaze state passes through them.
+    public enum EGazeStage : byte {
+        UsbRead, // Waiting in the USB read for the next packet, mostly the time between packets.
+        Parse, // From the read returning to the pipeline starting, timestamp unwrapping and conversion.
+        Remap, // Calibration sampling and remap.
+        Fusion,
+        Filter,
+        Record, // Stamping the sequence number and recording.
+        Predict,
+        Vergence,
+        Foveation, // Projecting the gaze into each eye's image.
+        OpenVrUpdate, // Passing the state on to SteamVR, including the eye tracking component update.
+        Publish, // Handing the sample to the IPC server and the shared memory ring.
+        Pipeline, // From the read returning, or a replayed frame starting, to the sample being published.
+        IpcWake, // From the sample being published to the IPC event loop picking it up.
+        IpcFanOut, // Sending the sample and any gaze events to every subscribed client.
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public struct CommandDataClientRequestHandshake {
         public ushort ipcVersion; // The IPC version this client is using.
@@ -75,12 +159,248 @@ namespace PSVR2Toolkit.CAPI {
         public GazeEyeResult rightEye;
     };
 
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    public struct GazeCombinedResult {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isGazeOriginValid;
+        public GazeVector3 gazeOriginMm;
+
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isGazeDirValid;
+        public GazeVector3 gazeDirNorm;
+    };
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    public struct CommandDataServerGazeDataResult2 {
+        public ulong sequence; // Starts at 1, increases by one for every gaze sample. A repeated sequence is a repeated sample.
+        public ulong hmdTimestampUs; // HMD clock, unwrapped to 64 bits.
+        public long hostTimestampUs; // The HMD timestamp converted to host QPC time, in microseconds.
+
+        public GazeEyeResult leftEye;
+        public GazeEyeResult rightEye;
+        public GazeCombinedResult combined;
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public struct CommandHeader {
         public ECommandType type;
         public int dataLen;
     };
 
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientSubscribeGaze {
+        public ushort decimation; // Only every Nth gaze sample is pushed to the client, 0 and 1 both mean every sample.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientRequestGazeHistory {
+        public ulong afterSequence; // Requests every sample newer than this, 0 for everything still in the history.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeHistoryResult {
+        public const int k_unGazeHistoryMaxSamples = 8;
+
+        public ulong latestSequence; // Newest sample in the history when the response was built.
+        public uint missedCount; // Requested samples skipped before this message's samples, because they were already overwritten.
+        public byte sampleCount;
+        [MarshalAs(UnmanagedType.I1)]
+        public bool hasMore; // More result messages for the same request follow.
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = k_unGazeHistoryMaxSamples)]
+        public CommandDataServerGazeDataResult2[] samples;
+    };
+
+    // Finishes the previous point and starts collecting samples for this one.
+    // Show the target before sending this, the first moments after are skipped while the eye settles.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientSetGazeCalibrationPoint {
+        public float targetX, targetY; // Where the target is, in calibrated gaze direction coordinates.
+    };
+
+    // Finishes the last point and ends the session.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientStopGazeCalibration {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool apply; // Applies the fit right away and saves it to the settings, otherwise it is discarded.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GazeCalibrationEyeStatus {
+        public ushort pointCount; // Points fitted so far.
+        public ushort lastPointSamples; // Samples kept for the last point, 0 if it was rejected.
+        public ushort lastPointRejected; // Samples of the last point dropped as blinks or outliers.
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isFitValid;
+        public float rmsError; // Distance between the fit and the targets, in calibrated gaze units.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeCalibrationStatus {
+        public EGazeCalibrationState state;
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isApplied; // Only set in the answer to a stop that applied the fit.
+        public GazeCalibrationEyeStatus leftEye;
+        public GazeCalibrationEyeStatus rightEye;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientRequestGazePrediction {
+        public long targetHostTimestampUs; // Host QPC time in microseconds to predict the gaze for, 0 for the next vsync.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazePredictionResult {
+        public long targetHostTimestampUs; // The time predicted for. Falls back to now if 0 was requested and no vsync has been seen.
+        public long sampleHostTimestampUs; // Host time of the newest sample the prediction is based on.
+        public ulong sequence; // Sequence number of that sample.
+        public GazeVector3 gazeOriginMm;
+        public GazeVector3 gazeDirNorm; // The combined gaze ray, extrapolated at most 50 ms past the sample.
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isValid; // Whether there was a valid combined gaze to predict from.
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isSaccade; // A saccade is in progress, the direction is held instead of extrapolated.
+    };
+
+    // Positions are in calibrated gaze direction coordinates, like the x and y of gazeDirNorm.
+    // A blink or lost tracking ends whatever event was in progress.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GazeEvent {
+        public ulong sequence; // Gaze sample the event started at.
+        public long hostTimestampUs; // Host time of that sample.
+        public uint durationUs; // Only set for end events.
+        public EGazeEventType type;
+        public EGazeEventSource source;
+        public ushort sampleCount; // Samples the fixation or saccade spans so far.
+        public float x, y; // Fixation centroid, or where the saccade started or landed.
+        public float amplitude; // Saccade end events only, distance between launch and landing.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeEvents {
+        public const int k_unGazeEventsMaxEvents = 16;
+
+        public byte eventCount;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = k_unGazeEventsMaxEvents)]
+        public GazeEvent[] events; // Oldest first.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeRecordingStatus {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isRecording;
+        public uint droppedFrameCount; // Frames of the current or last recording that didn't make it into the file.
+        public ulong frameCount; // Frames recorded so far, or in total once stopped.
+    };
+
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    public struct CommandDataClientStartGazeReplay {
+        public const int k_unGazeReplayMaxPath = 260;
+
+        [MarshalAs(UnmanagedType.I1)]
+        public bool asFastAsPossible; // Otherwise frames are fed at the pace they were recorded at.
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = k_unGazeReplayMaxPath)]
+        public string path; // A full path, or the file name of a recording in the recording directory.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeReplayStatus {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isReplaying;
+        public ulong frameCount; // Frames in the recording being replayed, or the last one.
+        public ulong replayedFrameCount;
+        public ulong processingTimeUs; // Time spent in the pipeline, for the throughput without any pacing.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataClientRequestGazeStats {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool reset; // Clears the histograms once they have been read.
+    };
+
+    // Percentiles are the upper bound of the histogram bucket they fall into, within about 6% of the real value.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GazeStageStats {
+        public ulong count;
+        public uint meanNs;
+        public uint p50Ns;
+        public uint p90Ns;
+        public uint p99Ns;
+        public uint p999Ns;
+        public uint maxNs;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeStats {
+        public const int k_unGazeStatsMaxStages = 16;
+
+        public byte stageCount;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = k_unGazeStatsMaxStages)]
+        public GazeStageStats[] stages; // Indexed by EGazeStage.
+    };
+
+    // How HMD timestamps are mapped to host time, and how well the mapped times line up with when samples arrive.
+    // Latency and interval statistics cover the last complete window of 1024 samples, they are 0 until the first one.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeClockStatus {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isSynchronized; // At least two HMD offset samples have been fitted.
+        public uint offsetSampleCount; // Offset samples in the fit, outliers excluded.
+        public long offsetUs; // Host minus HMD time at the newest offset sample.
+        public float driftPpm; // How much faster the host clock runs than the HMD's.
+        public float offsetResidualRmsUs; // Of the offset samples around the fit.
+        public float offsetResidualMaxUs;
+        public uint jitterSampleCount;
+        public float latencyMeanUs; // From the mapped sample time to the USB read returning.
+        public float latencyStdDevUs;
+        public float latencyMinUs;
+        public float latencyMaxUs;
+        public float intervalMeanUs; // Between consecutive HMD timestamps.
+        public float intervalStdDevUs;
+    };
+
+    // Where the eyes are fixating in 3D, from where the left and right gaze rays pass closest to each other.
+    // Positions are in the same coordinates as gazeOriginMm, depths are measured from midway between the eye origins.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeVergenceResult {
+        public ulong sequence; // Gaze sample it was computed from.
+        public long hostTimestampUs; // Host time of that sample.
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isValid; // Both eyes were tracked and open.
+        public float confidence; // 0 to 1, falls as the rays miss each other by more than about a degree.
+        public GazeVector3 fixationPointMm; // Along this sample's direction, at the smoothed depth.
+        public float fixationDepthMm; // Smoothed over confident samples, at most 10 m.
+        public float rawFixationDepthMm; // From this sample alone.
+        public float vergenceAngleDeg; // Angle between the rays, negative if they diverge.
+        public float rayGapMm; // How far apart the rays pass at their closest.
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GazeVector2 {
+        public float x, y;
+    };
+
+    // Where one eye's gaze lands on that eye's image, in normalized image coordinates from 0,0 at the top left to 1,1 at the bottom right.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GazeFoveationEye {
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isValid; // The eye, or failing that the combined gaze, was tracked, and the display geometry is known.
+        [MarshalAs(UnmanagedType.I1)]
+        public bool isInView; // gazePoint is within the image.
+        public GazeVector2 gazePoint; // Outside 0 to 1 when looking past the edge of the image.
+        public GazeVector2 foveaMin; // foveaRadiusDeg either side of the gaze along each axis, clamped to the image.
+        public GazeVector2 foveaMax;
+    };
+
+    // The gaze projected through the eye to head transforms and raw projections the headset reports to SteamVR.
+    [StructLayout(LayoutKind.Sequential)]
+    public struct CommandDataServerGazeFoveationResult {
+        public ulong sequence; // Gaze sample it was computed from.
+        public long hostTimestampUs; // Host time of that sample.
+        public float foveaRadiusDeg;
+        public GazeFoveationEye leftEye;
+        public GazeFoveationEye rightEye;
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public struct CommandDataClientTriggerEffectOff {
         public EVRControllerType controllerType;
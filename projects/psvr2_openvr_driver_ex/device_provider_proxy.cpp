@@ -3,6 +3,17 @@
 #include "config.h"
 #include "caesar_manager_hooks.h"
 #include "driver_context_proxy.h"
+#include "driver_host_proxy.h"
+#include "gaze_calibration_store.h"
+#include "gaze_filter.h"
+#include "gaze_foveation.h"
+#include "gaze_fusion.h"
+#include "gaze_metrics.h"
+#include "gaze_pipeline.h"
+#include "gaze_pipeline_driver.h"
+#include "gaze_recorder.h"
+#include "gaze_replay.h"
+#include "gaze_ring_publisher.h"
 #include "hmd_device_hooks.h"
 #include "hmd_driver_loader.h"
 #include "hook_lib.h"
@@ -58,6 +69,8 @@ namespace psvr2_toolkit {
 
   void DeviceProviderProxy::Cleanup() {
     IpcServer::Instance()->Stop();
+    GazeReplay::Instance()->Stop();
+    GazeRecorder::Instance()->Shutdown();
 
     m_pDeviceProvider->Cleanup();
   }
@@ -132,8 +145,24 @@ namespace psvr2_toolkit {
   }
 
   void DeviceProviderProxy::InitSystems() {
+    GazeMetrics::Instance()->Initialize();
     IpcServer::Instance()->Initialize();
+    GazeRingPublisher::Instance()->Initialize();
     TriggerEffectManager::Instance()->Initialize();
+    GazeCalibrationStore::Instance()->Initialize();
+    GazeFusion::Instance()->Initialize();
+    GazeFilter::Instance()->Initialize();
+    GazeFoveation::Instance()->Initialize();
+    GazeRecorder::Instance()->Initialize();
+    GazePipeline::Instance()->Initialize(new DriverGazeInput, new DriverGazeOpenVrUpdate, new DriverGazeIpcSink);
+    GazeReplay::Instance()->Initialize();
+
+    DriverHostProxy::Instance()->SetEventHandler(HandleEvent);
+  }
+
+  void DeviceProviderProxy::HandleEvent(vr::VREvent_t *pEvent) {
+    GazeCalibrationStore::HandleEvent(pEvent);
+    GazeRecorder::HandleEvent(pEvent);
   }
 
 } // psvr2_toolkit
@@ -33,6 +33,8 @@ namespace psvr2_toolkit {
 
     void InitPatches();
     void InitSystems();
+
+    static void HandleEvent(vr::VREvent_t *pEvent);
   };
 
 } // psvr2_toolkit
@@ -4,13 +4,14 @@
 #include "util.h"
 #include "vr_settings.h"
 
+#include <cmath>
 #include <cstdint>
 
 namespace psvr2_toolkit {
 
   /* Hardcoded device indexes, in order of when they are registered inside the driver. */
 
-  static constexpr uint32_t k_unDeviceIndexHeadset = 0; // Currently not used.
+  static constexpr uint32_t k_unDeviceIndexHeadset = 0;
   static constexpr uint32_t k_unDeviceIndexSenseControllerLeft = 1;
   static constexpr uint32_t k_unDeviceIndexSenseControllerRight = 2;
 
@@ -19,6 +20,11 @@ namespace psvr2_toolkit {
   DriverHostProxy::DriverHostProxy()
     : m_pDriverHost(nullptr)
     , m_pfnEventHandler(nullptr)
+    , m_lastVsyncTimestampUs(0)
+    , m_vsyncPeriodUs(0)
+    , m_displayGeometryMutex()
+    , m_displayGeometryWorking{}
+    , m_displayGeometry()
   {}
   
   DriverHostProxy *DriverHostProxy::Instance() {
@@ -37,6 +43,29 @@ namespace psvr2_toolkit {
     m_pfnEventHandler = pfnEventHandler;
   }
 
+  int64_t DriverHostProxy::GetNextVsyncTimestamp() {
+    int64_t lastVsync = m_lastVsyncTimestampUs.load(std::memory_order_relaxed);
+    int64_t period = m_vsyncPeriodUs.load(std::memory_order_relaxed);
+    if (lastVsync == 0 || period == 0) {
+      return 0;
+    }
+
+    int64_t now = Util::GetHostTimestamp();
+    if (now < lastVsync) {
+      return lastVsync;
+    }
+
+    return lastVsync + ((now - lastVsync) / period + 1) * period;
+  }
+
+  bool DriverHostProxy::GetDisplayGeometry(DisplayGeometry_t *pGeometry) {
+    if (!m_displayGeometry.Read(*pGeometry)) {
+      return false;
+    }
+
+    return pGeometry->hasEyeToHead && pGeometry->hasProjection;
+  }
+
   bool DriverHostProxy::TrackedDeviceAdded(const char *pchDeviceSerialNumber, vr::ETrackedDeviceClass eDeviceClass, vr::ITrackedDeviceServerDriver *pDriver) {
     if (Util::StartsWith(pchDeviceSerialNumber, "playstation_vr2_sense_controller_") &&
         VRSettings::GetBool(STEAMVR_SETTINGS_DISABLE_SENSE, SETTING_DISABLE_SENSE_DEFAULT_VALUE))
@@ -56,6 +85,19 @@ namespace psvr2_toolkit {
   }
 
   void DriverHostProxy::VsyncEvent(double vsyncTimeOffsetSeconds) {
+    // Anything outside of this is a missed vsync or a refresh rate change, not a period to learn from.
+    static constexpr int64_t k_minVsyncPeriodUs = 2000;
+    static constexpr int64_t k_maxVsyncPeriodUs = 50000;
+
+    int64_t vsync = Util::GetHostTimestamp() + std::llround(vsyncTimeOffsetSeconds * 1e6);
+    int64_t lastVsync = m_lastVsyncTimestampUs.exchange(vsync, std::memory_order_relaxed);
+    int64_t interval = vsync - lastVsync;
+
+    if (lastVsync != 0 && interval >= k_minVsyncPeriodUs && interval <= k_maxVsyncPeriodUs) {
+      int64_t period = m_vsyncPeriodUs.load(std::memory_order_relaxed);
+      m_vsyncPeriodUs.store(period == 0 ? interval : period + (interval - period) / 8, std::memory_order_relaxed);
+    }
+
     m_pDriverHost->VsyncEvent(vsyncTimeOffsetSeconds);
   }
 
@@ -90,10 +132,26 @@ namespace psvr2_toolkit {
   }
 
   void DriverHostProxy::SetDisplayEyeToHead(uint32_t unWhichDevice, const vr::HmdMatrix34_t &eyeToHeadLeft, const vr::HmdMatrix34_t &eyeToHeadRight) {
+    if (unWhichDevice == k_unDeviceIndexHeadset) {
+      std::scoped_lock<std::mutex> lock(m_displayGeometryMutex);
+      m_displayGeometryWorking.hasEyeToHead = true;
+      m_displayGeometryWorking.eyeToHead[0] = eyeToHeadLeft;
+      m_displayGeometryWorking.eyeToHead[1] = eyeToHeadRight;
+      m_displayGeometry.Write(m_displayGeometryWorking);
+    }
+
     m_pDriverHost->SetDisplayEyeToHead(unWhichDevice, eyeToHeadLeft, eyeToHeadRight);
   }
 
   void DriverHostProxy::SetDisplayProjectionRaw(uint32_t unWhichDevice, const vr::HmdRect2_t &eyeLeft, const vr::HmdRect2_t &eyeRight) {
+    if (unWhichDevice == k_unDeviceIndexHeadset) {
+      std::scoped_lock<std::mutex> lock(m_displayGeometryMutex);
+      m_displayGeometryWorking.hasProjection = true;
+      m_displayGeometryWorking.projection[0] = eyeLeft;
+      m_displayGeometryWorking.projection[1] = eyeRight;
+      m_displayGeometry.Write(m_displayGeometryWorking);
+    }
+
     m_pDriverHost->SetDisplayProjectionRaw(unWhichDevice, eyeLeft, eyeRight);
   }
 
@@ -1,11 +1,25 @@
 #pragma once
 
+#include "seqlock.h"
+
 #include <openvr_driver.h>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
 namespace psvr2_toolkit {
 
   class DriverHostProxy : public vr::IVRServerDriverHost {
   public:
+    // What the PS VR2 driver last told SteamVR about the headset's displays.
+    struct DisplayGeometry_t {
+      bool hasEyeToHead;
+      bool hasProjection;
+      vr::HmdMatrix34_t eyeToHead[2]; // Left, right.
+      vr::HmdRect2_t projection[2]; // Left, right. Tangents of the half angles, y down as in GetProjectionRaw.
+    };
+
     DriverHostProxy();
 
     static DriverHostProxy *Instance();
@@ -13,6 +27,12 @@ namespace psvr2_toolkit {
     void SetDriverHost(vr::IVRServerDriverHost *pDriverHost);
     void SetEventHandler(void (*pfnEventHandler)(vr::VREvent_t *)); // Required for intercepting polled events from the PS VR2 driver.
 
+    // Host QPC time in microseconds of the next vsync, extrapolated from the ones the PS VR2 driver reported. 0 if unknown.
+    int64_t GetNextVsyncTimestamp();
+
+    // Callable from any thread. Returns false until the PS VR2 driver has set both the eye to head transforms and the projections.
+    bool GetDisplayGeometry(DisplayGeometry_t *pGeometry);
+
     /** IVRServerDriverHost **/
 
     bool TrackedDeviceAdded(const char *pchDeviceSerialNumber, vr::ETrackedDeviceClass eDeviceClass, vr::ITrackedDeviceServerDriver *pDriver) override;
@@ -34,6 +54,14 @@ namespace psvr2_toolkit {
     vr::IVRServerDriverHost *m_pDriverHost;
     void (*m_pfnEventHandler)(vr::VREvent_t *);
 
+    std::atomic<int64_t> m_lastVsyncTimestampUs; // 0 until the first vsync.
+    std::atomic<int64_t> m_vsyncPeriodUs; // Smoothed, 0 until two vsyncs have been seen.
+
+    // The PS VR2 driver may set the transforms and the projections from different threads, the mutex keeps the SeqLock to one writer.
+    std::mutex m_displayGeometryMutex;
+    DisplayGeometry_t m_displayGeometryWorking;
+    SeqLock<DisplayGeometry_t> m_displayGeometry;
+
     // Used internally for controller pose correction.
     vr::DriverPose_t GetPose(uint32_t unWhichDevice, const vr::DriverPose_t &originalPose);
   };
@@ -1,9 +1,9 @@
 #include "gaze_calibration.h"
+#include "util.h"
 #include "vr_settings.h" // Provides psvr2_toolkit::VRSettings
 
 #include <algorithm>
 #include <cmath>
-#include <optional>
 #include <sstream>
 
 namespace
@@ -11,9 +11,16 @@ namespace
     // Configuration keys used in steamvr.vrsettings
     constexpr auto CALIBRATION_KEY_SUFFIX = "Calibration";
     constexpr auto CENTER_KEY_SUFFIX = "Center";
+    constexpr auto GRID_SIZE_KEY_SUFFIX = "GridSize";
+    constexpr auto GRID_BOUNDS_KEY_SUFFIX = "GridBounds";
+    constexpr auto GRID_KEY_SUFFIX = "Grid";
+    constexpr auto GRID_MODEL_NAME = "grid";
 
     // Values in the config file are scaled by this factor for human readability.
     constexpr double CONFIG_SCALE = 100.0;
+
+    // A displacement printed with 6 significant digits is at most 13 characters, e.g. "-1.23457e-100", and a space.
+    constexpr size_t MAX_GRID_CHARS_PER_NODE = 2 * (13 + 1);
     constexpr double PI = 3.14159265358979323846;
     constexpr double TAU = 2.0 * PI;
 
@@ -45,29 +52,35 @@ namespace
 
     // --- Geometric Utilities ---
 
-    /**
-     * @brief Calculates the distance from a ray's origin to its intersection
-     * with a line segment defined by two points.
-     * @return Distance to intersection, or nullopt if no intersection.
-     */
-    std::optional<double> FindRaySegmentIntersection(Vec2d ray_dir, Vec2d p1, Vec2d p2) {
-        const auto segment_vec = Vec2d{ p1.x - p2.x, p1.y - p2.y };
-        const auto ray_normal = Vec2d{ -ray_dir.y, ray_dir.x };
-        const double dot = (segment_vec.x * ray_normal.x) + (segment_vec.y * ray_normal.y);
+    // Pseudo-angles run from 0 up to this, one unit per quadrant.
+    constexpr float PSEUDO_ANGLE_RANGE = 4.0f;
 
-        if (std::abs(dot) < 1e-5) return std::nullopt; // Parallel lines
+    // Smallest number of pseudo-angle bins, the bin lookup needs at least 4 per segment.
+    constexpr size_t MIN_BIN_COUNT = 64;
 
-        const double t = ((p1.x * ray_normal.x) + (p1.y * ray_normal.y)) / dot;
-        if (t < -1e-5 || t > 1.0 + 1e-5) return std::nullopt; // Intersection is outside the segment
-
-        const double cross_product = p2.x * p1.y - p2.y * p1.x;
-        return cross_product / dot;
+    Vec2d GridNodePosition(const GazeGridLayout& layout, size_t col, size_t row)
+    {
+        return {
+            layout.min.x + (layout.max.x - layout.min.x) * col / (layout.cols - 1),
+            layout.min.y + (layout.max.y - layout.min.y) * row / (layout.rows - 1),
+        };
     }
 
     Vec2d PolarToCartesian(double angle, double length) {
         return { std::cos(angle) * length, std::sin(angle) * length };
     }
 
+    /**
+     * @brief Maps a direction to [0, 4), increasing with its angle like atan2 mapped to [0, 2PI).
+     * Undefined for (0, 0).
+     */
+    template <typename T>
+    T PseudoAngle(T x, T y)
+    {
+        const T p = x / (std::abs(x) + std::abs(y));
+        return (y >= T(0)) ? T(1) - p : T(3) + p;
+    }
+
 } // Anonymous namespace
 
 void GazeCalibrationProfile::LoadConfig(const std::string& eye_section)
@@ -98,62 +111,216 @@ void GazeCalibrationProfile::LoadConfig(const std::string& eye_section)
             m_calibration.push_back(sample / CONFIG_SCALE);
         }
     }
+
+    BuildSegmentTable();
+
+    // The polygon table is built either way, it is the fallback if the grid can't be loaded.
+    m_model = Model::Polygon;
+    m_grid.Clear();
+    const std::string model_str = psvr2_toolkit::VRSettings::GetString(STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL, SETTING_GAZE_CALIBRATION_MODEL_DEFAULT_VALUE);
+    if (model_str == GRID_MODEL_NAME)
+    {
+        if (LoadGridConfig(eye_section))
+        {
+            m_model = Model::Grid;
+        }
+        else
+        {
+            psvr2_toolkit::Util::DriverLog("[GAZE_CALIBRATION] {} grid is missing or malformed, using the polygon model.", eye_section);
+        }
+    }
 }
 
-Hmd2Vector3 GazeCalibrationProfile::Remap(const Hmd2Vector3& raw_gaze_dir) const
+bool GazeCalibrationProfile::LoadGridConfig(const std::string& eye_section)
 {
-    // 1. Apply the center offset to the raw gaze coordinates.
-    double x = raw_gaze_dir.x - m_center.x;
-    double y = raw_gaze_dir.y - m_center.y;
+    const std::string size_key = eye_section + "_" + GRID_SIZE_KEY_SUFFIX;
+    const std::string bounds_key = eye_section + "_" + GRID_BOUNDS_KEY_SUFFIX;
+    const std::string grid_key = eye_section + "_" + GRID_KEY_SUFFIX;
 
-    // If no calibration data is loaded, return the centered position as a fallback.
-    if (m_calibration.empty())
+    const auto size_data = SplitString(psvr2_toolkit::VRSettings::GetString(size_key.c_str(), ""), ' ');
+    size_t cols = 0, rows = 0;
+    if (size_data.size() != 2 || !TryParse(size_data[0], &cols) || !TryParse(size_data[1], &rows)) return false;
+
+    // Defaults to the unit square the polygon model normalizes to.
+    const auto bounds_data = SplitString(psvr2_toolkit::VRSettings::GetString(bounds_key.c_str(), "-100 -100 100 100"), ' ');
+    double bounds[4] = {};
+    if (bounds_data.size() != 4) return false;
+    for (size_t i = 0; i < 4; ++i)
     {
-        return { (float)x, (float)y, raw_gaze_dir.z };
+        if (!TryParse(bounds_data[i], &bounds[i])) return false;
+        bounds[i] /= CONFIG_SCALE;
     }
 
-    // 2. Convert the centered Cartesian coordinates to polar coordinates.
-    double angle = std::atan2(y, x);
-    if (angle < 0) angle += TAU; // Ensure angle is in the [0, 2PI] range.
+    const auto grid_data = SplitString(psvr2_toolkit::VRSettings::GetString(grid_key.c_str(), ""), ' ');
+    if (cols < 2 || rows < 2 || cols * rows > MAX_GRID_NODES || grid_data.size() != cols * rows * 2) return false;
 
-    const double raw_distance = std::sqrt(x * x + y * y);
+    GazeGridLayout layout;
+    layout.cols = cols;
+    layout.rows = rows;
+    layout.min = { bounds[0], bounds[1] };
+    layout.max = { bounds[2], bounds[3] };
 
-    // 3. Get the expected raw distance (radius) from the calibration polygon at this angle.
-    const double calibrated_radius = GetInterpolatedRadiusAtAngle(angle);
+    // Turn the displacements into target positions.
+    layout.targets.resize(cols * rows);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            const size_t node = row * cols + col;
+            double dx = 0.0, dy = 0.0;
+            if (!TryParse(grid_data[node * 2], &dx) || !TryParse(grid_data[node * 2 + 1], &dy)) return false;
 
-    // 4. Normalize the raw distance by the expected distance from calibration.
-    const double scale = (calibrated_radius > 1e-6) ? calibrated_radius : 1.0;
-    const double normalized_distance = raw_distance / scale;
+            const Vec2d position = GridNodePosition(layout, col, row);
+            layout.targets[node] = { position.x + dx / CONFIG_SCALE, position.y + dy / CONFIG_SCALE };
+        }
+    }
 
-    // 5. Convert the remapped polar coordinates back to Cartesian coordinates.
-    const auto final_x = static_cast<float>(std::cos(angle) * normalized_distance);
-    const auto final_y = static_cast<float>(std::sin(angle) * normalized_distance);
+    return m_grid.Build(layout);
+}
 
-    return { final_x, final_y, raw_gaze_dir.z };
+bool GazeCalibrationProfile::UseGrid(const GazeGridLayout& layout)
+{
+    // A larger grid would be truncated when read back, and the profile would fall back to the polygon model.
+    static_assert(MAX_GRID_NODES * MAX_GRID_CHARS_PER_NODE < psvr2_toolkit::VRSettings::k_unMaxStringSize);
+    if (layout.cols * layout.rows > MAX_GRID_NODES) return false;
+
+    GazeGridWarp grid;
+    if (!grid.Build(layout)) return false;
+
+    m_grid = std::move(grid);
+    m_model = Model::Grid;
+    return true;
 }
 
-double GazeCalibrationProfile::GetInterpolatedRadiusAtAngle(double angle) const
+void GazeCalibrationProfile::SaveGridConfig(const std::string& eye_section, const GazeGridLayout& layout)
+{
+    const std::string size_key = eye_section + "_" + GRID_SIZE_KEY_SUFFIX;
+    const std::string bounds_key = eye_section + "_" + GRID_BOUNDS_KEY_SUFFIX;
+    const std::string grid_key = eye_section + "_" + GRID_KEY_SUFFIX;
+
+    std::ostringstream size_ss, bounds_ss, grid_ss;
+    bounds_ss.precision(6);
+    grid_ss.precision(6);
+
+    size_ss << layout.cols << ' ' << layout.rows;
+    bounds_ss << layout.min.x * CONFIG_SCALE << ' ' << layout.min.y * CONFIG_SCALE << ' '
+              << layout.max.x * CONFIG_SCALE << ' ' << layout.max.y * CONFIG_SCALE;
+
+    for (size_t row = 0; row < layout.rows; ++row)
+    {
+        for (size_t col = 0; col < layout.cols; ++col)
+        {
+            const Vec2d position = GridNodePosition(layout, col, row);
+            const Vec2d& target = layout.targets[row * layout.cols + col];
+            if (row != 0 || col != 0) grid_ss << ' ';
+            grid_ss << (target.x - position.x) * CONFIG_SCALE << ' ' << (target.y - position.y) * CONFIG_SCALE;
+        }
+    }
+
+    // Each write triggers a reload of its own, the last one sees the complete layout.
+    psvr2_toolkit::VRSettings::SetString(size_key.c_str(), size_ss.str());
+    psvr2_toolkit::VRSettings::SetString(bounds_key.c_str(), bounds_ss.str());
+    psvr2_toolkit::VRSettings::SetString(grid_key.c_str(), grid_ss.str());
+}
+
+void GazeCalibrationProfile::BuildSegmentTable()
 {
     const size_t num_samples = m_calibration.size();
-    if (num_samples == 0) return 1.0;
 
-    // Determine which two calibration points the current angle falls between.
-    const double angular_pos = angle / TAU * num_samples;
-    const size_t prev_index = static_cast<size_t>(angular_pos) % num_samples;
-    if (num_samples == 1) return m_calibration[prev_index];
+    m_centerX = static_cast<float>(m_center.x);
+    m_centerY = static_cast<float>(m_center.y);
+
+    m_segmentStart.assign(num_samples + 1, 0.0f);
+    m_segmentKx.assign(num_samples, 0.0f);
+    m_segmentKy.assign(num_samples, 0.0f);
+    m_segmentK0.assign(num_samples, 0.0f);
+    m_binSegment.clear();
+    m_binScale = 0.0f;
+
+    if (num_samples == 0) return;
+
+    // Larger than any pseudo-angle, so the lookup never steps past the last segment.
+    m_segmentStart[num_samples] = PSEUDO_ANGLE_RANGE + 1.0f;
+
+    for (size_t i = 0; i < num_samples; ++i)
+    {
+        const double angle = i * TAU / num_samples;
+        const Vec2d start_dir = PolarToCartesian(angle, 1.0);
+        m_segmentStart[i] = (i == 0) ? 0.0f : static_cast<float>(PseudoAngle(start_dir.x, start_dir.y));
+
+        if (num_samples == 1)
+        {
+            // A single sample is a circle, the radius is the same at every angle.
+            const double radius = m_calibration[0];
+            m_segmentK0[i] = static_cast<float>((radius != 0.0) ? 1.0 / radius : 0.0);
+            continue;
+        }
+
+        // The ray at (x, y) / r hits the line through p1 and p2 at distance cross / dot, where
+        // dot = ((p1.y - p2.y) * x - (p1.x - p2.x) * y) / r. Store its inverse as two coefficients.
+        const size_t next_index = (i + 1) % num_samples;
+        const Vec2d p1 = PolarToCartesian(angle, m_calibration[i]);
+        const Vec2d p2 = PolarToCartesian(next_index * TAU / num_samples, m_calibration[next_index]);
+        const double cross_product = p2.x * p1.y - p2.y * p1.x;
+
+        // A segment through the origin has a zero radius, which Remap treats as no scaling.
+        if (std::abs(cross_product) < 1e-12) continue;
+
+        m_segmentKx[i] = static_cast<float>((p1.y - p2.y) / cross_product);
+        m_segmentKy[i] = static_cast<float>((p2.x - p1.x) / cross_product);
+    }
+
+    // Segments are at least PI / num_samples wide in pseudo-angle, so with 4 bins per
+    // segment a bin never spans more than one segment start.
+    size_t bin_count = MIN_BIN_COUNT;
+    while (bin_count < num_samples * 4) bin_count *= 2;
+
+    m_binScale = bin_count / PSEUDO_ANGLE_RANGE;
+    m_binSegment.resize(bin_count);
 
-    const size_t next_index = (prev_index + 1) % num_samples;
+    size_t segment = 0;
+    for (size_t bin = 0; bin < bin_count; ++bin)
+    {
+        const float bin_start = bin / m_binScale;
+        while (segment + 1 < num_samples && m_segmentStart[segment + 1] <= bin_start) ++segment;
+        m_binSegment[bin] = static_cast<int32_t>(segment);
+    }
+}
 
-    // Get the positions of these two calibration points.
-    const double prev_angle = prev_index * TAU / num_samples;
-    const double next_angle = next_index * TAU / num_samples;
-    const Vec2d p1 = PolarToCartesian(prev_angle, m_calibration[prev_index]);
-    const Vec2d p2 = PolarToCartesian(next_angle, m_calibration[next_index]);
+Hmd2Vector3 GazeCalibrationProfile::Remap(const Hmd2Vector3& raw_gaze_dir) const
+{
+    // 1. Apply the center offset to the raw gaze coordinates.
+    const float x = raw_gaze_dir.x - m_centerX;
+    const float y = raw_gaze_dir.y - m_centerY;
 
-    // Find the radius by intersecting a ray with the line segment between the points.
-    const Vec2d ray_dir = PolarToCartesian(angle, 1.0);
-    const auto intersection = FindRaySegmentIntersection(ray_dir, p1, p2);
+    if (m_model == Model::Grid)
+    {
+        return m_grid.Apply({ x, y, raw_gaze_dir.z });
+    }
 
-    // As a fallback, use the nearest point if intersection fails.
-    return intersection.value_or(m_calibration[prev_index]);
-}
\ No newline at end of file
+    // If no calibration data is loaded, return the centered position as a fallback.
+    if (m_binSegment.empty())
+    {
+        return { x, y, raw_gaze_dir.z };
+    }
+
+    const float raw_distance = std::sqrt(x * x + y * y);
+    if (raw_distance == 0.0f)
+    {
+        return { 0.0f, 0.0f, raw_gaze_dir.z };
+    }
+
+    // 2. Find the polygon segment the gaze direction falls into.
+    const float pseudo_angle = PseudoAngle(x, y);
+    const size_t bin = std::min(static_cast<size_t>(pseudo_angle * m_binScale), m_binSegment.size() - 1);
+    size_t segment = m_binSegment[bin];
+    segment += (pseudo_angle >= m_segmentStart[segment + 1]) ? 1 : 0;
+
+    // 3. Get the inverse of the polygon radius along the gaze direction.
+    const float inverse_radius = (m_segmentKx[segment] * x + m_segmentKy[segment] * y) / raw_distance + m_segmentK0[segment];
+
+    // 4. Normalize the raw distance by the radius, unless the radius is degenerate (<= 1e-6 or negative).
+    const float scale = (inverse_radius > 0.0f && inverse_radius < 1e6f) ? inverse_radius : 1.0f;
+
+    return { x * scale, y * scale, raw_gaze_dir.z };
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 #include "hmd2_gaze.h" // Provides Hmd2Vector3
@@ -11,6 +13,53 @@ struct Vec2d
     double y = 0.0;
 };
 
+// A regular grid of nodes and where each of them should end up.
+struct GazeGridLayout
+{
+    size_t cols = 0; // Nodes along x, at least 2.
+    size_t rows = 0; // Nodes along y, at least 2.
+    Vec2d min;       // Position of the first node.
+    Vec2d max;       // Position of the last node.
+    std::vector<Vec2d> targets; // Row-major from min, cols * rows entries.
+};
+
+/**
+ * @brief A bilinear warp over a regular grid of nodes, for distortions a radial model can't express.
+ * Each node stores where its position should end up. Build compiles the nodes into one block of
+ * bilinear coefficients per cell, so Apply is a single cell lookup with no allocation.
+ * Points outside the grid extrapolate from the nearest edge cell.
+ */
+class GazeGridWarp
+{
+public:
+    /**
+     * @brief Compiles the mesh.
+     * @return false, leaving the warp empty, if the layout is invalid.
+     */
+    bool Build(const GazeGridLayout& layout);
+
+    void Clear();
+    bool Empty() const { return m_cells.empty(); }
+
+    Hmd2Vector3 Apply(const Hmd2Vector3& dir) const;
+
+private:
+    // out = a + b * u + c * v + d * u * v, with (u, v) the position inside the cell. 32 bytes, half a cache line.
+    struct Cell
+    {
+        float ax, bx, cx, dx;
+        float ay, by, cy, dy;
+    };
+
+    std::vector<Cell> m_cells; // Row-major, (cols - 1) * (rows - 1) of them.
+    int32_t m_cellCols = 0;
+    int32_t m_cellRows = 0;
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    float m_cellsPerUnitX = 0.0f;
+    float m_cellsPerUnitY = 0.0f;
+};
+
 /**
  * @brief Manages the calibration profile for a single eye.
  * This class loads calibration data from settings and applies the necessary
@@ -23,35 +72,104 @@ public:
     // at equidistant angles around a 360-degree circle.
     using CalibrationData = std::vector<double>;
 
+    enum class Model
+    {
+        Polygon, // Radius polygon around the center, the default.
+        Grid,    // Displacement grid around the center, see GazeGridWarp.
+    };
+
     /**
      * @brief Remaps a raw gaze direction vector using the loaded calibration profile.
+     * Uses only the tables built by LoadConfig, no trigonometry per call.
      * @param raw_gaze_dir The raw {x, y, z} vector from the eye tracker.
      * @return A new, calibrated {x, y, z} vector.
      */
     Hmd2Vector3 Remap(const Hmd2Vector3& raw_gaze_dir) const;
 
     /**
-     * @brief Loads the center offset and polygonal calibration data from SteamVR settings.
+     * @brief Remaps many gaze directions at once, for offline processing of recorded gaze.
+     * Uses AVX2 or SSE2 kernels when the CPU has them. The results are bit-identical to
+     * calling Remap on each sample, so offline and live output match.
+     * All spans must have the same length, outputs may be the same arrays as the inputs.
+     */
+    void RemapBatch(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                    std::span<float> out_x, std::span<float> out_y, std::span<float> out_z) const;
+
+    /**
+     * @brief The individual RemapBatch kernels, so tests and benchmarks can compare them.
+     * Only valid for a loaded polygon model. Each returns how many leading samples it remapped, the rest are
+     * left for Remap. RemapBatchAvx2 must only be called when CpuHasAvx2 returns true.
+     */
+    size_t RemapBatchSse2(const float* x, const float* y, float* out_x, float* out_y, size_t count) const;
+    size_t RemapBatchAvx2(const float* x, const float* y, float* out_x, float* out_y, size_t count) const;
+    static bool CpuHasAvx2();
+
+    /**
+     * @brief Loads the center offset and the data of the selected calibration model from SteamVR settings.
+     * Falls back to the polygon model if the grid data is missing or malformed.
      * @param eye_section The identifier for the eye, e.g., "LeftEye".
      */
     void LoadConfig(const std::string& eye_section);
 
+    /**
+     * Most nodes a grid may have, so its displacements always fit the settings string LoadConfig reads back.
+     */
+    static constexpr size_t MAX_GRID_NODES = 144;
+
+    /**
+     * @brief Switches to the grid model with the given layout, keeping the center.
+     * @return false, leaving the profile unchanged, if the layout is invalid or has more than MAX_GRID_NODES nodes.
+     */
+    bool UseGrid(const GazeGridLayout& layout);
+
+    /**
+     * @brief Writes a grid layout to SteamVR settings, in the format LoadConfig reads.
+     * The layout is relative to the center, which is left as it is.
+     */
+    static void SaveGridConfig(const std::string& eye_section, const GazeGridLayout& layout);
+
+    Model GetModel() const { return m_model; }
+    const Vec2d& GetCenter() const { return m_center; }
     const CalibrationData& GetCalibrationData() const { return m_calibration; }
 
 private:
     /**
-     * @brief Calculates the calibrated radius for a given angle.
-     * Treats the calibration data as vertices of a polygon and finds the radius
-     * by calculating the intersection of a ray at the given angle with the
-     * line segment connecting the two nearest vertices.
-     * @param angle The angle of the gaze in radians [0, 2PI].
-     * @return The interpolated radius (scale factor).
+     * @brief Precompiles the calibration polygon into per-segment coefficients.
+     * Treats the calibration data as vertices of a polygon. For a gaze point (x, y) at
+     * distance r in segment i, the inverse of the polygon radius along the gaze ray is
+     * (kx[i] * x + ky[i] * y) / r + k0[i], which is what Remap scales by.
+     * Segments are found by pseudo-angle, which is monotonic in the real angle but needs no atan2.
+     */
+    void BuildSegmentTable();
+
+    /**
+     * @brief Loads "<eye>_GridSize" (cols rows), "<eye>_GridBounds" (min x, min y, max x, max y)
+     * and "<eye>_Grid" (dx dy per node, row-major) and compiles them into m_grid.
+     * Bounds and displacements are in the same scaled units as the center.
      */
-    double GetInterpolatedRadiusAtAngle(double angle) const;
+    bool LoadGridConfig(const std::string& eye_section);
+
+    Model m_model = Model::Polygon;
 
     // A 2D offset to correct for the resting position of the user's gaze.
     Vec2d m_center = { 0.0, 0.0 };
 
+    // Only built for the grid model, applied to the centered gaze.
+    GazeGridWarp m_grid;
+
     // Defines the polygonal shape of the raw input, used for normalization.
     CalibrationData m_calibration;
+
+    // Segment table built from m_calibration, one entry per polygon edge.
+    std::vector<float> m_segmentStart; // Pseudo-angle each segment starts at, plus a final 4.0 sentinel.
+    std::vector<float> m_segmentKx;
+    std::vector<float> m_segmentKy;
+    std::vector<float> m_segmentK0;
+
+    // Maps a pseudo-angle bin to the first segment overlapping it. Bins are narrow enough
+    // that each holds at most one segment start, so one comparison finds the exact segment.
+    std::vector<int32_t> m_binSegment; // 32-bit so the batch kernels can gather it.
+    float m_binScale = 0.0f; // Bins per unit of pseudo-angle.
+    float m_centerX = 0.0f;
+    float m_centerY = 0.0f;
 };
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "gaze_calibration.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+
+#include <algorithm>
+
+// The kernels below mirror GazeCalibrationProfile::Remap operation for operation, in the same
+// order and without fused multiply-adds, which is what keeps them bit-identical to it.
+
+namespace
+{
+    enum class SimdLevel
+    {
+        Sse2, // Always there on x64.
+        Avx2,
+    };
+
+    SimdLevel DetectSimdLevel()
+    {
+#ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 0);
+        const int max_leaf = info[0];
+        if (max_leaf < 7) return SimdLevel::Sse2;
+
+        // AVX needs OS support for saving the YMM registers.
+        __cpuid(info, 1);
+        const bool os_xsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!os_xsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return SimdLevel::Sse2;
+
+        __cpuidex(info, 7, 0);
+        const bool avx2 = (info[1] & (1 << 5)) != 0;
+        return avx2 ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+        // The test build, where the compiler runtime does the same checks.
+        return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#endif
+    }
+
+    SimdLevel GetSimdLevel()
+    {
+        static const SimdLevel level = DetectSimdLevel();
+        return level;
+    }
+
+    // SSE2 has no blend, pick a where mask is set and b elsewhere.
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // SSE2 has no gather either.
+    inline __m128 Gather(const float* table, __m128i indices)
+    {
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), indices);
+        return _mm_setr_ps(table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]);
+    }
+
+    inline __m128i Gather(const int32_t* table, __m128i indices)
+    {
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), indices);
+        return _mm_setr_epi32(table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]);
+    }
+}
+
+// MSVC compiles AVX2 intrinsics anywhere, gcc and clang only in functions targeting it.
+#if defined(__GNUC__)
+#define GAZE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define GAZE_TARGET_AVX2
+#endif
+
+bool GazeCalibrationProfile::CpuHasAvx2()
+{
+    return GetSimdLevel() == SimdLevel::Avx2;
+}
+
+void GazeCalibrationProfile::RemapBatch(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                                        std::span<float> out_x, std::span<float> out_y, std::span<float> out_z) const
+{
+    const size_t count = std::min({ x.size(), y.size(), z.size(), out_x.size(), out_y.size(), out_z.size() });
+
+    // z is passed through untouched.
+    if (out_z.data() != z.data())
+    {
+        std::copy_n(z.data(), count, out_z.data());
+    }
+
+    // The kernels only cover the polygon model, the grid goes through Remap.
+    size_t done = 0;
+    if (m_model == Model::Polygon && !m_binSegment.empty())
+    {
+        done = (GetSimdLevel() == SimdLevel::Avx2)
+            ? RemapBatchAvx2(x.data(), y.data(), out_x.data(), out_y.data(), count)
+            : RemapBatchSse2(x.data(), y.data(), out_x.data(), out_y.data(), count);
+    }
+
+    // The tail, or everything when the kernels don't apply.
+    for (size_t i = done; i < count; ++i)
+    {
+        const Hmd2Vector3 remapped = Remap({ x[i], y[i], 0.0f });
+        out_x[i] = remapped.x;
+        out_y[i] = remapped.y;
+    }
+}
+
+size_t GazeCalibrationProfile::RemapBatchSse2(const float* x, const float* y, float* out_x, float* out_y, size_t count) const
+{
+    const __m128 center_x = _mm_set1_ps(m_centerX);
+    const __m128 center_y = _mm_set1_ps(m_centerY);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 max_inverse_radius = _mm_set1_ps(1e6f);
+    const __m128 bin_scale = _mm_set1_ps(m_binScale);
+    const __m128 last_bin = _mm_set1_ps(static_cast<float>(m_binSegment.size() - 1));
+    const __m128i one_i = _mm_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 cx = _mm_sub_ps(_mm_loadu_ps(x + i), center_x);
+        const __m128 cy = _mm_sub_ps(_mm_loadu_ps(y + i), center_y);
+
+        const __m128 raw_distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)));
+        const __m128 is_zero = _mm_cmpeq_ps(raw_distance, zero);
+
+        // Lanes at the origin get a NaN pseudo-angle, min maps that to the last bin so the lookups stay in range.
+        const __m128 p = _mm_div_ps(cx, _mm_add_ps(_mm_andnot_ps(sign_mask, cx), _mm_andnot_ps(sign_mask, cy)));
+        const __m128 pseudo_angle = Select(_mm_cmpge_ps(cy, zero), _mm_sub_ps(one, p), _mm_add_ps(three, p));
+        const __m128i bin = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(pseudo_angle, bin_scale), last_bin));
+
+        __m128i segment = Gather(m_binSegment.data(), bin);
+        const __m128 next_start = Gather(m_segmentStart.data(), _mm_add_epi32(segment, one_i));
+        segment = _mm_sub_epi32(segment, _mm_castps_si128(_mm_cmpge_ps(pseudo_angle, next_start)));
+
+        const __m128 kx = Gather(m_segmentKx.data(), segment);
+        const __m128 ky = Gather(m_segmentKy.data(), segment);
+        const __m128 k0 = Gather(m_segmentK0.data(), segment);
+
+        const __m128 inverse_radius = _mm_add_ps(_mm_div_ps(_mm_add_ps(_mm_mul_ps(kx, cx), _mm_mul_ps(ky, cy)), raw_distance), k0);
+        const __m128 valid = _mm_and_ps(_mm_cmpgt_ps(inverse_radius, zero), _mm_cmplt_ps(inverse_radius, max_inverse_radius));
+        const __m128 scale = Select(valid, inverse_radius, one);
+
+        _mm_storeu_ps(out_x + i, _mm_andnot_ps(is_zero, _mm_mul_ps(cx, scale)));
+        _mm_storeu_ps(out_y + i, _mm_andnot_ps(is_zero, _mm_mul_ps(cy, scale)));
+    }
+
+    return i;
+}
+
+GAZE_TARGET_AVX2 size_t GazeCalibrationProfile::RemapBatchAvx2(const float* x, const float* y, float* out_x, float* out_y, size_t count) const
+{
+    const __m256 center_x = _mm256_set1_ps(m_centerX);
+    const __m256 center_y = _mm256_set1_ps(m_centerY);
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 max_inverse_radius = _mm256_set1_ps(1e6f);
+    const __m256 bin_scale = _mm256_set1_ps(m_binScale);
+    const __m256 last_bin = _mm256_set1_ps(static_cast<float>(m_binSegment.size() - 1));
+    const __m256i one_i = _mm256_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 cx = _mm256_sub_ps(_mm256_loadu_ps(x + i), center_x);
+        const __m256 cy = _mm256_sub_ps(_mm256_loadu_ps(y + i), center_y);
+
+        const __m256 raw_distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)));
+        const __m256 is_zero = _mm256_cmp_ps(raw_distance, zero, _CMP_EQ_OQ);
+
+        // Lanes at the origin get a NaN pseudo-angle, min maps that to the last bin so the gathers stay in range.
+        const __m256 p = _mm256_div_ps(cx, _mm256_add_ps(_mm256_andnot_ps(sign_mask, cx), _mm256_andnot_ps(sign_mask, cy)));
+        const __m256 pseudo_angle = _mm256_blendv_ps(_mm256_add_ps(three, p), _mm256_sub_ps(one, p), _mm256_cmp_ps(cy, zero, _CMP_GE_OQ));
+        const __m256i bin = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_mul_ps(pseudo_angle, bin_scale), last_bin));
+
+        __m256i segment = _mm256_i32gather_epi32(m_binSegment.data(), bin, 4);
+        const __m256 next_start = _mm256_i32gather_ps(m_segmentStart.data(), _mm256_add_epi32(segment, one_i), 4);
+        segment = _mm256_sub_epi32(segment, _mm256_castps_si256(_mm256_cmp_ps(pseudo_angle, next_start, _CMP_GE_OQ)));
+
+        const __m256 kx = _mm256_i32gather_ps(m_segmentKx.data(), segment, 4);
+        const __m256 ky = _mm256_i32gather_ps(m_segmentKy.data(), segment, 4);
+        const __m256 k0 = _mm256_i32gather_ps(m_segmentK0.data(), segment, 4);
+
+        const __m256 inverse_radius = _mm256_add_ps(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(kx, cx), _mm256_mul_ps(ky, cy)), raw_distance), k0);
+        const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(inverse_radius, zero, _CMP_GT_OQ), _mm256_cmp_ps(inverse_radius, max_inverse_radius, _CMP_LT_OQ));
+        const __m256 scale = _mm256_blendv_ps(one, inverse_radius, valid);
+
+        _mm256_storeu_ps(out_x + i, _mm256_andnot_ps(is_zero, _mm256_mul_ps(cx, scale)));
+        _mm256_storeu_ps(out_y + i, _mm256_andnot_ps(is_zero, _mm256_mul_ps(cy, scale)));
+    }
+
+    return i;
+}
@@ -0,0 +1,83 @@
+#include "gaze_calibration.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool GazeGridWarp::Build(const GazeGridLayout& layout)
+{
+    Clear();
+
+    const size_t cols = layout.cols;
+    const size_t rows = layout.rows;
+    const Vec2d& min = layout.min;
+    const Vec2d& max = layout.max;
+    const std::vector<Vec2d>& targets = layout.targets;
+
+    if (cols < 2 || rows < 2 || targets.size() != cols * rows) return false;
+    if (!(max.x > min.x) || !(max.y > min.y)) return false;
+
+    m_cellCols = static_cast<int32_t>(cols - 1);
+    m_cellRows = static_cast<int32_t>(rows - 1);
+    m_originX = static_cast<float>(min.x);
+    m_originY = static_cast<float>(min.y);
+    m_cellsPerUnitX = static_cast<float>(m_cellCols / (max.x - min.x));
+    m_cellsPerUnitY = static_cast<float>(m_cellRows / (max.y - min.y));
+
+    m_cells.resize(static_cast<size_t>(m_cellCols) * m_cellRows);
+    for (size_t row = 0; row + 1 < rows; ++row)
+    {
+        for (size_t col = 0; col + 1 < cols; ++col)
+        {
+            const Vec2d& p00 = targets[row * cols + col];
+            const Vec2d& p10 = targets[row * cols + col + 1];
+            const Vec2d& p01 = targets[(row + 1) * cols + col];
+            const Vec2d& p11 = targets[(row + 1) * cols + col + 1];
+
+            Cell& cell = m_cells[row * m_cellCols + col];
+            cell.ax = static_cast<float>(p00.x);
+            cell.bx = static_cast<float>(p10.x - p00.x);
+            cell.cx = static_cast<float>(p01.x - p00.x);
+            cell.dx = static_cast<float>(p11.x - p10.x - p01.x + p00.x);
+            cell.ay = static_cast<float>(p00.y);
+            cell.by = static_cast<float>(p10.y - p00.y);
+            cell.cy = static_cast<float>(p01.y - p00.y);
+            cell.dy = static_cast<float>(p11.y - p10.y - p01.y + p00.y);
+        }
+    }
+
+    return true;
+}
+
+void GazeGridWarp::Clear()
+{
+    m_cells.clear();
+    m_cellCols = 0;
+    m_cellRows = 0;
+}
+
+Hmd2Vector3 GazeGridWarp::Apply(const Hmd2Vector3& dir) const
+{
+    if (m_cells.empty())
+    {
+        return dir;
+    }
+
+    const float fx = (dir.x - m_originX) * m_cellsPerUnitX;
+    const float fy = (dir.y - m_originY) * m_cellsPerUnitY;
+
+    // Clamp to the edge cells, u and v then run past [0, 1] and the edge cell extrapolates.
+    // The float clamp keeps the conversion in range, the argument order sends NaN to -1 and so to cell 0.
+    const float clamped_x = std::max(-1.0f, std::min(fx, static_cast<float>(m_cellCols)));
+    const float clamped_y = std::max(-1.0f, std::min(fy, static_cast<float>(m_cellRows)));
+    const int32_t col = std::clamp(static_cast<int32_t>(std::floor(clamped_x)), 0, m_cellCols - 1);
+    const int32_t row = std::clamp(static_cast<int32_t>(std::floor(clamped_y)), 0, m_cellRows - 1);
+    const float u = fx - col;
+    const float v = fy - row;
+
+    const Cell& cell = m_cells[static_cast<size_t>(row) * m_cellCols + col];
+    return {
+        cell.ax + cell.bx * u + cell.cx * v + cell.dx * u * v,
+        cell.ay + cell.by * u + cell.cy * v + cell.dy * u * v,
+        dir.z,
+    };
+}
@@ -0,0 +1,279 @@
+#include "gaze_calibration_session.h"
+
+#include "gaze_calibration_store.h"
+#include "util.h"
+#include "vr_settings.h"
+
+#include <vector>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeCalibrationSession *GazeCalibrationSession::m_pInstance = nullptr;
+
+  GazeCalibrationSession::GazeCalibrationSession()
+    : m_ownerId(0)
+    , m_hasPoint(false)
+    , m_target{}
+    , m_eyes{}
+    , m_collecting(false)
+    , m_hasFirstSample(false)
+    , m_firstSampleTimestampUs(0)
+    , m_sampleCount(0)
+    , m_samples{}
+  {}
+
+  GazeCalibrationSession *GazeCalibrationSession::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeCalibrationSession;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeCalibrationSession::HandleIpcCommand(uint32_t ownerId, const CommandHeader_t *pHeader, void *pData, CommandDataServerGazeCalibrationStatus_t *pStatus) {
+    // Commands from anyone but the owner only get to see the session state.
+    bool isOwner = m_ownerId != 0 && m_ownerId == ownerId;
+    EGazeCalibrationState otherState = m_ownerId != 0 ? GazeCalibrationState_Busy : GazeCalibrationState_Idle;
+
+    // Clients may leave out command data that is all zeroes.
+    switch (pHeader->type) {
+      case Command_ClientStartGazeCalibration: {
+        if (pHeader->dataLen != 0) {
+          return false;
+        }
+
+        if (m_ownerId != 0 && !isOwner) {
+          FillStatus(GazeCalibrationState_Busy, pStatus);
+          return true;
+        }
+
+        Start(ownerId);
+        FillStatus(GazeCalibrationState_Running, pStatus);
+        return true;
+      }
+
+      case Command_ClientSetGazeCalibrationPoint: {
+        CommandDataClientSetGazeCalibrationPoint_t request = {};
+        if (pHeader->dataLen == sizeof(request)) {
+          request = *reinterpret_cast<CommandDataClientSetGazeCalibrationPoint_t *>(pData);
+        } else if (pHeader->dataLen != 0) {
+          return false;
+        }
+
+        if (!isOwner) {
+          FillStatus(otherState, pStatus);
+          return true;
+        }
+
+        SetPoint({ request.targetX, request.targetY });
+        FillStatus(GazeCalibrationState_Running, pStatus);
+        return true;
+      }
+
+      case Command_ClientStopGazeCalibration: {
+        CommandDataClientStopGazeCalibration_t request = {};
+        if (pHeader->dataLen == sizeof(request)) {
+          request = *reinterpret_cast<CommandDataClientStopGazeCalibration_t *>(pData);
+        } else if (pHeader->dataLen != 0) {
+          return false;
+        }
+
+        if (!isOwner) {
+          FillStatus(otherState, pStatus);
+          return true;
+        }
+
+        bool applied = Stop(request.apply);
+        FillStatus(GazeCalibrationState_Idle, pStatus);
+        pStatus->isApplied = applied;
+        return true;
+      }
+
+      default:
+        break;
+    }
+
+    return false;
+  }
+
+  void GazeCalibrationSession::ReleaseOwner(uint32_t ownerId) {
+    if (ownerId != 0 && m_ownerId == ownerId) {
+      Util::DriverLog("[GAZE_CALIBRATION] Session owner went away, discarding the session.");
+      Stop(false);
+    }
+  }
+
+  void GazeCalibrationSession::AddSample(const Hmd2GazeState &rawState, uint64_t hmdTimestampUs) {
+    if (!m_collecting.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    // Never wait on the event loop, a dropped sample costs nothing.
+    std::unique_lock<std::mutex> lock(m_sampleMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_collecting.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    if (!m_hasFirstSample) {
+      m_hasFirstSample = true;
+      m_firstSampleTimestampUs = hmdTimestampUs;
+    }
+
+    if (hmdTimestampUs - m_firstSampleTimestampUs < k_ulSettleTimeUs || m_sampleCount >= k_unMaxPointSamples) {
+      return;
+    }
+
+    const Hmd2GazeEye &leftEye = rawState.leftEye;
+    const Hmd2GazeEye &rightEye = rawState.rightEye;
+
+    RawSample_t &sample = m_samples[m_sampleCount++];
+    sample.leftEye = { leftEye.gazeDirNorm.x, leftEye.gazeDirNorm.y };
+    sample.rightEye = { rightEye.gazeDirNorm.x, rightEye.gazeDirNorm.y };
+    sample.isLeftEyeValid = leftEye.isGazeDirValid && !(leftEye.isBlinkValid && leftEye.blink);
+    sample.isRightEyeValid = rightEye.isGazeDirValid && !(rightEye.isBlinkValid && rightEye.blink);
+  }
+
+  void GazeCalibrationSession::Start(uint32_t ownerId) {
+    static GazeCalibrationStore *pGazeCalibrationStore = GazeCalibrationStore::Instance();
+
+    // A restart by the owner throws away whatever it had so far.
+    if (m_ownerId != 0) {
+      Stop(false);
+    }
+
+    m_ownerId = ownerId;
+
+    GazeCalibrationStore::ReadGuard calibration = pGazeCalibrationStore->Acquire();
+    m_eyes[0] = {};
+    m_eyes[0].center = calibration->leftEye.GetCenter();
+    m_eyes[1] = {};
+    m_eyes[1].center = calibration->rightEye.GetCenter();
+
+    Util::DriverLog("[GAZE_CALIBRATION] Session started.");
+  }
+
+  void GazeCalibrationSession::SetPoint(const Vec2d &target) {
+    FinishPoint();
+
+    std::scoped_lock<std::mutex> lock(m_sampleMutex);
+    m_target = target;
+    m_hasPoint = true;
+    m_hasFirstSample = false;
+    m_sampleCount = 0;
+    m_collecting.store(true, std::memory_order_relaxed);
+  }
+
+  bool GazeCalibrationSession::Stop(bool apply) {
+    FinishPoint();
+
+    bool applied = apply && Apply();
+    m_ownerId = 0;
+
+    Util::DriverLog("[GAZE_CALIBRATION] Session stopped, {} left eye and {} right eye points, {}.",
+                    m_eyes[0].status.pointCount, m_eyes[1].status.pointCount, applied ? "applied" : "discarded");
+    return applied;
+  }
+
+  void GazeCalibrationSession::FinishPoint() {
+    if (!m_hasPoint) {
+      return;
+    }
+    m_hasPoint = false;
+
+    std::vector<RawSample_t> samples;
+    {
+      std::scoped_lock<std::mutex> lock(m_sampleMutex);
+      m_collecting.store(false, std::memory_order_relaxed);
+      samples.assign(m_samples, m_samples + m_sampleCount);
+    }
+
+    std::vector<Vec2d> eyeSamples;
+    eyeSamples.reserve(samples.size());
+
+    for (int eye = 0; eye < 2; eye++) {
+      EyeSession_t &eyeSession = m_eyes[eye];
+
+      eyeSamples.clear();
+      for (const RawSample_t &sample : samples) {
+        if (eye == 0 ? sample.isLeftEyeValid : sample.isRightEyeValid) {
+          const Vec2d &gaze = eye == 0 ? sample.leftEye : sample.rightEye;
+          eyeSamples.push_back({ gaze.x - eyeSession.center.x, gaze.y - eyeSession.center.y });
+        }
+      }
+
+      GazeCalibrationSolver::FixationEstimate estimate;
+      bool accepted = GazeCalibrationSolver::EstimateFixation(eyeSamples, &estimate);
+      if (accepted) {
+        eyeSession.solver.AddPoint(estimate.gaze, m_target);
+      }
+
+      ipc::GazeCalibrationEyeStatus_t &status = eyeSession.status;
+      status.pointCount = static_cast<uint16_t>(eyeSession.solver.GetPointCount());
+      status.lastPointSamples = accepted ? static_cast<uint16_t>(estimate.kept) : 0;
+      status.lastPointRejected = static_cast<uint16_t>(samples.size() - eyeSamples.size() + estimate.rejected);
+      status.isFitValid = eyeSession.solver.HasFit();
+      status.rmsError = static_cast<float>(eyeSession.solver.GetRmsError());
+    }
+  }
+
+  bool GazeCalibrationSession::Apply() {
+    static GazeCalibrationStore *pGazeCalibrationStore = GazeCalibrationStore::Instance();
+    static const char *eyeSections[2] = { "LeftEye", "RightEye" };
+
+    GazeGridLayout layouts[2];
+    bool fitted[2] = {};
+    for (int eye = 0; eye < 2; eye++) {
+      fitted[eye] = m_eyes[eye].solver.SampleGrid(k_gridNodes, k_gridNodes, &layouts[eye]);
+    }
+
+    if (!fitted[0] && !fitted[1]) {
+      return false;
+    }
+
+    // Start from the current profiles, so an eye without a fit keeps its calibration.
+    GazeCalibrationSet_t *pSet;
+    {
+      GazeCalibrationStore::ReadGuard calibration = pGazeCalibrationStore->Acquire();
+      pSet = new GazeCalibrationSet_t(calibration.Get());
+    }
+
+    GazeCalibrationProfile *profiles[2] = { &pSet->leftEye, &pSet->rightEye };
+    for (int eye = 0; eye < 2; eye++) {
+      if (fitted[eye] && !profiles[eye]->UseGrid(layouts[eye])) {
+        fitted[eye] = false;
+      }
+    }
+
+    // Nothing changed, so leave the settings alone rather than switching the model to a grid that isn't there.
+    if (!fitted[0] && !fitted[1]) {
+      delete pSet;
+      return false;
+    }
+
+    pGazeCalibrationStore->Publish(pSet);
+
+    // Saving triggers a reload, which reads back the same grids.
+    for (int eye = 0; eye < 2; eye++) {
+      if (fitted[eye]) {
+        GazeCalibrationProfile::SaveGridConfig(eyeSections[eye], layouts[eye]);
+      }
+    }
+    VRSettings::SetString(STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL, "grid");
+
+    return true;
+  }
+
+  void GazeCalibrationSession::FillStatus(EGazeCalibrationState state, CommandDataServerGazeCalibrationStatus_t *pStatus) {
+    *pStatus = {};
+    pStatus->state = state;
+
+    // Another client's progress is none of this client's business.
+    if (state != GazeCalibrationState_Busy) {
+      pStatus->leftEye = m_eyes[0].status;
+      pStatus->rightEye = m_eyes[1].status;
+    }
+  }
+
+} // psvr2_toolkit
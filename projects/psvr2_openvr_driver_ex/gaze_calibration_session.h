@@ -0,0 +1,78 @@
+#pragma once
+
+#include "gaze_calibration_solver.h"
+#include "hmd2_gaze.h"
+#include "../shared/ipc_protocol.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace psvr2_toolkit {
+
+  // Runs a gaze calibration session for one IPC client at a time.
+  // The client shows a target, sends its position, and the USB gaze thread hands raw samples over until the next target.
+  // Each finished point is cleaned of blinks and outliers and refitted right away, a stop can apply the fit as a grid warp.
+  // Everything except AddSample runs on the IPC event loop thread.
+  class GazeCalibrationSession {
+  public:
+    GazeCalibrationSession();
+
+    static GazeCalibrationSession *Instance();
+
+    // Fills pStatus with the answer, returns false if the command was malformed and shouldn't be answered.
+    bool HandleIpcCommand(uint32_t ownerId, const ipc::CommandHeader_t *pHeader, void *pData, ipc::CommandDataServerGazeCalibrationStatus_t *pStatus);
+    void ReleaseOwner(uint32_t ownerId);
+
+    // Called from the USB gaze thread with the uncalibrated state. Never blocks, samples are dropped while the session is busy with them.
+    void AddSample(const Hmd2GazeState &rawState, uint64_t hmdTimestampUs);
+
+  private:
+    // Roughly 8 seconds of samples, far longer than anyone should look at one target.
+    static constexpr uint32_t k_unMaxPointSamples = 1024;
+
+    // Samples this soon after the first one of a point are skipped, the eye is still on its way to the target.
+    static constexpr uint64_t k_ulSettleTimeUs = 250000;
+
+    // Nodes along each axis of the grid the fit is compiled into.
+    static constexpr size_t k_gridNodes = 9;
+    static_assert(k_gridNodes * k_gridNodes <= GazeCalibrationProfile::MAX_GRID_NODES, "The grid must fit in the settings.");
+
+    struct RawSample_t {
+      Vec2d leftEye;
+      Vec2d rightEye;
+      bool isLeftEyeValid;
+      bool isRightEyeValid;
+    };
+
+    struct EyeSession_t {
+      Vec2d center; // Of the profile the session started with, samples are fitted relative to it.
+      GazeCalibrationSolver solver;
+      ipc::GazeCalibrationEyeStatus_t status;
+    };
+
+    static GazeCalibrationSession *m_pInstance;
+
+    uint32_t m_ownerId; // 0 if no session is running.
+    bool m_hasPoint; // Whether samples are being collected for m_target.
+    Vec2d m_target;
+    EyeSession_t m_eyes[2]; // 0 = Left, 1 = Right.
+
+    // Shared with the USB gaze thread, which only ever try-locks m_sampleMutex.
+    std::atomic<bool> m_collecting;
+    std::mutex m_sampleMutex;
+    bool m_hasFirstSample;
+    uint64_t m_firstSampleTimestampUs;
+    uint32_t m_sampleCount;
+    RawSample_t m_samples[k_unMaxPointSamples];
+
+    void Start(uint32_t ownerId);
+    void SetPoint(const Vec2d &target);
+    bool Stop(bool apply);
+    void FinishPoint();
+    bool Apply();
+
+    void FillStatus(ipc::EGazeCalibrationState state, ipc::CommandDataServerGazeCalibrationStatus_t *pStatus);
+  };
+
+} // psvr2_toolkit
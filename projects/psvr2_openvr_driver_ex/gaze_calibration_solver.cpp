@@ -0,0 +1,235 @@
+#include "gaze_calibration_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Fewer clean samples than this and a fixation is more likely noise than a look at the target.
+    constexpr size_t MIN_FIXATION_SAMPLES = 10;
+
+    // Samples further than this many scaled MADs from the median are outliers.
+    constexpr double OUTLIER_THRESHOLD = 3.0;
+
+    // Scales a MAD to the standard deviation of normally distributed samples.
+    constexpr double MAD_TO_SIGMA = 1.4826;
+
+    // A MAD of zero would reject everything but the median, which happens with quantized input.
+    constexpr double MIN_MAD = 1e-4;
+
+    // The quadratic fit has 6 terms, wait for a few more points than that so it is over-determined.
+    constexpr size_t MIN_QUADRATIC_POINTS = 8;
+    constexpr size_t MIN_AFFINE_POINTS = 3;
+
+    // How far the sampled grid extends past the outermost fixations, relative to their spread.
+    constexpr double GRID_MARGIN = 0.25;
+
+    double Median(std::vector<double>& values)
+    {
+        const size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + middle, values.end());
+        double median = values[middle];
+        if (values.size() % 2 == 0)
+        {
+            median = (median + *std::max_element(values.begin(), values.begin() + middle)) / 2.0;
+        }
+        return median;
+    }
+
+} // Anonymous namespace
+
+bool GazeCalibrationSolver::EstimateFixation(std::span<const Vec2d> samples, FixationEstimate* out)
+{
+    *out = {};
+    if (samples.size() < MIN_FIXATION_SAMPLES) return false;
+
+    std::vector<double> xs(samples.size()), ys(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        xs[i] = samples[i].x;
+        ys[i] = samples[i].y;
+    }
+
+    const double median_x = Median(xs);
+    const double median_y = Median(ys);
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        xs[i] = std::abs(samples[i].x - median_x);
+        ys[i] = std::abs(samples[i].y - median_y);
+    }
+
+    const double limit_x = OUTLIER_THRESHOLD * MAD_TO_SIGMA * std::max(Median(xs), MIN_MAD);
+    const double limit_y = OUTLIER_THRESHOLD * MAD_TO_SIGMA * std::max(Median(ys), MIN_MAD);
+
+    Vec2d sum;
+    for (const Vec2d& sample : samples)
+    {
+        if (std::abs(sample.x - median_x) > limit_x || std::abs(sample.y - median_y) > limit_y)
+        {
+            ++out->rejected;
+            continue;
+        }
+
+        sum.x += sample.x;
+        sum.y += sample.y;
+        ++out->kept;
+    }
+
+    if (out->kept < MIN_FIXATION_SAMPLES) return false;
+
+    out->gaze = { sum.x / out->kept, sum.y / out->kept };
+    return true;
+}
+
+void GazeCalibrationSolver::Reset()
+{
+    *this = GazeCalibrationSolver();
+}
+
+void GazeCalibrationSolver::AddPoint(const Vec2d& gaze, const Vec2d& target)
+{
+    m_points.push_back({ gaze, target });
+
+    const Basis basis = EvaluateBasis(gaze);
+    for (size_t i = 0; i < MAX_TERMS; ++i)
+    {
+        for (size_t j = 0; j < MAX_TERMS; ++j)
+        {
+            m_normal[i][j] += basis[i] * basis[j];
+        }
+        m_rhsX[i] += basis[i] * target.x;
+        m_rhsY[i] += basis[i] * target.y;
+    }
+
+    Refit();
+}
+
+Vec2d GazeCalibrationSolver::Evaluate(const Vec2d& gaze) const
+{
+    const Basis basis = EvaluateBasis(gaze);
+    Vec2d result;
+    for (size_t i = 0; i < m_terms; ++i)
+    {
+        result.x += m_coeffX[i] * basis[i];
+        result.y += m_coeffY[i] * basis[i];
+    }
+    return result;
+}
+
+bool GazeCalibrationSolver::SampleGrid(size_t cols, size_t rows, GazeGridLayout* out) const
+{
+    if (!HasFit() || cols < 2 || rows < 2) return false;
+
+    Vec2d min = m_points[0].gaze;
+    Vec2d max = m_points[0].gaze;
+    for (const Point& point : m_points)
+    {
+        min = { std::min(min.x, point.gaze.x), std::min(min.y, point.gaze.y) };
+        max = { std::max(max.x, point.gaze.x), std::max(max.y, point.gaze.y) };
+    }
+
+    // An affine fit from points along a line still needs a grid with some area.
+    const double spread = std::max({ max.x - min.x, max.y - min.y, 0.1 });
+    const double margin = spread * GRID_MARGIN;
+
+    out->cols = cols;
+    out->rows = rows;
+    out->min = { min.x - margin, min.y - margin };
+    out->max = { max.x + margin, max.y + margin };
+    out->targets.resize(cols * rows);
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            const Vec2d node = {
+                out->min.x + (out->max.x - out->min.x) * col / (cols - 1),
+                out->min.y + (out->max.y - out->min.y) * row / (rows - 1),
+            };
+            out->targets[row * cols + col] = Evaluate(node);
+        }
+    }
+
+    return true;
+}
+
+GazeCalibrationSolver::Basis GazeCalibrationSolver::EvaluateBasis(const Vec2d& gaze)
+{
+    return { 1.0, gaze.x, gaze.y, gaze.x * gaze.x, gaze.x * gaze.y, gaze.y * gaze.y };
+}
+
+bool GazeCalibrationSolver::SolveTerms(size_t terms)
+{
+    // Gaussian elimination with partial pivoting on [A^T A | A^T bx | A^T by].
+    double m[MAX_TERMS][MAX_TERMS + 2] = {};
+    double scale = 0.0;
+    for (size_t i = 0; i < terms; ++i)
+    {
+        for (size_t j = 0; j < terms; ++j)
+        {
+            m[i][j] = m_normal[i][j];
+        }
+        m[i][terms] = m_rhsX[i];
+        m[i][terms + 1] = m_rhsY[i];
+        scale = std::max(scale, std::abs(m_normal[i][i]));
+    }
+
+    for (size_t col = 0; col < terms; ++col)
+    {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < terms; ++row)
+        {
+            if (std::abs(m[row][col]) > std::abs(m[pivot][col])) pivot = row;
+        }
+
+        // Relative to the largest diagonal entry, so the test doesn't depend on the number of points.
+        if (std::abs(m[pivot][col]) <= scale * 1e-10) return false;
+
+        if (pivot != col)
+        {
+            for (size_t j = 0; j < terms + 2; ++j) std::swap(m[col][j], m[pivot][j]);
+        }
+
+        for (size_t row = 0; row < terms; ++row)
+        {
+            if (row == col) continue;
+            const double factor = m[row][col] / m[col][col];
+            for (size_t j = col; j < terms + 2; ++j)
+            {
+                m[row][j] -= factor * m[col][j];
+            }
+        }
+    }
+
+    m_coeffX = {};
+    m_coeffY = {};
+    for (size_t i = 0; i < terms; ++i)
+    {
+        m_coeffX[i] = m[i][terms] / m[i][i];
+        m_coeffY[i] = m[i][terms + 1] / m[i][i];
+    }
+    m_terms = terms;
+    return true;
+}
+
+void GazeCalibrationSolver::Refit()
+{
+    m_terms = 0;
+    m_rmsError = 0.0;
+
+    // Some layouts, like a plus of points with no corners, leave the quadratic singular. Fall back to affine then.
+    const bool solved = (m_points.size() >= MIN_QUADRATIC_POINTS && SolveTerms(MAX_TERMS)) ||
+                        (m_points.size() >= MIN_AFFINE_POINTS && SolveTerms(3));
+    if (!solved) return;
+
+    double sum_squares = 0.0;
+    for (const Point& point : m_points)
+    {
+        const Vec2d fitted = Evaluate(point.gaze);
+        const double dx = fitted.x - point.target.x;
+        const double dy = fitted.y - point.target.y;
+        sum_squares += dx * dx + dy * dy;
+    }
+    m_rmsError = std::sqrt(sum_squares / m_points.size());
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "gaze_calibration.h" // Provides Vec2d and GazeGridLayout
+
+/**
+ * @brief Fits a calibration from fixation points, one eye at a time.
+ * Has no driver dependencies, so recorded sample sets can be run through it offline.
+ * The fit is a least-squares polynomial from centered raw gaze to target position: quadratic
+ * once there are enough points to over-determine it, affine before that. The normal equations
+ * are accumulated as points arrive, so adding a point and refitting is constant time.
+ */
+class GazeCalibrationSolver
+{
+public:
+    struct FixationEstimate
+    {
+        Vec2d gaze;          // Mean of the samples that were kept.
+        size_t kept = 0;
+        size_t rejected = 0; // Outliers, blinks are expected to be filtered out by the caller.
+    };
+
+    /**
+     * @brief Reduces the samples of one fixation to a single gaze position.
+     * Drops samples more than 3 scaled median absolute deviations from the median on either axis,
+     * then averages the rest.
+     * @return false if too few samples survive to trust the estimate.
+     */
+    static bool EstimateFixation(std::span<const Vec2d> samples, FixationEstimate* out);
+
+    void Reset();
+
+    /**
+     * @brief Adds one fixation and refits.
+     * @param gaze Centered raw gaze, as estimated by EstimateFixation.
+     * @param target Where the calibrated gaze should be for that fixation.
+     */
+    void AddPoint(const Vec2d& gaze, const Vec2d& target);
+
+    size_t GetPointCount() const { return m_points.size(); }
+    bool HasFit() const { return m_terms != 0; }
+
+    // Root mean square distance between the fit and the targets, over all points.
+    double GetRmsError() const { return m_rmsError; }
+
+    Vec2d Evaluate(const Vec2d& gaze) const;
+
+    /**
+     * @brief Samples the fit on a grid spanning the fixations, grown by a margin on each side.
+     * Outside the grid the warp extrapolates linearly, which is safer than the polynomial.
+     * @return false if there is no fit yet.
+     */
+    bool SampleGrid(size_t cols, size_t rows, GazeGridLayout* out) const;
+
+private:
+    // 1, x, y, x * x, x * y, y * y. The affine fit uses the first three.
+    static constexpr size_t MAX_TERMS = 6;
+    using Basis = std::array<double, MAX_TERMS>;
+
+    struct Point
+    {
+        Vec2d gaze;
+        Vec2d target;
+    };
+
+    static Basis EvaluateBasis(const Vec2d& gaze);
+
+    // Solves the leading terms x terms block of the normal equations, false if it is singular.
+    bool SolveTerms(size_t terms);
+    void Refit();
+
+    std::vector<Point> m_points;
+
+    // Normal equations, A^T A and A^T b for each axis.
+    double m_normal[MAX_TERMS][MAX_TERMS] = {};
+    double m_rhsX[MAX_TERMS] = {};
+    double m_rhsY[MAX_TERMS] = {};
+
+    size_t m_terms = 0; // 0 while there is no fit.
+    Basis m_coeffX = {};
+    Basis m_coeffY = {};
+    double m_rmsError = 0.0;
+};
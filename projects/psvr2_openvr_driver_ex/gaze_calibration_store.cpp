@@ -0,0 +1,121 @@
+#include "gaze_calibration_store.h"
+
+#include "util.h"
+
+#include <thread>
+
+namespace psvr2_toolkit {
+
+  GazeCalibrationStore *GazeCalibrationStore::m_pInstance = nullptr;
+
+  GazeCalibrationStore::ReadGuard::ReadGuard(std::atomic<const GazeCalibrationSet_t *> *pHazard, std::atomic<bool> *pSlotUsed, const GazeCalibrationSet_t *pSet)
+    : m_pHazard(pHazard)
+    , m_pSlotUsed(pSlotUsed)
+    , m_pSet(pSet)
+  {}
+
+  GazeCalibrationStore::ReadGuard::~ReadGuard() {
+    m_pHazard->store(nullptr, std::memory_order_release);
+    m_pSlotUsed->store(false, std::memory_order_release);
+  }
+
+  GazeCalibrationStore::GazeCalibrationStore()
+    : m_initialized(false)
+    , m_pCurrent(new GazeCalibrationSet_t)
+    , m_hazards{}
+    , m_slotUsed{}
+  {}
+
+  GazeCalibrationStore *GazeCalibrationStore::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeCalibrationStore;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeCalibrationStore::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeCalibrationStore::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    Reload();
+
+    m_initialized = true;
+  }
+
+  GazeCalibrationStore::ReadGuard GazeCalibrationStore::Acquire() {
+    for (;;) {
+      for (uint32_t i = 0; i < k_unReaderSlots; i++) {
+        bool expected = false;
+        if (m_slotUsed[i].load(std::memory_order_relaxed) ||
+            !m_slotUsed[i].compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+          continue;
+        }
+
+        // Announce the set before using it, then make sure it wasn't swapped out in between.
+        // Once the re-check passes, Publish is guaranteed to see the hazard and wait for us.
+        const GazeCalibrationSet_t *pSet = m_pCurrent.load(std::memory_order_acquire);
+        for (;;) {
+          m_hazards[i].store(pSet, std::memory_order_seq_cst);
+          const GazeCalibrationSet_t *pCurrent = m_pCurrent.load(std::memory_order_seq_cst);
+          if (pCurrent == pSet) {
+            break;
+          }
+          pSet = pCurrent;
+        }
+
+        return ReadGuard(&m_hazards[i], &m_slotUsed[i], pSet);
+      }
+
+      // Every slot is taken, which only happens if guards are held far longer than they should be.
+      std::this_thread::yield();
+    }
+  }
+
+  void GazeCalibrationStore::Reload() {
+    GazeCalibrationSet_t *pSet = new GazeCalibrationSet_t;
+    pSet->leftEye.LoadConfig("LeftEye");
+    pSet->rightEye.LoadConfig("RightEye");
+
+    Publish(pSet);
+
+    Util::DriverLog("[GAZE_CALIBRATION] Loaded calibration profiles, {} left eye and {} right eye samples.",
+                    pSet->leftEye.GetCalibrationData().size(), pSet->rightEye.GetCalibrationData().size());
+  }
+
+  void GazeCalibrationStore::Publish(GazeCalibrationSet_t *pSet) {
+    std::scoped_lock<std::mutex> lock(m_publishMutex);
+
+    const GazeCalibrationSet_t *pRetired = m_pCurrent.exchange(pSet, std::memory_order_seq_cst);
+
+    // Readers only ever pin for the length of one remap, so this spin is short.
+    for (uint32_t i = 0; i < k_unReaderSlots; i++) {
+      while (m_hazards[i].load(std::memory_order_seq_cst) == pRetired) {
+        std::this_thread::yield();
+      }
+    }
+
+    delete pRetired;
+  }
+
+  void GazeCalibrationStore::HandleEvent(vr::VREvent_t *pEvent) {
+    // Our section isn't one SteamVR knows by name, so changes to it arrive as "other section" events.
+    if (pEvent->eventType != vr::VREvent_OtherSectionSettingChanged &&
+        pEvent->eventType != vr::VREvent_AnyDriverSettingsChanged)
+    {
+      return;
+    }
+
+    GazeCalibrationStore *pStore = Instance();
+    if (pStore->Initialized()) {
+      pStore->Reload();
+    }
+  }
+
+} // psvr2_toolkit
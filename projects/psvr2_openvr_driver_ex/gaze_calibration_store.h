@@ -0,0 +1,75 @@
+#pragma once
+
+#include "gaze_calibration.h"
+
+#include <openvr_driver.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace psvr2_toolkit {
+
+  struct GazeCalibrationSet_t {
+    GazeCalibrationProfile leftEye;
+    GazeCalibrationProfile rightEye;
+  };
+
+  // Holds the calibration profiles the USB gaze thread remaps with, and swaps in new ones when the settings change.
+  // Readers never lock, they pin the current set with a hazard slot and keep using it until they unpin it.
+  // Publishing a new set waits until no reader has the old one pinned before freeing it.
+  class GazeCalibrationStore {
+  public:
+    // Keeps one calibration set alive for as long as it is in scope. Keep it short, publishing waits on it.
+    class ReadGuard {
+    public:
+      ReadGuard(const ReadGuard &) = delete;
+      ReadGuard &operator=(const ReadGuard &) = delete;
+      ~ReadGuard();
+
+      const GazeCalibrationSet_t &Get() const { return *m_pSet; }
+      const GazeCalibrationSet_t *operator->() const { return m_pSet; }
+
+    private:
+      friend class GazeCalibrationStore;
+
+      ReadGuard(std::atomic<const GazeCalibrationSet_t *> *pHazard, std::atomic<bool> *pSlotUsed, const GazeCalibrationSet_t *pSet);
+
+      std::atomic<const GazeCalibrationSet_t *> *m_pHazard;
+      std::atomic<bool> *m_pSlotUsed;
+      const GazeCalibrationSet_t *m_pSet;
+    };
+
+    GazeCalibrationStore();
+
+    static GazeCalibrationStore *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    // Never returns an empty guard, before Initialize it pins a set with no calibration loaded.
+    ReadGuard Acquire();
+
+    // Re-reads both eyes from the settings and publishes them. Blocks briefly, don't call it from the USB gaze thread.
+    void Reload();
+
+    // Takes ownership of pSet. Blocks until the set it replaces is no longer pinned, then frees it.
+    void Publish(GazeCalibrationSet_t *pSet);
+
+    // Installed as the DriverHostProxy event handler, reloads whenever SteamVR reports a settings change.
+    static void HandleEvent(vr::VREvent_t *pEvent);
+
+  private:
+    // More than enough for the USB gaze thread plus the odd offline reader.
+    static constexpr uint32_t k_unReaderSlots = 4;
+
+    static GazeCalibrationStore *m_pInstance;
+
+    bool m_initialized;
+    std::atomic<const GazeCalibrationSet_t *> m_pCurrent;
+    std::atomic<const GazeCalibrationSet_t *> m_hazards[k_unReaderSlots];
+    std::atomic<bool> m_slotUsed[k_unReaderSlots];
+    std::mutex m_publishMutex; // Serializes publishers, readers never take it.
+  };
+
+} // psvr2_toolkit
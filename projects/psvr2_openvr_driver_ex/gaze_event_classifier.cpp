@@ -0,0 +1,225 @@
+#include "gaze_event_classifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeEventClassifier::GazeEventClassifier() {
+    Reset();
+  }
+
+  void GazeEventClassifier::Reset() {
+    for (Tracker_t &tracker : m_trackers) {
+      ResetTracker(&tracker);
+    }
+  }
+
+  uint32_t GazeEventClassifier::Classify(const CommandDataServerGazeDataResult2_t &sample, GazeEvent_t *pEvents) {
+    uint32_t eventCount = 0;
+
+    // A closed eye still reports a direction now and then, which is just noise.
+    bool isLeftValid = sample.leftEye.isGazeDirValid && !(sample.leftEye.isBlinkValid && sample.leftEye.blink);
+    bool isRightValid = sample.rightEye.isGazeDirValid && !(sample.rightEye.isBlinkValid && sample.rightEye.blink);
+
+    eventCount += ClassifyTracker(&m_trackers[GazeEventSource_LeftEye], GazeEventSource_LeftEye, sample.sequence, sample.hostTimestampUs,
+                                  isLeftValid, sample.leftEye.gazeDirNorm, pEvents + eventCount);
+    eventCount += ClassifyTracker(&m_trackers[GazeEventSource_RightEye], GazeEventSource_RightEye, sample.sequence, sample.hostTimestampUs,
+                                  isRightValid, sample.rightEye.gazeDirNorm, pEvents + eventCount);
+    eventCount += ClassifyTracker(&m_trackers[GazeEventSource_Combined], GazeEventSource_Combined, sample.sequence, sample.hostTimestampUs,
+                                  sample.combined.isGazeDirValid, sample.combined.gazeDirNorm, pEvents + eventCount);
+
+    return eventCount;
+  }
+
+  void GazeEventClassifier::ResetTracker(Tracker_t *pTracker) {
+    *pTracker = {};
+    pTracker->phase = Phase_None;
+  }
+
+  uint32_t GazeEventClassifier::ClassifyTracker(Tracker_t *pTracker, EGazeEventSource source, uint64_t sequence, int64_t hostTimestampUs,
+                                                bool isValid, const GazeVector3 &direction, GazeEvent_t *pEvents) {
+    uint32_t eventCount = 0;
+
+    const Point_t &newest = pTracker->window[(pTracker->windowCount + k_unVelocityWindow - 1) % k_unVelocityWindow];
+    bool isGap = pTracker->windowCount > 0 &&
+      (hostTimestampUs <= newest.hostTimestampUs || hostTimestampUs - newest.hostTimestampUs > k_maxSampleGapUs);
+
+    if (!isValid || isGap) {
+      eventCount += EndEvent(pTracker, source, pEvents);
+      ResetTracker(pTracker);
+      if (!isValid) {
+        return eventCount;
+      }
+    }
+
+    pTracker->window[pTracker->windowCount % k_unVelocityWindow] = { hostTimestampUs, direction.x, direction.y, direction.z };
+    pTracker->windowCount++;
+
+    if (pTracker->phase == Phase_None) {
+      StartPhase(pTracker, Phase_Fixation, sequence, hostTimestampUs, direction.x, direction.y);
+    }
+
+    float speed = 0.0f;
+    if (pTracker->windowCount >= 2) {
+      uint32_t oldestIndex = pTracker->windowCount - (std::min)(pTracker->windowCount, k_unVelocityWindow);
+      const Point_t &oldest = pTracker->window[oldestIndex % k_unVelocityWindow];
+      float dx = direction.x - oldest.x;
+      float dy = direction.y - oldest.y;
+      float dz = direction.z - oldest.z;
+      speed = std::sqrt(dx * dx + dy * dy + dz * dz) / ((hostTimestampUs - oldest.hostTimestampUs) / 1e6f);
+    }
+
+    if (speed > k_saccadeSpeed) {
+      if (pTracker->phase == Phase_Fixation) {
+        if (!pTracker->isSaccadeCandidate) {
+          pTracker->isSaccadeCandidate = true;
+          pTracker->candidateSequence = sequence;
+          pTracker->candidateTimestampUs = hostTimestampUs;
+          pTracker->candidateSampleCount = 0;
+        }
+        pTracker->candidateSampleCount++;
+
+        // The fixation keeps its last slow sample as its end, and the eye left from there.
+        if (std::hypot(direction.x - pTracker->lastX, direction.y - pTracker->lastY) < k_minSaccadeAmplitude) {
+          return eventCount;
+        }
+
+        float launchX = pTracker->lastX;
+        float launchY = pTracker->lastY;
+        uint16_t candidateSampleCount = pTracker->candidateSampleCount;
+        eventCount += EndEvent(pTracker, source, pEvents + eventCount);
+        StartPhase(pTracker, Phase_Saccade, pTracker->candidateSequence, pTracker->candidateTimestampUs, launchX, launchY);
+        pTracker->sampleCount = candidateSampleCount;
+
+        GazeEvent_t &event = pEvents[eventCount++];
+        event = {};
+        event.sequence = pTracker->startSequence;
+        event.hostTimestampUs = pTracker->startTimestampUs;
+        event.type = GazeEventType_SaccadeStart;
+        event.source = source;
+        event.sampleCount = pTracker->sampleCount;
+        event.x = launchX;
+        event.y = launchY;
+      } else if (pTracker->sampleCount < (std::numeric_limits<uint16_t>::max)()) {
+        pTracker->sampleCount++;
+      }
+
+      pTracker->lastX = direction.x;
+      pTracker->lastY = direction.y;
+      pTracker->lastTimestampUs = hostTimestampUs;
+      return eventCount;
+    }
+
+    // Whatever fast samples came before went nowhere, they are dropped and the fixation goes on.
+    pTracker->isSaccadeCandidate = false;
+
+    if (pTracker->phase == Phase_Saccade) {
+      // Landed, this sample is both the end of the saccade and the start of what comes next.
+      pTracker->lastX = direction.x;
+      pTracker->lastY = direction.y;
+      pTracker->lastTimestampUs = hostTimestampUs;
+      eventCount += EndEvent(pTracker, source, pEvents + eventCount);
+      StartPhase(pTracker, Phase_Fixation, sequence, hostTimestampUs, direction.x, direction.y);
+    } else {
+      float minX = (std::min)(pTracker->minX, direction.x);
+      float maxX = (std::max)(pTracker->maxX, direction.x);
+      float minY = (std::min)(pTracker->minY, direction.y);
+      float maxY = (std::max)(pTracker->maxY, direction.y);
+      if ((maxX - minX) + (maxY - minY) > k_maxFixationDispersion) {
+        eventCount += EndEvent(pTracker, source, pEvents + eventCount);
+        StartPhase(pTracker, Phase_Fixation, sequence, hostTimestampUs, direction.x, direction.y);
+      }
+    }
+
+    pTracker->sumX += direction.x;
+    pTracker->sumY += direction.y;
+    pTracker->minX = (std::min)(pTracker->minX, direction.x);
+    pTracker->maxX = (std::max)(pTracker->maxX, direction.x);
+    pTracker->minY = (std::min)(pTracker->minY, direction.y);
+    pTracker->maxY = (std::max)(pTracker->maxY, direction.y);
+    pTracker->lastX = direction.x;
+    pTracker->lastY = direction.y;
+    pTracker->lastTimestampUs = hostTimestampUs;
+    if (pTracker->sampleCount < (std::numeric_limits<uint16_t>::max)()) {
+      pTracker->sampleCount++;
+    }
+
+    if (!pTracker->isFixationReported && pTracker->lastTimestampUs - pTracker->startTimestampUs >= k_minFixationUs) {
+      pTracker->isFixationReported = true;
+
+      GazeEvent_t &event = pEvents[eventCount++];
+      event = {};
+      event.sequence = pTracker->startSequence;
+      event.hostTimestampUs = pTracker->startTimestampUs;
+      event.type = GazeEventType_FixationStart;
+      event.source = source;
+      event.sampleCount = pTracker->sampleCount;
+      event.x = static_cast<float>(pTracker->sumX / pTracker->sampleCount);
+      event.y = static_cast<float>(pTracker->sumY / pTracker->sampleCount);
+    }
+
+    return eventCount;
+  }
+
+  uint32_t GazeEventClassifier::EndEvent(Tracker_t *pTracker, EGazeEventSource source, GazeEvent_t *pEvents) {
+    GazeEvent_t &event = pEvents[0];
+
+    switch (pTracker->phase) {
+      case Phase_None: {
+        return 0;
+      }
+
+      case Phase_Fixation: {
+        // Too short to have been reported, the start event was never sent either.
+        if (!pTracker->isFixationReported) {
+          return 0;
+        }
+
+        event = {};
+        event.type = GazeEventType_FixationEnd;
+        event.x = static_cast<float>(pTracker->sumX / pTracker->sampleCount);
+        event.y = static_cast<float>(pTracker->sumY / pTracker->sampleCount);
+        break;
+      }
+
+      case Phase_Saccade: {
+        event = {};
+        event.type = GazeEventType_SaccadeEnd;
+        event.x = pTracker->lastX;
+        event.y = pTracker->lastY;
+        event.amplitude = std::hypot(pTracker->lastX - pTracker->startX, pTracker->lastY - pTracker->startY);
+        break;
+      }
+    }
+
+    event.sequence = pTracker->startSequence;
+    event.hostTimestampUs = pTracker->startTimestampUs;
+    event.durationUs = static_cast<uint32_t>(pTracker->lastTimestampUs - pTracker->startTimestampUs);
+    event.source = source;
+    event.sampleCount = pTracker->sampleCount;
+
+    pTracker->phase = Phase_None;
+    return 1;
+  }
+
+  void GazeEventClassifier::StartPhase(Tracker_t *pTracker, EPhase phase, uint64_t sequence, int64_t hostTimestampUs, float x, float y) {
+    pTracker->phase = phase;
+    pTracker->isFixationReported = false;
+    pTracker->isSaccadeCandidate = false;
+    pTracker->startSequence = sequence;
+    pTracker->startTimestampUs = hostTimestampUs;
+    pTracker->lastTimestampUs = hostTimestampUs;
+    pTracker->sampleCount = 0;
+    pTracker->sumX = 0.0;
+    pTracker->sumY = 0.0;
+    pTracker->minX = pTracker->maxX = x;
+    pTracker->minY = pTracker->maxY = y;
+    pTracker->startX = pTracker->lastX = x;
+    pTracker->startY = pTracker->lastY = y;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Online fixation and saccade classifier, run separately for the left, right and combined gaze.
+  // Velocity decides between fixation and saccade (I-VT), and a fixation that drifts too far is split (I-DT),
+  // so slow pursuit doesn't merge into one endless fixation. Uses a fixed amount of state per source.
+  // Has no driver dependencies, so it can be run over recorded samples as well.
+  class GazeEventClassifier {
+  public:
+    // At most an end and a start event per source and sample.
+    static constexpr uint32_t k_unMaxEventsPerSample = 6;
+
+    GazeEventClassifier();
+
+    void Reset();
+
+    // Samples must be passed in sequence order. Returns the number of events written to pEvents.
+    uint32_t Classify(const ipc::CommandDataServerGazeDataResult2_t &sample, ipc::GazeEvent_t *pEvents);
+
+  private:
+    // Gaze speed, in direction units per second, above which a sample is part of a saccade. Roughly 30 deg/s.
+    static constexpr float k_saccadeSpeed = 0.52f;
+
+    // Fixations shorter than this are never reported.
+    static constexpr int64_t k_minFixationUs = 60000;
+
+    // A fast movement only becomes a saccade once it has moved this far from where it started, roughly 1.5 deg.
+    // Keeps tracker noise, which is fast but goes nowhere, from breaking up fixations.
+    static constexpr float k_minSaccadeAmplitude = 0.025f;
+
+    // Largest (max x - min x) + (max y - min y) of a fixation, roughly 3 deg.
+    static constexpr float k_maxFixationDispersion = 0.05f;
+
+    // A gap longer than this ends the current event, the same as a blink.
+    static constexpr int64_t k_maxSampleGapUs = 100000;
+
+    // Velocity is measured across this many samples, a single sample step is dominated by tracker noise.
+    static constexpr uint32_t k_unVelocityWindow = 3;
+
+    enum EPhase : uint8_t {
+      Phase_None,
+      Phase_Fixation,
+      Phase_Saccade,
+    };
+
+    struct Point_t {
+      int64_t hostTimestampUs;
+      float x, y, z;
+    };
+
+    struct Tracker_t {
+      EPhase phase;
+      bool isFixationReported; // FixationStart was sent for the current fixation.
+
+      Point_t window[k_unVelocityWindow]; // Most recent samples, indexed by windowCount modulo the window size.
+      uint32_t windowCount;
+
+      // Set while a fixation sees fast samples that haven't moved far enough yet to be a saccade.
+      bool isSaccadeCandidate;
+      uint64_t candidateSequence;
+      int64_t candidateTimestampUs;
+      uint16_t candidateSampleCount;
+
+      uint64_t startSequence;
+      int64_t startTimestampUs;
+      int64_t lastTimestampUs;
+      uint16_t sampleCount;
+
+      // Fixation centroid and extent, or the saccade launch and latest position.
+      double sumX, sumY;
+      float minX, maxX, minY, maxY;
+      float startX, startY;
+      float lastX, lastY;
+    };
+
+    Tracker_t m_trackers[3]; // Indexed by EGazeEventSource.
+
+    static void ResetTracker(Tracker_t *pTracker);
+    static uint32_t ClassifyTracker(Tracker_t *pTracker, ipc::EGazeEventSource source, uint64_t sequence, int64_t hostTimestampUs,
+                                    bool isValid, const ipc::GazeVector3 &direction, ipc::GazeEvent_t *pEvents);
+    static uint32_t EndEvent(Tracker_t *pTracker, ipc::EGazeEventSource source, ipc::GazeEvent_t *pEvents);
+    static void StartPhase(Tracker_t *pTracker, EPhase phase, uint64_t sequence, int64_t hostTimestampUs, float x, float y);
+  };
+
+} // psvr2_toolkit
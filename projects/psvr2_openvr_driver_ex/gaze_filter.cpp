@@ -0,0 +1,104 @@
+#include "gaze_filter.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <cmath>
+
+namespace psvr2_toolkit {
+
+  GazeFilter *GazeFilter::m_pInstance = nullptr;
+
+  GazeFilter::GazeFilter()
+    : m_initialized(false)
+    , m_enabled(false)
+    , m_hasLastTimestamp(false)
+    , m_lastTimestampUs(0)
+  {}
+
+  GazeFilter *GazeFilter::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeFilter;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeFilter::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeFilter::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    m_enabled = VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_FILTER, SETTING_ENABLE_GAZE_FILTER_DEFAULT_VALUE);
+    if (m_enabled) {
+      float minCutoffHz = VRSettings::GetFloat(STEAMVR_SETTINGS_GAZE_FILTER_MIN_CUTOFF, SETTING_GAZE_FILTER_MIN_CUTOFF_DEFAULT_VALUE);
+      float beta = VRSettings::GetFloat(STEAMVR_SETTINGS_GAZE_FILTER_BETA, SETTING_GAZE_FILTER_BETA_DEFAULT_VALUE);
+      float derivativeCutoffHz = VRSettings::GetFloat(STEAMVR_SETTINGS_GAZE_FILTER_DERIVATIVE_CUTOFF, SETTING_GAZE_FILTER_DERIVATIVE_CUTOFF_DEFAULT_VALUE);
+
+      // A cutoff of zero or less would never let the filter move.
+      if (minCutoffHz <= 0.0f || derivativeCutoffHz <= 0.0f) {
+        Util::DriverLog("[GAZE_FILTER] Cutoffs must be positive, using the defaults.");
+        minCutoffHz = SETTING_GAZE_FILTER_MIN_CUTOFF_DEFAULT_VALUE;
+        derivativeCutoffHz = SETTING_GAZE_FILTER_DERIVATIVE_CUTOFF_DEFAULT_VALUE;
+      }
+
+      m_leftEyeFilter.Configure(minCutoffHz, beta, derivativeCutoffHz);
+      m_rightEyeFilter.Configure(minCutoffHz, beta, derivativeCutoffHz);
+      m_combinedFilter.Configure(minCutoffHz, beta, derivativeCutoffHz);
+
+      Util::DriverLog("[GAZE_FILTER] Filtering gaze, min cutoff {} Hz, beta {}, derivative cutoff {} Hz.", minCutoffHz, beta, derivativeCutoffHz);
+    }
+
+    m_initialized = true;
+  }
+
+  void GazeFilter::Apply(Hmd2GazeState &gazeState, uint64_t hmdTimestampUs) {
+    if (!m_enabled) {
+      return;
+    }
+
+    // Repeated or out of order timestamps carry no time step to filter with.
+    uint64_t dtUs = hmdTimestampUs - m_lastTimestampUs;
+    if (!m_hasLastTimestamp || hmdTimestampUs <= m_lastTimestampUs || dtUs > k_ulMaxSampleGapUs) {
+      Reset();
+      dtUs = 0;
+    }
+    m_hasLastTimestamp = true;
+    m_lastTimestampUs = hmdTimestampUs;
+
+    // With no time step the filters only take the sample as their new starting point.
+    float dtSeconds = dtUs > 0 ? dtUs / 1e6f : 1.0f;
+
+    FilterDirection(m_leftEyeFilter, gazeState.leftEye.isGazeDirValid, gazeState.leftEye.gazeDirNorm, dtSeconds);
+    FilterDirection(m_rightEyeFilter, gazeState.rightEye.isGazeDirValid, gazeState.rightEye.gazeDirNorm, dtSeconds);
+    FilterDirection(m_combinedFilter, gazeState.combined.isGazeDirValid, gazeState.combined.gazeDirNorm, dtSeconds);
+  }
+
+  void GazeFilter::FilterDirection(OneEuroFilter<3> &filter, bool isValid, Hmd2Vector3 &direction, float dtSeconds) {
+    // Invalid samples are left alone and restart the filter, so a blink doesn't smear into the next fixation.
+    if (!isValid) {
+      filter.Reset();
+      return;
+    }
+
+    float values[3] = { direction.x, direction.y, direction.z };
+    filter.Filter(values, dtSeconds);
+
+    // Each component is smoothed on its own, which cuts the corner of a saccade, back onto the unit sphere.
+    float length = std::sqrt(values[0] * values[0] + values[1] * values[1] + values[2] * values[2]);
+    if (length > 0.0f) {
+      direction = { values[0] / length, values[1] / length, values[2] / length };
+    }
+  }
+
+  void GazeFilter::Reset() {
+    m_leftEyeFilter.Reset();
+    m_rightEyeFilter.Reset();
+    m_combinedFilter.Reset();
+  }
+
+} // psvr2_toolkit
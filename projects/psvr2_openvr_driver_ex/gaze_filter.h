@@ -0,0 +1,45 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+#include "one_euro_filter.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Optional smoothing of the calibrated gaze directions, applied once before every consumer sees them.
+  // Uses a One Euro filter per ray, so fixations are smoothed while saccades pass with little lag.
+  // Only ever used by the USB gaze thread.
+  class GazeFilter {
+  public:
+    GazeFilter();
+
+    static GazeFilter *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    // Filters the left, right and combined gaze directions in place. Does nothing unless enabled in the settings.
+    void Apply(Hmd2GazeState &gazeState, uint64_t hmdTimestampUs);
+
+  private:
+    // A gap longer than this, e.g. while the headset was asleep, restarts the filters.
+    static constexpr uint64_t k_ulMaxSampleGapUs = 100000;
+
+    static GazeFilter *m_pInstance;
+
+    bool m_initialized;
+    bool m_enabled;
+    bool m_hasLastTimestamp;
+    uint64_t m_lastTimestampUs;
+
+    OneEuroFilter<3> m_leftEyeFilter;
+    OneEuroFilter<3> m_rightEyeFilter;
+    OneEuroFilter<3> m_combinedFilter;
+
+    void Reset();
+
+    static void FilterDirection(OneEuroFilter<3> &filter, bool isValid, Hmd2Vector3 &direction, float dtSeconds);
+  };
+
+} // psvr2_toolkit
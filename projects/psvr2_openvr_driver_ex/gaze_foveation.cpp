@@ -0,0 +1,139 @@
+#include "gaze_foveation.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeFoveation *GazeFoveation::m_pInstance = nullptr;
+
+  GazeFoveation::GazeFoveation()
+    : m_initialized(false)
+    , m_foveaRadiusRad(SETTING_GAZE_FOVEA_RADIUS_DEFAULT_VALUE * (3.14159265f / 180.0f))
+    , m_result()
+  {}
+
+  GazeFoveation *GazeFoveation::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeFoveation;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeFoveation::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeFoveation::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    float foveaRadiusDeg = VRSettings::GetFloat(STEAMVR_SETTINGS_GAZE_FOVEA_RADIUS, SETTING_GAZE_FOVEA_RADIUS_DEFAULT_VALUE);
+    if (foveaRadiusDeg < 0.0f || foveaRadiusDeg > 80.0f) {
+      Util::DriverLog("[GAZE_FOVEATION] Fovea radius must be between 0 and 80 degrees, using the default.");
+      foveaRadiusDeg = SETTING_GAZE_FOVEA_RADIUS_DEFAULT_VALUE;
+    }
+    m_foveaRadiusRad = foveaRadiusDeg * (3.14159265f / 180.0f);
+
+    m_initialized = true;
+  }
+
+  void GazeFoveation::Update(const CommandDataServerGazeDataResult2_t &gazeResult) {
+    static DriverHostProxy *pDriverHostProxy = DriverHostProxy::Instance();
+
+    CommandDataServerGazeFoveationResult_t result = {};
+    result.sequence = gazeResult.sequence;
+    result.hostTimestampUs = gazeResult.hostTimestampUs;
+    result.foveaRadiusDeg = m_foveaRadiusRad * (180.0f / 3.14159265f);
+
+    DriverHostProxy::DisplayGeometry_t geometry;
+    if (!pDriverHostProxy->GetDisplayGeometry(&geometry)) {
+      m_result.Write(result);
+      return;
+    }
+
+    const GazeEyeResult *ppEyes[2] = { &gazeResult.leftEye, &gazeResult.rightEye };
+    GazeFoveationEye_t *ppResultEyes[2] = { &result.leftEye, &result.rightEye };
+
+    for (int i = 0; i < 2; i++) {
+      // An eye that was lost still has an image to foveate, the combined gaze is the best guess for it.
+      const GazeVector3 *pDirection = nullptr;
+      if (ppEyes[i]->isGazeDirValid) {
+        pDirection = &ppEyes[i]->gazeDirNorm;
+      } else if (gazeResult.combined.isGazeDirValid) {
+        pDirection = &gazeResult.combined.gazeDirNorm;
+      } else {
+        continue;
+      }
+
+      // Same conversion to SteamVR head space as the eye tracking component.
+      vr::HmdVector3_t direction = { -pDirection->x, pDirection->y, -pDirection->z };
+      ProjectEye(direction, geometry.eyeToHead[i], geometry.projection[i], m_foveaRadiusRad, ppResultEyes[i]);
+    }
+
+    m_result.Write(result);
+  }
+
+  void GazeFoveation::GetResult(CommandDataServerGazeFoveationResult_t *pResult) const {
+    if (!m_result.Read(*pResult)) {
+      *pResult = {};
+    }
+  }
+
+  void GazeFoveation::ProjectEye(const vr::HmdVector3_t &direction, const vr::HmdMatrix34_t &eyeToHead, const vr::HmdRect2_t &projection,
+                                 float foveaRadiusRad, GazeFoveationEye_t *pEye) {
+    // Eye to head is a rigid transform, so head to eye rotates by the transpose. A direction ignores the translation,
+    // the eye's gaze origin and the render camera are close enough for a point at any distance to land in the same place.
+    float eye[3];
+    for (int i = 0; i < 3; i++) {
+      eye[i] = eyeToHead.m[0][i] * direction.v[0] + eyeToHead.m[1][i] * direction.v[1] + eyeToHead.m[2][i] * direction.v[2];
+    }
+
+    // SteamVR cameras look down -z.
+    if (eye[2] >= 0.0f) {
+      return;
+    }
+
+    float left = projection.vTopLeft.v[0];
+    float top = projection.vTopLeft.v[1];
+    float right = projection.vBottomRight.v[0];
+    float bottom = projection.vBottomRight.v[1];
+    if (right <= left || bottom <= top) {
+      return;
+    }
+
+    // Tangents as in the raw projection, with y down.
+    float tanX = eye[0] / -eye[2];
+    float tanY = eye[1] / eye[2];
+
+    pEye->isValid = true;
+    pEye->gazePoint = { (tanX - left) / (right - left), (tanY - top) / (bottom - top) };
+    pEye->isInView = pEye->gazePoint.x >= 0.0f && pEye->gazePoint.x <= 1.0f && pEye->gazePoint.y >= 0.0f && pEye->gazePoint.y <= 1.0f;
+
+    // The radius is taken along each axis from the gaze angle, which keeps the rectangle the right size off centre,
+    // where the same angle covers more of the image.
+    float angleX = std::atan(tanX);
+    float angleY = std::atan(tanY);
+    float minTanX = std::tan((std::max)(angleX - foveaRadiusRad, -k_maxEdgeAngleRad));
+    float maxTanX = std::tan((std::min)(angleX + foveaRadiusRad, k_maxEdgeAngleRad));
+    float minTanY = std::tan((std::max)(angleY - foveaRadiusRad, -k_maxEdgeAngleRad));
+    float maxTanY = std::tan((std::min)(angleY + foveaRadiusRad, k_maxEdgeAngleRad));
+
+    pEye->foveaMin = {
+      std::clamp((minTanX - left) / (right - left), 0.0f, 1.0f),
+      std::clamp((minTanY - top) / (bottom - top), 0.0f, 1.0f),
+    };
+    pEye->foveaMax = {
+      std::clamp((maxTanX - left) / (right - left), 0.0f, 1.0f),
+      std::clamp((maxTanY - top) / (bottom - top), 0.0f, 1.0f),
+    };
+  }
+
+} // psvr2_toolkit
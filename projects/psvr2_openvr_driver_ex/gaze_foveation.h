@@ -0,0 +1,41 @@
+#pragma once
+
+#include "driver_host_proxy.h"
+#include "seqlock.h"
+#include "../shared/ipc_protocol.h"
+
+namespace psvr2_toolkit {
+
+  // Projects each eye's gaze into that eye's image, using the display geometry the PS VR2 driver reports to SteamVR,
+  // so a renderer can place its foveal region without knowing the headset's optics.
+  // Update is only called from the thread that owns the gaze pipeline, GetResult can be called from any thread.
+  class GazeFoveation {
+  public:
+    GazeFoveation();
+
+    static GazeFoveation *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    void Update(const ipc::CommandDataServerGazeDataResult2_t &gazeResult);
+
+    void GetResult(ipc::CommandDataServerGazeFoveationResult_t *pResult) const;
+
+  private:
+    // Keeps the fovea edges short of a right angle from the eye's axis, where the tangent blows up.
+    static constexpr float k_maxEdgeAngleRad = 1.5f;
+
+    static GazeFoveation *m_pInstance;
+
+    bool m_initialized;
+    float m_foveaRadiusRad;
+
+    SeqLock<ipc::CommandDataServerGazeFoveationResult_t> m_result;
+
+    // direction is in SteamVR head space. Leaves pEye untouched if the gaze points away from the image plane.
+    static void ProjectEye(const vr::HmdVector3_t &direction, const vr::HmdMatrix34_t &eyeToHead, const vr::HmdRect2_t &projection,
+                           float foveaRadiusRad, ipc::GazeFoveationEye_t *pEye);
+  };
+
+} // psvr2_toolkit
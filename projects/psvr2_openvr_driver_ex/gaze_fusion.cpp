@@ -0,0 +1,225 @@
+#include "gaze_fusion.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace psvr2_toolkit {
+
+  GazeFusion *GazeFusion::m_pInstance = nullptr;
+
+  GazeFusion::GazeFusion()
+    : m_initialized(false)
+    , m_enabled(false)
+    , m_timeConstantSeconds(SETTING_GAZE_FUSION_TIME_CONSTANT_DEFAULT_VALUE)
+    , m_hasLastTimestamp(false)
+    , m_lastTimestampUs(0)
+    , m_leftEye{}
+    , m_rightEye{}
+  {
+    Reset();
+  }
+
+  GazeFusion *GazeFusion::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeFusion;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeFusion::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeFusion::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    m_enabled = VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_FUSION, SETTING_ENABLE_GAZE_FUSION_DEFAULT_VALUE);
+    if (m_enabled) {
+      m_timeConstantSeconds = VRSettings::GetFloat(STEAMVR_SETTINGS_GAZE_FUSION_TIME_CONSTANT, SETTING_GAZE_FUSION_TIME_CONSTANT_DEFAULT_VALUE);
+
+      if (m_timeConstantSeconds <= 0.0f) {
+        Util::DriverLog("[GAZE_FUSION] Time constant must be positive, using the default.");
+        m_timeConstantSeconds = SETTING_GAZE_FUSION_TIME_CONSTANT_DEFAULT_VALUE;
+      }
+
+      Util::DriverLog("[GAZE_FUSION] Fusing the combined gaze from both eyes, time constant {} s.", m_timeConstantSeconds);
+    }
+
+    m_initialized = true;
+  }
+
+  void GazeFusion::Apply(Hmd2GazeState &gazeState, uint64_t hmdTimestampUs) {
+    if (!m_enabled) {
+      return;
+    }
+
+    uint64_t dtUs = hmdTimestampUs - m_lastTimestampUs;
+    if (!m_hasLastTimestamp || hmdTimestampUs <= m_lastTimestampUs || dtUs > k_ulMaxSampleGapUs) {
+      Reset();
+      dtUs = 0;
+    }
+    m_hasLastTimestamp = true;
+    m_lastTimestampUs = hmdTimestampUs;
+
+    float dtSeconds = dtUs / 1e6f;
+    float alpha = dtSeconds / (m_timeConstantSeconds + dtSeconds);
+
+    const Hmd2GazeEye &left = gazeState.leftEye;
+    const Hmd2GazeEye &right = gazeState.rightEye;
+    Hmd2GazeCombined &combined = gazeState.combined;
+
+    // A closed eye still reports a direction now and then, which is just noise.
+    bool isLeftValid = left.isGazeDirValid && !(left.isBlinkValid && left.blink);
+    bool isRightValid = right.isGazeDirValid && !(right.isBlinkValid && right.blink);
+
+    UpdateEye(m_leftEye, isLeftValid, left.gazeDirNorm, dtSeconds, alpha);
+    UpdateEye(m_rightEye, isRightValid, right.gazeDirNorm, dtSeconds, alpha);
+
+    if (isLeftValid && isRightValid) {
+      float leftWeight = m_leftEye.validity / (std::max)(m_leftEye.noiseVariance, k_minNoiseVariance);
+      float rightWeight = m_rightEye.validity / (std::max)(m_rightEye.noiseVariance, k_minNoiseVariance);
+      float totalWeight = leftWeight + rightWeight;
+      leftWeight /= totalWeight;
+      rightWeight /= totalWeight;
+
+      // The biases are learned against the plain average of the eyes, so they carry the vergence between the eyes.
+      // Weighting the eyes with their biases applied then takes noise out without pulling the ray towards either eye.
+      Hmd2Vector3 midDirection = Normalize({
+        (left.gazeDirNorm.x + right.gazeDirNorm.x) * 0.5f,
+        (left.gazeDirNorm.y + right.gazeDirNorm.y) * 0.5f,
+        (left.gazeDirNorm.z + right.gazeDirNorm.z) * 0.5f,
+      });
+
+      UpdateBias(m_leftEye, left, midDirection, alpha);
+      UpdateBias(m_rightEye, right, midDirection, alpha);
+
+      combined.gazeDirNorm = Normalize({
+        leftWeight * (left.gazeDirNorm.x + m_leftEye.directionBias.x) + rightWeight * (right.gazeDirNorm.x + m_rightEye.directionBias.x),
+        leftWeight * (left.gazeDirNorm.y + m_leftEye.directionBias.y) + rightWeight * (right.gazeDirNorm.y + m_rightEye.directionBias.y),
+        leftWeight * (left.gazeDirNorm.z + m_leftEye.directionBias.z) + rightWeight * (right.gazeDirNorm.z + m_rightEye.directionBias.z),
+      });
+      combined.isGazeDirValid = HMD2_BOOL_TRUE;
+
+      // The ray starts between the eyes whatever the weights, like the combined ray the headset reports.
+      if (left.isGazeOriginValid && right.isGazeOriginValid) {
+        combined.gazeOriginMm = {
+          (left.gazeOriginMm.x + right.gazeOriginMm.x) * 0.5f,
+          (left.gazeOriginMm.y + right.gazeOriginMm.y) * 0.5f,
+          (left.gazeOriginMm.z + right.gazeOriginMm.z) * 0.5f,
+        };
+        combined.isGazeOriginValid = HMD2_BOOL_TRUE;
+
+        UpdateOriginBias(m_leftEye, left, combined.gazeOriginMm, alpha);
+        UpdateOriginBias(m_rightEye, right, combined.gazeOriginMm, alpha);
+      }
+      return;
+    }
+
+    if (!isLeftValid && !isRightValid) {
+      return;
+    }
+
+    const Hmd2GazeEye &gazeEye = isLeftValid ? left : right;
+    const EyeState_t &eye = isLeftValid ? m_leftEye : m_rightEye;
+
+    if (!eye.hasBias) {
+      combined.gazeDirNorm = gazeEye.gazeDirNorm;
+      combined.isGazeDirValid = HMD2_BOOL_TRUE;
+      if (gazeEye.isGazeOriginValid) {
+        combined.gazeOriginMm = gazeEye.gazeOriginMm;
+        combined.isGazeOriginValid = HMD2_BOOL_TRUE;
+      }
+      return;
+    }
+
+    combined.gazeDirNorm = Normalize({
+      gazeEye.gazeDirNorm.x + eye.directionBias.x,
+      gazeEye.gazeDirNorm.y + eye.directionBias.y,
+      gazeEye.gazeDirNorm.z + eye.directionBias.z,
+    });
+    combined.isGazeDirValid = HMD2_BOOL_TRUE;
+
+    if (gazeEye.isGazeOriginValid && eye.hasOriginBias) {
+      combined.gazeOriginMm = {
+        gazeEye.gazeOriginMm.x + eye.originBias.x,
+        gazeEye.gazeOriginMm.y + eye.originBias.y,
+        gazeEye.gazeOriginMm.z + eye.originBias.z,
+      };
+      combined.isGazeOriginValid = HMD2_BOOL_TRUE;
+    }
+  }
+
+  void GazeFusion::Reset() {
+    ResetEye(m_leftEye);
+    ResetEye(m_rightEye);
+  }
+
+  void GazeFusion::ResetEye(EyeState_t &eye) {
+    eye = {};
+    eye.validity = 1.0f;
+    eye.noiseVariance = k_initialNoiseVariance;
+  }
+
+  void GazeFusion::UpdateEye(EyeState_t &eye, bool isValid, const Hmd2Vector3 &direction, float dtSeconds, float alpha) {
+    eye.validity += alpha * ((isValid ? 1.0f : 0.0f) - eye.validity);
+
+    if (!isValid) {
+      eye.hasLastDirection = false;
+      return;
+    }
+
+    if (eye.hasLastDirection && dtSeconds > 0.0f) {
+      float dx = direction.x - eye.lastDirection.x;
+      float dy = direction.y - eye.lastDirection.y;
+      float dz = direction.z - eye.lastDirection.z;
+      float stepSquared = dx * dx + dy * dy + dz * dz;
+
+      // Saccades and fast pursuit would swamp the noise, and both eyes make them anyway.
+      if (stepSquared <= k_saccadeSpeed * k_saccadeSpeed * dtSeconds * dtSeconds) {
+        eye.noiseVariance += alpha * (stepSquared - eye.noiseVariance);
+      }
+    }
+
+    eye.hasLastDirection = true;
+    eye.lastDirection = direction;
+  }
+
+  void GazeFusion::UpdateBias(EyeState_t &eye, const Hmd2GazeEye &gazeEye, const Hmd2Vector3 &direction, float alpha) {
+    Hmd2Vector3 bias = { direction.x - gazeEye.gazeDirNorm.x, direction.y - gazeEye.gazeDirNorm.y, direction.z - gazeEye.gazeDirNorm.z };
+
+    // The first measurement is taken as is, there is nothing to average it with.
+    float biasAlpha = eye.hasBias ? alpha : 1.0f;
+    eye.hasBias = true;
+
+    eye.directionBias.x += biasAlpha * (bias.x - eye.directionBias.x);
+    eye.directionBias.y += biasAlpha * (bias.y - eye.directionBias.y);
+    eye.directionBias.z += biasAlpha * (bias.z - eye.directionBias.z);
+  }
+
+  void GazeFusion::UpdateOriginBias(EyeState_t &eye, const Hmd2GazeEye &gazeEye, const Hmd2Vector3 &origin, float alpha) {
+    Hmd2Vector3 bias = { origin.x - gazeEye.gazeOriginMm.x, origin.y - gazeEye.gazeOriginMm.y, origin.z - gazeEye.gazeOriginMm.z };
+
+    float biasAlpha = eye.hasOriginBias ? alpha : 1.0f;
+    eye.hasOriginBias = true;
+
+    eye.originBias.x += biasAlpha * (bias.x - eye.originBias.x);
+    eye.originBias.y += biasAlpha * (bias.y - eye.originBias.y);
+    eye.originBias.z += biasAlpha * (bias.z - eye.originBias.z);
+  }
+
+  Hmd2Vector3 GazeFusion::Normalize(const Hmd2Vector3 &vector) {
+    float length = std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+    if (length <= 0.0f) {
+      return vector;
+    }
+
+    return { vector.x / length, vector.y / length, vector.z / length };
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Optional rebuild of the combined gaze ray from the calibrated left and right eyes.
+  // Each eye is weighted by how often it has been valid lately and how noisy it has been, so an eye that flickers
+  // in and out barely moves the combined ray. While one eye is lost the other carries on alone, shifted by how far it
+  // has lately been from the average of both eyes, so the combined ray stays valid and doesn't jump.
+  // Only ever used by the thread that owns the gaze pipeline.
+  class GazeFusion {
+  public:
+    GazeFusion();
+
+    static GazeFusion *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    // Replaces the combined gaze in place. Does nothing unless enabled in the settings, or while both eyes are lost.
+    void Apply(Hmd2GazeState &gazeState, uint64_t hmdTimestampUs);
+
+  private:
+    // A gap longer than this, e.g. while the headset was asleep, starts over.
+    static constexpr uint64_t k_ulMaxSampleGapUs = 100000;
+
+    // Steps faster than this, in direction units per second, are eye movement rather than noise. Roughly 30 deg/s.
+    static constexpr float k_saccadeSpeed = 0.52f;
+
+    // Noise of an eye before anything has been measured, and the least it is ever taken to be.
+    static constexpr float k_initialNoiseVariance = 4e-6f;
+    static constexpr float k_minNoiseVariance = 1e-8f;
+
+    struct EyeState_t {
+      float validity; // Rolling fraction of samples the eye was valid in.
+      float noiseVariance; // Rolling squared step between samples, away from saccades.
+      bool hasLastDirection;
+      Hmd2Vector3 lastDirection;
+      bool hasBias;
+      Hmd2Vector3 directionBias; // Rolling average of both eyes minus this eye's direction, while both were valid.
+      bool hasOriginBias;
+      Hmd2Vector3 originBias;
+    };
+
+    static GazeFusion *m_pInstance;
+
+    bool m_initialized;
+    bool m_enabled;
+    float m_timeConstantSeconds;
+    bool m_hasLastTimestamp;
+    uint64_t m_lastTimestampUs;
+
+    EyeState_t m_leftEye;
+    EyeState_t m_rightEye;
+
+    void Reset();
+
+    static void ResetEye(EyeState_t &eye);
+    static void UpdateEye(EyeState_t &eye, bool isValid, const Hmd2Vector3 &direction, float dtSeconds, float alpha);
+    static void UpdateBias(EyeState_t &eye, const Hmd2GazeEye &gazeEye, const Hmd2Vector3 &direction, float alpha);
+    static void UpdateOriginBias(EyeState_t &eye, const Hmd2GazeEye &gazeEye, const Hmd2Vector3 &origin, float alpha);
+    static Hmd2Vector3 Normalize(const Hmd2Vector3 &vector);
+  };
+
+} // psvr2_toolkit
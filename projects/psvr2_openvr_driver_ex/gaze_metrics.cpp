@@ -0,0 +1,226 @@
+#include "gaze_metrics.h"
+
+#include "gaze_recorder.h"
+#include "util.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <ctime>
+#endif
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  static_assert(GazeStage_Count <= k_unGazeStatsMaxStages);
+
+  GazeMetrics *GazeMetrics::m_pInstance = nullptr;
+
+  GazeMetrics::GazeMetrics()
+    : m_initialized(false)
+    , m_referenceTicks(0)
+    , m_referenceHostTimestampUs(0)
+  {}
+
+  GazeMetrics *GazeMetrics::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeMetrics;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeMetrics::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeMetrics::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    m_referenceTicks = Now();
+    m_referenceHostTimestampUs = Util::GetHostTimestamp();
+
+    m_initialized = true;
+  }
+
+  void GazeMetrics::GetStats(CommandDataServerGazeStats_t *pStats) {
+    *pStats = {};
+    pStats->stageCount = GazeStage_Count;
+
+    double ticksPerNanosecond = GetTicksPerNanosecond();
+    if (ticksPerNanosecond == 0.0) {
+      return;
+    }
+
+    // Too big to keep on the stack of the event loop.
+    static LatencyHistogram::Snapshot_t snapshot;
+
+    for (uint32_t i = 0; i < GazeStage_Count; i++) {
+      m_histograms[i].TakeSnapshot(&snapshot);
+
+      GazeStageStats_t &stage = pStats->stages[i];
+      stage.count = snapshot.count;
+      if (snapshot.count == 0) {
+        continue;
+      }
+
+      stage.meanNs = TicksToNanoseconds(snapshot.sum / snapshot.count, ticksPerNanosecond);
+      stage.p50Ns = TicksToNanoseconds(LatencyHistogram::GetValueAtPercentile(snapshot, 0.5), ticksPerNanosecond);
+      stage.p90Ns = TicksToNanoseconds(LatencyHistogram::GetValueAtPercentile(snapshot, 0.9), ticksPerNanosecond);
+      stage.p99Ns = TicksToNanoseconds(LatencyHistogram::GetValueAtPercentile(snapshot, 0.99), ticksPerNanosecond);
+      stage.p999Ns = TicksToNanoseconds(LatencyHistogram::GetValueAtPercentile(snapshot, 0.999), ticksPerNanosecond);
+      stage.maxNs = TicksToNanoseconds(snapshot.max, ticksPerNanosecond);
+    }
+  }
+
+  void GazeMetrics::Reset() {
+    for (LatencyHistogram &histogram : m_histograms) {
+      histogram.Reset();
+    }
+  }
+
+  bool GazeMetrics::Dump() {
+    std::string directory = GazeRecorder::GetRecordingDirectory();
+    if (directory.empty()) {
+      Util::DriverLog("[GAZE_METRICS] No directory to dump to.");
+      return false;
+    }
+
+    double ticksPerNanosecond = GetTicksPerNanosecond();
+    if (ticksPerNanosecond == 0.0) {
+      return false;
+    }
+
+    CommandDataServerGazeStats_t stats;
+    GetStats(&stats);
+
+    std::string text = "stage,count,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+    for (uint32_t i = 0; i < GazeStage_Count; i++) {
+      const GazeStageStats_t &stage = stats.stages[i];
+      text += std::format("{},{},{},{},{},{},{},{}\n", GetStageName(static_cast<EGazeStage>(i)),
+                          stage.count, stage.meanNs, stage.p50Ns, stage.p90Ns, stage.p99Ns, stage.p999Ns, stage.maxNs);
+    }
+
+    static LatencyHistogram::Snapshot_t snapshot;
+
+    text += "\nstage,bucket_min_ns,bucket_max_ns,count\n";
+    for (uint32_t i = 0; i < GazeStage_Count; i++) {
+      m_histograms[i].TakeSnapshot(&snapshot);
+      for (uint32_t bucket = 0; bucket < LatencyHistogram::k_unBucketCount; bucket++) {
+        if (snapshot.counts[bucket] == 0) {
+          continue;
+        }
+
+        text += std::format("{},{},{},{}\n", GetStageName(static_cast<EGazeStage>(i)),
+                            TicksToNanoseconds(LatencyHistogram::GetBucketLowerBound(bucket), ticksPerNanosecond),
+                            TicksToNanoseconds(LatencyHistogram::GetBucketUpperBound(bucket), ticksPerNanosecond),
+                            snapshot.counts[bucket]);
+      }
+    }
+
+#ifdef _WIN32
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    std::string path = std::format("{}\\gaze_stats_{:04}{:02}{:02}_{:02}{:02}{:02}.csv", directory,
+                                   time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond);
+
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+      Util::DriverLog("[GAZE_METRICS] Creating {} failed. LastError = {}", path, GetLastError());
+      return false;
+    }
+
+    DWORD written = 0;
+    bool success = WriteFile(hFile, text.data(), static_cast<DWORD>(text.size()), &written, nullptr) && written == text.size();
+    CloseHandle(hFile);
+
+    if (!success) {
+      Util::DriverLog("[GAZE_METRICS] Writing {} failed. LastError = {}", path, GetLastError());
+      return false;
+    }
+#else
+    // Only the tests build on other platforms, the replay benchmark dumps through here.
+    time_t now = time(nullptr);
+    tm localTime;
+    localtime_r(&now, &localTime);
+    char pchName[64];
+    strftime(pchName, sizeof(pchName), "/gaze_stats_%Y%m%d_%H%M%S.csv", &localTime);
+    std::string path = directory + pchName;
+
+    int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file == -1) {
+      Util::DriverLog("[GAZE_METRICS] Creating {} failed. errno = {}", path, errno);
+      return false;
+    }
+
+    bool success = write(file, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(file);
+
+    if (!success) {
+      Util::DriverLog("[GAZE_METRICS] Writing {} failed. errno = {}", path, errno);
+      return false;
+    }
+#endif
+
+    Util::DriverLog("[GAZE_METRICS] Dumped gaze stage latencies to {}.", path);
+    return true;
+  }
+
+  double GazeMetrics::GetTicksPerNanosecond() {
+    if (!m_initialized) {
+      return 0.0;
+    }
+
+    uint64_t ticks = Now();
+    int64_t hostTimestampUs = Util::GetHostTimestamp();
+
+    // Below a second, the two clocks haven't been read far enough apart for a useful rate.
+    if (hostTimestampUs - m_referenceHostTimestampUs < 1000000) {
+      return 0.0;
+    }
+
+    return static_cast<double>(ticks - m_referenceTicks) / (static_cast<double>(hostTimestampUs - m_referenceHostTimestampUs) * 1e3);
+  }
+
+  const char *GazeMetrics::GetStageName(EGazeStage stage) {
+    // Indexed by EGazeStage.
+    static const char *const ppStageNames[] = {
+      "usb_read",
+      "parse",
+      "remap",
+      "fusion",
+      "filter",
+      "record",
+      "predict",
+      "vergence",
+      "foveation",
+      "openvr_update",
+      "publish",
+      "pipeline",
+      "ipc_wake",
+      "ipc_fan_out",
+    };
+    static_assert(std::size(ppStageNames) == GazeStage_Count);
+
+    return ppStageNames[stage];
+  }
+
+  uint32_t GazeMetrics::TicksToNanoseconds(uint64_t ticks, double ticksPerNanosecond) {
+    double nanoseconds = std::round(static_cast<double>(ticks) / ticksPerNanosecond);
+    if (nanoseconds >= static_cast<double>((std::numeric_limits<uint32_t>::max)())) {
+      return (std::numeric_limits<uint32_t>::max)();
+    }
+
+    return static_cast<uint32_t>(nanoseconds);
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include "../shared/ipc_protocol.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include <cstdint>
+#include <string>
+
+namespace psvr2_toolkit {
+
+  // Latency histograms of every stage a gaze state goes through, from the USB read to the IPC clients.
+  // Stages are timed in TSC ticks, which cost a few nanoseconds to read, and only converted to time when queried,
+  // against the host clock since Initialize. About a dozen reads per sample, far below 1% of the time between samples.
+  class GazeMetrics {
+  public:
+    GazeMetrics();
+
+    static GazeMetrics *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    static uint64_t Now() {
+      return __rdtsc();
+    }
+
+    // Each stage must only be recorded from one thread at a time, the gaze pipeline stages from whichever thread owns the pipeline.
+    void Record(ipc::EGazeStage stage, uint64_t startTicks, uint64_t endTicks) {
+      m_histograms[stage].Record(endTicks > startTicks ? endTicks - startTicks : 0);
+    }
+
+    void GetStats(ipc::CommandDataServerGazeStats_t *pStats);
+    void Reset();
+
+    // Writes the summary and every non-empty bucket of every stage as CSV, next to the gaze recordings.
+    bool Dump();
+
+    // As in the dump, e.g. "openvr_update".
+    static const char *GetStageName(ipc::EGazeStage stage);
+
+  private:
+    static GazeMetrics *m_pInstance;
+
+    bool m_initialized;
+    uint64_t m_referenceTicks;
+    int64_t m_referenceHostTimestampUs;
+
+    LatencyHistogram m_histograms[ipc::GazeStage_Count];
+
+    // Measured over the whole time since Initialize, so it's only as good as the uptime. 0 if too early to tell.
+    double GetTicksPerNanosecond();
+
+    static uint32_t TicksToNanoseconds(uint64_t ticks, double ticksPerNanosecond);
+  };
+
+} // psvr2_toolkit
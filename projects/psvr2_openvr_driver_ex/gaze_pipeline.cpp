@@ -0,0 +1,198 @@
+#include "gaze_pipeline.h"
+
+#include "gaze_calibration_session.h"
+#include "gaze_calibration_store.h"
+#include "gaze_filter.h"
+#include "gaze_foveation.h"
+#include "gaze_fusion.h"
+#include "gaze_metrics.h"
+#include "gaze_predictor.h"
+#include "gaze_recorder.h"
+#include "gaze_vergence.h"
+#include "ipc_gaze_result.h"
+#include "util.h"
+
+#include <thread>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazePipeline *GazePipeline::m_pInstance = nullptr;
+
+  GazePipeline::GazePipeline()
+    : m_initialized(false)
+    , m_pDriverInput(nullptr)
+    , m_pOpenVrUpdate(nullptr)
+    , m_pIpcSink(nullptr)
+    , m_replaying(false)
+    , m_liveInProgress(false)
+    , m_sequence(0)
+    , m_clockSync()
+  {}
+
+  GazePipeline *GazePipeline::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazePipeline;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazePipeline::Initialized() {
+    return m_initialized;
+  }
+
+  void GazePipeline::Initialize(GazeDriverInput *pDriverInput, GazeOpenVrUpdate *pOpenVrUpdate, GazeIpcSink *pIpcSink) {
+    if (m_initialized) {
+      return;
+    }
+
+    m_pDriverInput = pDriverInput;
+    m_pOpenVrUpdate = pOpenVrUpdate;
+    m_pIpcSink = pIpcSink;
+
+    m_initialized = true;
+  }
+
+  void GazePipeline::ProcessLive(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t readEndTicks) {
+    static GazeMetrics *pGazeMetrics = GazeMetrics::Instance();
+
+    if (!m_initialized) {
+      return;
+    }
+
+    // Pairs with BeginReplay, which sets m_replaying and then waits for this to drop.
+    m_liveInProgress.store(true, std::memory_order_seq_cst);
+
+    if (!m_replaying.load(std::memory_order_seq_cst)) {
+      uint32_t hmdTimestamp = rawState.combined.timestamp;
+      int64_t arrivalHostTimestampUs = Util::GetHostTimestamp();
+
+      uint64_t hmdTimestampUs = m_clockSync.Unwrap(hmdTimestamp);
+      if (m_clockSync.IsOffsetSampleDue(hmdTimestampUs)) {
+        m_clockSync.AddOffsetSample(hmdTimestampUs, m_pDriverInput->HmdToHostTimestamp(hmdTimestamp));
+      }
+      int64_t hostTimestampUs = m_clockSync.ToHost(hmdTimestampUs);
+      m_clockSync.AddArrival(hmdTimestampUs, hostTimestampUs, arrivalHostTimestampUs);
+      pGazeMetrics->Record(GazeStage_Parse, readEndTicks, GazeMetrics::Now());
+
+      Process(rawState, rawPacketSize, hmdTimestampUs, hostTimestampUs, readEndTicks);
+    }
+
+    m_liveInProgress.store(false, std::memory_order_release);
+  }
+
+  void GazePipeline::BeginReplay() {
+    m_replaying.store(true, std::memory_order_seq_cst);
+
+    // At most one gaze state, so this is short.
+    while (m_liveInProgress.load(std::memory_order_seq_cst)) {
+      std::this_thread::yield();
+    }
+  }
+
+  void GazePipeline::EndReplay() {
+    m_replaying.store(false, std::memory_order_seq_cst);
+  }
+
+  void GazePipeline::ProcessReplay(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t hmdTimestampUs, int64_t hostTimestampUs) {
+    Process(rawState, rawPacketSize, hmdTimestampUs, hostTimestampUs, GazeMetrics::Now());
+  }
+
+  void GazePipeline::GetClockStatus(CommandDataServerGazeClockStatus_t *pStatus) {
+    m_clockSync.GetStatus(pStatus);
+  }
+
+  void GazePipeline::Process(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t hmdTimestampUs, int64_t hostTimestampUs, uint64_t startTicks) {
+    static GazeCalibrationStore *pGazeCalibrationStore = GazeCalibrationStore::Instance();
+    static GazeCalibrationSession *pGazeCalibrationSession = GazeCalibrationSession::Instance();
+    static GazeFusion *pGazeFusion = GazeFusion::Instance();
+    static GazeFilter *pGazeFilter = GazeFilter::Instance();
+    static GazePredictor *pGazePredictor = GazePredictor::Instance();
+    static GazeRecorder *pGazeRecorder = GazeRecorder::Instance();
+    static GazeVergence *pGazeVergence = GazeVergence::Instance();
+    static GazeFoveation *pGazeFoveation = GazeFoveation::Instance();
+    static GazeMetrics *pGazeMetrics = GazeMetrics::Instance();
+
+    uint64_t stageStartTicks = GazeMetrics::Now();
+    uint64_t stageEndTicks;
+
+    Hmd2GazeState calibratedGazeState = rawState;
+
+    // Calibration works on the raw gaze, only does anything while a session is collecting samples.
+    pGazeCalibrationSession->AddSample(rawState, hmdTimestampUs);
+
+    {
+      // Pinned only for the remap, so a reload never waits on the rest of the pipeline.
+      GazeCalibrationStore::ReadGuard calibration = pGazeCalibrationStore->Acquire();
+
+      if (calibratedGazeState.leftEye.isGazeDirValid) {
+        calibratedGazeState.leftEye.gazeDirNorm = calibration->leftEye.Remap(rawState.leftEye.gazeDirNorm);
+      }
+
+      if (calibratedGazeState.rightEye.isGazeDirValid) {
+        calibratedGazeState.rightEye.gazeDirNorm = calibration->rightEye.Remap(rawState.rightEye.gazeDirNorm);
+      }
+    }
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Remap, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    // On the calibrated eyes, before the filter, so the noise estimates see the eyes as tracked.
+    pGazeFusion->Apply(calibratedGazeState, hmdTimestampUs);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Fusion, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    // Before anything is published, so OpenVR, IPC and shared memory all see the same smoothing.
+    pGazeFilter->Apply(calibratedGazeState, hmdTimestampUs);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Filter, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    // Stamped once here, so IPC, the gaze history and the shared memory ring all agree on sequence numbers.
+    CommandDataServerGazeDataResult2_t gazeResult = MakeGazeDataResult2(calibratedGazeState, ++m_sequence, hmdTimestampUs, hostTimestampUs);
+
+    pGazeRecorder->Record(rawState, rawPacketSize, calibratedGazeState, gazeResult);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Record, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    // Before UpdateGaze, which may report the prediction instead of the sample.
+    pGazePredictor->Update(gazeResult);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Predict, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    pGazeVergence->Update(gazeResult);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Vergence, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    pGazeFoveation->Update(gazeResult);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Foveation, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    m_pOpenVrUpdate->UpdateGaze(&calibratedGazeState, hostTimestampUs);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_OpenVrUpdate, stageStartTicks, stageEndTicks);
+    stageStartTicks = stageEndTicks;
+
+    m_pIpcSink->Publish(gazeResult);
+
+    stageEndTicks = GazeMetrics::Now();
+    pGazeMetrics->Record(GazeStage_Publish, stageStartTicks, stageEndTicks);
+    pGazeMetrics->Record(GazeStage_Pipeline, startTicks, stageEndTicks);
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gaze_pipeline_stages.h"
+#include "hmd2_gaze.h"
+#include "hmd_clock_sync.h"
+#include "../shared/ipc_protocol.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Everything a gaze state goes through between the USB read and its consumers:
+  // calibration, fusion, filtering, recording, prediction, vergence, foveation, SteamVR, IPC and shared memory.
+  // Fed by the USB gaze thread, or by a replay, which takes the pipeline over for as long as it runs.
+  class GazePipeline {
+  public:
+    GazePipeline();
+
+    static GazePipeline *Instance();
+
+    bool Initialized();
+
+    // Takes ownership of the stages. Gaze the USB thread reads before this is dropped.
+    void Initialize(GazeDriverInput *pDriverInput, GazeOpenVrUpdate *pOpenVrUpdate, GazeIpcSink *pIpcSink);
+
+    // Called from the USB gaze thread for every gaze state read. Dropped while a replay owns the pipeline, never blocks.
+    // readEndTicks is the GazeMetrics time the USB read returned.
+    void ProcessLive(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t readEndTicks);
+
+    // Waits until the USB gaze thread is out of the pipeline, live gaze is dropped until EndReplay.
+    void BeginReplay();
+    void EndReplay();
+
+    // Only from the thread that called BeginReplay. The timestamps are taken as is, the state's own are ignored.
+    void ProcessReplay(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t hmdTimestampUs, int64_t hostTimestampUs);
+
+    // Callable from any thread.
+    void GetClockStatus(ipc::CommandDataServerGazeClockStatus_t *pStatus);
+
+  private:
+    static GazePipeline *m_pInstance;
+
+    bool m_initialized;
+    GazeDriverInput *m_pDriverInput;
+    GazeOpenVrUpdate *m_pOpenVrUpdate;
+    GazeIpcSink *m_pIpcSink;
+
+    std::atomic<bool> m_replaying;
+    std::atomic<bool> m_liveInProgress; // Set by the USB gaze thread for as long as it might be in the pipeline.
+
+    // Only touched by whichever thread owns the pipeline.
+    uint64_t m_sequence;
+    HmdClockSync m_clockSync; // Only fed live gaze, a replay brings its own timestamps.
+
+    void Process(const Hmd2GazeState &rawState, uint32_t rawPacketSize, uint64_t hmdTimestampUs, int64_t hostTimestampUs, uint64_t startTicks);
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,27 @@
+#include "gaze_pipeline_driver.h"
+
+#include "gaze_ring_publisher.h"
+#include "hmd_device_hooks.h"
+#include "ipc_server.h"
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  int64_t DriverGazeInput::HmdToHostTimestamp(uint32_t hmdTimestamp) {
+    return HmdDeviceHooks::HmdToHostTimestamp(hmdTimestamp);
+  }
+
+  void DriverGazeOpenVrUpdate::UpdateGaze(Hmd2GazeState *pGazeState, int64_t hostTimestampUs) {
+    HmdDeviceHooks::UpdateGaze(pGazeState, sizeof(Hmd2GazeState), hostTimestampUs);
+  }
+
+  void DriverGazeIpcSink::Publish(const CommandDataServerGazeDataResult2_t &gazeResult) {
+    static IpcServer *pIpcServer = IpcServer::Instance();
+    static GazeRingPublisher *pGazeRingPublisher = GazeRingPublisher::Instance();
+
+    pIpcServer->UpdateGazeState(gazeResult);
+    pGazeRingPublisher->Publish(gazeResult);
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "gaze_pipeline_stages.h"
+
+namespace psvr2_toolkit {
+
+  // Reads the HMD to host offset the PS VR2 driver tracks alongside the IMU.
+  class DriverGazeInput : public GazeDriverInput {
+  public:
+    int64_t HmdToHostTimestamp(uint32_t hmdTimestamp) override;
+  };
+
+  // Reports the gaze to SteamVR through the headset's eye tracking component.
+  class DriverGazeOpenVrUpdate : public GazeOpenVrUpdate {
+  public:
+    void UpdateGaze(Hmd2GazeState *pGazeState, int64_t hostTimestampUs) override;
+  };
+
+  // Hands the gaze to the IPC clients and the shared memory ring.
+  class DriverGazeIpcSink : public GazeIpcSink {
+  public:
+    void Publish(const ipc::CommandDataServerGazeDataResult2_t &gazeResult) override;
+  };
+
+} // psvr2_toolkit
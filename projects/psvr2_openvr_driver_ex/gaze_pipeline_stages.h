@@ -0,0 +1,37 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // The ends of the gaze pipeline that reach into the PS VR2 driver, SteamVR and the IPC clients,
+  // so everything in between can run against stubs. The driver's own are in gaze_pipeline_driver.h.
+  // All of them are only called from whichever thread owns the pipeline.
+
+  class GazeDriverInput {
+  public:
+    virtual ~GazeDriverInput() = default;
+
+    // Converts an HMD timestamp to host time in microseconds. Too slow to call for every sample, HmdClockSync samples it.
+    virtual int64_t HmdToHostTimestamp(uint32_t hmdTimestamp) = 0;
+  };
+
+  class GazeOpenVrUpdate {
+  public:
+    virtual ~GazeOpenVrUpdate() = default;
+
+    // hostTimestampUs is the host time in microseconds the gaze state was sampled at.
+    virtual void UpdateGaze(Hmd2GazeState *pGazeState, int64_t hostTimestampUs) = 0;
+  };
+
+  class GazeIpcSink {
+  public:
+    virtual ~GazeIpcSink() = default;
+
+    virtual void Publish(const ipc::CommandDataServerGazeDataResult2_t &gazeResult) = 0;
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,106 @@
+#include "gaze_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazePredictor *GazePredictor::m_pInstance = nullptr;
+
+  GazePredictor::GazePredictor()
+    : m_writerState{}
+    , m_hasVelocity(false)
+  {}
+
+  GazePredictor *GazePredictor::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazePredictor;
+    }
+
+    return m_pInstance;
+  }
+
+  void GazePredictor::Update(const CommandDataServerGazeDataResult2_t &gazeResult) {
+    const GazeCombinedResult &combined = gazeResult.combined;
+    State_t &state = m_writerState;
+
+    int64_t dtUs = gazeResult.hostTimestampUs - state.hostTimestampUs;
+    bool continuous = state.isValid && combined.isGazeDirValid && dtUs > 0 && dtUs <= k_maxSampleGapUs;
+
+    if (continuous) {
+      float dtSeconds = dtUs / 1e6f;
+      GazeVector3 measured = {
+        (combined.gazeDirNorm.x - state.direction.x) / dtSeconds,
+        (combined.gazeDirNorm.y - state.direction.y) / dtSeconds,
+        (combined.gazeDirNorm.z - state.direction.z) / dtSeconds,
+      };
+      float speed = std::sqrt(measured.x * measured.x + measured.y * measured.y + measured.z * measured.z);
+
+      state.isSaccade = speed > k_saccadeSpeed;
+      if (state.isSaccade) {
+        // Start over once the saccade lands, its velocity says nothing about what comes after.
+        state.velocity = {};
+        m_hasVelocity = false;
+      } else if (!m_hasVelocity) {
+        state.velocity = measured;
+        m_hasVelocity = true;
+      } else {
+        state.velocity.x += k_velocitySmoothing * (measured.x - state.velocity.x);
+        state.velocity.y += k_velocitySmoothing * (measured.y - state.velocity.y);
+        state.velocity.z += k_velocitySmoothing * (measured.z - state.velocity.z);
+      }
+    } else {
+      state.velocity = {};
+      state.isSaccade = false;
+      m_hasVelocity = false;
+    }
+
+    state.sequence = gazeResult.sequence;
+    state.hostTimestampUs = gazeResult.hostTimestampUs;
+    state.isValid = combined.isGazeDirValid;
+    if (state.isValid) {
+      state.origin = combined.gazeOriginMm;
+      state.direction = combined.gazeDirNorm;
+    }
+
+    m_state.Write(state);
+  }
+
+  bool GazePredictor::Predict(int64_t targetHostTimestampUs, CommandDataServerGazePredictionResult_t *pResult) const {
+    *pResult = {};
+    pResult->targetHostTimestampUs = targetHostTimestampUs;
+
+    State_t state;
+    if (!m_state.Read(state) || !state.isValid) {
+      return false;
+    }
+
+    // Never predict backwards, an older target just gets the newest sample.
+    float horizonSeconds = std::clamp<int64_t>(targetHostTimestampUs - state.hostTimestampUs, 0, k_maxHorizonUs) / 1e6f;
+
+    pResult->sampleHostTimestampUs = state.hostTimestampUs;
+    pResult->sequence = state.sequence;
+    pResult->gazeOriginMm = state.origin;
+    // Stepping along the velocity leaves the unit sphere, clients expect a unit direction.
+    pResult->gazeDirNorm = Normalize({
+      state.direction.x + state.velocity.x * horizonSeconds,
+      state.direction.y + state.velocity.y * horizonSeconds,
+      state.direction.z + state.velocity.z * horizonSeconds,
+    });
+    pResult->isValid = true;
+    pResult->isSaccade = state.isSaccade;
+    return true;
+  }
+
+  GazeVector3 GazePredictor::Normalize(const GazeVector3 &vector) {
+    float length = std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+    if (length <= 0.0f) {
+      return vector;
+    }
+
+    return { vector.x / length, vector.y / length, vector.z / length };
+  }
+
+} // psvr2_toolkit
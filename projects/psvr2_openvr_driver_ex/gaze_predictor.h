@@ -0,0 +1,59 @@
+#pragma once
+
+#include "seqlock.h"
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Extrapolates the combined gaze ray to a requested host time, to make up for USB and pipeline latency.
+  // Uses a smoothed constant velocity model. During a saccade the velocity is reset and the direction is held,
+  // since extrapolating a saccade overshoots its landing point more often than not.
+  // Update is only called from the USB gaze thread, Predict can be called from any thread.
+  class GazePredictor {
+  public:
+    GazePredictor();
+
+    static GazePredictor *Instance();
+
+    void Update(const ipc::CommandDataServerGazeDataResult2_t &gazeResult);
+
+    // targetHostTimestampUs is host QPC time in microseconds. Returns false if there is no valid gaze to predict from.
+    bool Predict(int64_t targetHostTimestampUs, ipc::CommandDataServerGazePredictionResult_t *pResult) const;
+
+  private:
+    // Predictions never reach further past the newest sample than this.
+    static constexpr int64_t k_maxHorizonUs = 50000;
+
+    // Gaze speed, in direction units per second, above which a sample counts as part of a saccade. Roughly 85 deg/s.
+    static constexpr float k_saccadeSpeed = 1.5f;
+
+    // Weight of each new velocity measurement, lower is smoother but slower to follow pursuit.
+    static constexpr float k_velocitySmoothing = 0.3f;
+
+    // A gap longer than this restarts the velocity estimate.
+    static constexpr int64_t k_maxSampleGapUs = 100000;
+
+    struct State_t {
+      uint64_t sequence;
+      int64_t hostTimestampUs;
+      ipc::GazeVector3 origin;
+      ipc::GazeVector3 direction;
+      ipc::GazeVector3 velocity; // Direction units per second.
+      bool isValid;
+      bool isSaccade;
+    };
+
+    static GazePredictor *m_pInstance;
+
+    SeqLock<State_t> m_state;
+
+    // Only touched by the USB gaze thread.
+    State_t m_writerState;
+    bool m_hasVelocity;
+
+    static ipc::GazeVector3 Normalize(const ipc::GazeVector3 &vector);
+  };
+
+} // psvr2_toolkit
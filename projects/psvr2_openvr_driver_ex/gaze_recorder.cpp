@@ -0,0 +1,362 @@
+#include "gaze_recorder.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <cstring>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeRecorder *GazeRecorder::m_pInstance = nullptr;
+
+  GazeRecorder::GazeRecorder()
+    : m_initialized(false)
+    , m_settingEnabled(false)
+    , m_shutdownRequested(false)
+    , m_wantRecording(false)
+    , m_requestGeneration(0)
+    , m_appliedGeneration(0)
+    , m_recording(false)
+    , m_recordInProgress(false)
+    , m_pNextChunk(nullptr)
+    , m_pFullChunk(nullptr)
+    , m_fullChunkFrameCount(0)
+    , m_frameCount(0)
+    , m_droppedFrameCount(0)
+    , m_pCurrentChunk(nullptr)
+    , m_currentChunkFrameCount(0)
+#ifdef _WIN32
+    , m_hFile(nullptr)
+#else
+    , m_file(-1)
+#endif
+    , m_pHeader(nullptr)
+    , m_mappedChunkCount(0)
+    , m_retiredChunkCount(0)
+#ifdef _WIN32
+    , m_hWakeEvent(nullptr)
+#else
+    , m_wakeEvent(-1)
+#endif
+  {}
+
+  GazeRecorder *GazeRecorder::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeRecorder;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeRecorder::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeRecorder::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    if (VRSettings::GetBool(STEAMVR_SETTINGS_DISABLE_GAZE, SETTING_DISABLE_GAZE_DEFAULT_VALUE)) {
+      return;
+    }
+
+    if (!CreateWakeEvent()) {
+      return;
+    }
+
+    m_shutdownRequested = false;
+    m_writerThread = std::thread(&GazeRecorder::WriterLoop, this);
+    m_initialized = true;
+
+    m_settingEnabled = VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_RECORDING, SETTING_ENABLE_GAZE_RECORDING_DEFAULT_VALUE);
+    if (m_settingEnabled) {
+      Request(true);
+    }
+  }
+
+  void GazeRecorder::Start() {
+    if (!m_initialized) {
+      return;
+    }
+
+    WaitForRequest(Request(true));
+  }
+
+  void GazeRecorder::Stop() {
+    if (!m_initialized) {
+      return;
+    }
+
+    WaitForRequest(Request(false));
+  }
+
+  void GazeRecorder::Shutdown() {
+    if (!m_initialized) {
+      return;
+    }
+    m_initialized = false;
+
+    // The writer thread closes the recording, if there is one, on its way out.
+    m_shutdownRequested = true;
+    SignalWake();
+    m_writerThread.join();
+
+    DestroyWakeEvent();
+  }
+
+  void GazeRecorder::GetStatus(CommandDataServerGazeRecordingStatus_t *pStatus) {
+    *pStatus = {};
+    pStatus->isRecording = m_recording.load(std::memory_order_relaxed);
+    pStatus->droppedFrameCount = m_droppedFrameCount.load(std::memory_order_relaxed);
+    pStatus->frameCount = m_frameCount.load(std::memory_order_relaxed);
+  }
+
+  void GazeRecorder::Record(const Hmd2GazeState &rawState, uint32_t rawPacketSize, const Hmd2GazeState &calibratedState,
+                            const CommandDataServerGazeDataResult2_t &gazeResult)
+  {
+    // Pairs with Close, which clears m_recording and then waits for this to drop.
+    m_recordInProgress.store(true, std::memory_order_seq_cst);
+
+    if (m_recording.load(std::memory_order_seq_cst)) {
+      if (m_currentChunkFrameCount == k_unFramesPerChunk) {
+        // Only one full chunk can be waiting for the writer thread at a time.
+        GazeRecordingFrame_t *pNextChunk = nullptr;
+        if (!m_pFullChunk.load(std::memory_order_acquire)) {
+          pNextChunk = m_pNextChunk.exchange(nullptr, std::memory_order_acq_rel);
+        }
+
+        if (pNextChunk) {
+          m_fullChunkFrameCount.store(m_currentChunkFrameCount, std::memory_order_relaxed);
+          m_pFullChunk.store(m_pCurrentChunk, std::memory_order_release);
+          SignalWake();
+
+          m_pCurrentChunk = pNextChunk;
+          m_currentChunkFrameCount = 0;
+        }
+      }
+
+      if (m_currentChunkFrameCount < k_unFramesPerChunk) {
+        GazeRecordingFrame_t &frame = m_pCurrentChunk[m_currentChunkFrameCount++];
+        frame.sequence = gazeResult.sequence;
+        frame.hmdTimestampUs = gazeResult.hmdTimestampUs;
+        frame.hostTimestampUs = gazeResult.hostTimestampUs;
+        frame.rawPacketSize = rawPacketSize;
+        frame.reserved = 0;
+        memcpy(frame.rawState, &rawState, sizeof(frame.rawState));
+        memcpy(frame.calibratedState, &calibratedState, sizeof(frame.calibratedState));
+
+        m_frameCount.store(m_frameCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      } else {
+        // The writer thread hasn't caught up yet, or the file is as large as it gets.
+        m_droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    m_recordInProgress.store(false, std::memory_order_release);
+  }
+
+  void GazeRecorder::HandleEvent(vr::VREvent_t *pEvent) {
+    // Our section isn't one SteamVR knows by name, so changes to it arrive as "other section" events.
+    if (pEvent->eventType != vr::VREvent_OtherSectionSettingChanged &&
+        pEvent->eventType != vr::VREvent_AnyDriverSettingsChanged)
+    {
+      return;
+    }
+
+    GazeRecorder *pRecorder = Instance();
+    if (!pRecorder->Initialized()) {
+      return;
+    }
+
+    // Doesn't wait for the writer thread, this runs on the thread that polls SteamVR events.
+    bool enabled = VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_RECORDING, SETTING_ENABLE_GAZE_RECORDING_DEFAULT_VALUE);
+    if (enabled != pRecorder->m_settingEnabled) {
+      pRecorder->m_settingEnabled = enabled;
+      pRecorder->Request(enabled);
+    }
+  }
+
+  uint32_t GazeRecorder::Request(bool record) {
+    m_wantRecording.store(record);
+    uint32_t generation = m_requestGeneration.fetch_add(1) + 1;
+    SignalWake();
+    return generation;
+  }
+
+  void GazeRecorder::WaitForRequest(uint32_t generation) {
+    uint32_t applied = m_appliedGeneration.load(std::memory_order_acquire);
+    while (static_cast<int32_t>(applied - generation) < 0) {
+      m_appliedGeneration.wait(applied, std::memory_order_acquire);
+      applied = m_appliedGeneration.load(std::memory_order_acquire);
+    }
+  }
+
+  void GazeRecorder::WriterLoop() {
+    bool shutdown = false;
+    while (!shutdown) {
+      WaitForWake();
+
+      uint32_t generation = m_requestGeneration.load();
+      shutdown = m_shutdownRequested.load();
+      bool wantRecording = m_wantRecording.load() && !shutdown;
+
+      if (wantRecording && !m_pHeader) {
+        Open();
+      } else if (!wantRecording && m_pHeader) {
+        Close();
+      }
+
+      if (m_pHeader) {
+        RetireFullChunk();
+      }
+
+      // Also releases anyone still waiting on a request when shutting down.
+      m_appliedGeneration.store(generation, std::memory_order_release);
+      m_appliedGeneration.notify_all();
+    }
+  }
+
+  bool GazeRecorder::Open() {
+    if (!CreateRecordingFile()) {
+      return false;
+    }
+
+    m_pHeader = static_cast<GazeRecordingHeader_t *>(MapRegion(0, k_unGazeRecordingHeaderSize));
+    if (!m_pHeader) {
+      DeleteRecordingFile();
+      return false;
+    }
+
+    m_pHeader->magic = k_unGazeRecordingMagic;
+    m_pHeader->version = k_unGazeRecordingVersion;
+    m_pHeader->headerSize = k_unGazeRecordingHeaderSize;
+    m_pHeader->chunkSize = k_unGazeRecordingChunkSize;
+    m_pHeader->frameSize = sizeof(GazeRecordingFrame_t);
+    m_pHeader->stateSize = k_unGazeRecordingStateSize;
+    m_pHeader->startHostTimestampUs = Util::GetHostTimestamp();
+
+    m_mappedChunkCount = 0;
+    m_retiredChunkCount = 0;
+    m_frameCount = 0;
+    m_droppedFrameCount = 0;
+
+    // The first chunk becomes the current one right away, the second waits for it to fill up.
+    MapNextChunk();
+    m_pCurrentChunk = m_pNextChunk.exchange(nullptr);
+    m_currentChunkFrameCount = 0;
+    if (!m_pCurrentChunk) {
+      UnmapRegion(m_pHeader, k_unGazeRecordingHeaderSize);
+      m_pHeader = nullptr;
+      DeleteRecordingFile();
+      return false;
+    }
+    MapNextChunk();
+
+    m_recording.store(true, std::memory_order_seq_cst);
+
+    Util::DriverLog("[GAZE_RECORDER] Recording gaze to {}", m_path);
+    return true;
+  }
+
+  void GazeRecorder::Close() {
+    m_recording.store(false, std::memory_order_seq_cst);
+
+    // Once the USB gaze thread is out of Record, it won't look at the chunks again until the next start.
+    while (m_recordInProgress.load(std::memory_order_seq_cst)) {
+      std::this_thread::yield();
+    }
+
+    GazeRecordingFrame_t *pFullChunk = m_pFullChunk.exchange(nullptr);
+    if (pFullChunk) {
+      RetireChunk(pFullChunk, m_fullChunkFrameCount.load());
+    }
+    RetireChunk(m_pCurrentChunk, m_currentChunkFrameCount);
+    m_pCurrentChunk = nullptr;
+
+    GazeRecordingFrame_t *pNextChunk = m_pNextChunk.exchange(nullptr);
+    if (pNextChunk) {
+      UnmapRegion(pNextChunk, k_unGazeRecordingChunkSize);
+    }
+
+    uint32_t chunkCount = m_retiredChunkCount;
+    while (chunkCount > 0 && m_pHeader->chunks[chunkCount - 1].frameCount == 0) {
+      chunkCount--;
+    }
+
+    uint64_t frameCount = m_frameCount.load();
+    uint32_t droppedFrameCount = m_droppedFrameCount.load();
+
+    m_pHeader->chunkCount = chunkCount;
+    m_pHeader->droppedFrameCount = droppedFrameCount;
+    m_pHeader->frameCount = frameCount;
+    m_pHeader->stopHostTimestampUs = Util::GetHostTimestamp();
+    m_pHeader->isComplete = true;
+
+    uint64_t fileSize = k_unGazeRecordingHeaderSize;
+    if (chunkCount > 0) {
+      const GazeRecordingChunk_t &lastChunk = m_pHeader->chunks[chunkCount - 1];
+      fileSize = lastChunk.fileOffset + static_cast<uint64_t>(lastChunk.frameCount) * sizeof(GazeRecordingFrame_t);
+    }
+
+    FlushRegion(m_pHeader, k_unGazeRecordingHeaderSize);
+    UnmapRegion(m_pHeader, k_unGazeRecordingHeaderSize);
+    m_pHeader = nullptr;
+
+    // Drop the preallocated but unused end of the last chunk, now that nothing maps it anymore.
+    CloseRecordingFile(fileSize);
+
+    Util::DriverLog("[GAZE_RECORDER] Stopped recording to {}. Frames = {}, Dropped = {}", m_path, frameCount, droppedFrameCount);
+  }
+
+  void GazeRecorder::RetireFullChunk() {
+    GazeRecordingFrame_t *pFullChunk = m_pFullChunk.load(std::memory_order_acquire);
+    if (!pFullChunk) {
+      return;
+    }
+
+    RetireChunk(pFullChunk, m_fullChunkFrameCount.load(std::memory_order_relaxed));
+    m_pFullChunk.store(nullptr, std::memory_order_release);
+
+    MapNextChunk();
+  }
+
+  void GazeRecorder::MapNextChunk() {
+    if (m_mappedChunkCount == k_unGazeRecordingMaxChunks) {
+      Util::DriverLog("[GAZE_RECORDER] {} reached its size limit, frames are dropped from now on.", m_path);
+      return;
+    }
+
+    uint64_t offset = k_unGazeRecordingHeaderSize + static_cast<uint64_t>(m_mappedChunkCount) * k_unGazeRecordingChunkSize;
+    void *pChunk = MapRegion(offset, k_unGazeRecordingChunkSize);
+    if (!pChunk) {
+      return;
+    }
+
+    // Touch every page now, so the USB gaze thread never takes a page fault on a fresh chunk.
+    volatile uint8_t *pBytes = static_cast<volatile uint8_t *>(pChunk);
+    for (uint32_t i = 0; i < k_unGazeRecordingChunkSize; i += k_unPageSize) {
+      pBytes[i] = 0;
+    }
+
+    m_pHeader->chunks[m_mappedChunkCount].fileOffset = offset;
+    m_mappedChunkCount++;
+
+    m_pNextChunk.store(static_cast<GazeRecordingFrame_t *>(pChunk), std::memory_order_release);
+  }
+
+  void GazeRecorder::RetireChunk(GazeRecordingFrame_t *pChunk, uint32_t frameCount) {
+    // Chunks are handed over and retired in the order they were mapped.
+    GazeRecordingChunk_t &chunk = m_pHeader->chunks[m_retiredChunkCount++];
+    chunk.frameCount = frameCount;
+    if (frameCount > 0) {
+      chunk.firstSequence = pChunk[0].sequence;
+      chunk.firstHostTimestampUs = pChunk[0].hostTimestampUs;
+    }
+
+    UnmapRegion(pChunk, k_unGazeRecordingChunkSize);
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+#include "../shared/gaze_recording.h"
+#include "../shared/ipc_protocol.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <openvr_driver.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace psvr2_toolkit {
+
+  // Records the raw and calibrated gaze states of every sample into a chunked, memory-mapped file.
+  // A writer thread creates, maps and prefaults the next chunk ahead of time and retires full ones,
+  // so recording a frame on the USB gaze thread is a copy into memory that is already there.
+  // The file and wake event handling is platform specific, see gaze_recorder_win32.cpp and gaze_recorder_posix.cpp.
+  class GazeRecorder {
+  public:
+    GazeRecorder();
+
+    static GazeRecorder *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    // Both wait until the writer thread has opened or finalized the file, which takes a few milliseconds.
+    void Start();
+    void Stop();
+
+    // Stops recording and ends the writer thread, waiting for both. Called when the driver is cleaned up.
+    void Shutdown();
+
+    void GetStatus(ipc::CommandDataServerGazeRecordingStatus_t *pStatus);
+
+    // Called from the USB gaze thread, never blocks.
+    void Record(const Hmd2GazeState &rawState, uint32_t rawPacketSize, const Hmd2GazeState &calibratedState,
+                const ipc::CommandDataServerGazeDataResult2_t &gazeResult);
+
+    // Starts or stops recording when the setting is toggled.
+    static void HandleEvent(vr::VREvent_t *pEvent);
+
+    // Creates the default directory if needed. Empty if there is nowhere to record to.
+    static std::string GetRecordingDirectory();
+
+  private:
+    static constexpr uint32_t k_unFramesPerChunk = k_unGazeRecordingChunkSize / sizeof(GazeRecordingFrame_t);
+    static constexpr uint32_t k_unPageSize = 0x1000;
+
+    static_assert(sizeof(Hmd2GazeState) == k_unGazeRecordingStateSize);
+
+    static GazeRecorder *m_pInstance;
+
+    bool m_initialized;
+    bool m_settingEnabled; // Last seen value of the setting, so only a change starts or stops.
+    std::thread m_writerThread;
+    std::atomic<bool> m_shutdownRequested;
+
+    // Requests from Start and Stop, applied by the writer thread in order.
+    std::atomic<bool> m_wantRecording;
+    std::atomic<uint32_t> m_requestGeneration;
+    std::atomic<uint32_t> m_appliedGeneration;
+
+    // Shared between the USB gaze thread and the writer thread.
+    std::atomic<bool> m_recording;
+    std::atomic<bool> m_recordInProgress; // Set by the USB gaze thread for as long as it might touch the current chunk.
+    std::atomic<GazeRecordingFrame_t *> m_pNextChunk; // Mapped and prefaulted, waiting for the current chunk to fill up.
+    std::atomic<GazeRecordingFrame_t *> m_pFullChunk; // Handed back to the writer thread to be retired.
+    std::atomic<uint32_t> m_fullChunkFrameCount;
+    std::atomic<uint64_t> m_frameCount;
+    std::atomic<uint32_t> m_droppedFrameCount;
+
+    // Only touched by the USB gaze thread while recording, and by the writer thread otherwise.
+    GazeRecordingFrame_t *m_pCurrentChunk;
+    uint32_t m_currentChunkFrameCount;
+
+    // Only touched by the writer thread. The file is open whenever the header is mapped.
+#ifdef _WIN32
+    HANDLE m_hFile;
+#else
+    int m_file;
+#endif
+    GazeRecordingHeader_t *m_pHeader;
+    uint32_t m_mappedChunkCount; // Chunks mapped so far, including the current and next one.
+    uint32_t m_retiredChunkCount;
+    std::string m_path;
+
+    uint32_t Request(bool record);
+    void WaitForRequest(uint32_t generation);
+    void WriterLoop();
+
+    bool Open();
+    void Close();
+    void RetireFullChunk();
+    void MapNextChunk();
+    void RetireChunk(GazeRecordingFrame_t *pChunk, uint32_t frameCount);
+
+    // Platform specific.
+#ifdef _WIN32
+    HANDLE m_hWakeEvent;
+#else
+    int m_wakeEvent;
+#endif
+
+    bool CreateWakeEvent();
+    void DestroyWakeEvent();
+    void SignalWake(); // Never blocks.
+    void WaitForWake();
+
+    // Creates a new file named after the current time in the recording directory, and sets m_path.
+    bool CreateRecordingFile();
+    // Cuts the file down to fileSize and closes it.
+    void CloseRecordingFile(uint64_t fileSize);
+    // For a recording that failed to start, closes and removes the file.
+    void DeleteRecordingFile();
+
+    // Mapping past the end of the file grows it. Logs and returns nullptr on failure.
+    void *MapRegion(uint64_t offset, uint32_t size);
+    void UnmapRegion(void *pView, uint32_t size);
+    void FlushRegion(void *pView, uint32_t size);
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,129 @@
+#include "gaze_recorder.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <ctime>
+
+// Only built with the tests and benchmarks, the driver itself uses gaze_recorder_win32.cpp.
+
+namespace psvr2_toolkit {
+
+  bool GazeRecorder::CreateWakeEvent() {
+    // Reading an eventfd resets it, like the auto-reset event on Windows.
+    m_wakeEvent = eventfd(0, EFD_CLOEXEC);
+    if (m_wakeEvent == -1) {
+      Util::DriverLog("[GAZE_RECORDER] Creating wake event failed. errno = {}", errno);
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeRecorder::DestroyWakeEvent() {
+    close(m_wakeEvent);
+    m_wakeEvent = -1;
+  }
+
+  void GazeRecorder::SignalWake() {
+    uint64_t value = 1;
+    ssize_t result = write(m_wakeEvent, &value, sizeof(value));
+    (void)result; // Only fails if the counter is about to overflow, and then a wake is pending anyway.
+  }
+
+  void GazeRecorder::WaitForWake() {
+    uint64_t value;
+    while (read(m_wakeEvent, &value, sizeof(value)) == -1 && errno == EINTR) {}
+  }
+
+  bool GazeRecorder::CreateRecordingFile() {
+    std::string directory = GetRecordingDirectory();
+    if (directory.empty()) {
+      Util::DriverLog("[GAZE_RECORDER] No directory to record to.");
+      return false;
+    }
+
+    time_t now = time(nullptr);
+    tm localTime;
+    localtime_r(&now, &localTime);
+    char pchName[64];
+    strftime(pchName, sizeof(pchName), "/gaze_%Y%m%d_%H%M%S" GAZE_RECORDING_FILE_EXTENSION, &localTime);
+    m_path = directory + pchName;
+
+    m_file = open(m_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (m_file == -1) {
+      Util::DriverLog("[GAZE_RECORDER] Creating {} failed. errno = {}", m_path, errno);
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeRecorder::CloseRecordingFile(uint64_t fileSize) {
+    if (ftruncate(m_file, static_cast<off_t>(fileSize)) == -1) {
+      Util::DriverLog("[GAZE_RECORDER] Truncating {} failed. errno = {}", m_path, errno);
+    }
+
+    close(m_file);
+    m_file = -1;
+  }
+
+  void GazeRecorder::DeleteRecordingFile() {
+    close(m_file);
+    m_file = -1;
+    unlink(m_path.c_str());
+  }
+
+  void *GazeRecorder::MapRegion(uint64_t offset, uint32_t size) {
+    // Unlike a Windows file mapping, mmap doesn't grow the file.
+    struct stat fileStat;
+    uint64_t end = offset + size;
+    if (fstat(m_file, &fileStat) == -1 || (static_cast<uint64_t>(fileStat.st_size) < end && ftruncate(m_file, static_cast<off_t>(end)) == -1)) {
+      Util::DriverLog("[GAZE_RECORDER] Growing {} to {} bytes failed. errno = {}", m_path, end, errno);
+      return nullptr;
+    }
+
+    void *pView = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, static_cast<off_t>(offset));
+    if (pView == MAP_FAILED) {
+      Util::DriverLog("[GAZE_RECORDER] Mapping {} bytes at {} of {} failed. errno = {}", size, offset, m_path, errno);
+      return nullptr;
+    }
+
+    return pView;
+  }
+
+  void GazeRecorder::UnmapRegion(void *pView, uint32_t size) {
+    munmap(pView, size);
+  }
+
+  void GazeRecorder::FlushRegion(void *pView, uint32_t size) {
+    msync(pView, size, MS_ASYNC);
+  }
+
+  std::string GazeRecorder::GetRecordingDirectory() {
+    std::string directory = VRSettings::GetString(STEAMVR_SETTINGS_GAZE_RECORDING_DIRECTORY, SETTING_GAZE_RECORDING_DIRECTORY_DEFAULT_VALUE);
+    if (!directory.empty()) {
+      return directory;
+    }
+
+    const char *pchHome = getenv("HOME");
+    if (!pchHome || !*pchHome) {
+      return {};
+    }
+
+    directory = std::string(pchHome) + "/.local/share/PSVR2Toolkit";
+    mkdir(directory.c_str(), 0755);
+    directory += "/GazeRecordings";
+    mkdir(directory.c_str(), 0755);
+    return directory;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,114 @@
+#include "gaze_recorder.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+#include <format>
+
+namespace psvr2_toolkit {
+
+  bool GazeRecorder::CreateWakeEvent() {
+    m_hWakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_hWakeEvent) {
+      Util::DriverLog("[GAZE_RECORDER] Creating wake event failed. LastError = {}", GetLastError());
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeRecorder::DestroyWakeEvent() {
+    CloseHandle(m_hWakeEvent);
+    m_hWakeEvent = nullptr;
+  }
+
+  void GazeRecorder::SignalWake() {
+    SetEvent(m_hWakeEvent);
+  }
+
+  void GazeRecorder::WaitForWake() {
+    WaitForSingleObject(m_hWakeEvent, INFINITE);
+  }
+
+  bool GazeRecorder::CreateRecordingFile() {
+    std::string directory = GetRecordingDirectory();
+    if (directory.empty()) {
+      Util::DriverLog("[GAZE_RECORDER] No directory to record to.");
+      return false;
+    }
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    m_path = std::format("{}\\gaze_{:04}{:02}{:02}_{:02}{:02}{:02}{}", directory,
+                         time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, GAZE_RECORDING_FILE_EXTENSION);
+
+    HANDLE hFile = CreateFileA(m_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+      Util::DriverLog("[GAZE_RECORDER] Creating {} failed. LastError = {}", m_path, GetLastError());
+      return false;
+    }
+
+    m_hFile = hFile;
+    return true;
+  }
+
+  void GazeRecorder::CloseRecordingFile(uint64_t fileSize) {
+    LARGE_INTEGER size;
+    size.QuadPart = fileSize;
+    if (!SetFilePointerEx(m_hFile, size, nullptr, FILE_BEGIN) || !SetEndOfFile(m_hFile)) {
+      Util::DriverLog("[GAZE_RECORDER] Truncating {} failed. LastError = {}", m_path, GetLastError());
+    }
+
+    CloseHandle(m_hFile);
+    m_hFile = nullptr;
+  }
+
+  void GazeRecorder::DeleteRecordingFile() {
+    CloseHandle(m_hFile);
+    m_hFile = nullptr;
+    DeleteFileA(m_path.c_str());
+  }
+
+  void *GazeRecorder::MapRegion(uint64_t offset, uint32_t size) {
+    // Mapping past the end grows the file, the view keeps the mapping alive after its handle is closed.
+    uint64_t end = offset + size;
+    HANDLE hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READWRITE, static_cast<DWORD>(end >> 32), static_cast<DWORD>(end), nullptr);
+    void *pView = hMapping ? MapViewOfFile(hMapping, FILE_MAP_WRITE, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), size) : nullptr;
+    if (!pView) {
+      Util::DriverLog("[GAZE_RECORDER] Mapping {} bytes at {} of {} failed. LastError = {}", size, offset, m_path, GetLastError());
+    }
+
+    if (hMapping) {
+      CloseHandle(hMapping);
+    }
+    return pView;
+  }
+
+  void GazeRecorder::UnmapRegion(void *pView, uint32_t) {
+    UnmapViewOfFile(pView);
+  }
+
+  void GazeRecorder::FlushRegion(void *pView, uint32_t) {
+    FlushViewOfFile(pView, 0);
+  }
+
+  std::string GazeRecorder::GetRecordingDirectory() {
+    std::string directory = VRSettings::GetString(STEAMVR_SETTINGS_GAZE_RECORDING_DIRECTORY, SETTING_GAZE_RECORDING_DIRECTORY_DEFAULT_VALUE);
+    if (!directory.empty()) {
+      return directory;
+    }
+
+    char localAppData[MAX_PATH];
+    DWORD length = GetEnvironmentVariableA("LOCALAPPDATA", localAppData, sizeof(localAppData));
+    if (length == 0 || length >= sizeof(localAppData)) {
+      return {};
+    }
+
+    directory = std::string(localAppData) + "\\PSVR2Toolkit";
+    CreateDirectoryA(directory.c_str(), nullptr);
+    directory += "\\GazeRecordings";
+    CreateDirectoryA(directory.c_str(), nullptr);
+    return directory;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,233 @@
+#include "gaze_replay.h"
+
+#include "gaze_pipeline.h"
+#include "gaze_recorder.h"
+#include "hmd2_gaze.h"
+#include "util.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeReplay *GazeReplay::m_pInstance = nullptr;
+
+  GazeReplay::GazeReplay()
+    : m_initialized(false)
+    , m_replaying(false)
+    , m_stopRequested(false)
+    , m_frameCount(0)
+    , m_replayedFrameCount(0)
+    , m_processingTimeUs(0)
+    , m_pView(nullptr)
+    , m_fileSize(0)
+    , m_asFastAsPossible(false)
+#ifdef _WIN32
+    , m_hStopEvent(nullptr)
+    , m_hFile(nullptr)
+#else
+    , m_stopEvent(-1)
+    , m_file(-1)
+#endif
+  {}
+
+  GazeReplay *GazeReplay::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeReplay;
+    }
+
+    return m_pInstance;
+  }
+
+  bool GazeReplay::Initialized() {
+    return m_initialized;
+  }
+
+  void GazeReplay::Initialize() {
+    if (m_initialized) {
+      return;
+    }
+
+    if (VRSettings::GetBool(STEAMVR_SETTINGS_DISABLE_GAZE, SETTING_DISABLE_GAZE_DEFAULT_VALUE)) {
+      return;
+    }
+
+    if (!CreateStopEvent()) {
+      return;
+    }
+
+    m_initialized = true;
+  }
+
+  bool GazeReplay::Start(const std::string &path, bool asFastAsPossible) {
+    if (!m_initialized || !GazePipeline::Instance()->Initialized()) {
+      return false;
+    }
+
+    Stop();
+
+    // A bare file name is one of our own recordings.
+    std::string resolvedPath = path;
+    if (path.find_first_of("\\/") == std::string::npos) {
+      resolvedPath = GetRecordingPath(path);
+    }
+
+    if (!Open(resolvedPath)) {
+      return false;
+    }
+    m_asFastAsPossible = asFastAsPossible;
+
+    uint64_t frameCount = 0;
+    for (uint32_t chunkIndex = 0; ; chunkIndex++) {
+      uint32_t chunkFrameCount = GetChunkFrameCount(chunkIndex);
+      if (chunkFrameCount == 0) {
+        break;
+      }
+      frameCount += chunkFrameCount;
+    }
+
+    m_frameCount = frameCount;
+    m_replayedFrameCount = 0;
+    m_processingTimeUs = 0;
+    m_stopRequested = false;
+    ResetStopEvent();
+
+    m_replaying = true;
+    m_replayThread = std::thread(&GazeReplay::ReplayLoop, this);
+    return true;
+  }
+
+  void GazeReplay::Stop() {
+    if (!m_initialized) {
+      return;
+    }
+
+    m_stopRequested = true;
+    SignalStop();
+
+    // Also reaps a replay that already ran to its end.
+    if (m_replayThread.joinable()) {
+      m_replayThread.join();
+    }
+  }
+
+  void GazeReplay::GetStatus(CommandDataServerGazeReplayStatus_t *pStatus) {
+    *pStatus = {};
+    pStatus->isReplaying = m_replaying.load(std::memory_order_relaxed);
+    pStatus->frameCount = m_frameCount.load(std::memory_order_relaxed);
+    pStatus->replayedFrameCount = m_replayedFrameCount.load(std::memory_order_relaxed);
+    pStatus->processingTimeUs = m_processingTimeUs.load(std::memory_order_relaxed);
+  }
+
+  void GazeReplay::ReplayLoop() {
+    static GazePipeline *pGazePipeline = GazePipeline::Instance();
+
+    Util::DriverLog("[GAZE_REPLAY] Replaying {} frames from {}", m_frameCount.load(), m_path);
+
+    pGazePipeline->BeginReplay();
+
+    int64_t replayStartUs = Util::GetHostTimestamp();
+    int64_t firstFrameUs = 0;
+    uint64_t replayedFrameCount = 0;
+    uint64_t processingTimeUs = 0;
+
+    for (uint32_t chunkIndex = 0; !m_stopRequested.load(std::memory_order_relaxed); chunkIndex++) {
+      uint32_t chunkFrameCount = GetChunkFrameCount(chunkIndex);
+      if (chunkFrameCount == 0) {
+        break;
+      }
+
+      const GazeRecordingFrame_t *pFrames = GetChunkFrames(chunkIndex);
+      for (uint32_t i = 0; i < chunkFrameCount && !m_stopRequested.load(std::memory_order_relaxed); i++) {
+        const GazeRecordingFrame_t &frame = pFrames[i];
+        if (replayedFrameCount == 0) {
+          firstFrameUs = frame.hostTimestampUs;
+        }
+
+        int64_t hostTimestampUs = replayStartUs + (frame.hostTimestampUs - firstFrameUs);
+        if (!m_asFastAsPossible) {
+          int64_t waitUs = hostTimestampUs - Util::GetHostTimestamp();
+          if (waitUs > 0 && WaitForStop(waitUs)) {
+            break;
+          }
+        }
+
+        // Copied out, so nothing downstream ever holds on to the mapped file.
+        Hmd2GazeState rawState;
+        memcpy(&rawState, frame.rawState, sizeof(rawState));
+
+        int64_t processStartUs = Util::GetHostTimestamp();
+        pGazePipeline->ProcessReplay(rawState, frame.rawPacketSize, frame.hmdTimestampUs, hostTimestampUs);
+        processingTimeUs += Util::GetHostTimestamp() - processStartUs;
+
+        m_replayedFrameCount.store(++replayedFrameCount, std::memory_order_relaxed);
+        m_processingTimeUs.store(processingTimeUs, std::memory_order_relaxed);
+      }
+    }
+
+    pGazePipeline->EndReplay();
+    Close();
+
+    Util::DriverLog("[GAZE_REPLAY] Replayed {} frames, {} us spent in the pipeline.", replayedFrameCount, processingTimeUs);
+    m_replaying = false;
+  }
+
+  bool GazeReplay::Open(const std::string &path) {
+    m_path = path;
+
+    if (!MapRecording(path)) {
+      return false;
+    }
+
+    const GazeRecordingHeader_t *pHeader = reinterpret_cast<const GazeRecordingHeader_t *>(m_pView);
+    if (pHeader->magic != k_unGazeRecordingMagic ||
+        pHeader->version != k_unGazeRecordingVersion ||
+        pHeader->headerSize != k_unGazeRecordingHeaderSize ||
+        pHeader->chunkSize != k_unGazeRecordingChunkSize ||
+        pHeader->frameSize != sizeof(GazeRecordingFrame_t) ||
+        pHeader->stateSize != k_unGazeRecordingStateSize)
+    {
+      Util::DriverLog("[GAZE_REPLAY] {} is not a gaze recording this version can replay.", path);
+      UnmapRecording();
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeReplay::Close() {
+    UnmapRecording();
+  }
+
+  uint32_t GazeReplay::GetChunkFrameCount(uint32_t chunkIndex) {
+    const GazeRecordingHeader_t *pHeader = reinterpret_cast<const GazeRecordingHeader_t *>(m_pView);
+
+    uint64_t offset = k_unGazeRecordingHeaderSize + static_cast<uint64_t>(chunkIndex) * k_unGazeRecordingChunkSize;
+    if (chunkIndex >= k_unGazeRecordingMaxChunks || offset >= m_fileSize) {
+      return 0;
+    }
+
+    // Never trust the header past the end of the file.
+    uint32_t maxFrameCount = static_cast<uint32_t>((std::min<uint64_t>)(k_unGazeRecordingChunkSize, m_fileSize - offset) / sizeof(GazeRecordingFrame_t));
+
+    if (pHeader->isComplete) {
+      return chunkIndex < pHeader->chunkCount ? (std::min)(pHeader->chunks[chunkIndex].frameCount, maxFrameCount) : 0;
+    }
+
+    // A recording that wasn't stopped cleanly ends at the first frame that was never written.
+    const GazeRecordingFrame_t *pFrames = GetChunkFrames(chunkIndex);
+    uint32_t frameCount = 0;
+    while (frameCount < maxFrameCount && pFrames[frameCount].sequence != 0) {
+      frameCount++;
+    }
+    return frameCount;
+  }
+
+  const GazeRecordingFrame_t *GazeReplay::GetChunkFrames(uint32_t chunkIndex) {
+    return reinterpret_cast<const GazeRecordingFrame_t *>(m_pView + k_unGazeRecordingHeaderSize + static_cast<uint64_t>(chunkIndex) * k_unGazeRecordingChunkSize);
+  }
+
+} // psvr2_toolkit
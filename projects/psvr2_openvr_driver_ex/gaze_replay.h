@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../shared/gaze_recording.h"
+#include "../shared/ipc_protocol.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace psvr2_toolkit {
+
+  // Feeds a gaze recording through the gaze pipeline, in place of the headset.
+  // Frames are replayed at their recorded pace or as fast as possible. Either way their timestamps keep the recorded spacing,
+  // shifted to the start of the replay, so everything downstream behaves the same on every run.
+  class GazeReplay {
+  public:
+    GazeReplay();
+
+    static GazeReplay *Instance();
+
+    bool Initialized();
+    void Initialize();
+
+    // Stops a replay that is already running first. Returns false if the recording can't be opened.
+    bool Start(const std::string &path, bool asFastAsPossible);
+    void Stop();
+
+    void GetStatus(ipc::CommandDataServerGazeReplayStatus_t *pStatus);
+
+  private:
+    static GazeReplay *m_pInstance;
+
+    bool m_initialized;
+    std::thread m_replayThread;
+
+    std::atomic<bool> m_replaying;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<uint64_t> m_frameCount;
+    std::atomic<uint64_t> m_replayedFrameCount;
+    std::atomic<uint64_t> m_processingTimeUs;
+
+    // Set up by Start, then only touched by the replay thread.
+    const uint8_t *m_pView;
+    uint64_t m_fileSize;
+    bool m_asFastAsPossible;
+    std::string m_path;
+
+    void ReplayLoop();
+
+    bool Open(const std::string &path);
+    void Close();
+
+    // Frames in the given chunk, or 0 past the last one.
+    uint32_t GetChunkFrameCount(uint32_t chunkIndex);
+    const GazeRecordingFrame_t *GetChunkFrames(uint32_t chunkIndex);
+
+    // Platform specific, in gaze_replay_win32.cpp and gaze_replay_posix.cpp.
+#ifdef _WIN32
+    HANDLE m_hStopEvent;
+    HANDLE m_hFile;
+#else
+    int m_stopEvent;
+    int m_file;
+#endif
+
+    // The stop event stays set until reset.
+    bool CreateStopEvent();
+    void ResetStopEvent();
+    void SignalStop();
+    // Returns true if stopped before the timeout.
+    bool WaitForStop(int64_t timeoutUs);
+
+    // Maps the whole file read only into m_pView and m_fileSize, logs its own failures.
+    // Fails for a file too small to hold a recording header.
+    bool MapRecording(const std::string &path);
+    void UnmapRecording();
+
+    // Path of a recording in the recording directory.
+    static std::string GetRecordingPath(const std::string &fileName);
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,84 @@
+#include "gaze_replay.h"
+
+#include "gaze_recorder.h"
+#include "util.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// Only built with the tests and benchmarks, the driver itself uses gaze_replay_win32.cpp.
+
+namespace psvr2_toolkit {
+
+  bool GazeReplay::CreateStopEvent() {
+    // Only ever polled, never read, so it stays set like the manual reset event on Windows.
+    m_stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stopEvent == -1) {
+      Util::DriverLog("[GAZE_REPLAY] Creating stop event failed. errno = {}", errno);
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeReplay::ResetStopEvent() {
+    uint64_t value;
+    ssize_t result = read(m_stopEvent, &value, sizeof(value));
+    (void)result; // Fails with EAGAIN if it wasn't set.
+  }
+
+  void GazeReplay::SignalStop() {
+    uint64_t value = 1;
+    ssize_t result = write(m_stopEvent, &value, sizeof(value));
+    (void)result; // Only fails if the counter is about to overflow, and then it's set anyway.
+  }
+
+  bool GazeReplay::WaitForStop(int64_t timeoutUs) {
+    pollfd pollFd = { m_stopEvent, POLLIN, 0 };
+    return poll(&pollFd, 1, static_cast<int>(timeoutUs / 1000)) > 0;
+  }
+
+  bool GazeReplay::MapRecording(const std::string &path) {
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file == -1) {
+      Util::DriverLog("[GAZE_REPLAY] Opening {} failed. errno = {}", path, errno);
+      return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) == -1 || static_cast<uint64_t>(fileStat.st_size) < k_unGazeRecordingHeaderSize) {
+      Util::DriverLog("[GAZE_REPLAY] {} is not a gaze recording.", path);
+      close(file);
+      return false;
+    }
+
+    void *pView = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (pView == MAP_FAILED) {
+      Util::DriverLog("[GAZE_REPLAY] Mapping {} failed. errno = {}", path, errno);
+      close(file);
+      return false;
+    }
+
+    m_file = file;
+    m_pView = static_cast<const uint8_t *>(pView);
+    m_fileSize = static_cast<uint64_t>(fileStat.st_size);
+    return true;
+  }
+
+  void GazeReplay::UnmapRecording() {
+    munmap(const_cast<uint8_t *>(m_pView), static_cast<size_t>(m_fileSize));
+    m_pView = nullptr;
+    close(m_file);
+    m_file = -1;
+  }
+
+  std::string GazeReplay::GetRecordingPath(const std::string &fileName) {
+    return GazeRecorder::GetRecordingDirectory() + "/" + fileName;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,73 @@
+#include "gaze_replay.h"
+
+#include "gaze_recorder.h"
+#include "util.h"
+
+namespace psvr2_toolkit {
+
+  bool GazeReplay::CreateStopEvent() {
+    m_hStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!m_hStopEvent) {
+      Util::DriverLog("[GAZE_REPLAY] Creating stop event failed. LastError = {}", GetLastError());
+      return false;
+    }
+
+    return true;
+  }
+
+  void GazeReplay::ResetStopEvent() {
+    ResetEvent(m_hStopEvent);
+  }
+
+  void GazeReplay::SignalStop() {
+    SetEvent(m_hStopEvent);
+  }
+
+  bool GazeReplay::WaitForStop(int64_t timeoutUs) {
+    return WaitForSingleObject(m_hStopEvent, static_cast<DWORD>(timeoutUs / 1000)) == WAIT_OBJECT_0;
+  }
+
+  bool GazeReplay::MapRecording(const std::string &path) {
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+      Util::DriverLog("[GAZE_REPLAY] Opening {} failed. LastError = {}", path, GetLastError());
+      return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(hFile, &fileSize);
+    if (fileSize.QuadPart < k_unGazeRecordingHeaderSize) {
+      Util::DriverLog("[GAZE_REPLAY] {} is not a gaze recording.", path);
+      CloseHandle(hFile);
+      return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const uint8_t *pView = hMapping ? static_cast<const uint8_t *>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (hMapping) {
+      CloseHandle(hMapping);
+    }
+    if (!pView) {
+      Util::DriverLog("[GAZE_REPLAY] Mapping {} failed. LastError = {}", path, GetLastError());
+      CloseHandle(hFile);
+      return false;
+    }
+
+    m_hFile = hFile;
+    m_pView = pView;
+    m_fileSize = fileSize.QuadPart;
+    return true;
+  }
+
+  void GazeReplay::UnmapRecording() {
+    UnmapViewOfFile(m_pView);
+    m_pView = nullptr;
+    CloseHandle(m_hFile);
+    m_hFile = nullptr;
+  }
+
+  std::string GazeReplay::GetRecordingPath(const std::string &fileName) {
+    return GazeRecorder::GetRecordingDirectory() + "\\" + fileName;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,87 @@
+#include "gaze_ring_publisher.h"
+
+#include "util.h"
+#include "vr_settings.h"
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    GazeRingPublisher *GazeRingPublisher::m_pInstance = nullptr;
+
+    GazeRingPublisher::GazeRingPublisher()
+      : m_initialized(false)
+      , m_hMapping(nullptr)
+      , m_hEvents{}
+      , m_pRing(nullptr)
+      , m_writer(nullptr)
+    {}
+
+    GazeRingPublisher *GazeRingPublisher::Instance() {
+      if (!m_pInstance) {
+        m_pInstance = new GazeRingPublisher;
+      }
+
+      return m_pInstance;
+    }
+
+    bool GazeRingPublisher::Initialized() {
+      return m_initialized;
+    }
+
+    void GazeRingPublisher::Initialize() {
+      if (m_initialized) {
+        return;
+      }
+
+      if (!VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_SHARED_MEMORY, SETTING_ENABLE_GAZE_SHARED_MEMORY_DEFAULT_VALUE) ||
+          VRSettings::GetBool(STEAMVR_SETTINGS_DISABLE_GAZE, SETTING_DISABLE_GAZE_DEFAULT_VALUE))
+      {
+        return;
+      }
+
+      m_hMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(GazeRing_t), GAZE_RING_SHARED_MEMORY_NAME);
+      if (!m_hMapping) {
+        Util::DriverLog("[GAZE_RING] Creating shared memory failed. LastError = {}", GetLastError());
+        return;
+      }
+
+      m_pRing = static_cast<GazeRing_t *>(MapViewOfFile(m_hMapping, FILE_MAP_WRITE, 0, 0, sizeof(GazeRing_t)));
+      if (!m_pRing) {
+        Util::DriverLog("[GAZE_RING] Mapping shared memory failed. LastError = {}", GetLastError());
+        CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+        return;
+      }
+
+      // Manual-reset events, one per sequence parity. A reader that has consumed sequence N waits on the event of N + 1,
+      // which stays signaled until N + 2 is published. Readers should still wait with a timeout and re-check the ring.
+      m_hEvents[0] = CreateEventW(nullptr, TRUE, FALSE, GAZE_RING_EVENT_0_NAME);
+      m_hEvents[1] = CreateEventW(nullptr, TRUE, FALSE, GAZE_RING_EVENT_1_NAME);
+      if (!m_hEvents[0] || !m_hEvents[1]) {
+        Util::DriverLog("[GAZE_RING] Creating events failed. LastError = {}", GetLastError());
+      }
+
+      m_writer = GazeRingWriter(m_pRing);
+      m_writer.Initialize();
+
+      m_initialized = true;
+      Util::DriverLog("[GAZE_RING] Publishing gaze samples to shared memory.");
+    }
+
+    void GazeRingPublisher::Publish(const CommandDataServerGazeDataResult2_t &gazeResult) {
+      if (!m_initialized) {
+        return;
+      }
+
+      m_writer.Publish(gazeResult);
+
+      uint64_t sequence = gazeResult.sequence;
+
+      if (m_hEvents[0] && m_hEvents[1]) {
+        ResetEvent(m_hEvents[(sequence + 1) & 1]);
+        SetEvent(m_hEvents[sequence & 1]);
+      }
+    }
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../shared/gaze_ring.h"
+
+#include <windows.h>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    // Opt-in shared memory transport, publishes every calibrated gaze sample into a named ring buffer.
+    class GazeRingPublisher {
+    public:
+      GazeRingPublisher();
+
+      static GazeRingPublisher *Instance();
+
+      bool Initialized();
+      void Initialize();
+
+      // Called from the USB gaze thread, never blocks.
+      void Publish(const CommandDataServerGazeDataResult2_t &gazeResult);
+
+    private:
+      static GazeRingPublisher *m_pInstance;
+
+      bool m_initialized;
+      HANDLE m_hMapping;
+      HANDLE m_hEvents[2];
+      GazeRing_t *m_pRing;
+      GazeRingWriter m_writer;
+    };
+
+  } // ipc
+} // psvr2_toolkit
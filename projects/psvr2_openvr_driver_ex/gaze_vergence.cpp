@@ -0,0 +1,168 @@
+#include "gaze_vergence.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  GazeVergence *GazeVergence::m_pInstance = nullptr;
+
+  GazeVergence::GazeVergence()
+    : m_diopterFilter()
+    , m_hasSmoothedDepth(false)
+    , m_smoothedDepthMm(0.0f)
+    , m_lastSmoothedTimestampUs(0)
+  {
+    // Follows a change of fixation depth within a few hundred milliseconds, while holding a steady fixation still.
+    m_diopterFilter.Configure(0.5f, 0.5f, 1.0f);
+  }
+
+  GazeVergence *GazeVergence::Instance() {
+    if (!m_pInstance) {
+      m_pInstance = new GazeVergence;
+    }
+
+    return m_pInstance;
+  }
+
+  void GazeVergence::Update(const CommandDataServerGazeDataResult2_t &gazeResult) {
+    const GazeEyeResult &left = gazeResult.leftEye;
+    const GazeEyeResult &right = gazeResult.rightEye;
+
+    CommandDataServerGazeVergenceResult_t result = {};
+    result.sequence = gazeResult.sequence;
+    result.hostTimestampUs = gazeResult.hostTimestampUs;
+
+    // A smoothed depth that hasn't been confirmed for a while is stale.
+    if (m_hasSmoothedDepth && gazeResult.hostTimestampUs - m_lastSmoothedTimestampUs > k_maxSampleGapUs) {
+      m_hasSmoothedDepth = false;
+    }
+
+    bool isLeftValid = left.isGazeOriginValid && left.isGazeDirValid && !(left.isBlinkValid && left.blink);
+    bool isRightValid = right.isGazeOriginValid && right.isGazeDirValid && !(right.isBlinkValid && right.blink);
+    if (!isLeftValid || !isRightValid) {
+      m_result.Write(result);
+      return;
+    }
+
+    float leftOrigin[3] = { left.gazeOriginMm.x, left.gazeOriginMm.y, left.gazeOriginMm.z };
+    float leftDirection[3] = { left.gazeDirNorm.x, left.gazeDirNorm.y, left.gazeDirNorm.z };
+    float rightOrigin[3] = { right.gazeOriginMm.x, right.gazeOriginMm.y, right.gazeOriginMm.z };
+    float rightDirection[3] = { right.gazeDirNorm.x, right.gazeDirNorm.y, right.gazeDirNorm.z };
+
+    float cyclopean[3];
+    for (int i = 0; i < 3; i++) {
+      cyclopean[i] = (leftOrigin[i] + rightOrigin[i]) * 0.5f;
+    }
+
+    RayApproach_t approach;
+    bool isConverging = Approach(leftOrigin, leftDirection, rightOrigin, rightDirection, &approach) &&
+      approach.leftDistanceMm > 0.0f && approach.rightDistanceMm > 0.0f;
+
+    float direction[3];
+    float depthMm = k_maxDepthMm;
+    float angleError;
+    if (isConverging) {
+      float toPoint[3];
+      for (int i = 0; i < 3; i++) {
+        toPoint[i] = approach.pointMm[i] - cyclopean[i];
+      }
+      float distance = std::sqrt(toPoint[0] * toPoint[0] + toPoint[1] * toPoint[1] + toPoint[2] * toPoint[2]);
+      for (int i = 0; i < 3; i++) {
+        direction[i] = toPoint[i] / distance;
+      }
+
+      depthMm = (std::min)(distance, k_maxDepthMm);
+      angleError = approach.gapMm / distance;
+      result.vergenceAngleDeg = std::asin((std::min)(approach.sinAngle, 1.0f)) * (180.0f / 3.14159265f);
+    } else {
+      // Parallel or diverging rays are a fixation too far away to measure, at least the rays should have been parallel.
+      float sum[3] = { leftDirection[0] + rightDirection[0], leftDirection[1] + rightDirection[1], leftDirection[2] + rightDirection[2] };
+      float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+      if (length <= 0.0f) {
+        m_result.Write(result);
+        return;
+      }
+      for (int i = 0; i < 3; i++) {
+        direction[i] = sum[i] / length;
+      }
+
+      angleError = approach.sinAngle;
+      result.vergenceAngleDeg = -std::asin((std::min)(approach.sinAngle, 1.0f)) * (180.0f / 3.14159265f);
+    }
+
+    float relativeError = angleError / k_gapAngleScale;
+    result.isValid = true;
+    result.confidence = 1.0f / (1.0f + relativeError * relativeError);
+    result.rawFixationDepthMm = depthMm;
+    result.rayGapMm = isConverging ? approach.gapMm : 0.0f;
+
+    if (result.confidence >= k_minSmoothingConfidence) {
+      int64_t dtUs = gazeResult.hostTimestampUs - m_lastSmoothedTimestampUs;
+      if (!m_hasSmoothedDepth || dtUs <= 0) {
+        m_diopterFilter.Reset();
+        dtUs = 1;
+      }
+
+      float diopters[1] = { 1000.0f / depthMm };
+      m_diopterFilter.Filter(diopters, dtUs / 1e6f);
+
+      m_hasSmoothedDepth = true;
+      m_smoothedDepthMm = 1000.0f / (std::max)(diopters[0], 1000.0f / k_maxDepthMm);
+      m_lastSmoothedTimestampUs = gazeResult.hostTimestampUs;
+    }
+
+    result.fixationDepthMm = m_hasSmoothedDepth ? m_smoothedDepthMm : depthMm;
+    result.fixationPointMm = {
+      cyclopean[0] + direction[0] * result.fixationDepthMm,
+      cyclopean[1] + direction[1] * result.fixationDepthMm,
+      cyclopean[2] + direction[2] * result.fixationDepthMm,
+    };
+
+    m_result.Write(result);
+  }
+
+  void GazeVergence::GetResult(CommandDataServerGazeVergenceResult_t *pResult) const {
+    if (!m_result.Read(*pResult)) {
+      *pResult = {};
+    }
+  }
+
+  bool GazeVergence::Approach(const float (&leftOrigin)[3], const float (&leftDirection)[3],
+                              const float (&rightOrigin)[3], const float (&rightDirection)[3], RayApproach_t *pApproach) {
+    float offset[3];
+    float cross[3];
+    for (int i = 0; i < 3; i++) {
+      offset[i] = leftOrigin[i] - rightOrigin[i];
+    }
+    cross[0] = leftDirection[1] * rightDirection[2] - leftDirection[2] * rightDirection[1];
+    cross[1] = leftDirection[2] * rightDirection[0] - leftDirection[0] * rightDirection[2];
+    cross[2] = leftDirection[0] * rightDirection[1] - leftDirection[1] * rightDirection[0];
+
+    float cosAngle = leftDirection[0] * rightDirection[0] + leftDirection[1] * rightDirection[1] + leftDirection[2] * rightDirection[2];
+    float leftOffset = leftDirection[0] * offset[0] + leftDirection[1] * offset[1] + leftDirection[2] * offset[2];
+    float rightOffset = rightDirection[0] * offset[0] + rightDirection[1] * offset[1] + rightDirection[2] * offset[2];
+
+    // |a x b|^2 rather than 1 - (a . b)^2, which loses all precision for nearly parallel rays.
+    float sinAngleSquared = cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2];
+    float denominator = (std::max)(sinAngleSquared, k_minSinAngle * k_minSinAngle);
+
+    pApproach->leftDistanceMm = (cosAngle * rightOffset - leftOffset) / denominator;
+    pApproach->rightDistanceMm = (rightOffset - cosAngle * leftOffset) / denominator;
+
+    float gapSquared = 0.0f;
+    for (int i = 0; i < 3; i++) {
+      float leftPoint = leftOrigin[i] + pApproach->leftDistanceMm * leftDirection[i];
+      float rightPoint = rightOrigin[i] + pApproach->rightDistanceMm * rightDirection[i];
+      pApproach->pointMm[i] = (leftPoint + rightPoint) * 0.5f;
+      gapSquared += (leftPoint - rightPoint) * (leftPoint - rightPoint);
+    }
+    pApproach->gapMm = std::sqrt(gapSquared);
+    pApproach->sinAngle = std::sqrt(sinAngleSquared);
+
+    return sinAngleSquared >= k_minSinAngle * k_minSinAngle;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "one_euro_filter.h"
+#include "seqlock.h"
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Estimates where in 3D the eyes are fixating, from the point where the left and right gaze rays pass closest to each other.
+  // The depth is smoothed in diopters, where tracker noise is about even across distances, and only confident samples move it.
+  // Update is only called from the thread that owns the gaze pipeline, GetResult can be called from any thread.
+  class GazeVergence {
+  public:
+    // Closest approach of two rays, the result of Approach.
+    struct RayApproach_t {
+      float leftDistanceMm; // Along each ray to its closest point, negative if behind the eye.
+      float rightDistanceMm;
+      float pointMm[3]; // Midway between the two closest points.
+      float gapMm; // Distance between the two closest points.
+      float sinAngle; // Sine of the angle between the rays.
+    };
+
+    GazeVergence();
+
+    static GazeVergence *Instance();
+
+    void Update(const ipc::CommandDataServerGazeDataResult2_t &gazeResult);
+
+    void GetResult(ipc::CommandDataServerGazeVergenceResult_t *pResult) const;
+
+    // Plain float math on fixed-size arrays without data-dependent branches, so it vectorizes when run over many samples.
+    // Directions must be normalized. Returns false if the rays are too close to parallel for a closest point.
+    static bool Approach(const float (&leftOrigin)[3], const float (&leftDirection)[3],
+                         const float (&rightOrigin)[3], const float (&rightDirection)[3], RayApproach_t *pApproach);
+
+  private:
+    // Fixations further away than this can't be told apart by vergence, the depth is clamped to it.
+    static constexpr float k_maxDepthMm = 10000.0f;
+
+    // Rays closer to parallel than this, about 0.06 degrees, have no usable closest point.
+    static constexpr float k_minSinAngle = 1e-3f;
+
+    // Angle by which the rays may miss each other, seen from between the eyes, before confidence halves. About 1 degree.
+    static constexpr float k_gapAngleScale = 0.0175f;
+
+    // Below this confidence a sample doesn't move the smoothed depth.
+    static constexpr float k_minSmoothingConfidence = 0.3f;
+
+    // A gap longer than this restarts the smoothing.
+    static constexpr int64_t k_maxSampleGapUs = 100000;
+
+    static GazeVergence *m_pInstance;
+
+    SeqLock<ipc::CommandDataServerGazeVergenceResult_t> m_result;
+
+    // Only touched by the pipeline thread.
+    OneEuroFilter<1> m_diopterFilter;
+    bool m_hasSmoothedDepth;
+    float m_smoothedDepthMm;
+    int64_t m_lastSmoothedTimestampUs;
+  };
+
+} // psvr2_toolkit
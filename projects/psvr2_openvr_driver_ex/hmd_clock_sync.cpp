@@ -0,0 +1,250 @@
+#include "hmd_clock_sync.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace psvr2_toolkit {
+
+  HmdClockSync::HmdClockSync()
+    : m_unwrapper()
+    , m_offsetSamples{}
+    , m_offsetSampleCount(0)
+    , m_lastOffsetSampleUs(0)
+    , m_offsetStepCount(0)
+    , m_hasFit(false)
+    , m_fitReferenceUs(0)
+    , m_fitOffsetUs(0)
+    , m_fitDriftQ32(0)
+    , m_jitter{}
+    , m_lastArrivalHmdTimestampUs(0)
+    , m_statusWorking{}
+    , m_status()
+  {
+    ResetJitter();
+  }
+
+  uint64_t HmdClockSync::Unwrap(uint32_t hmdTimestamp) {
+    return m_unwrapper.Unwrap(hmdTimestamp);
+  }
+
+  bool HmdClockSync::IsOffsetSampleDue(uint64_t hmdTimestampUs) const {
+    return !m_hasFit || hmdTimestampUs < m_lastOffsetSampleUs || hmdTimestampUs - m_lastOffsetSampleUs >= k_ulOffsetSampleIntervalUs;
+  }
+
+  void HmdClockSync::AddOffsetSample(uint64_t hmdTimestampUs, int64_t hostTimestampUs) {
+    int64_t offsetUs = hostTimestampUs - static_cast<int64_t>(hmdTimestampUs);
+
+    if (m_hasFit) {
+      int64_t predictedOffsetUs = ToHost(hmdTimestampUs) - static_cast<int64_t>(hmdTimestampUs);
+
+      // The HMD driver converts the 32-bit timestamp, so a wrap it doesn't account for shows up as a step of 2^32.
+      int64_t wraps = std::llround(static_cast<double>(predictedOffsetUs - offsetUs) / 4294967296.0);
+      offsetUs += wraps * (int64_t(1) << 32);
+
+      int64_t deviationUs = std::llabs(offsetUs - predictedOffsetUs);
+      m_offsetStepCount = deviationUs > k_maxOffsetStepUs ? m_offsetStepCount + 1 : 0;
+
+      if (hmdTimestampUs < m_lastOffsetSampleUs || deviationUs > k_maxOffsetJumpUs || m_offsetStepCount >= k_unMaxOffsetStepCount) {
+        m_offsetSampleCount = 0;
+        m_offsetStepCount = 0;
+        m_hasFit = false;
+      }
+    }
+
+    m_offsetSamples[m_offsetSampleCount % k_unOffsetWindow] = { hmdTimestampUs, offsetUs };
+    m_offsetSampleCount++;
+    m_lastOffsetSampleUs = hmdTimestampUs;
+
+    Fit();
+  }
+
+  int64_t HmdClockSync::ToHost(uint64_t hmdTimestampUs) const {
+    // Arithmetic shift, so the drift term rounds towards negative infinity either side of the reference.
+    int64_t elapsedUs = static_cast<int64_t>(hmdTimestampUs - m_fitReferenceUs);
+    return static_cast<int64_t>(hmdTimestampUs) + m_fitOffsetUs + ((elapsedUs * m_fitDriftQ32) >> 32);
+  }
+
+  void HmdClockSync::AddArrival(uint64_t hmdTimestampUs, int64_t hostTimestampUs, int64_t arrivalHostTimestampUs) {
+    int64_t latencyUs = arrivalHostTimestampUs - hostTimestampUs;
+
+    m_jitter.count++;
+    m_jitter.latencySum += static_cast<double>(latencyUs);
+    m_jitter.latencySquaredSum += static_cast<double>(latencyUs) * static_cast<double>(latencyUs);
+    m_jitter.latencyMin = (std::min)(m_jitter.latencyMin, latencyUs);
+    m_jitter.latencyMax = (std::max)(m_jitter.latencyMax, latencyUs);
+
+    if (m_jitter.count > 1 && hmdTimestampUs > m_lastArrivalHmdTimestampUs) {
+      double intervalUs = static_cast<double>(hmdTimestampUs - m_lastArrivalHmdTimestampUs);
+      m_jitter.intervalCount++;
+      m_jitter.intervalSum += intervalUs;
+      m_jitter.intervalSquaredSum += intervalUs * intervalUs;
+    }
+    m_lastArrivalHmdTimestampUs = hmdTimestampUs;
+
+    if (m_jitter.count < k_unJitterWindow) {
+      return;
+    }
+
+    double latencyMean = m_jitter.latencySum / m_jitter.count;
+    double latencyVariance = m_jitter.latencySquaredSum / m_jitter.count - latencyMean * latencyMean;
+
+    m_statusWorking.jitterSampleCount = m_jitter.count;
+    m_statusWorking.latencyMeanUs = static_cast<float>(latencyMean);
+    m_statusWorking.latencyStdDevUs = static_cast<float>(std::sqrt((std::max)(latencyVariance, 0.0)));
+    m_statusWorking.latencyMinUs = static_cast<float>(m_jitter.latencyMin);
+    m_statusWorking.latencyMaxUs = static_cast<float>(m_jitter.latencyMax);
+
+    m_statusWorking.intervalMeanUs = 0.0f;
+    m_statusWorking.intervalStdDevUs = 0.0f;
+    if (m_jitter.intervalCount > 0) {
+      double intervalMean = m_jitter.intervalSum / m_jitter.intervalCount;
+      double intervalVariance = m_jitter.intervalSquaredSum / m_jitter.intervalCount - intervalMean * intervalMean;
+      m_statusWorking.intervalMeanUs = static_cast<float>(intervalMean);
+      m_statusWorking.intervalStdDevUs = static_cast<float>(std::sqrt((std::max)(intervalVariance, 0.0)));
+    }
+
+    m_status.Write(m_statusWorking);
+    ResetJitter();
+  }
+
+  void HmdClockSync::GetStatus(CommandDataServerGazeClockStatus_t *pStatus) {
+    if (!m_status.Read(*pStatus)) {
+      *pStatus = {};
+    }
+  }
+
+  void HmdClockSync::Fit() {
+    uint32_t count = (std::min)(m_offsetSampleCount, k_unOffsetWindow);
+    const OffsetSample_t &newest = m_offsetSamples[(m_offsetSampleCount - 1) % k_unOffsetWindow];
+
+    // Relative to the newest sample, so the doubles only ever hold small numbers.
+    double pX[k_unOffsetWindow] = {};
+    double pY[k_unOffsetWindow] = {};
+    double pResiduals[k_unOffsetWindow] = {};
+    double pDeviations[k_unOffsetWindow] = {};
+    bool pUsed[k_unOffsetWindow] = {};
+    for (uint32_t i = 0; i < count; i++) {
+      pX[i] = static_cast<double>(static_cast<int64_t>(m_offsetSamples[i].hmdTimestampUs - newest.hmdTimestampUs));
+      pY[i] = static_cast<double>(m_offsetSamples[i].offsetUs - newest.offsetUs);
+      pUsed[i] = true;
+    }
+
+    double intercept = 0.0;
+    double slope = 0.0;
+    if (FitLine(pX, pY, pUsed, count, &intercept, &slope)) {
+      // A fit through the outliers is pulled towards them, most of all by ones near the ends of the window, which makes the MAD
+      // too wide to reject them all at once. Rejecting and refitting until the inliers settle leaves them out.
+      for (uint32_t iteration = 0; iteration < k_unMaxFitIterations; iteration++) {
+        for (uint32_t i = 0; i < count; i++) {
+          pResiduals[i] = pY[i] - (intercept + slope * pX[i]);
+          pDeviations[i] = pResiduals[i];
+        }
+        double median = Median(pDeviations, count);
+        for (uint32_t i = 0; i < count; i++) {
+          pDeviations[i] = std::abs(pResiduals[i] - median);
+        }
+        double sigma = (std::max)(Median(pDeviations, count), k_minMadUs) * k_madToSigma;
+
+        bool pInliers[k_unOffsetWindow] = {};
+        bool isChanged = false;
+        for (uint32_t i = 0; i < count; i++) {
+          pInliers[i] = std::abs(pResiduals[i] - median) <= k_outlierThreshold * sigma;
+          isChanged = isChanged || pInliers[i] != pUsed[i];
+        }
+
+        // Keeps the last fit if too much was rejected to fit again.
+        double inlierIntercept;
+        double inlierSlope;
+        if (!FitLine(pX, pY, pInliers, count, &inlierIntercept, &inlierSlope)) {
+          break;
+        }
+
+        std::copy(pInliers, pInliers + count, pUsed);
+        intercept = inlierIntercept;
+        slope = inlierSlope;
+        if (!isChanged) {
+          break;
+        }
+      }
+
+      slope = std::clamp(slope, -k_maxDriftPpm * 1e-6, k_maxDriftPpm * 1e-6);
+    }
+
+    double residualSquaredSum = 0.0;
+    double residualMax = 0.0;
+    uint32_t inlierCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (!pUsed[i]) {
+        continue;
+      }
+
+      double residual = std::abs(pY[i] - (intercept + slope * pX[i]));
+      residualSquaredSum += residual * residual;
+      residualMax = (std::max)(residualMax, residual);
+      inlierCount++;
+    }
+
+    m_hasFit = true;
+    m_fitReferenceUs = newest.hmdTimestampUs;
+    m_fitOffsetUs = newest.offsetUs + std::llround(intercept);
+    m_fitDriftQ32 = std::llround(slope * 4294967296.0);
+
+    m_statusWorking.isSynchronized = count >= 2;
+    m_statusWorking.offsetSampleCount = inlierCount;
+    m_statusWorking.offsetUs = m_fitOffsetUs;
+    m_statusWorking.driftPpm = static_cast<float>(slope * 1e6);
+    m_statusWorking.offsetResidualRmsUs = inlierCount != 0 ? static_cast<float>(std::sqrt(residualSquaredSum / inlierCount)) : 0.0f;
+    m_statusWorking.offsetResidualMaxUs = static_cast<float>(residualMax);
+    m_status.Write(m_statusWorking);
+  }
+
+  void HmdClockSync::ResetJitter() {
+    m_jitter = {};
+    m_jitter.latencyMin = INT64_MAX;
+    m_jitter.latencyMax = INT64_MIN;
+  }
+
+  double HmdClockSync::Median(double *pValues, uint32_t count) {
+    uint32_t middle = count / 2;
+    std::nth_element(pValues, pValues + middle, pValues + count);
+    double median = pValues[middle];
+    if (count % 2 == 0) {
+      median = (median + *std::max_element(pValues, pValues + middle)) / 2.0;
+    }
+    return median;
+  }
+
+  bool HmdClockSync::FitLine(const double *pX, const double *pY, const bool *pUsed, uint32_t count, double *pIntercept, double *pSlope) {
+    uint32_t used = 0;
+    double meanX = 0.0;
+    double meanY = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (pUsed[i]) {
+        meanX += pX[i];
+        meanY += pY[i];
+        used++;
+      }
+    }
+    if (used < 2) {
+      return false;
+    }
+    meanX /= used;
+    meanY /= used;
+
+    double covariance = 0.0;
+    double variance = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (pUsed[i]) {
+        covariance += (pX[i] - meanX) * (pY[i] - meanY);
+        variance += (pX[i] - meanX) * (pX[i] - meanX);
+      }
+    }
+
+    *pSlope = variance > 0.0 ? covariance / variance : 0.0;
+    *pIntercept = meanY - *pSlope * meanX;
+    return true;
+  }
+
+} // psvr2_toolkit
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "seqlock.h"
+#include "timestamp_unwrapper.h"
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Maps HMD timestamps to host QPC time with a fitted offset and drift, instead of asking the HMD driver for its offset every sample.
+  // The HMD driver's offset is sampled a few times a second, and a line is fitted through the recent samples with outliers rejected,
+  // so a single bad offset doesn't move the conversion. Converting is integer math only.
+  // Also keeps statistics on how far the converted times are from when the samples actually arrived, to judge timestamp quality.
+  // Everything but GetStatus must be called from one thread at a time.
+  class HmdClockSync {
+  public:
+    HmdClockSync();
+
+    uint64_t Unwrap(uint32_t hmdTimestamp);
+
+    // Whether the HMD driver's offset should be sampled for this timestamp.
+    bool IsOffsetSampleDue(uint64_t hmdTimestampUs) const;
+
+    // hostTimestampUs is the HMD driver's own conversion of the same timestamp.
+    void AddOffsetSample(uint64_t hmdTimestampUs, int64_t hostTimestampUs);
+
+    int64_t ToHost(uint64_t hmdTimestampUs) const;
+
+    // arrivalHostTimestampUs is when the USB read of the sample returned.
+    void AddArrival(uint64_t hmdTimestampUs, int64_t hostTimestampUs, int64_t arrivalHostTimestampUs);
+
+    // Callable from any thread.
+    void GetStatus(ipc::CommandDataServerGazeClockStatus_t *pStatus);
+
+  private:
+    static constexpr uint64_t k_ulOffsetSampleIntervalUs = 250000;
+    static constexpr uint32_t k_unOffsetWindow = 64; // 16 seconds of offset samples.
+
+    // Samples further than this many scaled MADs from the fit are outliers.
+    static constexpr double k_outlierThreshold = 3.0;
+    static constexpr double k_madToSigma = 1.4826;
+    static constexpr double k_minMadUs = 1.0; // Offsets are whole microseconds, a MAD of zero would reject all but the median.
+    static constexpr uint32_t k_unMaxFitIterations = 4;
+
+    // An offset this far from the fit means the HMD clock was reset, e.g. by a reconnect, and the fit starts over.
+    static constexpr int64_t k_maxOffsetJumpUs = 50000;
+
+    // A smaller step, e.g. the HMD driver resynchronizing its offset, looks like a run of outliers at first.
+    // The fit would take most of the window to come round to it, so this many in a row this far off start it over too.
+    static constexpr int64_t k_maxOffsetStepUs = 1000;
+    static constexpr uint32_t k_unMaxOffsetStepCount = 4;
+
+    // Crystal drift is tens of ppm, anything beyond this is a bad fit.
+    static constexpr double k_maxDriftPpm = 1000.0;
+
+    static constexpr uint32_t k_unJitterWindow = 1024;
+
+    struct OffsetSample_t {
+      uint64_t hmdTimestampUs;
+      int64_t offsetUs; // Host minus unwrapped HMD time.
+    };
+
+    // Running sums of one jitter window, in microseconds.
+    struct JitterAccumulator_t {
+      uint32_t count;
+      double latencySum, latencySquaredSum;
+      int64_t latencyMin, latencyMax;
+      uint32_t intervalCount;
+      double intervalSum, intervalSquaredSum;
+    };
+
+    TimestampUnwrapper m_unwrapper;
+
+    OffsetSample_t m_offsetSamples[k_unOffsetWindow]; // Indexed by m_offsetSampleCount modulo the window size.
+    uint32_t m_offsetSampleCount; // Since the fit last started over.
+    uint64_t m_lastOffsetSampleUs;
+    uint32_t m_offsetStepCount; // Offset samples in a row further than k_maxOffsetStepUs from the fit.
+
+    // host = hmd + offset + (hmd - reference) * drift, with drift in units of 2^-32.
+    bool m_hasFit;
+    uint64_t m_fitReferenceUs;
+    int64_t m_fitOffsetUs;
+    int64_t m_fitDriftQ32;
+
+    JitterAccumulator_t m_jitter;
+    uint64_t m_lastArrivalHmdTimestampUs;
+
+    ipc::CommandDataServerGazeClockStatus_t m_statusWorking; // Fit and last complete jitter window, published on change.
+    SeqLock<ipc::CommandDataServerGazeClockStatus_t> m_status;
+
+    void Fit();
+    void ResetJitter();
+
+    static double Median(double *pValues, uint32_t count);
+    // Least squares line through the used points. Returns false if fewer than two points are used.
+    static bool FitLine(const double *pX, const double *pY, const bool *pUsed, uint32_t count, double *pIntercept, double *pSlope);
+  };
+
+} // psvr2_toolkit
@@ -6,6 +6,8 @@
 
 #include "hmd_device_hooks.h"
 
+#include "driver_host_proxy.h"
+#include "gaze_predictor.h"
 #include "hmd_driver_loader.h"
 #include "hook_lib.h"
 #include "vr_settings.h"
@@ -75,22 +77,7 @@ namespace psvr2_toolkit {
   void* (*CaesarManager__getInstance)();
   uint64_t(*CaesarManager__getIMUTimestampOffset)(void* thisptr, int64_t* hmdToHostOffset);
 
-  inline const int64_t GetHostTimestamp()
-  {
-      static LARGE_INTEGER frequency{};
-      if (frequency.QuadPart == 0)
-      {
-          QueryPerformanceFrequency(&frequency);
-      }
-
-      LARGE_INTEGER now;
-      QueryPerformanceCounter(&now);
-
-      return static_cast<int64_t>((static_cast<double>(now.QuadPart) /
-          static_cast<double>(frequency.QuadPart)) * 1e6);
-  }
-
-  void HmdDeviceHooks::UpdateGaze(void* pData, size_t dwSize)
+  void HmdDeviceHooks::UpdateGaze(void* pData, size_t dwSize, int64_t gazeTimestampUs)
   {
       Hmd2GazeState* pGazeState = reinterpret_cast<Hmd2GazeState*>(pData);
       vr::VREyeTrackingData_t eyeTrackingData {};
@@ -101,17 +88,31 @@ namespace psvr2_toolkit {
       eyeTrackingData.bTracked = valid;
       eyeTrackingData.bValid = valid;
 
+      static bool doPrediction = VRSettings::GetBool(STEAMVR_SETTINGS_ENABLE_GAZE_PREDICTION, SETTING_ENABLE_GAZE_PREDICTION_DEFAULT_VALUE);
+
       auto& origin = pGazeState->combined.gazeOriginMm;
-      auto& direction = pGazeState->combined.gazeDirNorm;
+      auto direction = pGazeState->combined.gazeDirNorm;
 
-      eyeTrackingData.vGazeOrigin = vr::HmdVector3_t { -origin.x / 1000.0f, origin.y / 1000.0f, -origin.z / 1000.0f };
-      eyeTrackingData.vGazeTarget = vr::HmdVector3_t { -direction.x, direction.y, -direction.z };
+      int64_t gazeTimestamp = gazeTimestampUs;
+      int64_t now = Util::GetHostTimestamp();
 
-      int64_t hmdToHostOffset;
+      // Report where the gaze will be at the next vsync instead of where it was when sampled.
+      if (doPrediction && valid) {
+        static DriverHostProxy *pDriverHostProxy = DriverHostProxy::Instance();
+        static GazePredictor *pGazePredictor = GazePredictor::Instance();
 
-      CaesarManager__getIMUTimestampOffset(CaesarManager__getInstance(), &hmdToHostOffset);
+        int64_t nextVsync = pDriverHostProxy->GetNextVsyncTimestamp();
+        ipc::CommandDataServerGazePredictionResult_t prediction;
+        if (nextVsync != 0 && pGazePredictor->Predict(nextVsync, &prediction)) {
+          direction = { prediction.gazeDirNorm.x, prediction.gazeDirNorm.y, prediction.gazeDirNorm.z };
+          gazeTimestamp = nextVsync;
+        }
+      }
+
+      eyeTrackingData.vGazeOrigin = vr::HmdVector3_t { -origin.x / 1000.0f, origin.y / 1000.0f, -origin.z / 1000.0f };
+      eyeTrackingData.vGazeTarget = vr::HmdVector3_t { -direction.x, direction.y, -direction.z };
 
-      double timeOffset = ((static_cast<int64_t>(pGazeState->combined.timestamp) + hmdToHostOffset) - GetHostTimestamp()) / 1e6;
+      double timeOffset = (gazeTimestamp - now) / 1e6;
 
       (vr::VRDriverInput())->UpdateEyeTrackingComponent(eyeTrackingComponent, &eyeTrackingData, timeOffset);
 
@@ -122,6 +123,14 @@ namespace psvr2_toolkit {
 #endif
   }
 
+  int64_t HmdDeviceHooks::HmdToHostTimestamp(uint32_t hmdTimestamp) {
+    int64_t hmdToHostOffset;
+
+    CaesarManager__getIMUTimestampOffset(CaesarManager__getInstance(), &hmdToHostOffset);
+
+    return static_cast<int64_t>(hmdTimestamp) + hmdToHostOffset;
+  }
+
   void HmdDeviceHooks::InstallHooks() {
     static HmdDriverLoader *pHmdDriverLoader = HmdDriverLoader::Instance();
 
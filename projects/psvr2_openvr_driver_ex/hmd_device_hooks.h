@@ -7,7 +7,12 @@ namespace psvr2_toolkit {
   class HmdDeviceHooks {
   public:
     static void InstallHooks();
-    static void UpdateGaze(void* pData, size_t dwSize);
+    // gazeTimestampUs is the host QPC time in microseconds the gaze state was sampled at.
+    static void UpdateGaze(void* pData, size_t dwSize, int64_t gazeTimestampUs);
+
+    // Converts an HMD timestamp to host QPC time in microseconds, using the offset tracked alongside the IMU.
+    // Too slow to call for every sample, HmdClockSync samples it instead.
+    static int64_t HmdToHostTimestamp(uint32_t hmdTimestamp);
   };
 
 } // psvr2_toolkit
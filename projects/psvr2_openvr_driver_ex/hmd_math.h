@@ -2,6 +2,8 @@
 
 #include <openvr_driver.h>
 
+#include <cmath>
+
 namespace psvr2_toolkit {
 
   class HmdMath {
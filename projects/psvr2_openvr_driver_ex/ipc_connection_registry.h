@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    // Low 16 bits are the slot index, high 16 bits the slot generation. 0 is never a valid handle.
+    typedef uint32_t ConnectionHandle_t;
+
+    static constexpr ConnectionHandle_t k_invalidConnectionHandle = 0;
+
+    // Fixed-size table of connections, keyed by a handle that goes stale as soon as its entry is removed.
+    // Add and Remove are serialized by a mutex, Find and ForEach are lock-free and can run on any thread.
+    // A stale or reused handle never resolves to the wrong entry, so handles are safe to pass between threads.
+    // The registry doesn't own the entries, whoever removes one decides when it is freed.
+    // Add scans linearly for a free slot, which is fine for the few hundred entries this is meant for.
+    template <typename T, uint32_t Capacity>
+    class ConnectionRegistry {
+    public:
+      static_assert(Capacity > 0 && Capacity <= 0xFFFF);
+
+      ConnectionRegistry()
+        : m_slots{}
+        , m_count(0)
+      {
+        for (Slot_t &slot : m_slots) {
+          slot.generation = 1;
+        }
+      }
+
+      // Returns k_invalidConnectionHandle if the registry is full.
+      ConnectionHandle_t Add(T *pEntry) {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        for (uint32_t i = 0; i < Capacity; i++) {
+          Slot_t &slot = m_slots[i];
+          if (slot.handle.load(std::memory_order_relaxed) != k_invalidConnectionHandle) {
+            continue;
+          }
+
+          ConnectionHandle_t handle = (static_cast<uint32_t>(slot.generation) << 16) | i;
+
+          // Publish the entry before the handle, Find checks the handle on both sides of loading the entry.
+          slot.pEntry.store(pEntry, std::memory_order_relaxed);
+          slot.handle.store(handle, std::memory_order_release);
+
+          m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          return handle;
+        }
+
+        return k_invalidConnectionHandle;
+      }
+
+      // Returns the removed entry, or nullptr if the handle was already stale.
+      T *Remove(ConnectionHandle_t handle) {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        Slot_t *pSlot = SlotFor(handle);
+        if (!pSlot || pSlot->handle.load(std::memory_order_relaxed) != handle) {
+          return nullptr;
+        }
+
+        T *pEntry = pSlot->pEntry.load(std::memory_order_relaxed);
+        pSlot->handle.store(k_invalidConnectionHandle, std::memory_order_release);
+        pSlot->pEntry.store(nullptr, std::memory_order_relaxed);
+
+        // Skip 0 when wrapping, so a handle can never be k_invalidConnectionHandle.
+        if (++pSlot->generation == 0) {
+          pSlot->generation = 1;
+        }
+
+        m_count.store(m_count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return pEntry;
+      }
+
+      // O(1). Returns nullptr if the handle is stale.
+      T *Find(ConnectionHandle_t handle) const {
+        const Slot_t *pSlot = SlotFor(handle);
+        if (!pSlot || pSlot->handle.load(std::memory_order_acquire) != handle) {
+          return nullptr;
+        }
+
+        T *pEntry = pSlot->pEntry.load(std::memory_order_acquire);
+        if (pSlot->handle.load(std::memory_order_acquire) != handle) {
+          return nullptr; // Removed while we were looking.
+        }
+        return pEntry;
+      }
+
+      // Entries added or removed concurrently may or may not be visited.
+      template <typename F>
+      void ForEach(F &&func) const {
+        for (const Slot_t &slot : m_slots) {
+          ConnectionHandle_t handle = slot.handle.load(std::memory_order_acquire);
+          if (handle == k_invalidConnectionHandle) {
+            continue;
+          }
+
+          T *pEntry = slot.pEntry.load(std::memory_order_acquire);
+          if (pEntry && slot.handle.load(std::memory_order_acquire) == handle) {
+            func(handle, pEntry);
+          }
+        }
+      }
+
+      uint32_t Count() const {
+        return m_count.load(std::memory_order_relaxed);
+      }
+
+      bool Empty() const {
+        return Count() == 0;
+      }
+
+    private:
+      struct Slot_t {
+        std::atomic<ConnectionHandle_t> handle; // k_invalidConnectionHandle if the slot is free.
+        std::atomic<T *> pEntry;
+        uint16_t generation; // Only touched under the mutex.
+      };
+
+      Slot_t m_slots[Capacity];
+      std::atomic<uint32_t> m_count;
+      std::mutex m_mutex;
+
+      Slot_t *SlotFor(ConnectionHandle_t handle) {
+        uint32_t index = handle & 0xFFFF;
+        return handle != k_invalidConnectionHandle && index < Capacity ? &m_slots[index] : nullptr;
+      }
+
+      const Slot_t *SlotFor(ConnectionHandle_t handle) const {
+        uint32_t index = handle & 0xFFFF;
+        return handle != k_invalidConnectionHandle && index < Capacity ? &m_slots[index] : nullptr;
+      }
+    };
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,98 @@
+#include <winsock2.h>
+
+#include "ipc_event_loop.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    static_assert(sizeof(IpcBuffer_t) == sizeof(WSABUF) &&
+                  offsetof(IpcBuffer_t, len) == offsetof(WSABUF, len) &&
+                  offsetof(IpcBuffer_t, buf) == offsetof(WSABUF, buf));
+
+    IpcEventLoop::IpcEventLoop()
+      : m_hCompletionPort(nullptr)
+    {}
+
+    bool IpcEventLoop::Create() {
+      m_hCompletionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+      return m_hCompletionPort != nullptr;
+    }
+
+    bool IpcEventLoop::Associate(IpcSocket_t socket, void *pKey) {
+      return CreateIoCompletionPort(reinterpret_cast<HANDLE>(socket), m_hCompletionPort, reinterpret_cast<ULONG_PTR>(pKey), 0) != nullptr;
+    }
+
+    bool IpcEventLoop::PostRecv(IpcSocket_t socket, IpcIoContext_t *pContext, char *pBuffer, int bufferLen) {
+      memset(&pContext->overlapped, 0, sizeof(pContext->overlapped));
+      pContext->type = IpcEvent_Recv;
+
+      WSABUF buffer = {
+        .len = static_cast<ULONG>(bufferLen),
+        .buf = pBuffer,
+      };
+      DWORD flags = 0;
+
+      // Even if the receive completes immediately, the completion is still queued to the port.
+      if (WSARecv(socket, &buffer, 1, nullptr, &flags, &pContext->overlapped, nullptr) == SOCKET_ERROR) {
+        return WSAGetLastError() == WSA_IO_PENDING;
+      }
+      return true;
+    }
+
+    bool IpcEventLoop::PostSend(IpcSocket_t socket, IpcIoContext_t *pContext, IpcBuffer_t *pBuffers, uint32_t bufferCount) {
+      memset(&pContext->overlapped, 0, sizeof(pContext->overlapped));
+      pContext->type = IpcEvent_Send;
+
+      if (WSASend(socket, reinterpret_cast<WSABUF *>(pBuffers), bufferCount, nullptr, 0, &pContext->overlapped, nullptr) == SOCKET_ERROR) {
+        return WSAGetLastError() == WSA_IO_PENDING;
+      }
+      return true;
+    }
+
+    void IpcEventLoop::Close(IpcSocket_t socket) {
+      closesocket(socket); // The completion port cancels outstanding I/O, which then completes with an error.
+    }
+
+    bool IpcEventLoop::Wake(uint32_t wakeReason, void *pData) {
+      return PostQueuedCompletionStatus(m_hCompletionPort, wakeReason, reinterpret_cast<ULONG_PTR>(pData), nullptr) != FALSE;
+    }
+
+    bool IpcEventLoop::Wait(IpcEvent_t &event) {
+      DWORD bytesTransferred = 0;
+      ULONG_PTR completionKey = 0;
+      OVERLAPPED *pOverlapped = nullptr;
+
+      BOOL result = GetQueuedCompletionStatus(m_hCompletionPort, &bytesTransferred, &completionKey, &pOverlapped, INFINITE);
+      if (!pOverlapped) {
+        if (!result) {
+          return false; // The port itself failed, no completion was dequeued.
+        }
+
+        event = {
+          .type = IpcEvent_Wake,
+          .pKey = reinterpret_cast<void *>(completionKey),
+          .pContext = nullptr,
+          .bytesTransferred = 0,
+          .wakeReason = bytesTransferred,
+          .succeeded = true,
+        };
+        return true;
+      }
+
+      IpcIoContext_t *pContext = CONTAINING_RECORD(pOverlapped, IpcIoContext_t, overlapped);
+      event = {
+        .type = pContext->type,
+        .pKey = reinterpret_cast<void *>(completionKey),
+        .pContext = pContext,
+        .bytesTransferred = bytesTransferred,
+        .wakeReason = 0,
+        .succeeded = result != FALSE,
+      };
+      return true;
+    }
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,117 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/uio.h>
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#endif
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+#ifdef _WIN32
+    typedef SOCKET IpcSocket_t;
+#else
+    typedef int IpcSocket_t;
+#endif
+
+    // Most buffers one PostSend can gather.
+    static constexpr uint32_t k_unMaxIpcBuffers = 32;
+
+    enum EIpcEventType : uint8_t {
+      IpcEvent_Recv,
+      IpcEvent_Send,
+      IpcEvent_Wake,
+    };
+
+    // One per outstanding I/O operation, must stay alive until its completion has been returned by Wait.
+    struct IpcIoContext_t {
+#ifdef _WIN32
+      OVERLAPPED overlapped;
+#else
+      // The operation still to do once the socket is ready.
+      iovec pBuffers[k_unMaxIpcBuffers];
+      uint32_t firstBuffer;
+      uint32_t bufferCount;
+      uint32_t bytesTransferred;
+#endif
+      EIpcEventType type;
+    };
+
+    // Layout-compatible with WSABUF on Windows, so this header doesn't need to pull in winsock2.h.
+    struct IpcBuffer_t {
+      unsigned long len;
+      char *buf;
+    };
+
+    struct IpcEvent_t {
+      EIpcEventType type;
+      void *pKey; // The key the socket was associated with, or the data passed to Wake.
+      IpcIoContext_t *pContext; // nullptr for wake events.
+      uint32_t bytesTransferred;
+      uint32_t wakeReason;
+      bool succeeded;
+    };
+
+    // Platform shim around a completion-based event loop.
+    // On Windows it is backed by an I/O completion port. Elsewhere, completions are emulated on top of epoll:
+    // a posted operation is tried right away and otherwise finished once the socket is ready, either way its
+    // completion is returned by Wait, as with a completion port.
+    // The loop lives as long as the process, so Wake can never race with it being closed.
+    // Only one thread may call Wait, any thread may call Wake. Associate, PostRecv, PostSend and Close must be called
+    // from the thread that calls Wait.
+    class IpcEventLoop {
+    public:
+      IpcEventLoop();
+
+      bool Create();
+
+      bool Associate(IpcSocket_t socket, void *pKey);
+
+      bool PostRecv(IpcSocket_t socket, IpcIoContext_t *pContext, char *pBuffer, int bufferLen);
+      bool PostSend(IpcSocket_t socket, IpcIoContext_t *pContext, IpcBuffer_t *pBuffers, uint32_t bufferCount);
+
+      // Closes an associated socket. Outstanding operations on it still complete, with an error.
+      void Close(IpcSocket_t socket);
+
+      // Never blocks, safe to call from the USB gaze thread.
+      bool Wake(uint32_t wakeReason, void *pData = nullptr);
+
+      // Blocks until an I/O operation completes or a wake is posted. Returns false if the loop is broken.
+      bool Wait(IpcEvent_t &event);
+
+    private:
+#ifdef _WIN32
+      HANDLE m_hCompletionPort;
+#else
+      struct Socket_t {
+        IpcSocket_t socket;
+        void *pKey;
+        IpcIoContext_t *pRecvContext; // Posted and not completed yet, nullptr if none.
+        IpcIoContext_t *pSendContext;
+      };
+
+      int m_epoll;
+      int m_wakeEvent;
+
+      // Only touched by the thread that calls Wait.
+      std::unordered_map<IpcSocket_t, Socket_t *> m_sockets;
+      std::deque<IpcEvent_t> m_completions;
+
+      std::mutex m_wakeMutex;
+      std::deque<IpcEvent_t> m_wakes;
+
+      void TryRecv(Socket_t *pSocket);
+      void TrySend(Socket_t *pSocket);
+      void Complete(Socket_t *pSocket, IpcIoContext_t *pContext, bool succeeded);
+#endif
+    };
+
+  } // ipc
+} // psvr2_toolkit
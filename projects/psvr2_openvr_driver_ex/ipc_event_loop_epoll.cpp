@@ -0,0 +1,275 @@
+#include "ipc_event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    IpcEventLoop::IpcEventLoop()
+      : m_epoll(-1)
+      , m_wakeEvent(-1)
+    {}
+
+    bool IpcEventLoop::Create() {
+      m_epoll = epoll_create1(EPOLL_CLOEXEC);
+      if (m_epoll == -1) {
+        return false;
+      }
+
+      m_wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (m_wakeEvent == -1) {
+        return false;
+      }
+
+      // The wake event is the only registration without a socket behind it.
+      epoll_event event = {
+        .events = EPOLLIN,
+        .data = { .ptr = nullptr },
+      };
+      return epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeEvent, &event) == 0;
+    }
+
+    bool IpcEventLoop::Associate(IpcSocket_t socket, void *pKey) {
+      int flags = fcntl(socket, F_GETFL, 0);
+      if (flags == -1 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return false;
+      }
+
+      Socket_t *pSocket = new Socket_t {
+        .socket = socket,
+        .pKey = pKey,
+        .pRecvContext = nullptr,
+        .pSendContext = nullptr,
+      };
+
+      // Edge-triggered, readiness is only acted on while an operation is posted, which then runs until it would block.
+      epoll_event event = {
+        .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data = { .ptr = pSocket },
+      };
+      if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0) {
+        delete pSocket;
+        return false;
+      }
+
+      m_sockets[socket] = pSocket;
+      return true;
+    }
+
+    bool IpcEventLoop::PostRecv(IpcSocket_t socket, IpcIoContext_t *pContext, char *pBuffer, int bufferLen) {
+      auto it = m_sockets.find(socket);
+      if (it == m_sockets.end() || it->second->pRecvContext) {
+        return false;
+      }
+
+      pContext->type = IpcEvent_Recv;
+      pContext->pBuffers[0] = {
+        .iov_base = pBuffer,
+        .iov_len = static_cast<size_t>(bufferLen),
+      };
+      pContext->firstBuffer = 0;
+      pContext->bufferCount = 1;
+      pContext->bytesTransferred = 0;
+
+      // Even if the receive completes immediately, the completion is still queued for Wait.
+      it->second->pRecvContext = pContext;
+      TryRecv(it->second);
+      return true;
+    }
+
+    bool IpcEventLoop::PostSend(IpcSocket_t socket, IpcIoContext_t *pContext, IpcBuffer_t *pBuffers, uint32_t bufferCount) {
+      auto it = m_sockets.find(socket);
+      if (it == m_sockets.end() || it->second->pSendContext || bufferCount > k_unMaxIpcBuffers) {
+        return false;
+      }
+
+      pContext->type = IpcEvent_Send;
+      for (uint32_t i = 0; i < bufferCount; i++) {
+        pContext->pBuffers[i] = {
+          .iov_base = pBuffers[i].buf,
+          .iov_len = pBuffers[i].len,
+        };
+      }
+      pContext->firstBuffer = 0;
+      pContext->bufferCount = bufferCount;
+      pContext->bytesTransferred = 0;
+
+      it->second->pSendContext = pContext;
+      TrySend(it->second);
+      return true;
+    }
+
+    void IpcEventLoop::Close(IpcSocket_t socket) {
+      auto it = m_sockets.find(socket);
+      if (it == m_sockets.end()) {
+        close(socket);
+        return;
+      }
+
+      // Fail whatever is still outstanding, like a completion port does when the socket goes away.
+      Socket_t *pSocket = it->second;
+      if (pSocket->pRecvContext) {
+        Complete(pSocket, pSocket->pRecvContext, false);
+      }
+      if (pSocket->pSendContext) {
+        Complete(pSocket, pSocket->pSendContext, false);
+      }
+
+      epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, nullptr);
+      close(socket);
+
+      m_sockets.erase(it);
+      delete pSocket;
+    }
+
+    bool IpcEventLoop::Wake(uint32_t wakeReason, void *pData) {
+      {
+        std::scoped_lock<std::mutex> lock(m_wakeMutex);
+        m_wakes.push_back({
+          .type = IpcEvent_Wake,
+          .pKey = pData,
+          .pContext = nullptr,
+          .bytesTransferred = 0,
+          .wakeReason = wakeReason,
+          .succeeded = true,
+        });
+      }
+
+      // The counter only saturates after 2^64 - 2 unread wakes, EAGAIN still means Wait will see it.
+      uint64_t value = 1;
+      return write(m_wakeEvent, &value, sizeof(value)) == sizeof(value) || errno == EAGAIN;
+    }
+
+    bool IpcEventLoop::Wait(IpcEvent_t &event) {
+      static constexpr int k_nMaxReadyEvents = 64;
+
+      while (true) {
+        if (!m_completions.empty()) {
+          event = m_completions.front();
+          m_completions.pop_front();
+          return true;
+        }
+
+        {
+          std::scoped_lock<std::mutex> lock(m_wakeMutex);
+          if (!m_wakes.empty()) {
+            event = m_wakes.front();
+            m_wakes.pop_front();
+            return true;
+          }
+        }
+
+        epoll_event pReady[k_nMaxReadyEvents];
+        int readyCount = epoll_wait(m_epoll, pReady, k_nMaxReadyEvents, -1);
+        if (readyCount == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+
+        // Everything ready is handled before returning, so no event refers to a socket that Close has freed since.
+        for (int i = 0; i < readyCount; i++) {
+          Socket_t *pSocket = static_cast<Socket_t *>(pReady[i].data.ptr);
+          if (!pSocket) {
+            uint64_t value;
+            while (read(m_wakeEvent, &value, sizeof(value)) == sizeof(value)) {}
+            continue;
+          }
+
+          uint32_t events = pReady[i].events;
+          if (pSocket->pRecvContext && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+            TryRecv(pSocket);
+          }
+          if (pSocket->pSendContext && (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))) {
+            TrySend(pSocket);
+          }
+        }
+      }
+    }
+
+    void IpcEventLoop::TryRecv(Socket_t *pSocket) {
+      IpcIoContext_t *pContext = pSocket->pRecvContext;
+
+      while (true) {
+        ssize_t received = recv(pSocket->socket, pContext->pBuffers[0].iov_base, pContext->pBuffers[0].iov_len, 0);
+        if (received >= 0) {
+          // 0 is a graceful close, which a completion port reports as a successful empty receive too.
+          pContext->bytesTransferred = static_cast<uint32_t>(received);
+          Complete(pSocket, pContext, true);
+          return;
+        }
+
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          Complete(pSocket, pContext, false);
+        }
+        return;
+      }
+    }
+
+    void IpcEventLoop::TrySend(Socket_t *pSocket) {
+      IpcIoContext_t *pContext = pSocket->pSendContext;
+
+      // Like an overlapped send, this only completes once every byte has been written.
+      while (pContext->firstBuffer < pContext->bufferCount) {
+        msghdr message = {};
+        message.msg_iov = &pContext->pBuffers[pContext->firstBuffer];
+        message.msg_iovlen = pContext->bufferCount - pContext->firstBuffer;
+
+        ssize_t sent = sendmsg(pSocket->socket, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Complete(pSocket, pContext, false);
+          }
+          return;
+        }
+
+        pContext->bytesTransferred += static_cast<uint32_t>(sent);
+
+        size_t remaining = static_cast<size_t>(sent);
+        while (pContext->firstBuffer < pContext->bufferCount) {
+          iovec &buffer = pContext->pBuffers[pContext->firstBuffer];
+          if (remaining < buffer.iov_len) {
+            buffer.iov_base = static_cast<char *>(buffer.iov_base) + remaining;
+            buffer.iov_len -= remaining;
+            break;
+          }
+
+          remaining -= buffer.iov_len;
+          pContext->firstBuffer++;
+        }
+      }
+
+      Complete(pSocket, pContext, true);
+    }
+
+    void IpcEventLoop::Complete(Socket_t *pSocket, IpcIoContext_t *pContext, bool succeeded) {
+      if (pContext == pSocket->pRecvContext) {
+        pSocket->pRecvContext = nullptr;
+      } else {
+        pSocket->pSendContext = nullptr;
+      }
+
+      m_completions.push_back({
+        .type = pContext->type,
+        .pKey = pSocket->pKey,
+        .pContext = pContext,
+        .bytesTransferred = pContext->bytesTransferred,
+        .wakeReason = 0,
+        .succeeded = succeeded,
+      });
+    }
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    // Reassembles CommandHeader_t + payload frames from a TCP byte stream.
+    // Reads may split a command or coalesce several, so received bytes are appended here and
+    // every complete command is dispatched in one pass.
+    class IpcFramer {
+    public:
+      static constexpr size_t k_unBufferSize = 8192;
+      static constexpr int32_t k_nMaxDataLen = static_cast<int32_t>(k_unBufferSize - sizeof(CommandHeader_t));
+
+      IpcFramer()
+        : m_pBuffer{}
+        , m_readOffset(0)
+        , m_writeOffset(0)
+      {}
+
+      char *WritePointer() {
+        return m_pBuffer + m_writeOffset;
+      }
+
+      int WritableSize() const {
+        return static_cast<int>(k_unBufferSize - m_writeOffset);
+      }
+
+      void Commit(int dataLen) {
+        m_writeOffset += dataLen;
+      }
+
+      // Calls handler(const CommandHeader_t &header, void *pData) for every complete command.
+      // Returns false if the stream contains an invalid header, the connection should be dropped then.
+      template <typename Handler>
+      bool Dispatch(Handler &&handler) {
+        while (m_writeOffset - m_readOffset >= sizeof(CommandHeader_t)) {
+          CommandHeader_t header;
+          memcpy(&header, m_pBuffer + m_readOffset, sizeof(header)); // The buffer isn't necessarily aligned here.
+
+          if (header.dataLen < 0 || header.dataLen > k_nMaxDataLen) {
+            return false;
+          }
+
+          size_t commandLen = sizeof(CommandHeader_t) + header.dataLen;
+          if (m_writeOffset - m_readOffset < commandLen) {
+            break;
+          }
+
+          handler(header, m_pBuffer + m_readOffset + sizeof(CommandHeader_t));
+          m_readOffset += commandLen;
+        }
+
+        // Move any partial command to the front, so the next read has room for the rest of it.
+        if (m_readOffset == m_writeOffset) {
+          m_readOffset = 0;
+          m_writeOffset = 0;
+        } else if (m_readOffset > 0) {
+          memmove(m_pBuffer, m_pBuffer + m_readOffset, m_writeOffset - m_readOffset);
+          m_writeOffset -= m_readOffset;
+          m_readOffset = 0;
+        }
+
+        return true;
+      }
+
+    private:
+      char m_pBuffer[k_unBufferSize];
+      size_t m_readOffset;
+      size_t m_writeOffset;
+    };
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+#include "../shared/ipc_protocol.h"
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    // Converts the raw HMD gaze state into the packed form sent to IPC clients.
+    inline GazeEyeResult MakeGazeEyeResult(const Hmd2GazeEye &eye) {
+      return {
+        .isGazeOriginValid = eye.isGazeOriginValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .gazeOriginMm = {
+          .x = eye.gazeOriginMm.x,
+          .y = eye.gazeOriginMm.y,
+          .z = eye.gazeOriginMm.z,
+        },
+        .isGazeDirValid = eye.isGazeDirValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .gazeDirNorm {
+          .x = eye.gazeDirNorm.x,
+          .y = eye.gazeDirNorm.y,
+          .z = eye.gazeDirNorm.z,
+        },
+        .isPupilDiaValid = eye.isPupilDiaValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .pupilDiaMm = eye.pupilDiaMm,
+        .isBlinkValid = eye.isBlinkValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .blink = eye.blink == Hmd2Bool::HMD2_BOOL_TRUE,
+      };
+    }
+
+    inline GazeCombinedResult MakeGazeCombinedResult(const Hmd2GazeCombined &combined) {
+      return {
+        .isGazeOriginValid = combined.isGazeOriginValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .gazeOriginMm = {
+          .x = combined.gazeOriginMm.x,
+          .y = combined.gazeOriginMm.y,
+          .z = combined.gazeOriginMm.z,
+        },
+        .isGazeDirValid = combined.isGazeDirValid == Hmd2Bool::HMD2_BOOL_TRUE,
+        .gazeDirNorm = {
+          .x = combined.gazeDirNorm.x,
+          .y = combined.gazeDirNorm.y,
+          .z = combined.gazeDirNorm.z,
+        },
+      };
+    }
+
+    inline CommandDataServerGazeDataResult2_t MakeGazeDataResult2(const Hmd2GazeState &gazeState, uint64_t sequence, uint64_t hmdTimestampUs, int64_t hostTimestampUs) {
+      return {
+        .sequence = sequence,
+        .hmdTimestampUs = hmdTimestampUs,
+        .hostTimestampUs = hostTimestampUs,
+        .leftEye = MakeGazeEyeResult(gazeState.leftEye),
+        .rightEye = MakeGazeEyeResult(gazeState.rightEye),
+        .combined = MakeGazeCombinedResult(gazeState.combined),
+      };
+    }
+
+    // For clients that handshook with IPC version 1.
+    inline CommandDataServerGazeDataResult_t MakeGazeDataResult(const CommandDataServerGazeDataResult2_t &gazeResult) {
+      return {
+        .leftEye = gazeResult.leftEye,
+        .rightEye = gazeResult.rightEye,
+      };
+    }
+
+  } // ipc
+} // psvr2_toolkit
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "ipc_event_loop.h"
+#include "../shared/ipc_protocol.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    // Preallocated outbound queue for one connection, nothing here allocates.
+    // Queued messages are sent together in one gather write, and at most one write is in flight at a time.
+    // When the queue is full, the oldest droppable message (a stale gaze frame) that isn't in flight makes room.
+    class IpcSendQueue {
+    public:
+      static constexpr uint32_t k_unSlotCount = 32;
+      static constexpr uint32_t k_unMaxMessageLen = 1024;
+
+      static_assert(k_unSlotCount <= k_unMaxIpcBuffers); // The whole queue goes out in one gather write.
+
+      IpcSendQueue()
+        : m_sendContext{}
+        , m_slots{}
+        , m_order{}
+        , m_freeSlots{}
+        , m_freeCount(k_unSlotCount)
+        , m_queuedCount(0)
+        , m_inFlightCount(0)
+        , m_inFlightOffset(0)
+      {
+        for (uint32_t i = 0; i < k_unSlotCount; i++) {
+          m_freeSlots[i] = static_cast<uint8_t>(i);
+        }
+      }
+
+      // Returns false if the message doesn't fit and nothing could be dropped for it.
+      bool Enqueue(ECommandType type, const void *pData, int dataLen, bool droppable) {
+        uint32_t messageLen = sizeof(CommandHeader_t) + dataLen;
+        if (dataLen < 0 || messageLen > k_unMaxMessageLen) {
+          return false;
+        }
+
+        if (m_freeCount == 0 && !DropOldestDroppable()) {
+          return false;
+        }
+
+        uint8_t slotIndex = m_freeSlots[--m_freeCount];
+        Slot_t &slot = m_slots[slotIndex];
+        slot.len = messageLen;
+        slot.droppable = droppable;
+
+        CommandHeader_t header = {
+          .type = type,
+          .dataLen = dataLen,
+        };
+        memcpy(slot.pData, &header, sizeof(header));
+        if (dataLen > 0) {
+          memcpy(slot.pData + sizeof(header), pData, dataLen);
+        }
+
+        m_order[m_queuedCount++] = slotIndex;
+        return true;
+      }
+
+      // Slots a non-droppable message can still take without dropping anything.
+      uint32_t FreeCount() const {
+        return m_freeCount;
+      }
+
+      bool SendPending() const {
+        return m_inFlightCount > 0;
+      }
+
+      // Fills pBuffers (k_unSlotCount entries) with every queued message and marks them in flight.
+      // Returns the number of buffers, 0 if there is nothing to send or a send is already in flight.
+      uint32_t BeginSend(IpcBuffer_t *pBuffers) {
+        if (m_inFlightCount > 0) {
+          return 0;
+        }
+
+        for (uint32_t i = 0; i < m_queuedCount; i++) {
+          Slot_t &slot = m_slots[m_order[i]];
+          uint32_t offset = i == 0 ? m_inFlightOffset : 0;
+          pBuffers[i] = {
+            .len = slot.len - offset,
+            .buf = slot.pData + offset,
+          };
+        }
+
+        m_inFlightCount = m_queuedCount;
+        return m_inFlightCount;
+      }
+
+      // Releases every message that was fully sent. A partially sent message is resent from where it stopped.
+      void EndSend(uint32_t bytesSent) {
+        uint32_t completedCount = 0;
+
+        for (uint32_t i = 0; i < m_inFlightCount; i++) {
+          Slot_t &slot = m_slots[m_order[i]];
+          uint32_t remainingLen = slot.len - m_inFlightOffset;
+          if (bytesSent < remainingLen) {
+            m_inFlightOffset += bytesSent;
+            break;
+          }
+
+          bytesSent -= remainingLen;
+          m_inFlightOffset = 0;
+          m_freeSlots[m_freeCount++] = m_order[i];
+          completedCount++;
+        }
+
+        RemoveOrder(0, completedCount);
+        m_inFlightCount = 0;
+      }
+
+      IpcIoContext_t &SendContext() {
+        return m_sendContext;
+      }
+
+    private:
+      struct Slot_t {
+        uint32_t len;
+        bool droppable;
+        char pData[k_unMaxMessageLen];
+      };
+
+      IpcIoContext_t m_sendContext;
+      Slot_t m_slots[k_unSlotCount];
+      uint8_t m_order[k_unSlotCount]; // Queued slot indices, oldest first. The first m_inFlightCount are being sent.
+      uint8_t m_freeSlots[k_unSlotCount];
+      uint32_t m_freeCount;
+      uint32_t m_queuedCount;
+      uint32_t m_inFlightCount;
+      uint32_t m_inFlightOffset; // Bytes of the oldest message that were already sent.
+
+      bool DropOldestDroppable() {
+        for (uint32_t i = m_inFlightCount; i < m_queuedCount; i++) {
+          uint8_t slotIndex = m_order[i];
+          if (m_slots[slotIndex].droppable && !(i == 0 && m_inFlightOffset > 0)) {
+            m_freeSlots[m_freeCount++] = slotIndex;
+            RemoveOrder(i, 1);
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void RemoveOrder(uint32_t index, uint32_t count) {
+        memmove(m_order + index, m_order + index + count, m_queuedCount - index - count);
+        m_queuedCount -= count;
+      }
+    };
+
+  } // ipc
+} // psvr2_toolkit
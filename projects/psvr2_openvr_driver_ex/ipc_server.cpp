@@ -1,10 +1,23 @@
 #include "ipc_server.h"
 
+#include "driver_host_proxy.h"
+#include "gaze_calibration_session.h"
+#include "gaze_foveation.h"
+#include "gaze_metrics.h"
+#include "gaze_pipeline.h"
+#include "gaze_predictor.h"
+#include "gaze_vergence.h"
+#include "gaze_recorder.h"
+#include "gaze_replay.h"
+#include "ipc_gaze_result.h"
 #include "trigger_effect_manager.h"
 #include "util.h"
 #include "vr_settings.h"
+#include "win32_process_watcher.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 namespace psvr2_toolkit {
   namespace ipc {
@@ -17,8 +30,19 @@ namespace psvr2_toolkit {
       , m_doGaze(false)
       , m_socket{}
       , m_serverAddr{}
-      , m_pGazeState(nullptr)
-    {}
+      , m_pProcessWatcher(nullptr)
+      , m_gazeState()
+      , m_gazeWakePending(false)
+      , m_gazeWakeTicks(0)
+      , m_lastGazeVersion(0)
+      , m_pGazeHistory(new GazeRing_t)
+      , m_gazeHistoryWriter(m_pGazeHistory)
+      , m_gazeEventClassifier()
+      , m_gazeEventSubscriberCount(0)
+      , m_lastClassifiedSequence(0)
+    {
+      m_gazeHistoryWriter.Initialize();
+    }
 
     IpcServer *IpcServer::Instance() {
       if (!m_pInstance) {
@@ -44,12 +68,19 @@ namespace psvr2_toolkit {
         return;
       }
 
+      if (!m_eventLoop.Create()) {
+        Util::DriverLog("[IPC_SERVER] Creating event loop failed. LastError = {}", GetLastError());
+        return;
+      }
+
+      m_pProcessWatcher = new Win32ProcessWatcher(&IpcServer::OnProcessExited, this);
+
       m_initialized = true;
       m_doGaze = !VRSettings::GetBool(STEAMVR_SETTINGS_DISABLE_GAZE, SETTING_DISABLE_GAZE_DEFAULT_VALUE);
     }
 
     void IpcServer::Start() {
-      if (!m_initialized && m_running) {
+      if (!m_initialized || m_running) {
         return;
       }
 
@@ -76,7 +107,9 @@ namespace psvr2_toolkit {
       }
 
       m_running = true;
-      m_receiveThread = std::thread(&IpcServer::ReceiveLoop, this);
+      m_gazeWakePending = false;
+      m_eventLoopThread = std::thread(&IpcServer::EventLoop, this);
+      m_acceptThread = std::thread(&IpcServer::AcceptLoop, this);
     }
 
     void IpcServer::Stop() {
@@ -86,23 +119,27 @@ namespace psvr2_toolkit {
 
       m_running = false;
       closesocket(m_socket);
-      m_receiveThread.join();
+      m_acceptThread.join();
+
+      // The event loop closes every connection and waits for their outstanding I/O before exiting.
+      m_eventLoop.Wake(WakeReason_Shutdown);
+      m_eventLoopThread.join();
     }
 
-    void IpcServer::UpdateGazeState(Hmd2GazeState *pGazeState) {
-      if (!m_pGazeState) {
-        m_pGazeState = reinterpret_cast<Hmd2GazeState *>(malloc(sizeof(Hmd2GazeState)));
-      }
-      if (m_pGazeState) {
-        memcpy(m_pGazeState, pGazeState, sizeof(Hmd2GazeState)); // Realistically, we should have a mutex here. Sadly, we do not have the time.
+    void IpcServer::UpdateGazeState(const CommandDataServerGazeDataResult2_t &gazeResult) {
+      m_gazeState.Write(gazeResult);
+      m_gazeHistoryWriter.Publish(gazeResult);
+
+      // Never blocks, the event loop does the sending.
+      if (m_running && !m_gazeWakePending.exchange(true)) {
+        m_gazeWakeTicks.store(GazeMetrics::Now(), std::memory_order_relaxed);
+        if (!m_eventLoop.Wake(WakeReason_Gaze)) {
+          m_gazeWakePending = false;
+        }
       }
     }
 
-    void IpcServer::ReceiveLoop() {
-      char pBuffer[1024] = {}; // This does not need to be static.
-      sockaddr_in clientAddr = {};
-      int clientAddrLen = sizeof(clientAddr);
-
+    void IpcServer::AcceptLoop() {
       while (m_running) {
         SOCKADDR_IN clientAddr = {};
         int clientAddrLen = sizeof(clientAddr);
@@ -114,55 +151,446 @@ namespace psvr2_toolkit {
               Util::DriverLog("[IPC_SERVER] Accept failed. LastError = {}", error);
           }
           else {
-            Util::DriverLog("[IPC_SERVER] Server socket closed. Exiting receive loop.");
+            Util::DriverLog("[IPC_SERVER] Server socket closed. Exiting accept loop.");
           }
           break;
         }
 
-        std::thread clientThread(&IpcServer::HandleClient, this, clientSocket, clientAddr);
-        clientThread.detach(); // client thread shouldnt block receive thread
+        Connection_t *pConnection = new Connection_t {
+          .handle = k_invalidConnectionHandle,
+          .clientSocket = clientSocket,
+          .clientAddr = clientAddr,
+          .state = ConnectionState_Connected,
+          .ipcVersion = 0,
+          .processId = 0,
+          .gazeDecimation = 0,
+          .gazeSampleCounter = 0,
+          .gazeEventsSubscribed = false,
+          .gazeHistory = {},
+          .recvPending = false,
+          .recvContext = {},
+          .framer = {},
+          .sendQueue = {},
+        };
+
+        // Hand the connection over to the event loop, which owns it from now on.
+        if (!m_eventLoop.Wake(WakeReason_NewConnection, pConnection)) {
+          Util::DriverLog("[IPC_SERVER] Handing over client on port {} failed. LastError = {}", ntohs(clientAddr.sin_port), GetLastError());
+          closesocket(clientSocket);
+          delete pConnection;
+        }
       }
     }
 
-    void IpcServer::HandleClient(SOCKET clientSocket, SOCKADDR_IN clientAddr) {
-      char pBuffer[1024] = {};
-      int clientPort = ntohs(clientAddr.sin_port);
+    void IpcServer::EventLoop() {
+      bool shuttingDown = false;
 
-      while (m_running) {
+      while (!shuttingDown || !m_connections.Empty()) {
+        IpcEvent_t event;
+        if (!m_eventLoop.Wait(event)) {
+          Util::DriverLog("[IPC_SERVER] Event loop failed. LastError = {}", GetLastError());
+          break;
+        }
+
+        switch (event.type) {
+          case IpcEvent_Wake: {
+            switch (event.wakeReason) {
+              case WakeReason_NewConnection: {
+                Connection_t *pConnection = static_cast<Connection_t *>(event.pKey);
+                if (shuttingDown) {
+                  closesocket(pConnection->clientSocket);
+                  delete pConnection;
+                } else {
+                  OpenConnection(pConnection);
+                }
+                break;
+              }
+
+              case WakeReason_Gaze: {
+                m_gazeWakePending = false;
+                PushGazeState();
+                break;
+              }
+
+              case WakeReason_ProcessExited: {
+                // The connection may have closed on its own since, then the handle is simply stale.
+                ConnectionHandle_t handle = static_cast<ConnectionHandle_t>(reinterpret_cast<uintptr_t>(event.pKey));
+                Connection_t *pConnection = m_connections.Find(handle);
+                if (pConnection && pConnection->state != ConnectionState_Closing) {
+                  Util::DriverLog("[IPC_SERVER] Process {} of client on port {} exited, disconnecting.", pConnection->processId, ntohs(pConnection->clientAddr.sin_port));
+                  CloseConnection(pConnection);
+                }
+                break;
+              }
+
+              case WakeReason_Shutdown: {
+                shuttingDown = true;
+
+                // Closing may release the connection, which the registry tolerates mid-iteration.
+                m_connections.ForEach([&](ConnectionHandle_t, Connection_t *pConnection) {
+                  CloseConnection(pConnection);
+                });
+                break;
+              }
+            }
+            break;
+          }
+
+          case IpcEvent_Recv: {
+            OnReceive(static_cast<Connection_t *>(event.pKey), event);
+            break;
+          }
+
+          case IpcEvent_Send: {
+            OnSend(static_cast<Connection_t *>(event.pKey), event);
+            break;
+          }
+        }
+      }
+
+      Util::DriverLog("[IPC_SERVER] Exiting event loop.");
+    }
+
+    void IpcServer::OpenConnection(Connection_t *pConnection) {
+      if (!m_eventLoop.Associate(pConnection->clientSocket, pConnection)) {
+        Util::DriverLog("[IPC_SERVER] Associating client on port {} failed. LastError = {}", ntohs(pConnection->clientAddr.sin_port), GetLastError());
+        closesocket(pConnection->clientSocket);
+        delete pConnection;
+        return;
+      }
 
-        int dwBufferSize = recv(clientSocket, pBuffer, sizeof(pBuffer), 0);
-        if (dwBufferSize <= 0) {
-          if (dwBufferSize == 0) {
+      pConnection->handle = m_connections.Add(pConnection);
+      if (pConnection->handle == k_invalidConnectionHandle) {
+        Util::DriverLog("[IPC_SERVER] Too many clients, rejecting client on port {}.", ntohs(pConnection->clientAddr.sin_port));
+        m_eventLoop.Close(pConnection->clientSocket);
+        delete pConnection;
+        return;
+      }
+
+      PostReceive(pConnection);
+    }
+
+    void IpcServer::CloseConnection(Connection_t *pConnection) {
+      static TriggerEffectManager *pTriggerEffectManager = TriggerEffectManager::Instance();
+      static GazeCalibrationSession *pGazeCalibrationSession = GazeCalibrationSession::Instance();
+
+      if (pConnection->state == ConnectionState_Closing) {
+        return;
+      }
+
+      if (pConnection->state == ConnectionState_Handshaken) {
+        m_pProcessWatcher->Unwatch(pConnection->handle);
+      }
+
+      pConnection->state = ConnectionState_Closing;
+
+      // Release everything the client held right away, the entry itself lingers until its I/O has drained.
+      pConnection->gazeDecimation = 0;
+      SubscribeGazeEvents(pConnection, false);
+      pTriggerEffectManager->ReleaseOwner(pConnection->handle);
+      pGazeCalibrationSession->ReleaseOwner(pConnection->handle);
+
+      m_eventLoop.Close(pConnection->clientSocket); // Outstanding I/O then completes with an error.
+
+      TryReleaseConnection(pConnection);
+    }
+
+    void IpcServer::TryReleaseConnection(Connection_t *pConnection) {
+      if (pConnection->state != ConnectionState_Closing || pConnection->recvPending || pConnection->sendQueue.SendPending()) {
+        return;
+      }
+
+      m_connections.Remove(pConnection->handle);
+      delete pConnection;
+    }
+
+    void IpcServer::PostReceive(Connection_t *pConnection) {
+      pConnection->recvPending = true;
+
+      IpcFramer &framer = pConnection->framer;
+      if (!m_eventLoop.PostRecv(pConnection->clientSocket, &pConnection->recvContext, framer.WritePointer(), framer.WritableSize())) {
+        Util::DriverLog("[IPC_SERVER] Receive failed for client on port {}. LastError = {}", ntohs(pConnection->clientAddr.sin_port), WSAGetLastError());
+        pConnection->recvPending = false;
+        CloseConnection(pConnection);
+      }
+    }
+
+    void IpcServer::OnReceive(Connection_t *pConnection, const IpcEvent_t &event) {
+      uint16_t clientPort = ntohs(pConnection->clientAddr.sin_port);
+
+      if (pConnection->state != ConnectionState_Closing) {
+        if (!event.succeeded || event.bytesTransferred == 0) {
+          if (event.succeeded) {
             Util::DriverLog("[IPC_SERVER] Client on port {} disconnected.", clientPort);
           } else {
-            Util::DriverLog("[IPC_SERVER] Receive failed for client on port {}. LastError = {}", clientPort, WSAGetLastError());
+            Util::DriverLog("[IPC_SERVER] Receive failed for client on port {}. LastError = {}", clientPort, GetLastError());
           }
 
-          break;
+          CloseConnection(pConnection);
+        } else {
+          pConnection->framer.Commit(event.bytesTransferred);
+
+          // recvPending is still set here, so a handler closing the connection can't release it under us.
+          bool valid = pConnection->framer.Dispatch([&](const CommandHeader_t &header, void *pData) {
+            if (pConnection->state != ConnectionState_Closing) {
+              HandleIpcCommand(pConnection, header, pData);
+            }
+          });
+          if (!valid) {
+            Util::DriverLog("[IPC_SERVER] Received invalid command header from client on port {}.", clientPort);
+            CloseConnection(pConnection);
+          }
+        }
+      }
+
+      // Every response to this batch of commands goes out in one write.
+      FlushSendQueue(pConnection);
+
+      pConnection->recvPending = false;
+
+      if (pConnection->state == ConnectionState_Closing) {
+        TryReleaseConnection(pConnection);
+        return;
+      }
+
+      PostReceive(pConnection);
+    }
+
+    void IpcServer::FlushSendQueue(Connection_t *pConnection) {
+      if (pConnection->state == ConnectionState_Closing) {
+        return;
+      }
+
+      IpcSendQueue &sendQueue = pConnection->sendQueue;
+      IpcBuffer_t pBuffers[IpcSendQueue::k_unSlotCount];
+
+      uint32_t bufferCount = sendQueue.BeginSend(pBuffers);
+      if (bufferCount == 0) {
+        return;
+      }
+
+      if (!m_eventLoop.PostSend(pConnection->clientSocket, &sendQueue.SendContext(), pBuffers, bufferCount)) {
+        Util::DriverLog("[IPC_SERVER] Send failed for client on port {}. LastError = {}", ntohs(pConnection->clientAddr.sin_port), WSAGetLastError());
+        sendQueue.EndSend(0);
+        CloseConnection(pConnection);
+      }
+    }
+
+    void IpcServer::OnSend(Connection_t *pConnection, const IpcEvent_t &event) {
+      pConnection->sendQueue.EndSend(event.succeeded ? event.bytesTransferred : 0);
+
+      if (pConnection->state == ConnectionState_Closing) {
+        TryReleaseConnection(pConnection);
+        return;
+      }
+
+      if (!event.succeeded) {
+        Util::DriverLog("[IPC_SERVER] Send failed for client on port {}. LastError = {}", ntohs(pConnection->clientAddr.sin_port), GetLastError());
+        CloseConnection(pConnection); // May release the connection.
+        return;
+      }
+
+      // The write freed up send queue slots, so a history response that was waiting for them can go on.
+      ContinueGazeHistory(pConnection);
+
+      // Anything queued while the last write was in flight.
+      FlushSendQueue(pConnection);
+    }
+
+    void IpcServer::PushGazeState() {
+      static GazeMetrics *pGazeMetrics = GazeMetrics::Instance();
+
+      uint64_t startTicks = GazeMetrics::Now();
+
+      // The version must be the one of the sample read, a write in between would otherwise get the newer sample skipped.
+      CommandDataServerGazeDataResult2_t gazeResult;
+      uint32_t version;
+      if (!m_doGaze || !m_gazeState.Read(gazeResult, &version)) {
+        return;
+      }
+
+      if (version == m_lastGazeVersion) {
+        return;
+      }
+      m_lastGazeVersion = version;
+
+      // The wake is only sent for the first of a run of samples, so this is the longest any of them waited.
+      pGazeMetrics->Record(GazeStage_IpcWake, m_gazeWakeTicks.load(std::memory_order_relaxed), startTicks);
+
+      PushGazeEvents();
+
+      m_connections.ForEach([&](ConnectionHandle_t, Connection_t *pConnection) {
+        if (pConnection->state != ConnectionState_Handshaken || pConnection->gazeDecimation == 0) {
+          return;
+        }
+        if (++pConnection->gazeSampleCounter < pConnection->gazeDecimation) {
+          return;
         }
+        pConnection->gazeSampleCounter = 0;
+
+        // Pushed gaze frames are the first thing dropped when a client falls behind.
+        SendGazeResult(pConnection, gazeResult, true);
+        FlushSendQueue(pConnection);
+      });
+
+      pGazeMetrics->Record(GazeStage_IpcFanOut, startTicks, GazeMetrics::Now());
+    }
+
+    void IpcServer::SubscribeGazeEvents(Connection_t *pConnection, bool subscribe) {
+      if (pConnection->gazeEventsSubscribed == subscribe) {
+        return;
+      }
+      pConnection->gazeEventsSubscribed = subscribe;
+
+      if (!subscribe) {
+        m_gazeEventSubscriberCount--;
+        return;
+      }
+
+      // Events only start from the first subscription, nobody is interested in what happened before.
+      if (m_gazeEventSubscriberCount++ == 0) {
+        m_gazeEventClassifier.Reset();
+        m_lastClassifiedSequence = GazeRingReader(m_pGazeHistory).LatestSequence();
+      }
+    }
+
+    void IpcServer::PushGazeEvents() {
+      if (m_gazeEventSubscriberCount == 0) {
+        return;
+      }
 
-        if (dwBufferSize < sizeof(CommandHeader_t)) {
-          Util::DriverLog("[IPC_SERVER] Received invalid command header size from client on port {}.", clientPort);
+      // Runs over the history instead of the latest state, so samples the event loop was too slow to see still count.
+      GazeRingReader reader(m_pGazeHistory);
+      uint64_t latestSequence = reader.LatestSequence();
+      uint64_t oldestSequence = latestSequence > k_unGazeRingCapacity ? latestSequence - k_unGazeRingCapacity + 1 : 1;
+
+      CommandDataServerGazeEvents_t events = {};
+      for (uint64_t sequence = (std::max)(m_lastClassifiedSequence + 1, oldestSequence); sequence <= latestSequence; sequence++) {
+        // A sample that was already overwritten is skipped, the classifier treats the jump in time as a gap.
+        GazeRingSample_t sample;
+        if (!reader.Read(sequence, sample)) {
           continue;
         }
 
-        HandleIpcCommand(clientSocket, clientAddr, pBuffer);
+        if (events.eventCount + GazeEventClassifier::k_unMaxEventsPerSample > k_unGazeEventsMaxEvents) {
+          SendGazeEvents(events);
+          events.eventCount = 0;
+        }
+        events.eventCount += static_cast<uint8_t>(m_gazeEventClassifier.Classify(sample, &events.events[events.eventCount]));
+      }
+      m_lastClassifiedSequence = latestSequence;
+
+      if (events.eventCount > 0) {
+        SendGazeEvents(events);
       }
-      closesocket(clientSocket);
     }
 
-    void IpcServer::HandleIpcCommand(SOCKET clientSocket, const sockaddr_in &clientAddr, char *pBuffer) {
-      static TriggerEffectManager *pTriggerEffectManager = TriggerEffectManager::Instance();
+    static_assert(sizeof(CommandHeader_t) + sizeof(CommandDataServerGazeEvents_t) <= IpcSendQueue::k_unMaxMessageLen);
+    static_assert(GazeEventClassifier::k_unMaxEventsPerSample <= k_unGazeEventsMaxEvents);
+    static_assert(sizeof(CommandHeader_t) + sizeof(CommandDataServerGazeStats_t) <= IpcSendQueue::k_unMaxMessageLen);
+
+    void IpcServer::SendGazeEvents(const CommandDataServerGazeEvents_t &events) {
+      m_connections.ForEach([&](ConnectionHandle_t, Connection_t *pConnection) {
+        if (pConnection->state != ConnectionState_Handshaken || !pConnection->gazeEventsSubscribed) {
+          return;
+        }
+
+        // Unlike gaze frames, an event can't be dropped without leaving a start without its end.
+        SendIpcCommand(pConnection, Command_ServerGazeEvents, &events, sizeof(events));
+        FlushSendQueue(pConnection);
+      });
+    }
+
+    void IpcServer::SendGazeResult(Connection_t *pConnection, const CommandDataServerGazeDataResult2_t &gazeResult, bool droppable) {
+      if (pConnection->ipcVersion >= 3) {
+        SendIpcCommand(pConnection, Command_ServerGazeDataResult, &gazeResult, sizeof(gazeResult), droppable);
+      } else {
+        CommandDataServerGazeDataResult_t response = MakeGazeDataResult(gazeResult);
+        SendIpcCommand(pConnection, Command_ServerGazeDataResult, &response, sizeof(response), droppable);
+      }
+    }
+
+    static_assert(sizeof(CommandHeader_t) + sizeof(CommandDataServerGazeHistoryResult_t) <= IpcSendQueue::k_unMaxMessageLen);
+
+    void IpcServer::SendGazeHistory(Connection_t *pConnection, uint64_t afterSequence) {
+      // Caps a single request, so a client can't keep the history flowing forever. The client asks again for the rest.
+      static constexpr uint32_t k_unGazeHistoryMaxMessages = IpcSendQueue::k_unSlotCount / 2;
+
+      GazeRingReader reader(m_pGazeHistory);
+      uint64_t latestSequence = reader.LatestSequence();
+      uint64_t oldestSequence = latestSequence > k_unGazeRingCapacity ? latestSequence - k_unGazeRingCapacity + 1 : 1;
+
+      // A client asking past the newest sample (e.g. after a driver restart) just gets latestSequence to resync with.
+      // A request made while the previous response is still being sent takes over from it.
+      GazeHistoryCursor_t &cursor = pConnection->gazeHistory;
+      cursor = {
+        .sequence = (std::min)(afterSequence, latestSequence) + 1,
+        .latestSequence = latestSequence,
+        .missedCount = 0,
+        .messagesLeft = k_unGazeHistoryMaxMessages,
+      };
+      if (cursor.sequence < oldestSequence) {
+        cursor.missedCount = static_cast<uint32_t>(oldestSequence - cursor.sequence);
+        cursor.sequence = oldestSequence;
+      }
+
+      ContinueGazeHistory(pConnection);
+    }
+
+    void IpcServer::ContinueGazeHistory(Connection_t *pConnection) {
+      // History messages can't be dropped, so they never take the slots events and command responses need.
+      // Whatever doesn't fit now is queued from OnSend, once the client has read enough to free slots up.
+      static constexpr uint32_t k_unGazeHistoryReservedSlots = IpcSendQueue::k_unSlotCount / 2;
+
+      GazeHistoryCursor_t &cursor = pConnection->gazeHistory;
+      GazeRingReader reader(m_pGazeHistory);
+
+      while (cursor.messagesLeft > 0 && pConnection->sendQueue.FreeCount() > k_unGazeHistoryReservedSlots) {
+        CommandDataServerGazeHistoryResult_t response = {};
+        response.latestSequence = cursor.latestSequence;
+
+        while (cursor.sequence <= cursor.latestSequence && response.sampleCount < k_unGazeHistoryMaxSamples) {
+          GazeRingSample_t sample;
+          if (reader.Read(cursor.sequence, sample)) {
+            response.samples[response.sampleCount++] = sample;
+          } else {
+            cursor.missedCount++; // Overwritten by the USB thread while we were catching up.
+          }
+          cursor.sequence++;
+        }
+
+        cursor.messagesLeft--;
+        if (cursor.sequence > cursor.latestSequence) {
+          cursor.messagesLeft = 0;
+        }
+
+        response.missedCount = cursor.missedCount;
+        response.hasMore = cursor.messagesLeft > 0;
+        cursor.missedCount = 0;
+        SendIpcCommand(pConnection, Command_ServerGazeHistoryResult, &response, sizeof(response));
+      }
+    }
+
+    void IpcServer::OnProcessExited(void *pUserData, uint32_t cookie) {
+      IpcServer *pServer = static_cast<IpcServer *>(pUserData);
 
-      uint16_t clientPort = ntohs(clientAddr.sin_port);
+      // Runs on a thread pool thread, the event loop does the actual reaping.
+      pServer->m_eventLoop.Wake(WakeReason_ProcessExited, reinterpret_cast<void *>(static_cast<uintptr_t>(cookie)));
+    }
+
+    void IpcServer::HandleIpcCommand(Connection_t *pConnection, const CommandHeader_t &header, void *pData) {
+      static TriggerEffectManager *pTriggerEffectManager = TriggerEffectManager::Instance();
+      static GazeCalibrationSession *pGazeCalibrationSession = GazeCalibrationSession::Instance();
+      static GazeRecorder *pGazeRecorder = GazeRecorder::Instance();
+      static GazeReplay *pGazeReplay = GazeReplay::Instance();
+      static GazeMetrics *pGazeMetrics = GazeMetrics::Instance();
 
-      CommandHeader_t *pHeader = reinterpret_cast<CommandHeader_t *>(pBuffer);
-      void *pData = pBuffer + sizeof(CommandHeader_t);
+      bool handshaken = pConnection->state == ConnectionState_Handshaken;
 
-      switch (pHeader->type) {
+      switch (header.type) {
         case Command_ClientPing: {
-          if (pHeader->dataLen == 0 && m_connections.contains(clientPort)) {
-            SendIpcCommand(clientSocket, Command_ServerPong); // TODO
+          if (header.dataLen == 0 && handshaken) {
+            SendIpcCommand(pConnection, Command_ServerPong); // TODO
           }
           break;
         }
@@ -172,74 +600,224 @@ namespace psvr2_toolkit {
           response.result = HandshakeResult_Failed;
           response.ipcVersion = k_unIpcVersion;
 
-          if (pHeader->dataLen == sizeof(CommandDataClientRequestHandshake_t) && !m_connections.contains(clientPort)) {
+          if (header.dataLen == sizeof(CommandDataClientRequestHandshake_t) && !handshaken) {
             CommandDataClientRequestHandshake_t *pRequest = reinterpret_cast<CommandDataClientRequestHandshake_t *>(pData);
 
             // We only want real running processes to handshake with us.
-            if (Util::IsProcessRunning(pRequest->processId)) {
-              m_connections[clientPort] = {
-                .clientAddr = clientAddr,
-                .ipcVersion = pRequest->ipcVersion,
-                .processId = pRequest->processId
-              };
+            if (m_pProcessWatcher->IsProcessRunning(pRequest->processId)) {
+              pConnection->state = ConnectionState_Handshaken;
+              pConnection->ipcVersion = (std::min)(pRequest->ipcVersion, k_unIpcVersion); // Older clients keep their old message layouts.
+              pConnection->processId = pRequest->processId;
+
+              // Reap the client as soon as its process exits, even if it never closes the socket.
+              if (!m_pProcessWatcher->Watch(pRequest->processId, pConnection->handle)) {
+                Util::DriverLog("[IPC_SERVER] Watching process {} failed. LastError = {}", pRequest->processId, GetLastError());
+              }
 
               response.result = HandshakeResult_Success;
             }
           }
 
-          SendIpcCommand(clientSocket, Command_ServerHandshakeResult, &response, sizeof(response));
+          SendIpcCommand(pConnection, Command_ServerHandshakeResult, &response, sizeof(response));
           break;
         }
 
         case Command_ClientRequestGazeData: {
-          if (pHeader->dataLen == 0 && m_connections.contains(clientPort)) {
-
-            if (m_doGaze && m_pGazeState) {
-              CommandDataServerGazeDataResult_t response = {
-                .leftEye = {
-                  .isGazeOriginValid = m_pGazeState->leftEye.isGazeOriginValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .gazeOriginMm = {
-                    .x = m_pGazeState->leftEye.gazeOriginMm.x,
-                    .y = m_pGazeState->leftEye.gazeOriginMm.y,
-                    .z = m_pGazeState->leftEye.gazeOriginMm.z,
-                  },
-                  .isGazeDirValid = m_pGazeState->leftEye.isGazeDirValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .gazeDirNorm {
-                    .x = m_pGazeState->leftEye.gazeDirNorm.x,
-                    .y = m_pGazeState->leftEye.gazeDirNorm.y,
-                    .z = m_pGazeState->leftEye.gazeDirNorm.z,
-                  },
-                  .isPupilDiaValid = m_pGazeState->leftEye.isPupilDiaValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .pupilDiaMm = m_pGazeState->leftEye.pupilDiaMm,
-                  .isBlinkValid = m_pGazeState->leftEye.isBlinkValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .blink = m_pGazeState->leftEye.blink == Hmd2Bool::HMD2_BOOL_TRUE,
-                },
-                
-                .rightEye = {
-                  .isGazeOriginValid = m_pGazeState->rightEye.isGazeOriginValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .gazeOriginMm = {
-                    .x = m_pGazeState->rightEye.gazeOriginMm.x,
-                    .y = m_pGazeState->rightEye.gazeOriginMm.y,
-                    .z = m_pGazeState->rightEye.gazeOriginMm.z,
-                  },
-                  .isGazeDirValid = m_pGazeState->rightEye.isGazeDirValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .gazeDirNorm {
-                    .x = m_pGazeState->rightEye.gazeDirNorm.x,
-                    .y = m_pGazeState->rightEye.gazeDirNorm.y,
-                    .z = m_pGazeState->rightEye.gazeDirNorm.z,
-                  },
-                  .isPupilDiaValid = m_pGazeState->rightEye.isPupilDiaValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .pupilDiaMm = m_pGazeState->rightEye.pupilDiaMm,
-                  .isBlinkValid = m_pGazeState->rightEye.isBlinkValid == Hmd2Bool::HMD2_BOOL_TRUE,
-                  .blink = m_pGazeState->rightEye.blink == Hmd2Bool::HMD2_BOOL_TRUE,
-                }
-              };
-              SendIpcCommand(clientSocket, Command_ServerGazeDataResult, &response, sizeof(response));
+          if (header.dataLen == 0 && handshaken) {
+            CommandDataServerGazeDataResult2_t gazeResult = {};
+            if (m_doGaze) {
+              m_gazeState.Read(gazeResult);
+            }
+            SendGazeResult(pConnection, gazeResult, false);
+          }
+          break;
+        }
+
+        case Command_ClientSubscribeGaze: {
+          if (handshaken && pConnection->ipcVersion >= 2) {
+            uint16_t decimation = 1;
+            if (header.dataLen == sizeof(CommandDataClientSubscribeGaze_t)) {
+              decimation = (std::max<uint16_t>)(reinterpret_cast<CommandDataClientSubscribeGaze_t *>(pData)->decimation, 1);
+            } else if (header.dataLen != 0) {
+              break;
+            }
+
+            pConnection->gazeDecimation = decimation;
+            pConnection->gazeSampleCounter = 0;
+          }
+          break;
+        }
+
+        case Command_ClientUnsubscribeGaze: {
+          if (header.dataLen == 0 && handshaken) {
+            pConnection->gazeDecimation = 0;
+          }
+          break;
+        }
+
+        case Command_ClientSubscribeGazeEvents:
+        case Command_ClientUnsubscribeGazeEvents: {
+          if (header.dataLen == 0 && handshaken) {
+            SubscribeGazeEvents(pConnection, header.type == Command_ClientSubscribeGazeEvents);
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazeHistory: {
+          if (handshaken && pConnection->ipcVersion >= 3) {
+            // No command data means everything, which is how the C# client sends afterSequence 0.
+            uint64_t afterSequence = 0;
+            if (header.dataLen == sizeof(CommandDataClientRequestGazeHistory_t)) {
+              afterSequence = reinterpret_cast<CommandDataClientRequestGazeHistory_t *>(pData)->afterSequence;
+            } else if (header.dataLen != 0) {
+              break;
+            }
+
+            SendGazeHistory(pConnection, afterSequence);
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazePrediction: {
+          if (handshaken) {
+            int64_t targetTimestamp = 0;
+            if (header.dataLen == sizeof(CommandDataClientRequestGazePrediction_t)) {
+              targetTimestamp = reinterpret_cast<CommandDataClientRequestGazePrediction_t *>(pData)->targetHostTimestampUs;
+            } else if (header.dataLen != 0) {
+              break;
+            }
+
+            if (targetTimestamp == 0) {
+              targetTimestamp = DriverHostProxy::Instance()->GetNextVsyncTimestamp();
+            }
+            if (targetTimestamp == 0) {
+              targetTimestamp = Util::GetHostTimestamp();
+            }
+
+            CommandDataServerGazePredictionResult_t response;
+            if (!m_doGaze || !GazePredictor::Instance()->Predict(targetTimestamp, &response)) {
+              response = {};
+              response.targetHostTimestampUs = targetTimestamp;
+            }
+            SendIpcCommand(pConnection, Command_ServerGazePredictionResult, &response, sizeof(response));
+          }
+          break;
+        }
+
+        case Command_ClientStartGazeCalibration:
+        case Command_ClientSetGazeCalibrationPoint:
+        case Command_ClientStopGazeCalibration: {
+          CommandDataServerGazeCalibrationStatus_t status;
+          if (handshaken && m_doGaze && pGazeCalibrationSession->HandleIpcCommand(pConnection->handle, &header, pData, &status)) {
+            SendIpcCommand(pConnection, Command_ServerGazeCalibrationStatus, &status, sizeof(status));
+          }
+          break;
+        }
+
+        case Command_ClientStartGazeRecording:
+        case Command_ClientStopGazeRecording:
+        case Command_ClientRequestGazeRecordingStatus: {
+          if (header.dataLen == 0 && handshaken) {
+            if (header.type == Command_ClientStartGazeRecording) {
+              pGazeRecorder->Start();
+            } else if (header.type == Command_ClientStopGazeRecording) {
+              pGazeRecorder->Stop();
+            }
+
+            CommandDataServerGazeRecordingStatus_t status;
+            pGazeRecorder->GetStatus(&status);
+            SendIpcCommand(pConnection, Command_ServerGazeRecordingStatus, &status, sizeof(status));
+          }
+          break;
+        }
+
+        case Command_ClientStartGazeReplay: {
+          if (header.dataLen == sizeof(CommandDataClientStartGazeReplay_t) && handshaken) {
+            CommandDataClientStartGazeReplay_t *pRequest = reinterpret_cast<CommandDataClientStartGazeReplay_t *>(pData);
+            pGazeReplay->Start(std::string(pRequest->path, strnlen(pRequest->path, sizeof(pRequest->path))), pRequest->asFastAsPossible);
+
+            CommandDataServerGazeReplayStatus_t status;
+            pGazeReplay->GetStatus(&status);
+            SendIpcCommand(pConnection, Command_ServerGazeReplayStatus, &status, sizeof(status));
+          }
+          break;
+        }
+
+        case Command_ClientStopGazeReplay:
+        case Command_ClientRequestGazeReplayStatus: {
+          if (header.dataLen == 0 && handshaken) {
+            if (header.type == Command_ClientStopGazeReplay) {
+              pGazeReplay->Stop();
+            }
+
+            CommandDataServerGazeReplayStatus_t status;
+            pGazeReplay->GetStatus(&status);
+            SendIpcCommand(pConnection, Command_ServerGazeReplayStatus, &status, sizeof(status));
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazeStats: {
+          if (handshaken) {
+            bool reset = false;
+            if (header.dataLen == sizeof(CommandDataClientRequestGazeStats_t)) {
+              reset = reinterpret_cast<CommandDataClientRequestGazeStats_t *>(pData)->reset;
+            } else if (header.dataLen != 0) {
+              break;
+            }
+
+            CommandDataServerGazeStats_t stats;
+            pGazeMetrics->GetStats(&stats);
+            if (reset) {
+              pGazeMetrics->Reset();
+            }
+            SendIpcCommand(pConnection, Command_ServerGazeStats, &stats, sizeof(stats));
+          }
+          break;
+        }
+
+        case Command_ClientDumpGazeStats: {
+          if (header.dataLen == 0 && handshaken) {
+            pGazeMetrics->Dump();
+
+            CommandDataServerGazeStats_t stats;
+            pGazeMetrics->GetStats(&stats);
+            SendIpcCommand(pConnection, Command_ServerGazeStats, &stats, sizeof(stats));
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazeClockStatus: {
+          if (header.dataLen == 0 && handshaken) {
+            CommandDataServerGazeClockStatus_t status;
+            GazePipeline::Instance()->GetClockStatus(&status);
+            SendIpcCommand(pConnection, Command_ServerGazeClockStatus, &status, sizeof(status));
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazeVergence: {
+          if (header.dataLen == 0 && handshaken) {
+            CommandDataServerGazeVergenceResult_t response;
+            if (m_doGaze) {
+              GazeVergence::Instance()->GetResult(&response);
+            } else {
+              response = {};
+            }
+            SendIpcCommand(pConnection, Command_ServerGazeVergenceResult, &response, sizeof(response));
+          }
+          break;
+        }
+
+        case Command_ClientRequestGazeFoveation: {
+          if (header.dataLen == 0 && handshaken) {
+            CommandDataServerGazeFoveationResult_t response;
+            if (m_doGaze) {
+              GazeFoveation::Instance()->GetResult(&response);
             } else {
-                CommandDataServerGazeDataResult_t response = {};
-                SendIpcCommand(clientSocket, Command_ServerGazeDataResult, &response, sizeof(response));
+              response = {};
             }
-            
+            SendIpcCommand(pConnection, Command_ServerGazeFoveationResult, &response, sizeof(response));
           }
           break;
         }
@@ -251,28 +829,26 @@ namespace psvr2_toolkit {
         case Command_ClientTriggerEffectMultiplePositionFeedback:
         case Command_ClientTriggerEffectSlopeFeedback:
         case Command_ClientTriggerEffectMultiplePositionVibration: {
-          if (m_connections.contains(clientPort)) {
-            pTriggerEffectManager->HandleIpcCommand(m_connections[clientPort].processId, pHeader, pData);
+          if (handshaken) {
+            pTriggerEffectManager->HandleIpcCommand(pConnection->handle, &header, pData);
           }
           break;
         }
       }
     }
 
-    void IpcServer::SendIpcCommand(SOCKET clientSocket, ECommandType type, void *pData, int dataLen) {
-      // Reduce the allocations by making the buffer static.
-      // I'm sure this isn't thread-safe, but we only have one receive thread anyways.
-      static char pBuffer[1024] = {};
+    void IpcServer::SendIpcCommand(Connection_t *pConnection, ECommandType type, const void *pData, int dataLen, bool droppable) {
+      if (pConnection->state == ConnectionState_Closing) {
+        return;
+      }
 
       int actualDataLen = pData ? dataLen : 0;
-      int actualBufferLen = sizeof(CommandHeader_t) + actualDataLen;
-
-      CommandHeader_t *pHeader = reinterpret_cast<CommandHeader_t *>(pBuffer);
-      pHeader->type = type;
-      pHeader->dataLen = actualDataLen;
-      memcpy(pBuffer + sizeof(CommandHeader_t), pData, actualDataLen);
 
-      send(clientSocket, pBuffer, actualBufferLen, 0);
+      if (!pConnection->sendQueue.Enqueue(type, pData, actualDataLen, droppable)) {
+        // Bounded backpressure, a client this far behind on everything but gaze is dropped.
+        Util::DriverLog("[IPC_SERVER] Send queue full for client on port {}, disconnecting.", ntohs(pConnection->clientAddr.sin_port));
+        CloseConnection(pConnection);
+      }
     }
 
   } // ipc
@@ -1,12 +1,19 @@
 #pragma once
 
-#include "hmd2_gaze.h"
+#include "gaze_event_classifier.h"
+#include "ipc_connection_registry.h"
+#include "ipc_event_loop.h"
+#include "ipc_framer.h"
+#include "ipc_send_queue.h"
+#include "process_watcher.h"
+#include "seqlock.h"
+#include "../shared/gaze_ring.h"
 #include "../shared/ipc_protocol.h"
 
 #include <windows.h>
 
+#include <atomic>
 #include <cstdint>
-#include <map>
 #include <thread>
 
 namespace psvr2_toolkit {
@@ -24,32 +31,103 @@ namespace psvr2_toolkit {
       void Start();
       void Stop();
 
-      void UpdateGazeState(Hmd2GazeState *pGazeState);
+      void UpdateGazeState(const CommandDataServerGazeDataResult2_t &gazeResult);
 
     private:
-      struct ConnectionInfo_t {
+      // Well above the handful of clients expected, so a burst of reconnects can't run the registry dry.
+      static constexpr uint32_t k_unMaxConnections = 256;
+
+      enum EConnectionState : uint8_t {
+        ConnectionState_Connected, // Waiting for a handshake.
+        ConnectionState_Handshaken,
+        ConnectionState_Closing, // Socket is closed, waiting for outstanding I/O to complete.
+      };
+
+      enum EWakeReason : uint32_t {
+        WakeReason_NewConnection, // The wake data is the new Connection_t.
+        WakeReason_Gaze,
+        WakeReason_Shutdown,
+        WakeReason_ProcessExited, // The wake data is the ConnectionHandle_t of the client.
+      };
+
+      // A history response that is still being queued, a message at a time as send queue slots free up.
+      struct GazeHistoryCursor_t {
+        uint64_t sequence; // Next sample to send.
+        uint64_t latestSequence; // Newest sample in the history when the request came in.
+        uint32_t missedCount; // Skipped since the last message that was queued.
+        uint32_t messagesLeft; // 0 if no response is being sent.
+      };
+
+      // Owned and only ever touched by the event loop thread, once it has been handed over by the accept thread.
+      struct Connection_t {
+        ConnectionHandle_t handle; // Assigned once the event loop takes over the connection.
+        SOCKET clientSocket;
         sockaddr_in clientAddr;
-        uint16_t ipcVersion;
+        EConnectionState state;
+        uint16_t ipcVersion; // Negotiated during the handshake, never newer than k_unIpcVersion.
         uint32_t processId;
+        uint16_t gazeDecimation; // 0 if the client isn't subscribed to gaze.
+        uint16_t gazeSampleCounter;
+        bool gazeEventsSubscribed;
+        GazeHistoryCursor_t gazeHistory;
+        bool recvPending;
+        IpcIoContext_t recvContext;
+        IpcFramer framer;
+        IpcSendQueue sendQueue;
       };
 
       static IpcServer *m_pInstance;
 
       bool m_initialized;
-      bool m_running;
+      std::atomic<bool> m_running;
       bool m_doGaze;
       SOCKET m_socket;
       sockaddr_in m_serverAddr;
-      std::thread m_receiveThread;
-      std::map<uint16_t, ConnectionInfo_t> m_connections;
-
-      Hmd2GazeState *m_pGazeState;
-
-      void ReceiveLoop();
-      void HandleClient(SOCKET clientSocket, SOCKADDR_IN clientAddr);
-
-      void HandleIpcCommand(SOCKET clientSocket, const sockaddr_in &clientAddr, char *pBuffer);
-      void SendIpcCommand(SOCKET clientSocket, ECommandType type, void *pData = nullptr, int dataSize = 0);
+      std::thread m_acceptThread;
+      std::thread m_eventLoopThread;
+      IpcEventLoop m_eventLoop;
+      ProcessWatcher *m_pProcessWatcher; // Only used by the event loop thread.
+      ConnectionRegistry<Connection_t, k_unMaxConnections> m_connections;
+
+      SeqLock<CommandDataServerGazeDataResult2_t> m_gazeState; // Written by the USB gaze thread, read by the event loop.
+      std::atomic<bool> m_gazeWakePending; // Coalesces gaze wakes, so a slow event loop isn't flooded.
+      std::atomic<uint64_t> m_gazeWakeTicks; // GazeMetrics time of the last gaze wake.
+      uint32_t m_lastGazeVersion;
+
+      // Private history of calibrated samples, in the same layout as the shared memory ring.
+      // Written by the USB gaze thread, read by the event loop to answer history requests.
+      GazeRing_t *m_pGazeHistory;
+      GazeRingWriter m_gazeHistoryWriter;
+
+      // Classifies the history into fixations and saccades, only while some client is subscribed to the events.
+      GazeEventClassifier m_gazeEventClassifier;
+      uint32_t m_gazeEventSubscriberCount;
+      uint64_t m_lastClassifiedSequence;
+
+      void AcceptLoop();
+      void EventLoop();
+
+      void OpenConnection(Connection_t *pConnection);
+      void CloseConnection(Connection_t *pConnection);
+      void TryReleaseConnection(Connection_t *pConnection);
+      void PostReceive(Connection_t *pConnection);
+      void OnReceive(Connection_t *pConnection, const IpcEvent_t &event);
+      void FlushSendQueue(Connection_t *pConnection);
+      void OnSend(Connection_t *pConnection, const IpcEvent_t &event);
+
+      void PushGazeState();
+      void SendGazeResult(Connection_t *pConnection, const CommandDataServerGazeDataResult2_t &gazeResult, bool droppable);
+      void SendGazeHistory(Connection_t *pConnection, uint64_t afterSequence);
+      void ContinueGazeHistory(Connection_t *pConnection);
+      void SubscribeGazeEvents(Connection_t *pConnection, bool subscribe);
+      void PushGazeEvents();
+      void SendGazeEvents(const CommandDataServerGazeEvents_t &events);
+
+      static void OnProcessExited(void *pUserData, uint32_t cookie);
+
+      void HandleIpcCommand(Connection_t *pConnection, const CommandHeader_t &header, void *pData);
+      // Only queues the message, FlushSendQueue sends everything queued in one write.
+      void SendIpcCommand(Connection_t *pConnection, ECommandType type, const void *pData = nullptr, int dataSize = 0, bool droppable = false);
     };
 
   } // ipc
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Log-linear histogram in the style of HdrHistogram: every power of two is split into 16 equal buckets,
+  // so a value is kept to within about 6% at any magnitude, from single ticks up to hours.
+  // Recording is a handful of relaxed loads and stores, no locked instructions, which is why only one thread may record.
+  // Any thread may read, each counter is read on its own so a snapshot can be off by the samples recorded meanwhile.
+  class LatencyHistogram {
+  public:
+    static constexpr uint32_t k_unSubBucketBits = 4;
+    static constexpr uint32_t k_unSubBucketCount = 1 << k_unSubBucketBits;
+    static constexpr uint32_t k_unMaxShift = 40;
+    static constexpr uint32_t k_unBucketCount = (k_unMaxShift + 2) * k_unSubBucketCount;
+
+    struct Snapshot_t {
+      uint32_t counts[k_unBucketCount];
+      uint64_t count; // Sum of the bucket counts.
+      uint64_t sum;
+      uint64_t max;
+    };
+
+    LatencyHistogram()
+      : m_buckets{}
+      , m_sum(0)
+      , m_max(0)
+    {}
+
+    // Must only ever be called from one thread at a time.
+    void Record(uint64_t value) {
+      std::atomic<uint32_t> &bucket = m_buckets[GetBucketIndex(value)];
+      bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      m_sum.store(m_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+      if (value > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(value, std::memory_order_relaxed);
+      }
+    }
+
+    // Races with Record, a sample recorded at the same time may survive the reset.
+    void Reset() {
+      for (std::atomic<uint32_t> &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      m_sum.store(0, std::memory_order_relaxed);
+      m_max.store(0, std::memory_order_relaxed);
+    }
+
+    void TakeSnapshot(Snapshot_t *pSnapshot) const {
+      pSnapshot->count = 0;
+      for (uint32_t i = 0; i < k_unBucketCount; i++) {
+        pSnapshot->counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        pSnapshot->count += pSnapshot->counts[i];
+      }
+      pSnapshot->sum = m_sum.load(std::memory_order_relaxed);
+      pSnapshot->max = m_max.load(std::memory_order_relaxed);
+    }
+
+    // Upper bound of the bucket holding the given fraction (0 to 1) of the samples, never above the recorded maximum.
+    static uint64_t GetValueAtPercentile(const Snapshot_t &snapshot, double percentile) {
+      if (snapshot.count == 0) {
+        return 0;
+      }
+
+      uint64_t rank = static_cast<uint64_t>(percentile * snapshot.count + 0.5);
+      if (rank == 0) {
+        rank = 1;
+      }
+
+      uint64_t seen = 0;
+      for (uint32_t i = 0; i < k_unBucketCount; i++) {
+        seen += snapshot.counts[i];
+        if (seen >= rank) {
+          uint64_t value = GetBucketUpperBound(i);
+          return value < snapshot.max ? value : snapshot.max;
+        }
+      }
+
+      return snapshot.max;
+    }
+
+    static uint32_t GetBucketIndex(uint64_t value) {
+      uint32_t bitWidth = static_cast<uint32_t>(std::bit_width(value));
+      if (bitWidth <= k_unSubBucketBits + 1) {
+        return static_cast<uint32_t>(value);
+      }
+
+      uint32_t shift = bitWidth - (k_unSubBucketBits + 1);
+      if (shift > k_unMaxShift) {
+        return k_unBucketCount - 1;
+      }
+
+      return shift * k_unSubBucketCount + static_cast<uint32_t>(value >> shift);
+    }
+
+    static uint64_t GetBucketLowerBound(uint32_t index) {
+      if (index < 2 * k_unSubBucketCount) {
+        return index;
+      }
+
+      uint32_t shift = index / k_unSubBucketCount - 1;
+      return static_cast<uint64_t>(index - shift * k_unSubBucketCount) << shift;
+    }
+
+    static uint64_t GetBucketUpperBound(uint32_t index) {
+      if (index < 2 * k_unSubBucketCount) {
+        return index;
+      }
+
+      uint32_t shift = index / k_unSubBucketCount - 1;
+      return GetBucketLowerBound(index) + (uint64_t(1) << shift) - 1;
+    }
+
+  private:
+    std::atomic<uint32_t> m_buckets[k_unBucketCount];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace psvr2_toolkit {
+
+  // One Euro filter (Casiez et al. 2012) over an N-dimensional value.
+  // A low-pass filter whose cutoff rises with the speed of the value: slow movement is smoothed hard, fast movement passes with little lag.
+  // All dimensions share one cutoff, driven by the magnitude of the velocity, so a direction isn't bent towards one axis.
+  // O(N) per sample, no allocation.
+  template <size_t N>
+  class OneEuroFilter {
+  public:
+    OneEuroFilter()
+      : m_minCutoffHz(1.0f)
+      , m_beta(0.0f)
+      , m_derivativeCutoffHz(1.0f)
+      , m_initialized(false)
+      , m_values{}
+      , m_derivatives{}
+    {}
+
+    // minCutoffHz is the cutoff at rest, beta how much it rises per unit per second of speed.
+    void Configure(float minCutoffHz, float beta, float derivativeCutoffHz) {
+      m_minCutoffHz = minCutoffHz;
+      m_beta = beta;
+      m_derivativeCutoffHz = derivativeCutoffHz;
+    }
+
+    // The next sample passes through unfiltered.
+    void Reset() {
+      m_initialized = false;
+    }
+
+    // Filters values in place. dtSeconds is the time since the previous sample and must be positive.
+    void Filter(float (&values)[N], float dtSeconds) {
+      if (!m_initialized) {
+        for (size_t i = 0; i < N; i++) {
+          m_values[i] = values[i];
+          m_derivatives[i] = 0.0f;
+        }
+        m_initialized = true;
+        return;
+      }
+
+      float derivativeAlpha = Alpha(m_derivativeCutoffHz, dtSeconds);
+      float speedSquared = 0.0f;
+      for (size_t i = 0; i < N; i++) {
+        float derivative = (values[i] - m_values[i]) / dtSeconds;
+        m_derivatives[i] += derivativeAlpha * (derivative - m_derivatives[i]);
+        speedSquared += m_derivatives[i] * m_derivatives[i];
+      }
+
+      float alpha = Alpha(m_minCutoffHz + m_beta * std::sqrt(speedSquared), dtSeconds);
+      for (size_t i = 0; i < N; i++) {
+        m_values[i] += alpha * (values[i] - m_values[i]);
+        values[i] = m_values[i];
+      }
+    }
+
+  private:
+    float m_minCutoffHz;
+    float m_beta;
+    float m_derivativeCutoffHz;
+
+    bool m_initialized;
+    float m_values[N];
+    float m_derivatives[N];
+
+    // Smoothing factor of a first-order low-pass at cutoffHz, sampled every dtSeconds.
+    static float Alpha(float cutoffHz, float dtSeconds) {
+      constexpr float k_twoPi = 6.28318530718f;
+      float tau = 1.0f / (k_twoPi * cutoffHz);
+      return 1.0f / (1.0f + tau / dtSeconds);
+    }
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Called on an arbitrary thread, must not block and must not call back into the watcher.
+  typedef void (*ProcessExitCallback_t)(void *pUserData, uint32_t cookie);
+
+  // Process table abstraction, so liveness tracking can run against a fake table. Win32ProcessWatcher is the real one.
+  // Watch and Unwatch must be called from a single thread.
+  class ProcessWatcher {
+  public:
+    virtual ~ProcessWatcher() = default;
+
+    virtual bool IsProcessRunning(uint32_t processId) = 0;
+
+    // The exit callback fires once for cookie when the process exits, unless it is unwatched first.
+    // Returns false if the process can't be watched, for example because it already exited.
+    virtual bool Watch(uint32_t processId, uint32_t cookie) = 0;
+
+    // Once this returns, the exit callback for cookie is guaranteed not to be running or to run later.
+    virtual void Unwatch(uint32_t cookie) = 0;
+  };
+
+} // psvr2_toolkit
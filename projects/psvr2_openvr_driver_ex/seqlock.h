@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <immintrin.h>
+
+namespace psvr2_toolkit {
+
+  // Single-writer, multi-reader sequence lock.
+  // The writer never blocks or waits on readers, readers retry if they raced with a write.
+  // The payload is stored as relaxed atomic words, so a torn copy is never observed by a reader.
+  template <typename T>
+  class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable.");
+
+  public:
+    SeqLock()
+      : m_sequence(0)
+      , m_words{}
+    {}
+
+    // Must only ever be called from one thread at a time.
+    void Write(const T &value) {
+      uint64_t pWords[k_unWordCount] = {};
+      memcpy(pWords, &value, sizeof(T));
+
+      uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+      m_sequence.store(sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (size_t i = 0; i < k_unWordCount; i++) {
+        m_words[i].store(pWords[i], std::memory_order_relaxed);
+      }
+
+      m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Returns false if nothing has been written yet.
+    // pVersion receives the number of completed writes as of the copy that was read, which Version() can't give
+    // without racing the writer.
+    bool Read(T &value, uint32_t *pVersion = nullptr) const {
+      uint64_t pWords[k_unWordCount];
+      uint32_t sequence;
+
+      while (true) {
+        sequence = m_sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+          _mm_pause();
+          continue;
+        }
+
+        for (size_t i = 0; i < k_unWordCount; i++) {
+          pWords[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+          break;
+        }
+      }
+
+      if (sequence == 0) {
+        return false;
+      }
+
+      memcpy(&value, pWords, sizeof(T));
+      if (pVersion) {
+        *pVersion = sequence / 2;
+      }
+      return true;
+    }
+
+    // Number of completed writes.
+    uint32_t Version() const {
+      return m_sequence.load(std::memory_order_acquire) / 2;
+    }
+
+  private:
+    static constexpr size_t k_unWordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint32_t> m_sequence;
+    std::atomic<uint64_t> m_words[k_unWordCount];
+  };
+
+} // psvr2_toolkit
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    inline int64_t GetBenchTimestampNs() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Keeps the optimizer from dropping a result that is never used.
+    template <typename T>
+    inline void DoNotOptimize(const T &value) {
+#if defined(_MSC_VER)
+      static volatile const void *pSink;
+      pSink = &value;
+#else
+      asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "fake_driver_context.h"
+
+#include "gaze_calibration.h"
+#include "vr_settings.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // Writes a polygon profile the way it appears in steamvr.vrsettings, scaled by 100, and loads it back.
+    // Values are written with 6 significant digits like a hand-edited file, so up to about 400 samples fit in the
+    // 4 KiB VRSettings::GetString reads. Compare against the loaded GetCalibrationData, not the radii passed in.
+    inline GazeCalibrationProfile LoadPolygonProfile(FakeDriverContext &context, const std::vector<double> &radii, double centerX = 0.0, double centerY = 0.0) {
+      std::string calibration;
+      char pchValue[64];
+      for (double radius : radii) {
+        snprintf(pchValue, sizeof(pchValue), "%s%.6g", calibration.empty() ? "" : " ", radius * 100.0);
+        calibration += pchValue;
+      }
+      snprintf(pchValue, sizeof(pchValue), "%.6g %.6g", centerX * 100.0, centerY * 100.0);
+
+      context.settings.Clear();
+      context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Calibration", calibration);
+      context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Center", pchValue);
+
+      GazeCalibrationProfile profile;
+      profile.LoadConfig("LeftEye");
+      return profile;
+    }
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <openvr_driver.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // Settings kept as strings, so a test can seed any key the way it would appear in steamvr.vrsettings.
+    // Missing keys report VRSettingsError_UnsetSettingHasNoDefault, like SteamVR does for unknown keys.
+    class FakeVRSettings : public vr::IVRSettings {
+    public:
+      void Set(const char *pchSection, const char *pchSettingsKey, const std::string &value) {
+        m_values[{ pchSection, pchSettingsKey }] = value;
+      }
+
+      bool Has(const char *pchSection, const char *pchSettingsKey) const {
+        return m_values.count({ pchSection, pchSettingsKey }) != 0;
+      }
+
+      std::string Get(const char *pchSection, const char *pchSettingsKey) const {
+        auto it = m_values.find({ pchSection, pchSettingsKey });
+        return it != m_values.end() ? it->second : std::string();
+      }
+
+      void Clear() {
+        m_values.clear();
+      }
+
+      const char *GetSettingsErrorNameFromEnum(vr::EVRSettingsError) override {
+        return "";
+      }
+
+      void SetBool(const char *pchSection, const char *pchSettingsKey, bool bValue, vr::EVRSettingsError *peError) override {
+        Store(pchSection, pchSettingsKey, bValue ? "true" : "false", peError);
+      }
+
+      void SetInt32(const char *pchSection, const char *pchSettingsKey, int32_t nValue, vr::EVRSettingsError *peError) override {
+        Store(pchSection, pchSettingsKey, std::to_string(nValue), peError);
+      }
+
+      void SetFloat(const char *pchSection, const char *pchSettingsKey, float flValue, vr::EVRSettingsError *peError) override {
+        Store(pchSection, pchSettingsKey, std::to_string(flValue), peError);
+      }
+
+      void SetString(const char *pchSection, const char *pchSettingsKey, const char *pchValue, vr::EVRSettingsError *peError) override {
+        Store(pchSection, pchSettingsKey, pchValue, peError);
+      }
+
+      bool GetBool(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override {
+        const std::string *pValue = Find(pchSection, pchSettingsKey, peError);
+        return pValue && (*pValue == "true" || *pValue == "1");
+      }
+
+      int32_t GetInt32(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override {
+        const std::string *pValue = Find(pchSection, pchSettingsKey, peError);
+        return pValue ? std::stoi(*pValue) : 0;
+      }
+
+      float GetFloat(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override {
+        const std::string *pValue = Find(pchSection, pchSettingsKey, peError);
+        return pValue ? std::stof(*pValue) : 0.0f;
+      }
+
+      void GetString(const char *pchSection, const char *pchSettingsKey, char *pchValue, uint32_t unValueLen, vr::EVRSettingsError *peError) override {
+        const std::string *pValue = Find(pchSection, pchSettingsKey, peError);
+        if (unValueLen == 0) {
+          return;
+        }
+
+        std::string value = pValue ? *pValue : std::string();
+        if (value.size() >= unValueLen) {
+          value.resize(unValueLen - 1);
+          if (peError) {
+            *peError = vr::VRSettingsError_ReadFailed; // Stands in for SteamVR's buffer too small error.
+          }
+        }
+        memcpy(pchValue, value.c_str(), value.size() + 1);
+      }
+
+      void RemoveSection(const char *pchSection, vr::EVRSettingsError *peError) override {
+        for (auto it = m_values.begin(); it != m_values.end();) {
+          it = it->first.first == pchSection ? m_values.erase(it) : std::next(it);
+        }
+        if (peError) {
+          *peError = vr::VRSettingsError_None;
+        }
+      }
+
+      void RemoveKeyInSection(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override {
+        m_values.erase({ pchSection, pchSettingsKey });
+        if (peError) {
+          *peError = vr::VRSettingsError_None;
+        }
+      }
+
+    private:
+      std::map<std::pair<std::string, std::string>, std::string> m_values;
+
+      void Store(const char *pchSection, const char *pchSettingsKey, const std::string &value, vr::EVRSettingsError *peError) {
+        Set(pchSection, pchSettingsKey, value);
+        if (peError) {
+          *peError = vr::VRSettingsError_None;
+        }
+      }
+
+      const std::string *Find(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) const {
+        auto it = m_values.find({ pchSection, pchSettingsKey });
+        if (peError) {
+          *peError = it != m_values.end() ? vr::VRSettingsError_None : vr::VRSettingsError_UnsetSettingHasNoDefault;
+        }
+        return it != m_values.end() ? &it->second : nullptr;
+      }
+    };
+
+    class FakeVRDriverLog : public vr::IVRDriverLog {
+    public:
+      std::vector<std::string> lines;
+
+      void Log(const char *pchLogMessage) override {
+        lines.push_back(pchLogMessage);
+      }
+    };
+
+    // Serves the fake settings and log to vr::VRSettings() and vr::VRDriverLog(), nothing else is available.
+    // Only one can be installed at a time, it stays installed until it is destroyed.
+    class FakeDriverContext : public vr::IVRDriverContext {
+    public:
+      FakeVRSettings settings;
+      FakeVRDriverLog log;
+
+      FakeDriverContext() {
+        // InitServerDriverContext would insist on every server interface, the getters fetch what they need lazily.
+        vr::VRDriverContext() = this;
+        vr::OpenVRInternal_ModuleServerDriverContext().Clear();
+      }
+
+      ~FakeDriverContext() {
+        vr::CleanupDriverContext();
+      }
+
+      FakeDriverContext(const FakeDriverContext &) = delete;
+      FakeDriverContext &operator=(const FakeDriverContext &) = delete;
+
+      void *GetGenericInterface(const char *pchInterfaceVersion, vr::EVRInitError *peError) override {
+        void *pInterface = nullptr;
+        if (strcmp(pchInterfaceVersion, vr::IVRSettings_Version) == 0) {
+          pInterface = static_cast<vr::IVRSettings *>(&settings);
+        } else if (strcmp(pchInterfaceVersion, vr::IVRDriverLog_Version) == 0) {
+          pInterface = static_cast<vr::IVRDriverLog *>(&log);
+        }
+
+        if (peError) {
+          *peError = pInterface ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+        }
+        return pInterface;
+      }
+
+      vr::DriverHandle_t GetDriverHandle() override {
+        return vr::k_ulInvalidDriverHandle;
+      }
+    };
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gaze_pipeline_stages.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // The PS VR2 driver's clock, a fixed offset from the HMD's.
+    class FakeGazeDriverInput : public GazeDriverInput {
+    public:
+      int64_t offsetUs = 0;
+      uint32_t callCount = 0;
+
+      int64_t HmdToHostTimestamp(uint32_t hmdTimestamp) override {
+        callCount++;
+        return static_cast<int64_t>(hmdTimestamp) + offsetUs;
+      }
+    };
+
+    // Keeps what SteamVR would have been told, unless only counting.
+    class FakeGazeOpenVrUpdate : public GazeOpenVrUpdate {
+    public:
+      struct Update_t {
+        Hmd2GazeState gazeState;
+        int64_t hostTimestampUs;
+      };
+
+      bool keepUpdates = true;
+      uint64_t updateCount = 0;
+      std::vector<Update_t> updates;
+
+      void Clear() {
+        updateCount = 0;
+        updates.clear();
+      }
+
+      void UpdateGaze(Hmd2GazeState *pGazeState, int64_t hostTimestampUs) override {
+        updateCount++;
+        if (keepUpdates) {
+          updates.push_back({ *pGazeState, hostTimestampUs });
+        }
+      }
+    };
+
+    // Keeps what the IPC clients would have been sent, unless only counting.
+    class FakeGazeIpcSink : public GazeIpcSink {
+    public:
+      bool keepResults = true;
+      uint64_t resultCount = 0;
+      std::vector<ipc::CommandDataServerGazeDataResult2_t> results;
+
+      void Clear() {
+        resultCount = 0;
+        results.clear();
+      }
+
+      void Publish(const ipc::CommandDataServerGazeDataResult2_t &gazeResult) override {
+        resultCount++;
+        if (keepResults) {
+          results.push_back(gazeResult);
+        }
+      }
+    };
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "process_watcher.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // Process table the test starts and ends processes in by hand.
+    // ExitProcess may be called from any thread and fires the exit callbacks on that thread, like the thread pool would.
+    class FakeProcessWatcher : public ProcessWatcher {
+    public:
+      FakeProcessWatcher(ProcessExitCallback_t pCallback, void *pUserData)
+        : m_pCallback(pCallback)
+        , m_pUserData(pUserData)
+      {}
+
+      void StartProcess(uint32_t processId) {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_running.insert(processId);
+      }
+
+      void ExitProcess(uint32_t processId) {
+        // Held while the callbacks run, so Unwatch waits for one that is already running.
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_running.erase(processId);
+
+        for (auto it = m_watches.begin(); it != m_watches.end();) {
+          if (it->second != processId) {
+            ++it;
+            continue;
+          }
+
+          uint32_t cookie = it->first;
+          it = m_watches.erase(it);
+          m_pCallback(m_pUserData, cookie);
+        }
+      }
+
+      size_t WatchCount() {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_watches.size();
+      }
+
+      bool IsProcessRunning(uint32_t processId) override {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_running.count(processId) != 0;
+      }
+
+      bool Watch(uint32_t processId, uint32_t cookie) override {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_watches.erase(cookie);
+
+        if (m_running.count(processId) == 0) {
+          return false;
+        }
+        m_watches[cookie] = processId;
+        return true;
+      }
+
+      void Unwatch(uint32_t cookie) override {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_watches.erase(cookie);
+      }
+
+    private:
+      ProcessExitCallback_t m_pCallback;
+      void *m_pUserData;
+      std::mutex m_mutex;
+      std::unordered_set<uint32_t> m_running;
+      std::unordered_map<uint32_t, uint32_t> m_watches; // Cookie to process ID.
+    };
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,161 @@
+#include "test_harness.h"
+
+#include "calibration_settings.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr double k_pi = 3.14159265358979323846;
+
+  typedef size_t (GazeCalibrationProfile::*BatchKernel_t)(const float *, const float *, float *, float *, size_t) const;
+
+  bool BitEqual(float a, float b) {
+    uint32_t bitsA, bitsB;
+    memcpy(&bitsA, &a, sizeof(a));
+    memcpy(&bitsB, &b, sizeof(b));
+    return bitsA == bitsB;
+  }
+
+  // Random points plus the ones the kernels treat specially: the center itself, the axes, where the pseudo-angle
+  // changes formula, directions through every vertex, tiny and large distances.
+  void MakeInputs(const GazeCalibrationProfile &profile, std::mt19937 &random, std::vector<float> &x, std::vector<float> &y) {
+    const Vec2d &center = profile.GetCenter();
+    const size_t sampleCount = (std::max)(profile.GetCalibrationData().size(), static_cast<size_t>(1));
+    auto add = [&](double dx, double dy) {
+      x.push_back(static_cast<float>(center.x + dx));
+      y.push_back(static_cast<float>(center.y + dy));
+    };
+
+    add(0.0, 0.0);
+    for (double distance : { 1e-7, 1e-3, 0.5, 1.0, 3.0, 1e4 }) {
+      add(distance, 0.0);
+      add(-distance, 0.0);
+      add(0.0, distance);
+      add(0.0, -distance);
+      add(distance, distance);
+      add(-distance, -distance);
+      for (size_t i = 0; i < sampleCount; i++) {
+        double angle = 2.0 * k_pi * i / sampleCount;
+        add(std::cos(angle) * distance, std::sin(angle) * distance);
+      }
+    }
+    x.push_back(-0.0f);
+    y.push_back(-0.0f);
+
+    std::uniform_real_distribution<float> coordinate(-2.0f, 2.0f);
+    for (int i = 0; i < 20000; i++) {
+      x.push_back(coordinate(random));
+      y.push_back(coordinate(random));
+    }
+  }
+
+  int CountMismatches(const GazeCalibrationProfile &profile, const std::vector<float> &x, const std::vector<float> &y,
+                      const std::vector<float> &outX, const std::vector<float> &outY, size_t count) {
+    int mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+      Hmd2Vector3 expected = profile.Remap({ x[i], y[i], 0.0f });
+      if (!BitEqual(outX[i], expected.x) || !BitEqual(outY[i], expected.y)) {
+        if (mismatches++ == 0) {
+          printf("  first mismatch at (%.9g, %.9g): (%.9g, %.9g) instead of (%.9g, %.9g)\n", x[i], y[i], outX[i], outY[i], expected.x, expected.y);
+        }
+      }
+    }
+    return mismatches;
+  }
+
+  void CheckKernel(BatchKernel_t pfnKernel, size_t width) {
+    FakeDriverContext context;
+    std::mt19937 random(12);
+    std::uniform_real_distribution<double> radius(0.4, 1.6);
+
+    std::vector<std::vector<double>> profiles = {
+      { 0.8 },
+      { 0.9, 1.1 },
+      { 0.7, 1.1, 0.9, 1.2, 0.8, 1.0, 1.05, 0.95 },
+      { 1.0, 0.0, 1.0, 1.0 }, // A vertex at the center, its segments fall back to a scale of 1.
+    };
+    for (size_t sampleCount : { 13, 64, 360 }) {
+      std::vector<double> radii;
+      for (size_t i = 0; i < sampleCount; i++) {
+        radii.push_back(radius(random));
+      }
+      profiles.push_back(radii);
+    }
+
+    for (const std::vector<double> &radii : profiles) {
+      GazeCalibrationProfile profile = LoadPolygonProfile(context, radii, 0.031, -0.017);
+      CHECK(profile.GetCalibrationData().size() == radii.size());
+
+      std::vector<float> x, y;
+      MakeInputs(profile, random, x, y);
+      std::vector<float> outX(x.size()), outY(x.size());
+
+      size_t done = (profile.*pfnKernel)(x.data(), y.data(), outX.data(), outY.data(), x.size());
+      CHECK(done == x.size() - x.size() % width);
+      CHECK(CountMismatches(profile, x, y, outX, outY, done) == 0);
+    }
+  }
+
+} // namespace
+
+TEST_CASE(Sse2KernelIsBitIdenticalToRemap) {
+  CheckKernel(&GazeCalibrationProfile::RemapBatchSse2, 4);
+}
+
+TEST_CASE(Avx2KernelIsBitIdenticalToRemap) {
+  if (!GazeCalibrationProfile::CpuHasAvx2()) {
+    printf("  no AVX2 on this CPU, skipped\n");
+    return;
+  }
+  CheckKernel(&GazeCalibrationProfile::RemapBatchAvx2, 8);
+}
+
+TEST_CASE(RemapBatchCoversTailAndRunsInPlace) {
+  FakeDriverContext context;
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, { 0.7, 1.1, 0.9, 1.2, 0.8 }, 0.02, 0.01);
+
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> coordinate(-2.0f, 2.0f);
+  for (size_t count : { 0, 1, 3, 7, 8, 9, 31, 1001 }) {
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; i++) {
+      x[i] = coordinate(random);
+      y[i] = coordinate(random);
+      z[i] = -1.0f - i;
+    }
+    std::vector<float> inX = x, inY = y, inZ = z;
+
+    profile.RemapBatch(x, y, z, x, y, z);
+
+    int mismatches = CountMismatches(profile, inX, inY, x, y, count);
+    CHECK(mismatches == 0);
+    CHECK(z == inZ);
+  }
+}
+
+TEST_CASE(RemapBatchMatchesRemapForGridModel) {
+  FakeDriverContext context;
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, { 1.0 });
+
+  GazeGridLayout layout = { .cols = 3, .rows = 3, .min = { -1.0, -1.0 }, .max = { 1.0, 1.0 }, .targets = {} };
+  for (size_t row = 0; row < 3; row++) {
+    for (size_t col = 0; col < 3; col++) {
+      layout.targets.push_back({ -1.0 + col + 0.05 * row, -1.0 + row - 0.03 * col });
+    }
+  }
+  CHECK(profile.UseGrid(layout));
+
+  std::vector<float> x = { 0.0f, 0.5f, -0.7f, 1.5f, -2.0f, 0.1f, 0.2f, 0.3f, 0.4f };
+  std::vector<float> y = { 0.0f, -0.5f, 0.2f, 1.5f, 0.3f, 0.9f, -0.8f, 0.7f, -0.6f };
+  std::vector<float> z(x.size(), -1.0f);
+  std::vector<float> outX(x.size()), outY(x.size()), outZ(x.size());
+
+  profile.RemapBatch(x, y, z, outX, outY, outZ);
+  CHECK(CountMismatches(profile, x, y, outX, outY, x.size()) == 0);
+}
@@ -0,0 +1,108 @@
+#include "bench_harness.h"
+
+#include "calibration_settings.h"
+#include "polygon_remap_reference.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  template <typename Remap>
+  double MeasureNsPerCall(const std::vector<Hmd2Vector3> &points, Remap &&remap) {
+    uint64_t callCount = 0;
+    int64_t startNs = GetBenchTimestampNs();
+    int64_t elapsedNs = 0;
+    while (elapsedNs < 300000000) {
+      float sum = 0.0f;
+      for (const Hmd2Vector3 &point : points) {
+        Hmd2Vector3 remapped = remap(point);
+        sum += remapped.x + remapped.y;
+      }
+      DoNotOptimize(sum);
+      callCount += points.size();
+      elapsedNs = GetBenchTimestampNs() - startNs;
+    }
+    return static_cast<double>(elapsedNs) / callCount;
+  }
+
+} // namespace
+
+// Cost of one Remap call with the segment table, against the polygon search it replaced, then batch throughput.
+int main() {
+  FakeDriverContext context;
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> coordinate(-1.2f, 1.2f);
+  std::vector<Hmd2Vector3> points(4096);
+  for (Hmd2Vector3 &point : points) {
+    point = { coordinate(random), coordinate(random), -1.0f };
+  }
+
+  printf("%8s %16s %16s\n", "samples", "table ns/call", "search ns/call");
+  for (size_t sampleCount : { 8, 64, 360 }) {
+    std::vector<double> radii;
+    for (size_t i = 0; i < sampleCount; i++) {
+      radii.push_back(0.8 + 0.15 * std::sin(6.283185307179586 * 3.0 * i / sampleCount));
+    }
+
+    GazeCalibrationProfile profile = LoadPolygonProfile(context, radii, 0.02, -0.01);
+    PolygonRemapReference reference(profile.GetCenter(), profile.GetCalibrationData());
+
+    double tableNs = MeasureNsPerCall(points, [&](const Hmd2Vector3 &point) { return profile.Remap(point); });
+    double searchNs = MeasureNsPerCall(points, [&](const Hmd2Vector3 &point) { return reference.Remap(point); });
+    printf("%8zu %16.1f %16.1f\n", sampleCount, tableNs, searchNs);
+  }
+
+  // Offline throughput of a recording's worth of samples, per kernel.
+  std::vector<double> radii;
+  for (size_t i = 0; i < 64; i++) {
+    radii.push_back(0.8 + 0.15 * std::sin(6.283185307179586 * 3.0 * i / 64));
+  }
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, radii, 0.02, -0.01);
+
+  constexpr size_t k_unSampleCount = 1 << 16;
+  std::vector<float> x(k_unSampleCount), y(k_unSampleCount), z(k_unSampleCount, -1.0f);
+  std::vector<float> outX(k_unSampleCount), outY(k_unSampleCount), outZ(k_unSampleCount);
+  for (size_t i = 0; i < k_unSampleCount; i++) {
+    x[i] = coordinate(random);
+    y[i] = coordinate(random);
+  }
+
+  auto measureMSamplesPerSecond = [&](auto &&remapAll) {
+    uint64_t sampleCount = 0;
+    int64_t startNs = GetBenchTimestampNs();
+    int64_t elapsedNs = 0;
+    while (elapsedNs < 300000000) {
+      remapAll();
+      DoNotOptimize(outX[k_unSampleCount - 1]);
+      sampleCount += k_unSampleCount;
+      elapsedNs = GetBenchTimestampNs() - startNs;
+    }
+    return sampleCount * 1e3 / elapsedNs;
+  };
+
+  printf("\n%-12s %12s\n", "kernel", "Msamples/s");
+  printf("%-12s %12.1f\n", "Remap loop", measureMSamplesPerSecond([&]() {
+    for (size_t i = 0; i < k_unSampleCount; i++) {
+      Hmd2Vector3 remapped = profile.Remap({ x[i], y[i], z[i] });
+      outX[i] = remapped.x;
+      outY[i] = remapped.y;
+    }
+  }));
+  printf("%-12s %12.1f\n", "SSE2", measureMSamplesPerSecond([&]() {
+    profile.RemapBatchSse2(x.data(), y.data(), outX.data(), outY.data(), k_unSampleCount);
+  }));
+  if (GazeCalibrationProfile::CpuHasAvx2()) {
+    printf("%-12s %12.1f\n", "AVX2", measureMSamplesPerSecond([&]() {
+      profile.RemapBatchAvx2(x.data(), y.data(), outX.data(), outY.data(), k_unSampleCount);
+    }));
+  }
+  printf("%-12s %12.1f\n", "RemapBatch", measureMSamplesPerSecond([&]() {
+    profile.RemapBatch(x, y, z, outX, outY, outZ);
+  }));
+  return 0;
+}
@@ -0,0 +1,249 @@
+#include "test_harness.h"
+
+#include "fake_driver_context.h"
+
+#include "gaze_calibration_session.h"
+#include "gaze_calibration_solver.h"
+#include "vr_settings.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  // A smooth, mildly non-linear distortion from centered raw gaze to target, of the kind the quadratic fit can express.
+  Vec2d KnownWarp(const Vec2d &gaze) {
+    double x = gaze.x;
+    double y = gaze.y;
+    return {
+      0.02 + 1.10 * x + 0.05 * y + 0.08 * x * x - 0.04 * x * y + 0.06 * y * y,
+      -0.03 + 0.04 * x + 0.95 * y - 0.05 * x * x + 0.07 * x * y + 0.09 * y * y,
+    };
+  }
+
+  // One fixation's worth of samples: jitter around the true gaze, with a share of them thrown anywhere.
+  std::vector<Vec2d> FixationSamples(const Vec2d &gaze, std::mt19937 &random, int sampleCount, double outlierRate) {
+    std::normal_distribution<double> jitter(0.0, 0.01);
+    std::uniform_real_distribution<double> anywhere(-1.0, 1.0);
+    std::bernoulli_distribution isOutlier(outlierRate);
+
+    std::vector<Vec2d> samples;
+    for (int i = 0; i < sampleCount; i++) {
+      if (isOutlier(random)) {
+        samples.push_back({ anywhere(random), anywhere(random) });
+      } else {
+        samples.push_back({ gaze.x + jitter(random), gaze.y + jitter(random) });
+      }
+    }
+    return samples;
+  }
+
+  // Fixations on a 5x5 grid over [-0.6, 0.6], each estimated from noisy samples before it is added.
+  void AddFixations(GazeCalibrationSolver &solver, std::mt19937 &random, double outlierRate) {
+    for (int row = 0; row < 5; row++) {
+      for (int col = 0; col < 5; col++) {
+        Vec2d gaze = { -0.6 + 0.3 * col, -0.6 + 0.3 * row };
+
+        std::vector<Vec2d> samples = FixationSamples(gaze, random, 150, outlierRate);
+        GazeCalibrationSolver::FixationEstimate estimate;
+        CHECK(GazeCalibrationSolver::EstimateFixation(samples, &estimate));
+        CHECK(estimate.kept + estimate.rejected == samples.size());
+        if (outlierRate > 0.0) {
+          CHECK(estimate.rejected > 0);
+        }
+
+        solver.AddPoint(estimate.gaze, KnownWarp(gaze));
+      }
+    }
+  }
+
+  Hmd2GazeState GazeStateAt(float x, float y) {
+    Hmd2GazeState state = {};
+    for (Hmd2GazeEye *pEye : { &state.leftEye, &state.rightEye }) {
+      pEye->isGazeDirValid = HMD2_BOOL_TRUE;
+      pEye->gazeDirNorm = { x, y, -1.0f };
+    }
+    return state;
+  }
+
+  CommandDataServerGazeCalibrationStatus_t SendCommand(GazeCalibrationSession &session, ECommandType type, void *pData = nullptr, int32_t dataLen = 0) {
+    CommandHeader_t header = { type, dataLen };
+    CommandDataServerGazeCalibrationStatus_t status = {};
+    CHECK(session.HandleIpcCommand(1, &header, pData, &status));
+    return status;
+  }
+
+  // Runs a whole session through the IPC commands, every sample of a point at gaze(target), and stops with apply set.
+  template <typename F>
+  bool RunSession(GazeCalibrationSession &session, F &&gaze) {
+    SendCommand(session, Command_ClientStartGazeCalibration);
+
+    uint64_t timestampUs = 0;
+    for (int row = 0; row < 3; row++) {
+      for (int col = 0; col < 3; col++) {
+        CommandDataClientSetGazeCalibrationPoint_t point = { -0.4f + 0.4f * col, -0.4f + 0.4f * row };
+        SendCommand(session, Command_ClientSetGazeCalibrationPoint, &point, sizeof(point));
+
+        // Past the settle time, at the 240 Hz the headset reports gaze at.
+        Vec2d raw = gaze(Vec2d{ point.targetX, point.targetY });
+        for (int i = 0; i < 180; i++) {
+          session.AddSample(GazeStateAt(static_cast<float>(raw.x), static_cast<float>(raw.y)), timestampUs);
+          timestampUs += 4167;
+        }
+      }
+    }
+
+    CommandDataClientStopGazeCalibration_t stop = { true };
+    return SendCommand(session, Command_ClientStopGazeCalibration, &stop, sizeof(stop)).isApplied;
+  }
+
+} // namespace
+
+TEST_CASE(RecoversKnownWarpDespiteOutliers) {
+  std::mt19937 random(15);
+  GazeCalibrationSolver solver;
+  AddFixations(solver, random, 0.15);
+
+  CHECK(solver.HasFit());
+  CHECK(solver.GetPointCount() == 25);
+  CHECK(solver.GetRmsError() < 0.005);
+
+  // Anywhere inside the fixations, not just at them.
+  for (double y = -0.6; y <= 0.6; y += 0.05) {
+    for (double x = -0.6; x <= 0.6; x += 0.05) {
+      Vec2d expected = KnownWarp({ x, y });
+      Vec2d actual = solver.Evaluate({ x, y });
+      CHECK_NEAR(actual.x, expected.x, 0.005);
+      CHECK_NEAR(actual.y, expected.y, 0.005);
+    }
+  }
+}
+
+TEST_CASE(SampledGridMatchesKnownWarp) {
+  std::mt19937 random(16);
+  GazeCalibrationSolver solver;
+  AddFixations(solver, random, 0.15);
+
+  // The node count the session applies with.
+  GazeGridLayout layout;
+  CHECK(solver.SampleGrid(9, 9, &layout));
+  CHECK(layout.min.x < -0.6 && layout.min.y < -0.6 && layout.max.x > 0.6 && layout.max.y > 0.6);
+
+  GazeGridWarp warp;
+  CHECK(warp.Build(layout));
+
+  for (double y = -0.6; y <= 0.6; y += 0.05) {
+    for (double x = -0.6; x <= 0.6; x += 0.05) {
+      Vec2d expected = KnownWarp({ x, y });
+      Hmd2Vector3 actual = warp.Apply({ static_cast<float>(x), static_cast<float>(y), -1.0f });
+      CHECK_NEAR(actual.x, expected.x, 0.005);
+      CHECK_NEAR(actual.y, expected.y, 0.005);
+    }
+  }
+}
+
+TEST_CASE(OutliersDontMoveTheFixation) {
+  std::mt19937 random(17);
+  Vec2d gaze = { 0.25, -0.35 };
+
+  for (double outlierRate : { 0.0, 0.1, 0.3 }) {
+    std::vector<Vec2d> samples = FixationSamples(gaze, random, 200, outlierRate);
+    GazeCalibrationSolver::FixationEstimate estimate;
+    CHECK(GazeCalibrationSolver::EstimateFixation(samples, &estimate));
+    CHECK_NEAR(estimate.gaze.x, gaze.x, 0.003);
+    CHECK_NEAR(estimate.gaze.y, gaze.y, 0.003);
+  }
+
+  // Too few samples to trust.
+  std::vector<Vec2d> samples = FixationSamples(gaze, random, 5, 0.0);
+  GazeCalibrationSolver::FixationEstimate estimate;
+  CHECK(!GazeCalibrationSolver::EstimateFixation(samples, &estimate));
+}
+
+TEST_CASE(SessionAppliesGrid) {
+  FakeDriverContext context;
+  GazeCalibrationSession session;
+
+  bool applied = RunSession(session, [](const Vec2d &target) {
+    return Vec2d{ target.x * 0.9 + 0.01, target.y * 1.1 - 0.02 };
+  });
+
+  CHECK(applied);
+  CHECK(context.settings.Get(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL) == "grid");
+  CHECK(context.settings.Has(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Grid"));
+  CHECK(context.settings.Has(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "RightEye_Grid"));
+
+  // The reload the save triggers must read the grid back, not fall back to the polygon model.
+  GazeCalibrationProfile profile;
+  profile.LoadConfig("LeftEye");
+  CHECK(profile.GetModel() == GazeCalibrationProfile::Model::Grid);
+}
+
+TEST_CASE(SessionWithoutUsableGridLeavesModelAlone) {
+  FakeDriverContext context;
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL, "polygon");
+  GazeCalibrationSession session;
+
+  // NaN gaze the headset still marks as valid gives a fit, but one whose grid can't be built.
+  bool applied = RunSession(session, [](const Vec2d &) {
+    return Vec2d{ NAN, NAN };
+  });
+
+  CHECK(!applied);
+  CHECK(context.settings.Get(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL) == "polygon");
+  CHECK(!context.settings.Has(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Grid"));
+  CHECK(!context.settings.Has(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "RightEye_Grid"));
+}
+
+TEST_CASE(LargestGridReadsBack) {
+  FakeDriverContext context;
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL, "grid");
+
+  // 12 by 12 nodes, each displaced by an amount that prints as wide as a displacement can.
+  GazeGridLayout layout = { .cols = 12, .rows = 12, .min = { -1.0, -1.0 }, .max = { 1.0, 1.0 }, .targets = {} };
+  for (size_t row = 0; row < layout.rows; row++) {
+    for (size_t col = 0; col < layout.cols; col++) {
+      layout.targets.push_back({ -1.0 + 2.0 * col / (layout.cols - 1) - 1.23456789e-7, -1.0 + 2.0 * row / (layout.rows - 1) - 1.23456789e-7 });
+    }
+  }
+  CHECK(layout.cols * layout.rows == GazeCalibrationProfile::MAX_GRID_NODES);
+
+  GazeCalibrationProfile profile;
+  CHECK(profile.UseGrid(layout));
+  GazeCalibrationProfile::SaveGridConfig("LeftEye", layout);
+  CHECK(context.settings.Get(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Grid").size() > 3000);
+
+  GazeCalibrationProfile loaded;
+  loaded.LoadConfig("LeftEye");
+  CHECK(loaded.GetModel() == GazeCalibrationProfile::Model::Grid);
+}
+
+TEST_CASE(GridTooLargeForTheSettingsIsRejected) {
+  FakeDriverContext context;
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL, "grid");
+
+  GazeGridLayout layout = { .cols = 13, .rows = 12, .min = { -1.0, -1.0 }, .max = { 1.0, 1.0 }, .targets = {} };
+  std::string grid;
+  for (size_t row = 0; row < layout.rows; row++) {
+    for (size_t col = 0; col < layout.cols; col++) {
+      layout.targets.push_back({ -1.0 + 2.0 * col / (layout.cols - 1), -1.0 + 2.0 * row / (layout.rows - 1) });
+      grid += grid.empty() ? "0 0" : " 0 0";
+    }
+  }
+
+  GazeCalibrationProfile profile;
+  CHECK(!profile.UseGrid(layout));
+  CHECK(profile.GetModel() == GazeCalibrationProfile::Model::Polygon);
+
+  // Even if it would fit written out this short, a hand-edited grid over the limit isn't loaded either.
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_GridSize", "13 12");
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, "LeftEye_Grid", grid);
+  profile.LoadConfig("LeftEye");
+  CHECK(profile.GetModel() == GazeCalibrationProfile::Model::Polygon);
+}
@@ -0,0 +1,128 @@
+#include "test_harness.h"
+
+#include "calibration_settings.h"
+#include "polygon_remap_reference.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr double k_pi = 3.14159265358979323846;
+
+  // Largest difference between Remap and the old polygon search over random gaze points, up to 1.5 from the center.
+  double MaxDifference(const GazeCalibrationProfile &profile, std::mt19937 &random, int pointCount) {
+    PolygonRemapReference reference(profile.GetCenter(), profile.GetCalibrationData());
+    std::uniform_real_distribution<float> coordinate(-1.5f, 1.5f);
+
+    double maxDifference = 0.0;
+    for (int i = 0; i < pointCount; i++) {
+      Hmd2Vector3 raw = { coordinate(random), coordinate(random), -1.0f };
+      Hmd2Vector3 actual = profile.Remap(raw);
+      Hmd2Vector3 expected = reference.Remap(raw);
+
+      maxDifference = (std::max)(maxDifference, static_cast<double>(std::abs(actual.x - expected.x)));
+      maxDifference = (std::max)(maxDifference, static_cast<double>(std::abs(actual.y - expected.y)));
+      if (actual.z != raw.z) {
+        maxDifference = INFINITY;
+      }
+    }
+    return maxDifference;
+  }
+
+} // namespace
+
+TEST_CASE(SmoothProfilesMatchPolygonSearch) {
+  FakeDriverContext context;
+  std::mt19937 random(11);
+
+  for (size_t sampleCount : { 3, 8, 16, 37, 64, 100, 360 }) {
+    std::vector<double> radii;
+    for (size_t i = 0; i < sampleCount; i++) {
+      double angle = 2.0 * k_pi * i / sampleCount;
+      radii.push_back(0.8 + 0.15 * std::sin(3.0 * angle) + 0.05 * std::cos(angle));
+    }
+
+    GazeCalibrationProfile profile = LoadPolygonProfile(context, radii, 0.03, -0.02);
+    CHECK(profile.GetModel() == GazeCalibrationProfile::Model::Polygon);
+    CHECK(profile.GetCalibrationData().size() == sampleCount);
+    CHECK_NEAR(MaxDifference(profile, random, 20000), 0.0, 1e-5);
+  }
+}
+
+TEST_CASE(JaggedProfilesMatchPolygonSearch) {
+  FakeDriverContext context;
+  std::mt19937 random(12);
+  std::uniform_real_distribution<double> radius(0.4, 1.6);
+
+  for (size_t sampleCount = 2; sampleCount <= 64; sampleCount++) {
+    for (int profileIndex = 0; profileIndex < 4; profileIndex++) {
+      std::vector<double> radii;
+      for (size_t i = 0; i < sampleCount; i++) {
+        radii.push_back(radius(random));
+      }
+
+      GazeCalibrationProfile profile = LoadPolygonProfile(context, radii);
+      CHECK(profile.GetCalibrationData().size() == sampleCount);
+      CHECK_NEAR(MaxDifference(profile, random, 5000), 0.0, 1e-5);
+    }
+  }
+}
+
+TEST_CASE(PointsOnVerticesAndAxesMatchPolygonSearch) {
+  FakeDriverContext context;
+  std::mt19937 random(13);
+
+  // Directions exactly on a vertex or an axis are where the segment lookup switches from one segment to the next.
+  for (size_t sampleCount : { 4, 6, 8, 12, 90 }) {
+    std::vector<double> radii;
+    for (size_t i = 0; i < sampleCount; i++) {
+      radii.push_back(i % 2 ? 0.7 : 1.1);
+    }
+
+    GazeCalibrationProfile profile = LoadPolygonProfile(context, radii);
+    CHECK(profile.GetCalibrationData().size() == sampleCount);
+    PolygonRemapReference reference(profile.GetCenter(), profile.GetCalibrationData());
+
+    for (size_t i = 0; i < sampleCount * 4; i++) {
+      double angle = 2.0 * k_pi * i / (sampleCount * 4);
+      for (double distance : { 0.01, 0.5, 1.3 }) {
+        Hmd2Vector3 raw = { static_cast<float>(std::cos(angle) * distance), static_cast<float>(std::sin(angle) * distance), -1.0f };
+        Hmd2Vector3 actual = profile.Remap(raw);
+        Hmd2Vector3 expected = reference.Remap(raw);
+        CHECK_NEAR(actual.x, expected.x, 1e-5);
+        CHECK_NEAR(actual.y, expected.y, 1e-5);
+      }
+    }
+  }
+}
+
+TEST_CASE(SingleSampleIsACircle) {
+  FakeDriverContext context;
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, { 0.5 });
+
+  Hmd2Vector3 remapped = profile.Remap({ 0.3f, -0.4f, -1.0f });
+  CHECK_NEAR(remapped.x, 0.6, 1e-6);
+  CHECK_NEAR(remapped.y, -0.8, 1e-6);
+}
+
+TEST_CASE(EmptyProfileOnlyAppliesTheCenter) {
+  FakeDriverContext context;
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, {}, 0.1, 0.2);
+
+  Hmd2Vector3 remapped = profile.Remap({ 0.3f, -0.4f, -1.0f });
+  CHECK_NEAR(remapped.x, 0.2, 1e-6);
+  CHECK_NEAR(remapped.y, -0.6, 1e-6);
+  CHECK(remapped.z == -1.0f);
+}
+
+TEST_CASE(CenterMapsToCenter) {
+  FakeDriverContext context;
+  GazeCalibrationProfile profile = LoadPolygonProfile(context, { 0.9, 1.0, 1.1, 1.0 }, 0.05, 0.05);
+
+  Hmd2Vector3 remapped = profile.Remap({ 0.05f, 0.05f, -1.0f });
+  CHECK(remapped.x == 0.0f && remapped.y == 0.0f);
+}
@@ -0,0 +1,267 @@
+#include "test_harness.h"
+
+#include "gaze_event_scoring.h"
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr int64_t k_sampleIntervalUs = 4167;
+
+  struct SyntheticGaze_t {
+    int64_t hostTimestampUs;
+    bool isValid;
+    float x, y;
+    char label;
+  };
+
+  // Fixations with tracker noise, joined by minimum jerk saccades, with the odd blink in between.
+  // Saccade durations follow the usual main sequence, about 21 ms plus 2.2 ms per degree.
+  std::vector<SyntheticGaze_t> MakeSyntheticGaze(std::mt19937 &random, int fixationCount) {
+    std::uniform_real_distribution<float> position(-0.4f, 0.4f);
+    std::uniform_int_distribution<int64_t> fixationUs(150000, 450000);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::bernoulli_distribution isBlink(0.1);
+
+    std::vector<SyntheticGaze_t> gaze;
+    int64_t timestampUs = 1000000;
+    float x = 0.0f;
+    float y = 0.0f;
+
+    for (int fixation = 0; fixation < fixationCount; fixation++) {
+      for (int64_t endUs = timestampUs + fixationUs(random); timestampUs < endUs; timestampUs += k_sampleIntervalUs) {
+        gaze.push_back({ timestampUs, true, x + noise(random), y + noise(random), 'F' });
+      }
+
+      if (isBlink(random)) {
+        for (int64_t endUs = timestampUs + 80000; timestampUs < endUs; timestampUs += k_sampleIntervalUs) {
+          gaze.push_back({ timestampUs, false, 0.0f, 0.0f, '-' });
+        }
+        continue;
+      }
+
+      // Far enough that even the shortest saccade is clearly one.
+      float targetX, targetY, amplitude;
+      do {
+        targetX = position(random);
+        targetY = position(random);
+        amplitude = std::hypot(targetX - x, targetY - y);
+      } while (amplitude < 0.1f);
+
+      int64_t durationUs = 21000 + static_cast<int64_t>(2200.0f * amplitude * 57.3f);
+      int64_t startUs = timestampUs;
+      for (; timestampUs - startUs < durationUs; timestampUs += k_sampleIntervalUs) {
+        float t = static_cast<float>(timestampUs - startUs) / durationUs;
+        float s = t * t * t * (10.0f - 15.0f * t + 6.0f * t * t);
+        gaze.push_back({ timestampUs, true, x + (targetX - x) * s + noise(random), y + (targetY - y) * s + noise(random), 'S' });
+      }
+      x = targetX;
+      y = targetY;
+    }
+
+    return gaze;
+  }
+
+  GazeVector3 DirectionOf(const SyntheticGaze_t &gaze) {
+    return { gaze.x, gaze.y, -std::sqrt(1.0f - gaze.x * gaze.x - gaze.y * gaze.y) };
+  }
+
+  std::string TempPath(const char *pchName) {
+    return (std::filesystem::temp_directory_path() / pchName).string();
+  }
+
+  void WriteLabeledCsv(const std::string &path, const std::vector<SyntheticGaze_t> &gaze) {
+    FILE *pFile = fopen(path.c_str(), "w");
+    fprintf(pFile, "sequence,host_timestamp_us,valid,x,y,z,label\n");
+    for (size_t i = 0; i < gaze.size(); i++) {
+      GazeVector3 direction = DirectionOf(gaze[i]);
+      fprintf(pFile, "%zu,%lld,%d,%.9g,%.9g,%.9g,%c\n", i + 1, static_cast<long long>(gaze[i].hostTimestampUs), gaze[i].isValid ? 1 : 0,
+              direction.x, direction.y, direction.z, gaze[i].label);
+    }
+    fclose(pFile);
+  }
+
+  // A recording like GazeRecorder leaves behind when stopped cleanly, cut off after the last frame.
+  void WriteRecording(const std::string &path, const std::vector<SyntheticGaze_t> &gaze) {
+    std::vector<uint8_t> headerRegion(k_unGazeRecordingHeaderSize);
+    GazeRecordingHeader_t *pHeader = reinterpret_cast<GazeRecordingHeader_t *>(headerRegion.data());
+    pHeader->magic = k_unGazeRecordingMagic;
+    pHeader->version = k_unGazeRecordingVersion;
+    pHeader->headerSize = k_unGazeRecordingHeaderSize;
+    pHeader->chunkSize = k_unGazeRecordingChunkSize;
+    pHeader->frameSize = sizeof(GazeRecordingFrame_t);
+    pHeader->stateSize = k_unGazeRecordingStateSize;
+    pHeader->chunkCount = 1;
+    pHeader->frameCount = gaze.size();
+    pHeader->isComplete = true;
+    pHeader->chunks[0].fileOffset = k_unGazeRecordingHeaderSize;
+    pHeader->chunks[0].firstSequence = 1;
+    pHeader->chunks[0].frameCount = static_cast<uint32_t>(gaze.size());
+
+    FILE *pFile = fopen(path.c_str(), "wb");
+    fwrite(headerRegion.data(), 1, headerRegion.size(), pFile);
+    for (size_t i = 0; i < gaze.size(); i++) {
+      GazeVector3 direction = DirectionOf(gaze[i]);
+      Hmd2Bool isValid = gaze[i].isValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+
+      Hmd2GazeState state = {};
+      for (Hmd2GazeEye *pEye : { &state.leftEye, &state.rightEye }) {
+        pEye->isGazeDirValid = isValid;
+        pEye->gazeDirNorm = { direction.x, direction.y, direction.z };
+      }
+      state.combined.isGazeDirValid = isValid;
+      state.combined.gazeDirNorm = { direction.x, direction.y, direction.z };
+
+      GazeRecordingFrame_t frame = {};
+      frame.sequence = i + 1;
+      frame.hmdTimestampUs = static_cast<uint64_t>(gaze[i].hostTimestampUs);
+      frame.hostTimestampUs = gaze[i].hostTimestampUs;
+      memcpy(frame.calibratedState, &state, sizeof(state));
+      fwrite(&frame, sizeof(frame), 1, pFile);
+    }
+    fclose(pFile);
+  }
+
+  void WriteSequenceLabels(const std::string &path, const std::vector<SyntheticGaze_t> &gaze) {
+    FILE *pFile = fopen(path.c_str(), "w");
+    fprintf(pFile, "sequence,label\n");
+    for (size_t i = 0; i < gaze.size(); i++) {
+      fprintf(pFile, "%zu,%c\n", i + 1, gaze[i].label);
+    }
+    fclose(pFile);
+  }
+
+  bool SameScore(const EventScore_t &a, const EventScore_t &b) {
+    return a.labeledCount == b.labeledCount && a.classifiedCount == b.classifiedCount && a.matchedCount == b.matchedCount;
+  }
+
+} // namespace
+
+TEST_CASE(MatchingNeedsHalfOverlapAndIsOneToOne) {
+  std::vector<EventSpan_t> labeled = {
+    { false, 1, 41 },
+    { true, 41, 51 },
+    { false, 51, 91 },
+  };
+
+  // Exact.
+  EventScore_t score = MatchEvents(labeled, labeled, false);
+  CHECK(score.labeledCount == 2 && score.classifiedCount == 2 && score.matchedCount == 2);
+
+  // A saccade found two samples late and one short still matches, 7 of 10 samples.
+  score = MatchEvents(labeled, { { true, 43, 50 } }, true);
+  CHECK(score.matchedCount == 1);
+
+  // One fixation split in two halves matches at most once, and only if a half covers half of the union.
+  score = MatchEvents(labeled, { { false, 1, 21 }, { false, 21, 41 } }, false);
+  CHECK(score.classifiedCount == 2 && score.matchedCount == 1);
+  score = MatchEvents(labeled, { { false, 1, 20 }, { false, 20, 41 } }, false);
+  CHECK(score.matchedCount == 1);
+  score = MatchEvents(labeled, { { false, 1, 14 }, { false, 14, 27 }, { false, 27, 41 } }, false);
+  CHECK(score.matchedCount == 0);
+
+  // Two fixations merged into one covers neither well enough.
+  score = MatchEvents(labeled, { { false, 1, 91 } }, false);
+  CHECK(score.matchedCount == 0);
+
+  // A saccade isn't a fixation.
+  score = MatchEvents(labeled, { { true, 1, 41 } }, false);
+  CHECK(score.classifiedCount == 0 && score.matchedCount == 0);
+}
+
+TEST_CASE(LabeledRunsBecomeEvents) {
+  std::vector<LabeledSample_t> samples(10);
+  const char *pchLabels = "FFFSSFF--F";
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = {};
+    // A dropped frame after the second sample splits the first run.
+    samples[i].gazeResult.sequence = i < 2 ? i + 1 : i + 2;
+    samples[i].label = pchLabels[i];
+  }
+
+  std::vector<EventSpan_t> events = GetLabeledEvents(samples);
+  CHECK(events.size() == 5);
+  if (events.size() == 5) {
+    CHECK(!events[0].isSaccade && events[0].firstSequence == 1 && events[0].endSequence == 3);
+    CHECK(!events[1].isSaccade && events[1].firstSequence == 4 && events[1].endSequence == 5);
+    CHECK(events[2].isSaccade && events[2].firstSequence == 5 && events[2].endSequence == 7);
+    CHECK(!events[3].isSaccade && events[3].firstSequence == 7 && events[3].endSequence == 9);
+    CHECK(!events[4].isSaccade && events[4].firstSequence == 11 && events[4].endSequence == 12);
+  }
+}
+
+TEST_CASE(ClassifierScoresWellOnSyntheticGaze) {
+  std::mt19937 random(18);
+  std::vector<SyntheticGaze_t> gaze = MakeSyntheticGaze(random, 300);
+
+  std::string csvPath = TempPath("gaze_event_classifier_test.csv");
+  WriteLabeledCsv(csvPath, gaze);
+
+  std::vector<LabeledSample_t> samples;
+  std::string error;
+  CHECK(LoadLabeledCsv(csvPath, &samples, &error));
+  CHECK(samples.size() == gaze.size());
+  std::filesystem::remove(csvPath);
+
+  ClassifierScore_t score = ScoreClassifier(samples);
+  printf("fixations: %u labeled, %u classified, precision %.3f, recall %.3f\n",
+         score.fixations.labeledCount, score.fixations.classifiedCount, score.fixations.Precision(), score.fixations.Recall());
+  printf("saccades: %u labeled, %u classified, precision %.3f, recall %.3f\n",
+         score.saccades.labeledCount, score.saccades.classifiedCount, score.saccades.Precision(), score.saccades.Recall());
+
+  CHECK(score.fixations.labeledCount == 300);
+  CHECK(score.fixations.Precision() >= 0.95);
+  CHECK(score.fixations.Recall() >= 0.95);
+  CHECK(score.saccades.labeledCount > 200);
+  CHECK(score.saccades.Precision() >= 0.95);
+  CHECK(score.saccades.Recall() >= 0.95);
+
+  // Each eye sees the same gaze here, so it scores the same as the combined gaze.
+  CHECK(SameScore(ScoreClassifier(samples, GazeEventSource_LeftEye).saccades, score.saccades));
+}
+
+TEST_CASE(RecordingScoresLikeItsCsv) {
+  std::mt19937 random(19);
+  std::vector<SyntheticGaze_t> gaze = MakeSyntheticGaze(random, 40);
+
+  std::string csvPath = TempPath("gaze_event_classifier_test_recording.csv");
+  std::string recordingPath = TempPath("gaze_event_classifier_test" GAZE_RECORDING_FILE_EXTENSION);
+  std::string labelsPath = TempPath("gaze_event_classifier_test_labels.csv");
+  WriteLabeledCsv(csvPath, gaze);
+  WriteRecording(recordingPath, gaze);
+  WriteSequenceLabels(labelsPath, gaze);
+
+  std::vector<LabeledSample_t> fromCsv;
+  std::vector<LabeledSample_t> fromRecording;
+  std::string error;
+  CHECK(LoadLabeledCsv(csvPath, &fromCsv, &error));
+  CHECK(LoadRecording(recordingPath, &fromRecording, &error));
+  CHECK(fromRecording.size() == gaze.size());
+
+  // Unlabeled until the labels are applied.
+  CHECK(ScoreClassifier(fromRecording).fixations.labeledCount == 0);
+  CHECK(LoadSequenceLabels(labelsPath, &fromRecording, &error));
+
+  ClassifierScore_t csvScore = ScoreClassifier(fromCsv);
+  ClassifierScore_t recordingScore = ScoreClassifier(fromRecording);
+  CHECK(csvScore.fixations.labeledCount > 0);
+  CHECK(SameScore(csvScore.fixations, recordingScore.fixations));
+  CHECK(SameScore(csvScore.saccades, recordingScore.saccades));
+
+  // Not a recording.
+  CHECK(!LoadRecording(csvPath, &fromRecording, &error));
+  CHECK(!LoadRecording(TempPath("gaze_event_classifier_test_missing" GAZE_RECORDING_FILE_EXTENSION), &fromRecording, &error));
+
+  std::filesystem::remove(csvPath);
+  std::filesystem::remove(recordingPath);
+  std::filesystem::remove(labelsPath);
+}
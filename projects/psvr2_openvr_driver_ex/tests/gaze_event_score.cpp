@@ -0,0 +1,80 @@
+#include "gaze_event_scoring.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+// Scores the gaze event classifier against labeled gaze.
+//   gaze_event_score [--source left|right|combined] <labeled.csv>
+//   gaze_event_score [--source left|right|combined] <recording.pvgr> <labels.csv>
+// See gaze_event_scoring.h for the file formats and how events are matched.
+
+namespace {
+
+  void PrintScore(const char *pchKind, const EventScore_t &score) {
+    printf("%-10s %8u %10u %8u %10.3f %8.3f\n", pchKind, score.labeledCount, score.classifiedCount, score.matchedCount,
+           score.Precision(), score.Recall());
+  }
+
+  int Usage() {
+    fprintf(stderr, "usage: gaze_event_score [--source left|right|combined] <labeled.csv>\n"
+                    "       gaze_event_score [--source left|right|combined] <recording.pvgr> <labels.csv>\n");
+    return 2;
+  }
+
+  bool EndsWith(const std::string &value, const char *pchSuffix) {
+    size_t length = strlen(pchSuffix);
+    return value.size() >= length && value.compare(value.size() - length, length, pchSuffix) == 0;
+  }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  EGazeEventSource source = GazeEventSource_Combined;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+      const char *pchSource = argv[++i];
+      if (strcmp(pchSource, "left") == 0) {
+        source = GazeEventSource_LeftEye;
+      } else if (strcmp(pchSource, "right") == 0) {
+        source = GazeEventSource_RightEye;
+      } else if (strcmp(pchSource, "combined") == 0) {
+        source = GazeEventSource_Combined;
+      } else {
+        return Usage();
+      }
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  std::vector<LabeledSample_t> samples;
+  std::string error;
+  bool isLoaded = false;
+  if (paths.size() == 1 && !EndsWith(paths[0], GAZE_RECORDING_FILE_EXTENSION)) {
+    isLoaded = LoadLabeledCsv(paths[0], &samples, &error);
+  } else if (paths.size() == 2 && EndsWith(paths[0], GAZE_RECORDING_FILE_EXTENSION)) {
+    isLoaded = LoadRecording(paths[0], &samples, &error) && LoadSequenceLabels(paths[1], &samples, &error);
+  } else {
+    return Usage();
+  }
+
+  if (!isLoaded) {
+    fprintf(stderr, "gaze_event_score: %s\n", error.c_str());
+    return 1;
+  }
+
+  ClassifierScore_t score = ScoreClassifier(samples, source);
+
+  printf("%zu samples, events match at %.0f%% overlap\n", samples.size(), k_minEventOverlap * 100.0);
+  printf("%-10s %8s %10s %8s %10s %8s\n", "event", "labeled", "classified", "matched", "precision", "recall");
+  PrintScore("fixation", score.fixations);
+  PrintScore("saccade", score.saccades);
+  return 0;
+}
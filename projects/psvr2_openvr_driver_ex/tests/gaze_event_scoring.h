@@ -0,0 +1,350 @@
+#pragma once
+
+#include "gaze_event_classifier.h"
+#include "hmd2_gaze.h"
+#include "ipc_gaze_result.h"
+#include "../shared/gaze_recording.h"
+#include "../shared/ipc_protocol.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // Scores GazeEventClassifier against hand-labeled gaze, event by event.
+    // Labels are per sample: 'F' fixation, 'S' saccade, '-' anything else (blinks, pursuit, unlabeled).
+    // A run of samples with the same label is one labeled event. A classified event matches a labeled event of the
+    // same kind when they overlap by at least half of their union, and every event matches at most once.
+
+    static_assert(sizeof(Hmd2GazeState) == k_unGazeRecordingStateSize);
+
+    struct LabeledSample_t {
+      ipc::CommandDataServerGazeDataResult2_t gazeResult;
+      char label;
+    };
+
+    // Samples [firstSequence, endSequence).
+    struct EventSpan_t {
+      bool isSaccade;
+      uint64_t firstSequence;
+      uint64_t endSequence;
+    };
+
+    struct EventScore_t {
+      uint32_t labeledCount;
+      uint32_t classifiedCount;
+      uint32_t matchedCount;
+
+      double Precision() const { return classifiedCount ? static_cast<double>(matchedCount) / classifiedCount : 1.0; }
+      double Recall() const { return labeledCount ? static_cast<double>(matchedCount) / labeledCount : 1.0; }
+    };
+
+    struct ClassifierScore_t {
+      EventScore_t fixations;
+      EventScore_t saccades;
+    };
+
+    static constexpr double k_minEventOverlap = 0.5;
+
+    inline std::vector<std::string> SplitCsvLine(const std::string &line) {
+      std::vector<std::string> fields;
+      std::stringstream stream(line);
+      std::string field;
+      while (std::getline(stream, field, ',')) {
+        while (!field.empty() && (field.back() == '\r' || field.back() == ' ')) {
+          field.pop_back();
+        }
+        size_t start = field.find_first_not_of(' ');
+        fields.push_back(start == std::string::npos ? std::string() : field.substr(start));
+      }
+      return fields;
+    }
+
+    inline bool IsLabel(const std::string &field) {
+      return field == "F" || field == "S" || field == "-";
+    }
+
+    // One gaze direction per row, used for both eyes and the combined gaze:
+    //   sequence,host_timestamp_us,valid,x,y,z,label
+    // The sequence and valid columns are optional, rows are numbered from 1 and valid if they are left out.
+    inline bool LoadLabeledCsv(const std::string &path, std::vector<LabeledSample_t> *pSamples, std::string *pError) {
+      pSamples->clear();
+
+      std::ifstream file(path);
+      if (!file) {
+        *pError = "can't open " + path;
+        return false;
+      }
+
+      std::string line;
+      if (!std::getline(file, line)) {
+        *pError = path + " is empty";
+        return false;
+      }
+
+      std::unordered_map<std::string, size_t> columns;
+      std::vector<std::string> names = SplitCsvLine(line);
+      for (size_t i = 0; i < names.size(); i++) {
+        columns[names[i]] = i;
+      }
+      for (const char *pchRequired : { "host_timestamp_us", "x", "y", "z", "label" }) {
+        if (!columns.count(pchRequired)) {
+          *pError = path + " has no " + pchRequired + " column";
+          return false;
+        }
+      }
+
+      auto column = [&](const char *pchName) { return columns.count(pchName) ? static_cast<int>(columns[pchName]) : -1; };
+      int sequenceColumn = column("sequence");
+      int validColumn = column("valid");
+
+      for (size_t lineNumber = 2; std::getline(file, line); lineNumber++) {
+        if (line.empty() || line == "\r") {
+          continue;
+        }
+
+        std::vector<std::string> fields = SplitCsvLine(line);
+        if (fields.size() < names.size() || !IsLabel(fields[columns["label"]])) {
+          *pError = path + ":" + std::to_string(lineNumber) + ": malformed row";
+          return false;
+        }
+
+        LabeledSample_t labeled = {};
+        ipc::CommandDataServerGazeDataResult2_t &gazeResult = labeled.gazeResult;
+        gazeResult.sequence = sequenceColumn >= 0 ? std::strtoull(fields[sequenceColumn].c_str(), nullptr, 10) : pSamples->size() + 1;
+        gazeResult.hostTimestampUs = std::strtoll(fields[columns["host_timestamp_us"]].c_str(), nullptr, 10);
+
+        bool isValid = validColumn < 0 || std::atoi(fields[validColumn].c_str()) != 0;
+        ipc::GazeVector3 direction = {
+          std::strtof(fields[columns["x"]].c_str(), nullptr),
+          std::strtof(fields[columns["y"]].c_str(), nullptr),
+          std::strtof(fields[columns["z"]].c_str(), nullptr),
+        };
+        for (ipc::GazeEyeResult *pEye : { &gazeResult.leftEye, &gazeResult.rightEye }) {
+          pEye->isGazeDirValid = isValid;
+          pEye->gazeDirNorm = direction;
+        }
+        gazeResult.combined.isGazeDirValid = isValid;
+        gazeResult.combined.gazeDirNorm = direction;
+
+        labeled.label = fields[columns["label"]][0];
+        pSamples->push_back(labeled);
+      }
+
+      return true;
+    }
+
+    // The calibrated states of a recording, the same stream the driver classifies. Every sample is labeled '-'.
+    inline bool LoadRecording(const std::string &path, std::vector<LabeledSample_t> *pSamples, std::string *pError) {
+      pSamples->clear();
+
+      std::ifstream file(path, std::ios::binary);
+      if (!file) {
+        *pError = "can't open " + path;
+        return false;
+      }
+
+      file.seekg(0, std::ios::end);
+      uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+      file.seekg(0);
+
+      GazeRecordingHeader_t header = {};
+      if (fileSize < k_unGazeRecordingHeaderSize || !file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+          header.magic != k_unGazeRecordingMagic ||
+          header.version != k_unGazeRecordingVersion ||
+          header.headerSize != k_unGazeRecordingHeaderSize ||
+          header.chunkSize != k_unGazeRecordingChunkSize ||
+          header.frameSize != sizeof(GazeRecordingFrame_t) ||
+          header.stateSize != k_unGazeRecordingStateSize)
+      {
+        *pError = path + " is not a gaze recording this version can read";
+        return false;
+      }
+
+      // The same rules GazeReplay follows: trust the chunk frame counts only if the recording was stopped cleanly,
+      // otherwise a chunk ends at its first unwritten frame, and never read past the end of the file.
+      GazeRecordingFrame_t frame;
+      for (uint32_t chunkIndex = 0; chunkIndex < k_unGazeRecordingMaxChunks; chunkIndex++) {
+        uint64_t offset = k_unGazeRecordingHeaderSize + static_cast<uint64_t>(chunkIndex) * k_unGazeRecordingChunkSize;
+        if (offset >= fileSize || (header.isComplete && chunkIndex >= header.chunkCount)) {
+          break;
+        }
+
+        uint64_t maxFrameCount = (std::min<uint64_t>)(k_unGazeRecordingChunkSize, fileSize - offset) / sizeof(GazeRecordingFrame_t);
+        uint64_t frameCount = header.isComplete ? (std::min<uint64_t>)(header.chunks[chunkIndex].frameCount, maxFrameCount) : maxFrameCount;
+
+        file.seekg(static_cast<std::streamoff>(offset));
+        for (uint64_t i = 0; i < frameCount; i++) {
+          if (!file.read(reinterpret_cast<char *>(&frame), sizeof(frame)) || frame.sequence == 0) {
+            break;
+          }
+
+          Hmd2GazeState calibratedState;
+          memcpy(&calibratedState, frame.calibratedState, sizeof(calibratedState));
+
+          LabeledSample_t labeled = {};
+          labeled.gazeResult = ipc::MakeGazeDataResult2(calibratedState, frame.sequence, frame.hmdTimestampUs, frame.hostTimestampUs);
+          labeled.label = '-';
+          pSamples->push_back(labeled);
+        }
+      }
+
+      return true;
+    }
+
+    // Labels for a recording, keyed by the sequence numbers in it:
+    //   sequence,label
+    // Samples without a row keep their '-'.
+    inline bool LoadSequenceLabels(const std::string &path, std::vector<LabeledSample_t> *pSamples, std::string *pError) {
+      std::ifstream file(path);
+      if (!file) {
+        *pError = "can't open " + path;
+        return false;
+      }
+
+      std::unordered_map<uint64_t, char> labels;
+      std::string line;
+      std::getline(file, line); // Header.
+      for (size_t lineNumber = 2; std::getline(file, line); lineNumber++) {
+        if (line.empty() || line == "\r") {
+          continue;
+        }
+
+        std::vector<std::string> fields = SplitCsvLine(line);
+        if (fields.size() < 2 || !IsLabel(fields[1])) {
+          *pError = path + ":" + std::to_string(lineNumber) + ": malformed row";
+          return false;
+        }
+        labels[std::strtoull(fields[0].c_str(), nullptr, 10)] = fields[1][0];
+      }
+
+      for (LabeledSample_t &labeled : *pSamples) {
+        auto it = labels.find(labeled.gazeResult.sequence);
+        if (it != labels.end()) {
+          labeled.label = it->second;
+        }
+      }
+      return true;
+    }
+
+    // Runs of 'F' or 'S' samples. A jump in the sequence numbers, a dropped frame, ends a run as well.
+    inline std::vector<EventSpan_t> GetLabeledEvents(const std::vector<LabeledSample_t> &samples) {
+      std::vector<EventSpan_t> events;
+      for (size_t i = 0; i < samples.size(); i++) {
+        char label = samples[i].label;
+        if (label != 'F' && label != 'S') {
+          continue;
+        }
+
+        uint64_t sequence = samples[i].gazeResult.sequence;
+        if (i > 0 && samples[i - 1].label == label && events.back().endSequence == sequence) {
+          events.back().endSequence = sequence + 1;
+        } else {
+          events.push_back({ label == 'S', sequence, sequence + 1 });
+        }
+      }
+      return events;
+    }
+
+    // Every fixation and saccade the classifier reports for one source, from its end events.
+    inline std::vector<EventSpan_t> GetClassifiedEvents(const std::vector<LabeledSample_t> &samples, ipc::EGazeEventSource source) {
+      std::vector<EventSpan_t> events;
+      GazeEventClassifier classifier;
+      ipc::GazeEvent_t pEvents[GazeEventClassifier::k_unMaxEventsPerSample];
+
+      auto collect = [&](uint32_t eventCount) {
+        for (uint32_t i = 0; i < eventCount; i++) {
+          const ipc::GazeEvent_t &event = pEvents[i];
+          if (event.source != source || (event.type != ipc::GazeEventType_FixationEnd && event.type != ipc::GazeEventType_SaccadeEnd)) {
+            continue;
+          }
+          events.push_back({ event.type == ipc::GazeEventType_SaccadeEnd, event.sequence, event.sequence + event.sampleCount });
+        }
+      };
+
+      for (const LabeledSample_t &labeled : samples) {
+        collect(classifier.Classify(labeled.gazeResult, pEvents));
+      }
+
+      // Lost tracking ends whatever is still in progress.
+      if (!samples.empty()) {
+        ipc::CommandDataServerGazeDataResult2_t end = {};
+        end.sequence = samples.back().gazeResult.sequence + 1;
+        end.hostTimestampUs = samples.back().gazeResult.hostTimestampUs + 1;
+        collect(classifier.Classify(end, pEvents));
+      }
+
+      return events;
+    }
+
+    inline double GetEventOverlap(const EventSpan_t &a, const EventSpan_t &b) {
+      uint64_t first = (std::max)(a.firstSequence, b.firstSequence);
+      uint64_t end = (std::min)(a.endSequence, b.endSequence);
+      if (end <= first) {
+        return 0.0;
+      }
+
+      uint64_t unionLength = (std::max)(a.endSequence, b.endSequence) - (std::min)(a.firstSequence, b.firstSequence);
+      return static_cast<double>(end - first) / unionLength;
+    }
+
+    // Both lists are in sequence order. Each labeled event takes the best overlapping classified event still free.
+    inline EventScore_t MatchEvents(const std::vector<EventSpan_t> &labeled, const std::vector<EventSpan_t> &classified, bool isSaccade) {
+      EventScore_t score = {};
+
+      std::vector<size_t> candidates;
+      for (size_t i = 0; i < classified.size(); i++) {
+        if (classified[i].isSaccade == isSaccade) {
+          candidates.push_back(i);
+        }
+      }
+      score.classifiedCount = static_cast<uint32_t>(candidates.size());
+
+      std::vector<bool> isMatched(candidates.size(), false);
+      size_t firstCandidate = 0;
+      for (const EventSpan_t &event : labeled) {
+        if (event.isSaccade != isSaccade) {
+          continue;
+        }
+        score.labeledCount++;
+
+        // Candidates that end before this event can't overlap it or anything after it.
+        while (firstCandidate < candidates.size() && classified[candidates[firstCandidate]].endSequence <= event.firstSequence) {
+          firstCandidate++;
+        }
+
+        size_t best = candidates.size();
+        double bestOverlap = k_minEventOverlap;
+        for (size_t i = firstCandidate; i < candidates.size() && classified[candidates[i]].firstSequence < event.endSequence; i++) {
+          double overlap = GetEventOverlap(event, classified[candidates[i]]);
+          if (!isMatched[i] && overlap >= bestOverlap) {
+            best = i;
+            bestOverlap = overlap;
+          }
+        }
+
+        if (best != candidates.size()) {
+          isMatched[best] = true;
+          score.matchedCount++;
+        }
+      }
+
+      return score;
+    }
+
+    inline ClassifierScore_t ScoreClassifier(const std::vector<LabeledSample_t> &samples, ipc::EGazeEventSource source = ipc::GazeEventSource_Combined) {
+      std::vector<EventSpan_t> labeled = GetLabeledEvents(samples);
+      std::vector<EventSpan_t> classified = GetClassifiedEvents(samples, source);
+      return { MatchEvents(labeled, classified, false), MatchEvents(labeled, classified, true) };
+    }
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,84 @@
+#include "bench_harness.h"
+
+#include "fake_driver_context.h"
+#include "synthetic_gaze.h"
+
+#include "gaze_fusion.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr size_t k_sampleCount = 57600; // About 4 minutes of gaze.
+  constexpr int k_runCount = 5;
+
+  // Runs Apply over synthetic gaze where the given fraction of fixations is followed by one eye being lost,
+  // and reports what each call cost, both timed one by one and as the mean of whole runs.
+  void MeasureApply(FakeDriverContext &context, float singleEyeDropoutProbability) {
+    std::mt19937 random(24);
+    std::vector<SyntheticGazeSample_t> samples = MakeSyntheticGaze(random, k_sampleCount, singleEyeDropoutProbability);
+    std::vector<Hmd2GazeState> states(samples.size());
+
+    context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FUSION, "true");
+    GazeFusion fusion;
+    fusion.Initialize();
+
+    // A run is the whole sequence, so the timestamps go back at the start of each and the fusion starts over.
+    double bestRunNs = 0.0;
+    for (int run = 0; run < k_runCount; run++) {
+      for (size_t i = 0; i < samples.size(); i++) {
+        states[i] = samples[i].state;
+      }
+
+      int64_t startNs = GetBenchTimestampNs();
+      for (size_t i = 0; i < samples.size(); i++) {
+        fusion.Apply(states[i], samples[i].hmdTimestampUs);
+      }
+      double runNs = static_cast<double>(GetBenchTimestampNs() - startNs) / samples.size();
+      DoNotOptimize(states);
+
+      bestRunNs = run == 0 ? runNs : (std::min)(bestRunNs, runNs);
+    }
+
+    // One by one, which adds the clock's own cost to each call but shows the tail.
+    std::vector<int64_t> costs;
+    costs.reserve(samples.size());
+    uint64_t dropoutCount = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+      Hmd2GazeState state = samples[i].state;
+      int64_t startNs = GetBenchTimestampNs();
+      fusion.Apply(state, samples[i].hmdTimestampUs);
+      costs.push_back(GetBenchTimestampNs() - startNs);
+      DoNotOptimize(state);
+
+      if (state.combined.isGazeDirValid && !samples[i].state.combined.isGazeDirValid) {
+        dropoutCount++;
+      }
+    }
+
+    std::sort(costs.begin(), costs.end());
+    auto percentileNs = [&](double percentile) {
+      return costs[static_cast<size_t>(percentile * (costs.size() - 1))];
+    };
+    printf("dropout %4.2f %8zu samples, %6llu carried on one eye, mean %6.1f ns, p50 %4lld ns, p99 %4lld ns, p99.9 %5lld ns, max %6lld ns\n",
+           singleEyeDropoutProbability, samples.size(), static_cast<unsigned long long>(dropoutCount), bestRunNs,
+           static_cast<long long>(percentileNs(0.5)), static_cast<long long>(percentileNs(0.99)),
+           static_cast<long long>(percentileNs(0.999)), static_cast<long long>(costs.back()));
+  }
+
+} // namespace
+
+int main() {
+  FakeDriverContext context;
+
+  for (float singleEyeDropoutProbability : { 0.0f, 0.2f, 0.5f }) {
+    MeasureApply(context, singleEyeDropoutProbability);
+  }
+  return 0;
+}
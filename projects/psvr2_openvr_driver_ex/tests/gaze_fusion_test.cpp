@@ -0,0 +1,183 @@
+#include "test_harness.h"
+
+#include "fake_driver_context.h"
+#include "synthetic_gaze.h"
+
+#include "gaze_fusion.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  // Far apart and with little noise, so taking the lone eye as it is would jump by about 0.02 rad.
+  constexpr float k_leftBias[2] = { 0.01f, -0.005f };
+  constexpr float k_rightBias[2] = { -0.01f, 0.005f };
+  constexpr float k_eyeNoise = 0.0005f;
+
+  // Where the fused ray should point, halfway between the eyes.
+  constexpr float k_midBias[2] = { (k_leftBias[0] + k_rightBias[0]) * 0.5f, (k_leftBias[1] + k_rightBias[1]) * 0.5f };
+
+  float AngleBetween(const Hmd2Vector3 &a, const Hmd2Vector3 &b) {
+    float dot = a.x * b.x + a.y * b.y + a.z * b.z;
+    return std::acos(std::clamp(dot, -1.0f, 1.0f));
+  }
+
+  float Length(const Hmd2Vector3 &vector) {
+    return std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+  }
+
+  struct DropoutGaze_t {
+    uint64_t hmdTimestampUs;
+    float x, y; // Where both eyes look.
+    Hmd2GazeState state;
+  };
+
+  // Slow pursuit across the view, with one eye lost from dropoutStartUs to dropoutEndUs after the start.
+  std::vector<DropoutGaze_t> MakeDropoutGaze(uint32_t seed, bool isLeftLost, uint64_t durationUs, uint64_t dropoutStartUs, uint64_t dropoutEndUs) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0.0f, k_eyeNoise);
+
+    std::vector<DropoutGaze_t> samples;
+    for (uint64_t elapsedUs = 0; elapsedUs < durationUs; elapsedUs += k_ulSyntheticSampleIntervalUs) {
+      DropoutGaze_t sample = {};
+      sample.hmdTimestampUs = 1000000 + elapsedUs;
+      sample.x = -0.3f + 0.1f * (elapsedUs / 1e6f);
+      sample.y = 0.05f * std::sin(elapsedUs / 1e6f);
+
+      bool isDropout = elapsedUs >= dropoutStartUs && elapsedUs < dropoutEndUs;
+      bool leftValid = !(isDropout && isLeftLost);
+      bool rightValid = !(isDropout && !isLeftLost);
+
+      Hmd2GazeState &state = sample.state;
+      state.leftEye.isGazeDirValid = leftValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.leftEye.gazeDirNorm = MakeSyntheticDirection(sample.x + k_leftBias[0] + noise(random), sample.y + k_leftBias[1] + noise(random));
+      state.leftEye.isGazeOriginValid = leftValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.leftEye.gazeOriginMm = { -32.0f, 0.0f, -27.0f };
+      state.rightEye.isGazeDirValid = rightValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.rightEye.gazeDirNorm = MakeSyntheticDirection(sample.x + k_rightBias[0] + noise(random), sample.y + k_rightBias[1] + noise(random));
+      state.rightEye.isGazeOriginValid = rightValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.rightEye.gazeOriginMm = { 32.0f, 0.0f, -27.0f };
+
+      // The headset loses the combined ray along with either eye.
+      bool combinedValid = leftValid && rightValid;
+      state.combined.isGazeDirValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.combined.isGazeOriginValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+      state.combined.isValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+
+      samples.push_back(sample);
+    }
+
+    return samples;
+  }
+
+  void InitializeFusion(FakeDriverContext &context, GazeFusion &fusion) {
+    context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FUSION, "true");
+    fusion.Initialize();
+  }
+
+} // namespace
+
+TEST_CASE(CarriesTheRayThroughASingleEyeDropout) {
+  for (bool isLeftLost : { true, false }) {
+    FakeDriverContext context;
+    GazeFusion fusion;
+    InitializeFusion(context, fusion);
+
+    // Three seconds to learn the biases, then a fifth of a second on one eye.
+    std::vector<DropoutGaze_t> samples = MakeDropoutGaze(24, isLeftLost, 5000000, 3000000, 3200000);
+
+    float maxSettledErrorRad = 0.0f;
+    float maxDropoutErrorRad = 0.0f;
+    float maxStepErrorRad = 0.0f;
+    Hmd2Vector3 lastDirection = {};
+    Hmd2Vector3 lastExpected = {};
+    for (size_t i = 0; i < samples.size(); i++) {
+      Hmd2GazeState state = samples[i].state;
+      fusion.Apply(state, samples[i].hmdTimestampUs);
+
+      CHECK(state.combined.isGazeDirValid);
+      CHECK(state.combined.isGazeOriginValid);
+      CHECK_NEAR(Length(state.combined.gazeDirNorm), 1.0f, 1e-5f);
+
+      Hmd2Vector3 expected = MakeSyntheticDirection(samples[i].x + k_midBias[0], samples[i].y + k_midBias[1]);
+      float errorRad = AngleBetween(state.combined.gazeDirNorm, expected);
+      uint64_t elapsedUs = samples[i].hmdTimestampUs - samples[0].hmdTimestampUs;
+      if (elapsedUs >= 3000000 && elapsedUs < 3200000) {
+        maxDropoutErrorRad = (std::max)(maxDropoutErrorRad, errorRad);
+        CHECK_NEAR(state.combined.gazeOriginMm.x, 0.0f, 1e-3f);
+      } else if (elapsedUs >= 2000000) {
+        maxSettledErrorRad = (std::max)(maxSettledErrorRad, errorRad);
+      }
+
+      // From one sample to the next the ray only moves as far as the eyes did, including where the eye drops out and comes back.
+      if (i > 0 && elapsedUs >= 2000000) {
+        float stepErrorRad = std::abs(AngleBetween(state.combined.gazeDirNorm, lastDirection) - AngleBetween(expected, lastExpected));
+        maxStepErrorRad = (std::max)(maxStepErrorRad, stepErrorRad);
+      }
+      lastDirection = state.combined.gazeDirNorm;
+      lastExpected = expected;
+    }
+
+    // Noise alone, a few times the eyes' own. The biases being left out would be 0.01 rad or more.
+    CHECK(maxSettledErrorRad < 0.002f);
+    CHECK(maxDropoutErrorRad < 0.003f);
+    CHECK(maxStepErrorRad < 0.004f);
+  }
+}
+
+TEST_CASE(KeepsTheRayThroughRandomDropouts) {
+  FakeDriverContext context;
+  GazeFusion fusion;
+  InitializeFusion(context, fusion);
+
+  // Two minutes of gaze, a fifth of the fixations followed by one eye being lost.
+  std::mt19937 random(25);
+  std::vector<SyntheticGazeSample_t> samples = MakeSyntheticGaze(random, 28800, 0.2f);
+
+  uint32_t dropoutCount = 0;
+  float maxErrorRad = 0.0f;
+  for (const SyntheticGazeSample_t &sample : samples) {
+    Hmd2GazeState state = sample.state;
+    fusion.Apply(state, sample.hmdTimestampUs);
+
+    bool isLeftValid = sample.state.leftEye.isGazeDirValid;
+    bool isRightValid = sample.state.rightEye.isGazeDirValid;
+    if (!isLeftValid && !isRightValid) {
+      // Nothing to carry it on with during a blink.
+      CHECK(!state.combined.isGazeDirValid);
+      continue;
+    }
+
+    CHECK(state.combined.isGazeDirValid);
+    CHECK_NEAR(Length(state.combined.gazeDirNorm), 1.0f, 1e-5f);
+    if (isLeftValid != isRightValid) {
+      dropoutCount++;
+    }
+
+    // Bias and noise of the eyes together, on the right eye alone the noise is 0.004.
+    maxErrorRad = (std::max)(maxErrorRad, AngleBetween(state.combined.gazeDirNorm, sample.target));
+  }
+
+  CHECK(dropoutCount > 1000);
+  CHECK(maxErrorRad < 0.025f);
+}
+
+TEST_CASE(DoesNothingUnlessEnabled) {
+  FakeDriverContext context;
+  GazeFusion fusion;
+  fusion.Initialize();
+
+  std::vector<DropoutGaze_t> samples = MakeDropoutGaze(26, true, 1000000, 500000, 700000);
+  for (const DropoutGaze_t &sample : samples) {
+    Hmd2GazeState state = sample.state;
+    fusion.Apply(state, sample.hmdTimestampUs);
+    CHECK(state.combined.isGazeDirValid == sample.state.combined.isGazeDirValid);
+  }
+}
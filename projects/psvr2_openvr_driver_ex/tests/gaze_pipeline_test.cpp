@@ -0,0 +1,275 @@
+#include "test_harness.h"
+
+#include "fake_driver_context.h"
+#include "fake_gaze_stages.h"
+#include "synthetic_gaze.h"
+
+#include "gaze_calibration_store.h"
+#include "gaze_filter.h"
+#include "gaze_foveation.h"
+#include "gaze_fusion.h"
+#include "gaze_metrics.h"
+#include "gaze_pipeline.h"
+#include "gaze_recorder.h"
+#include "gaze_replay.h"
+#include "util.h"
+#include "vr_settings.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  struct FakeGazeStages_t {
+    FakeGazeDriverInput *pDriverInput;
+    FakeGazeOpenVrUpdate *pOpenVrUpdate;
+    FakeGazeIpcSink *pIpcSink;
+  };
+
+  // The pipeline and its stages are singletons, set up once with fusion and filtering on, the way they would be in the driver.
+  FakeGazeStages_t &InitializePipeline(FakeDriverContext &context) {
+    static FakeGazeStages_t stages = { new FakeGazeDriverInput, new FakeGazeOpenVrUpdate, new FakeGazeIpcSink };
+
+    context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FUSION, "true");
+    context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FILTER, "true");
+
+    GazeMetrics::Instance()->Initialize();
+    GazeCalibrationStore::Instance()->Initialize();
+    GazeFusion::Instance()->Initialize();
+    GazeFilter::Instance()->Initialize();
+    GazeFoveation::Instance()->Initialize();
+    GazeRecorder::Instance()->Initialize();
+    GazePipeline::Instance()->Initialize(stages.pDriverInput, stages.pOpenVrUpdate, stages.pIpcSink);
+    GazeReplay::Instance()->Initialize();
+
+    stages.pOpenVrUpdate->Clear();
+    stages.pIpcSink->Clear();
+    return stages;
+  }
+
+  std::string WriteRecording(const char *pchName, size_t sampleCount, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string path = (std::filesystem::temp_directory_path() / pchName).string();
+    CHECK(WriteSyntheticRecording(path, MakeSyntheticGaze(random, sampleCount, 0.2f), 5000000));
+    return path;
+  }
+
+  // Returns false if the replay is still running after timeoutMs.
+  bool WaitForReplay(int timeoutMs) {
+    GazeReplay *pGazeReplay = GazeReplay::Instance();
+    for (int elapsedMs = 0; elapsedMs < timeoutMs; elapsedMs++) {
+      CommandDataServerGazeReplayStatus_t status;
+      pGazeReplay->GetStatus(&status);
+      if (!status.isReplaying) {
+        pGazeReplay->Stop();
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+  }
+
+  bool IsUnit(const GazeVector3 &vector) {
+    return std::abs(std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z) - 1.0f) < 1e-4f;
+  }
+
+} // namespace
+
+TEST_CASE(LiveGazeGoesThroughEveryStage) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+  stages.pDriverInput->offsetUs = 123456;
+  stages.pDriverInput->callCount = 0;
+
+  std::mt19937 random(20);
+  std::vector<SyntheticGazeSample_t> samples = MakeSyntheticGaze(random, 24, 0.0f);
+  for (const SyntheticGazeSample_t &sample : samples) {
+    GazePipeline::Instance()->ProcessLive(sample.state, sizeof(Hmd2GazeState), GazeMetrics::Now());
+  }
+
+  // 100 ms of gaze, the PS VR2 driver's clock is only asked once.
+  CHECK(stages.pDriverInput->callCount == 1);
+  CHECK(stages.pOpenVrUpdate->updates.size() == samples.size());
+  CHECK(stages.pIpcSink->results.size() == samples.size());
+  if (stages.pIpcSink->results.size() != samples.size() || stages.pOpenVrUpdate->updates.size() != samples.size()) {
+    return;
+  }
+
+  for (size_t i = 0; i < samples.size(); i++) {
+    const CommandDataServerGazeDataResult2_t &gazeResult = stages.pIpcSink->results[i];
+    CHECK(gazeResult.sequence == stages.pIpcSink->results[0].sequence + i);
+    CHECK(gazeResult.hmdTimestampUs == samples[i].hmdTimestampUs);
+    CHECK(gazeResult.hostTimestampUs == static_cast<int64_t>(samples[i].hmdTimestampUs) + 123456);
+    CHECK(gazeResult.combined.isGazeDirValid);
+    CHECK(IsUnit(gazeResult.combined.gazeDirNorm));
+
+    // SteamVR is told the same sample the IPC clients see.
+    const FakeGazeOpenVrUpdate::Update_t &update = stages.pOpenVrUpdate->updates[i];
+    CHECK(update.hostTimestampUs == gazeResult.hostTimestampUs);
+    CHECK(update.gazeState.combined.gazeDirNorm.x == gazeResult.combined.gazeDirNorm.x);
+    CHECK(update.gazeState.combined.gazeDirNorm.y == gazeResult.combined.gazeDirNorm.y);
+  }
+}
+
+TEST_CASE(LiveGazeIsDroppedDuringReplay) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+
+  std::mt19937 random(21);
+  std::vector<SyntheticGazeSample_t> samples = MakeSyntheticGaze(random, 2, 0.0f);
+
+  GazePipeline::Instance()->BeginReplay();
+  GazePipeline::Instance()->ProcessLive(samples[0].state, sizeof(Hmd2GazeState), GazeMetrics::Now());
+  CHECK(stages.pIpcSink->results.empty());
+  CHECK(stages.pOpenVrUpdate->updates.empty());
+  GazePipeline::Instance()->EndReplay();
+
+  GazePipeline::Instance()->ProcessLive(samples[1].state, sizeof(Hmd2GazeState), GazeMetrics::Now());
+  CHECK(stages.pIpcSink->results.size() == 1);
+}
+
+TEST_CASE(ReplayFeedsEveryFrameThrough) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+
+  // Past the first chunk, so the replay has to find the second one.
+  size_t frameCount = k_unGazeRecordingChunkSize / sizeof(GazeRecordingFrame_t) + 500;
+  std::mt19937 random(22);
+  std::vector<SyntheticGazeSample_t> samples = MakeSyntheticGaze(random, frameCount, 0.2f);
+  std::string path = (std::filesystem::temp_directory_path() / "gaze_pipeline_test_frames.pvgr").string();
+  CHECK(WriteSyntheticRecording(path, samples, 5000000));
+
+  int64_t startUs = Util::GetHostTimestamp();
+  CHECK(GazeReplay::Instance()->Start(path, true));
+  CHECK(WaitForReplay(60000));
+
+  CommandDataServerGazeReplayStatus_t status;
+  GazeReplay::Instance()->GetStatus(&status);
+  CHECK(status.frameCount == frameCount);
+  CHECK(status.replayedFrameCount == frameCount);
+
+  const std::vector<CommandDataServerGazeDataResult2_t> &results = stages.pIpcSink->results;
+  CHECK(results.size() == frameCount);
+  CHECK(stages.pOpenVrUpdate->updates.size() == frameCount);
+  if (results.size() == frameCount) {
+    // HMD timestamps as recorded, host timestamps with the recorded spacing from the start of the replay.
+    CHECK(results[0].hostTimestampUs >= startUs);
+    bool isInOrder = true;
+    bool hasRecordedTimestamps = true;
+    bool isUnit = true;
+    bool combinedStaysValid = true;
+    for (size_t i = 0; i < frameCount; i++) {
+      isInOrder = isInOrder && results[i].sequence == results[0].sequence + i;
+      hasRecordedTimestamps = hasRecordedTimestamps && results[i].hmdTimestampUs == samples[i].hmdTimestampUs &&
+                              results[i].hostTimestampUs - results[0].hostTimestampUs == static_cast<int64_t>(samples[i].hmdTimestampUs - samples[0].hmdTimestampUs);
+      isUnit = isUnit && (!results[i].combined.isGazeDirValid || IsUnit(results[i].combined.gazeDirNorm));
+
+      // Fusion carries the combined ray through a single eye dropout, only a blink loses it.
+      bool eitherEyeValid = samples[i].state.leftEye.isGazeDirValid || samples[i].state.rightEye.isGazeDirValid;
+      combinedStaysValid = combinedStaysValid && results[i].combined.isGazeDirValid == eitherEyeValid;
+    }
+    CHECK(isInOrder);
+    CHECK(hasRecordedTimestamps);
+    CHECK(isUnit);
+    CHECK(combinedStaysValid);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE(ReplayIsDeterministic) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+  std::string path = WriteRecording("gaze_pipeline_test_deterministic.pvgr", 5000, 23);
+
+  std::vector<std::vector<FakeGazeOpenVrUpdate::Update_t>> runs;
+  for (int run = 0; run < 2; run++) {
+    stages.pOpenVrUpdate->Clear();
+    CHECK(GazeReplay::Instance()->Start(path, true));
+    CHECK(WaitForReplay(60000));
+    runs.push_back(stages.pOpenVrUpdate->updates);
+  }
+
+  // Bit for bit the same states, every stage starts over when the timestamps go back to the start of the recording.
+  CHECK(runs[0].size() == 5000 && runs[1].size() == 5000);
+  if (runs[0].size() == runs[1].size()) {
+    bool isSame = true;
+    for (size_t i = 0; i < runs[0].size(); i++) {
+      isSame = isSame && memcmp(&runs[0][i].gazeState, &runs[1][i].gazeState, sizeof(Hmd2GazeState)) == 0 &&
+               runs[0][i].hostTimestampUs - runs[0][0].hostTimestampUs == runs[1][i].hostTimestampUs - runs[1][0].hostTimestampUs;
+    }
+    CHECK(isSame);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE(ReplayKeepsTheRecordedPace) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+
+  // About 250 ms of gaze.
+  std::string path = WriteRecording("gaze_pipeline_test_pace.pvgr", 60, 24);
+  int64_t expectedUs = 59 * static_cast<int64_t>(k_ulSyntheticSampleIntervalUs);
+
+  int64_t startUs = Util::GetHostTimestamp();
+  CHECK(GazeReplay::Instance()->Start(path, false));
+  CHECK(WaitForReplay(5000));
+  int64_t elapsedUs = Util::GetHostTimestamp() - startUs;
+
+  CHECK(stages.pIpcSink->results.size() == 60);
+  // The wait is in whole milliseconds, so every frame may come up to 1 ms early, never late enough to add up.
+  CHECK(elapsedUs >= expectedUs - 1000);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE(StopEndsAReplayEarly) {
+  FakeDriverContext context;
+  FakeGazeStages_t &stages = InitializePipeline(context);
+
+  // About 4 s of gaze at the recorded pace.
+  std::string path = WriteRecording("gaze_pipeline_test_stop.pvgr", 1000, 25);
+  CHECK(GazeReplay::Instance()->Start(path, false));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  GazeReplay::Instance()->Stop();
+
+  CommandDataServerGazeReplayStatus_t status;
+  GazeReplay::Instance()->GetStatus(&status);
+  CHECK(!status.isReplaying);
+  CHECK(status.replayedFrameCount < 1000);
+  CHECK(stages.pIpcSink->results.size() == status.replayedFrameCount);
+
+  // Live gaze goes through again.
+  std::mt19937 random(25);
+  GazePipeline::Instance()->ProcessLive(MakeSyntheticGaze(random, 1, 0.0f)[0].state, sizeof(Hmd2GazeState), GazeMetrics::Now());
+  CHECK(stages.pIpcSink->results.size() == status.replayedFrameCount + 1);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE(ReplayRejectsWhatIsNotARecording) {
+  FakeDriverContext context;
+  InitializePipeline(context);
+
+  std::string path = (std::filesystem::temp_directory_path() / "gaze_pipeline_test_empty.pvgr").string();
+  FILE *pFile = fopen(path.c_str(), "wb");
+  fputs("not a recording", pFile);
+  fclose(pFile);
+
+  CHECK(!GazeReplay::Instance()->Start(path, true));
+  CHECK(!GazeReplay::Instance()->Start(path + ".missing", true));
+
+  std::filesystem::remove(path);
+}
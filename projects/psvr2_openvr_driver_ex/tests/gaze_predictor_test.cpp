@@ -0,0 +1,169 @@
+#include "test_harness.h"
+
+#include "gaze_predictor.h"
+
+#include <cmath>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  // The headset reports gaze at 240 Hz.
+  constexpr int64_t k_sampleIntervalUs = 4167;
+
+  // Straight ahead, turned by angle radians to the right.
+  GazeVector3 DirectionAt(float angle) {
+    return { std::sin(angle), 0.0f, -std::cos(angle) };
+  }
+
+  class PredictorFeed {
+  public:
+    void Sample(const GazeVector3 &direction, bool isValid = true) {
+      CommandDataServerGazeDataResult2_t gazeResult = {};
+      gazeResult.sequence = ++m_sequence;
+      gazeResult.hostTimestampUs = Now();
+      gazeResult.combined.isGazeOriginValid = isValid;
+      gazeResult.combined.gazeOriginMm = { 0.0f, 0.0f, 0.0f };
+      gazeResult.combined.isGazeDirValid = isValid;
+      gazeResult.combined.gazeDirNorm = direction;
+      predictor.Update(gazeResult);
+    }
+
+    int64_t Now() const {
+      return 1000000 + static_cast<int64_t>(m_sequence) * k_sampleIntervalUs;
+    }
+
+    CommandDataServerGazePredictionResult_t Predict(int64_t aheadUs) {
+      CommandDataServerGazePredictionResult_t result;
+      CHECK(predictor.Predict(Now() + aheadUs, &result));
+      return result;
+    }
+
+    GazePredictor predictor;
+
+  private:
+    uint64_t m_sequence = 0;
+  };
+
+  float Length(const GazeVector3 &vector) {
+    return std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+  }
+
+} // namespace
+
+TEST_CASE(NothingToPredictFrom) {
+  GazePredictor predictor;
+  CommandDataServerGazePredictionResult_t result;
+  CHECK(!predictor.Predict(0, &result));
+  CHECK(!result.isValid);
+
+  PredictorFeed feed;
+  feed.Sample(DirectionAt(0.0f), false);
+  CHECK(!feed.predictor.Predict(feed.Now(), &result));
+}
+
+TEST_CASE(PursuitIsExtrapolatedOnTheUnitSphere) {
+  PredictorFeed feed;
+
+  // 1 rad/s, a smooth pursuit well under the saccade threshold.
+  float angle = 0.0f;
+  for (int i = 0; i < 60; i++) {
+    feed.Sample(DirectionAt(angle));
+    angle += k_sampleIntervalUs / 1e6f;
+  }
+  angle -= k_sampleIntervalUs / 1e6f;
+
+  for (int64_t aheadUs : { 0, 10000, 25000, 50000 }) {
+    CommandDataServerGazePredictionResult_t result = feed.Predict(aheadUs);
+    CHECK(result.isValid);
+    CHECK(!result.isSaccade);
+    CHECK_NEAR(Length(result.gazeDirNorm), 1.0, 1e-6);
+
+    // A straight step along the tangent, so a little short of the arc.
+    GazeVector3 expected = DirectionAt(angle + aheadUs / 1e6f);
+    CHECK_NEAR(result.gazeDirNorm.x, expected.x, 2e-3);
+    CHECK_NEAR(result.gazeDirNorm.y, expected.y, 1e-6);
+    CHECK_NEAR(result.gazeDirNorm.z, expected.z, 2e-3);
+  }
+}
+
+TEST_CASE(HorizonIsClamped) {
+  PredictorFeed feed;
+  float angle = 0.0f;
+  for (int i = 0; i < 30; i++) {
+    feed.Sample(DirectionAt(angle));
+    angle += 0.004f;
+  }
+
+  // Past the 50 ms limit, the prediction stops moving.
+  CommandDataServerGazePredictionResult_t atLimit = feed.Predict(50000);
+  for (int64_t aheadUs : { 50001, 80000, 1000000 }) {
+    CommandDataServerGazePredictionResult_t result = feed.Predict(aheadUs);
+    CHECK(result.targetHostTimestampUs == feed.Now() + aheadUs);
+    CHECK(result.gazeDirNorm.x == atLimit.gazeDirNorm.x);
+    CHECK(result.gazeDirNorm.y == atLimit.gazeDirNorm.y);
+    CHECK(result.gazeDirNorm.z == atLimit.gazeDirNorm.z);
+  }
+
+  // Never backwards, a target before the newest sample gets that sample.
+  CommandDataServerGazePredictionResult_t now = feed.Predict(0);
+  for (int64_t aheadUs : { -1, -20000, -1000000 }) {
+    CommandDataServerGazePredictionResult_t result = feed.Predict(aheadUs);
+    CHECK(result.gazeDirNorm.x == now.gazeDirNorm.x);
+    CHECK(result.gazeDirNorm.z == now.gazeDirNorm.z);
+  }
+  CHECK(now.sampleHostTimestampUs == feed.Now());
+  CHECK(atLimit.gazeDirNorm.x > now.gazeDirNorm.x);
+}
+
+TEST_CASE(SaccadeHoldsDirectionAndRestartsVelocity) {
+  PredictorFeed feed;
+  float angle = 0.0f;
+  for (int i = 0; i < 30; i++) {
+    feed.Sample(DirectionAt(angle));
+    angle += 0.004f;
+  }
+  CHECK(feed.Predict(20000).gazeDirNorm.x > feed.Predict(0).gazeDirNorm.x);
+
+  // 0.2 rad in one sample is about 48 rad/s, far past the threshold.
+  angle += 0.2f;
+  feed.Sample(DirectionAt(angle));
+
+  CommandDataServerGazePredictionResult_t result = feed.Predict(20000);
+  CHECK(result.isSaccade);
+  GazeVector3 landed = DirectionAt(angle);
+  CHECK_NEAR(result.gazeDirNorm.x, landed.x, 1e-6);
+  CHECK_NEAR(result.gazeDirNorm.z, landed.z, 1e-6);
+
+  // Once it lands and holds still, none of the old pursuit or the saccade carries over.
+  feed.Sample(DirectionAt(angle));
+  result = feed.Predict(50000);
+  CHECK(!result.isSaccade);
+  CHECK_NEAR(result.gazeDirNorm.x, landed.x, 1e-6);
+  CHECK_NEAR(result.gazeDirNorm.z, landed.z, 1e-6);
+
+  // A new pursuit the other way is followed right away, the one before the saccade doesn't drag it along.
+  angle -= 0.002f;
+  feed.Sample(DirectionAt(angle));
+  result = feed.Predict(20000);
+  CHECK(result.gazeDirNorm.x < DirectionAt(angle).x);
+}
+
+TEST_CASE(GapRestartsVelocity) {
+  PredictorFeed feed;
+  float angle = 0.0f;
+  for (int i = 0; i < 30; i++) {
+    feed.Sample(DirectionAt(angle));
+    angle += 0.004f;
+  }
+
+  // Lost tracking, then back where it was.
+  feed.Sample(DirectionAt(angle), false);
+  feed.Sample(DirectionAt(angle));
+
+  CommandDataServerGazePredictionResult_t result = feed.Predict(50000);
+  CHECK(!result.isSaccade);
+  CHECK_NEAR(result.gazeDirNorm.x, DirectionAt(angle).x, 1e-6);
+}
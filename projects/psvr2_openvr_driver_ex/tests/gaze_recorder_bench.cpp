@@ -0,0 +1,84 @@
+#include "bench_harness.h"
+
+#include "fake_driver_context.h"
+
+#include "gaze_recorder.h"
+#include "vr_settings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr uint32_t k_unFramesPerChunk = k_unGazeRecordingChunkSize / sizeof(GazeRecordingFrame_t);
+
+  // The USB gaze thread has a budget of about 5 us per frame for recording.
+  constexpr double k_budgetUs = 5.0;
+
+  // Records frameCount frames with gapUs between them and reports what each Record call cost.
+  // A gap gives the writer thread time to map the next chunk, the way the 4 ms between headset frames does.
+  void MeasureRecord(const char *pchName, uint64_t frameCount, int64_t gapUs) {
+    GazeRecorder recorder;
+    recorder.Initialize();
+    recorder.Start();
+
+    Hmd2GazeState rawState = {};
+    Hmd2GazeState calibratedState = {};
+    CommandDataServerGazeDataResult2_t gazeResult = {};
+
+    std::vector<int64_t> costs;
+    costs.reserve(frameCount);
+    for (uint64_t sequence = 1; sequence <= frameCount; sequence++) {
+      rawState.combined.gazeDirNorm.x = static_cast<float>(sequence);
+      calibratedState.combined.gazeDirNorm.x = static_cast<float>(sequence);
+      gazeResult.sequence = sequence;
+      gazeResult.hostTimestampUs = static_cast<int64_t>(sequence) * 4167;
+
+      int64_t startNs = GetBenchTimestampNs();
+      recorder.Record(rawState, 64, calibratedState, gazeResult);
+      costs.push_back(GetBenchTimestampNs() - startNs);
+
+      if (gapUs > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(gapUs));
+      }
+    }
+
+    recorder.Stop();
+    CommandDataServerGazeRecordingStatus_t status;
+    recorder.GetStatus(&status);
+    recorder.Shutdown();
+
+    std::sort(costs.begin(), costs.end());
+    auto percentileUs = [&](double percentile) {
+      return costs[static_cast<size_t>(percentile * (costs.size() - 1))] / 1000.0;
+    };
+    printf("%-14s %8llu frames, %5.2f chunks, p50 %6.3f us, p99 %6.3f us, p99.9 %7.3f us, max %8.3f us, %llu dropped, p99 %s %.0f us\n",
+           pchName, static_cast<unsigned long long>(frameCount), static_cast<double>(frameCount) / k_unFramesPerChunk,
+           percentileUs(0.5), percentileUs(0.99), percentileUs(0.999), costs.back() / 1000.0,
+           static_cast<unsigned long long>(status.droppedFrameCount), percentileUs(0.99) < k_budgetUs ? "under" : "OVER", k_budgetUs);
+  }
+
+} // namespace
+
+int main() {
+  FakeDriverContext context;
+  std::filesystem::path directory = std::filesystem::temp_directory_path() / "gaze_recorder_bench";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_RECORDING_DIRECTORY, directory.string());
+
+  // Recordings are named after the second they started in, wait out the second between runs.
+  MeasureRecord("paced", k_unFramesPerChunk * 3, 50);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  MeasureRecord("back to back", k_unFramesPerChunk * 3, 0);
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include "test_harness.h"
+
+#include "fake_driver_context.h"
+#include "gaze_event_scoring.h"
+
+#include "gaze_recorder.h"
+#include "vr_settings.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr uint32_t k_unFramesPerChunk = k_unGazeRecordingChunkSize / sizeof(GazeRecordingFrame_t);
+
+  // An empty directory of its own for each test, recordings are named after the second they started in.
+  std::filesystem::path MakeRecordingDirectory(FakeDriverContext &context, const char *pchName) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / pchName;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_GAZE_RECORDING_DIRECTORY, directory.string());
+    return directory;
+  }
+
+  std::vector<std::filesystem::path> ListRecordings(const std::filesystem::path &directory) {
+    std::vector<std::filesystem::path> recordings;
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory)) {
+      if (entry.path().extension() == GAZE_RECORDING_FILE_EXTENSION) {
+        recordings.push_back(entry.path());
+      }
+    }
+    return recordings;
+  }
+
+  void RecordFrame(GazeRecorder &recorder, uint64_t sequence) {
+    Hmd2GazeState rawState = {};
+    rawState.combined.isGazeDirValid = HMD2_BOOL_TRUE;
+    rawState.combined.gazeDirNorm = { static_cast<float>(sequence), 0.0f, -1.0f };
+
+    Hmd2GazeState calibratedState = rawState;
+    calibratedState.combined.gazeDirNorm.y = 0.5f;
+
+    CommandDataServerGazeDataResult2_t gazeResult = {};
+    gazeResult.sequence = sequence;
+    gazeResult.hmdTimestampUs = sequence * 4167;
+    gazeResult.hostTimestampUs = 1000000 + static_cast<int64_t>(sequence) * 4167;
+    recorder.Record(rawState, 64, calibratedState, gazeResult);
+  }
+
+  // Every frame, in order, with the calibrated state that went in.
+  void CheckRecording(const std::filesystem::path &path, uint64_t frameCount) {
+    std::vector<LabeledSample_t> samples;
+    std::string error;
+    CHECK(LoadRecording(path.string(), &samples, &error));
+    CHECK(samples.size() == frameCount);
+
+    bool isIntact = true;
+    for (size_t i = 0; i < samples.size(); i++) {
+      const CommandDataServerGazeDataResult2_t &gazeResult = samples[i].gazeResult;
+      isIntact = isIntact && gazeResult.sequence == i + 1 && gazeResult.hostTimestampUs == 1000000 + static_cast<int64_t>(i + 1) * 4167 &&
+                 gazeResult.combined.gazeDirNorm.x == static_cast<float>(i + 1) && gazeResult.combined.gazeDirNorm.y == 0.5f;
+    }
+    CHECK(isIntact);
+
+    // The unused rest of the last chunk is cut off.
+    uint64_t lastChunkFrames = frameCount % k_unFramesPerChunk;
+    uint64_t expectedSize = k_unGazeRecordingHeaderSize + (frameCount / k_unFramesPerChunk) * static_cast<uint64_t>(k_unGazeRecordingChunkSize) +
+                            lastChunkFrames * sizeof(GazeRecordingFrame_t);
+    CHECK(std::filesystem::file_size(path) == expectedSize);
+  }
+
+} // namespace
+
+TEST_CASE(RecordsAcrossChunks) {
+  FakeDriverContext context;
+  std::filesystem::path directory = MakeRecordingDirectory(context, "gaze_recorder_test_chunks");
+
+  GazeRecorder recorder;
+  recorder.Initialize();
+  CHECK(recorder.Initialized());
+
+  // Nothing is recorded before the start.
+  RecordFrame(recorder, 1000);
+  CHECK(ListRecordings(directory).empty());
+
+  recorder.Start();
+  uint64_t frameCount = k_unFramesPerChunk + k_unFramesPerChunk / 4;
+  for (uint64_t sequence = 1; sequence <= frameCount; sequence++) {
+    RecordFrame(recorder, sequence);
+  }
+  recorder.Stop();
+
+  CommandDataServerGazeRecordingStatus_t status;
+  recorder.GetStatus(&status);
+  CHECK(!status.isRecording);
+  CHECK(status.frameCount == frameCount);
+  CHECK(status.droppedFrameCount == 0);
+
+  recorder.Shutdown();
+  CHECK(!recorder.Initialized());
+
+  std::vector<std::filesystem::path> recordings = ListRecordings(directory);
+  CHECK(recordings.size() == 1);
+  if (recordings.size() == 1) {
+    CheckRecording(recordings[0], frameCount);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(ShutdownFinishesTheRecording) {
+  FakeDriverContext context;
+  std::filesystem::path directory = MakeRecordingDirectory(context, "gaze_recorder_test_shutdown");
+
+  GazeRecorder recorder;
+  recorder.Initialize();
+  recorder.Start();
+  for (uint64_t sequence = 1; sequence <= 500; sequence++) {
+    RecordFrame(recorder, sequence);
+  }
+
+  // Without a stop first, the writer thread still closes the file cleanly on its way out.
+  recorder.Shutdown();
+
+  CommandDataServerGazeRecordingStatus_t status;
+  recorder.GetStatus(&status);
+  CHECK(!status.isRecording);
+
+  // Once shut down, nothing waits on the writer thread that is gone, and nothing is recorded.
+  recorder.Start();
+  RecordFrame(recorder, 501);
+  recorder.Stop();
+  recorder.Shutdown();
+
+  std::vector<std::filesystem::path> recordings = ListRecordings(directory);
+  CHECK(recordings.size() == 1);
+  if (recordings.size() == 1) {
+    CheckRecording(recordings[0], 500);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(ShutdownWhileIdle) {
+  FakeDriverContext context;
+  std::filesystem::path directory = MakeRecordingDirectory(context, "gaze_recorder_test_idle");
+
+  GazeRecorder recorder;
+  recorder.Shutdown(); // Never initialized.
+  recorder.Initialize();
+  recorder.Shutdown();
+  CHECK(!recorder.Initialized());
+  CHECK(ListRecordings(directory).empty());
+
+  std::filesystem::remove_all(directory);
+}
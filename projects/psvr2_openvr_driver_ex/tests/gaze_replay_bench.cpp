@@ -0,0 +1,117 @@
+#include "bench_harness.h"
+
+#include "fake_driver_context.h"
+#include "fake_gaze_stages.h"
+#include "synthetic_gaze.h"
+
+#include "gaze_calibration_store.h"
+#include "gaze_filter.h"
+#include "gaze_foveation.h"
+#include "gaze_fusion.h"
+#include "gaze_metrics.h"
+#include "gaze_pipeline.h"
+#include "gaze_recorder.h"
+#include "gaze_replay.h"
+#include "util.h"
+#include "vr_settings.h"
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+// Replays a gaze recording through the whole pipeline as fast as possible, against stubs for SteamVR and the IPC clients,
+// and reports the throughput and each stage's latency.
+// Usage: gaze_replay_bench [recording.pvgr], a synthetic recording with single eye dropouts is used without one.
+int main(int argc, char **argv) {
+  constexpr int k_runCount = 5;
+
+  FakeDriverContext context;
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FUSION, "true");
+  context.settings.Set(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, STEAMVR_SETTINGS_ENABLE_GAZE_FILTER, "true");
+
+  FakeGazeOpenVrUpdate *pOpenVrUpdate = new FakeGazeOpenVrUpdate;
+  FakeGazeIpcSink *pIpcSink = new FakeGazeIpcSink;
+  pOpenVrUpdate->keepUpdates = false;
+  pIpcSink->keepResults = false;
+
+  GazeMetrics::Instance()->Initialize();
+  GazeCalibrationStore::Instance()->Initialize();
+  GazeFusion::Instance()->Initialize();
+  GazeFilter::Instance()->Initialize();
+  GazeFoveation::Instance()->Initialize();
+  GazeRecorder::Instance()->Initialize();
+  GazePipeline::Instance()->Initialize(new FakeGazeDriverInput, pOpenVrUpdate, pIpcSink);
+  GazeReplay::Instance()->Initialize();
+  int64_t metricsStartUs = Util::GetHostTimestamp();
+
+  std::string path;
+  bool isSynthetic = argc < 2;
+  if (isSynthetic) {
+    // About 4 minutes of gaze.
+    std::mt19937 random(20);
+    path = (std::filesystem::temp_directory_path() / "gaze_replay_bench.pvgr").string();
+    if (!WriteSyntheticRecording(path, MakeSyntheticGaze(random, 57600, 0.2f), 1000000)) {
+      printf("Writing %s failed.\n", path.c_str());
+      return 1;
+    }
+  } else {
+    path = argv[1];
+  }
+
+  GazeReplay *pGazeReplay = GazeReplay::Instance();
+  printf("%4s %10s %12s %12s %14s\n", "run", "frames", "pipeline us", "us/frame", "frames/s");
+  for (int run = 1; run <= k_runCount; run++) {
+    if (!pGazeReplay->Start(path, true)) {
+      printf("Replaying %s failed.\n", path.c_str());
+      return 1;
+    }
+
+    CommandDataServerGazeReplayStatus_t status;
+    do {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      pGazeReplay->GetStatus(&status);
+    } while (status.isReplaying);
+    pGazeReplay->Stop();
+
+    double usPerFrame = static_cast<double>(status.processingTimeUs) / static_cast<double>(status.replayedFrameCount);
+    printf("%4d %10llu %12llu %12.3f %14.0f\n", run, static_cast<unsigned long long>(status.replayedFrameCount),
+           static_cast<unsigned long long>(status.processingTimeUs), usPerFrame, 1e6 / usPerFrame);
+  }
+
+  if (pOpenVrUpdate->updateCount != pIpcSink->resultCount) {
+    printf("SteamVR was updated %llu times, but %llu samples were published.\n",
+           static_cast<unsigned long long>(pOpenVrUpdate->updateCount), static_cast<unsigned long long>(pIpcSink->resultCount));
+    return 1;
+  }
+
+  // The stage times are only converted once the TSC rate has been measured over a second.
+  int64_t waitUs = metricsStartUs + 1100000 - Util::GetHostTimestamp();
+  if (waitUs > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+  }
+
+  CommandDataServerGazeStats_t stats;
+  GazeMetrics::Instance()->GetStats(&stats);
+
+  printf("\n%-14s %10s %9s %9s %9s %9s %10s\n", "stage", "count", "mean ns", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+  for (uint32_t i = 0; i < GazeStage_Count; i++) {
+    const GazeStageStats_t &stage = stats.stages[i];
+    if (stage.count == 0) {
+      continue;
+    }
+
+    printf("%-14s %10llu %9u %9u %9u %9u %10u\n", GazeMetrics::GetStageName(static_cast<EGazeStage>(i)),
+           static_cast<unsigned long long>(stage.count), stage.meanNs, stage.p50Ns, stage.p99Ns, stage.p999Ns, stage.maxNs);
+  }
+
+  if (isSynthetic) {
+    std::filesystem::remove(path);
+  }
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include "test_harness.h"
+
+#include "../shared/gaze_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace {
+
+  // The ring in POSIX shared memory, mapped twice the way the driver and a client map it on Windows:
+  // read-write for the writer, and read-only for the readers.
+  class SharedGazeRing {
+  public:
+    SharedGazeRing()
+      : m_name("/psvr2_gaze_ring_test_" + std::to_string(getpid()))
+      , m_pWritable(nullptr)
+      , m_pReadOnly(nullptr)
+    {
+      int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      if (fd < 0) {
+        return;
+      }
+      if (ftruncate(fd, sizeof(GazeRing_t)) == 0) {
+        void *pView = mmap(nullptr, sizeof(GazeRing_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        m_pWritable = pView != MAP_FAILED ? static_cast<GazeRing_t *>(pView) : nullptr;
+      }
+      close(fd);
+
+      fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+      if (fd < 0) {
+        return;
+      }
+      void *pView = mmap(nullptr, sizeof(GazeRing_t), PROT_READ, MAP_SHARED, fd, 0);
+      m_pReadOnly = pView != MAP_FAILED ? static_cast<const GazeRing_t *>(pView) : nullptr;
+      close(fd);
+    }
+
+    ~SharedGazeRing() {
+      if (m_pReadOnly) {
+        munmap(const_cast<GazeRing_t *>(m_pReadOnly), sizeof(GazeRing_t));
+      }
+      if (m_pWritable) {
+        munmap(m_pWritable, sizeof(GazeRing_t));
+      }
+      shm_unlink(m_name.c_str());
+    }
+
+    bool Mapped() const {
+      return m_pWritable && m_pReadOnly;
+    }
+
+    GazeRing_t *Writable() const {
+      return m_pWritable;
+    }
+
+    const GazeRing_t *ReadOnly() const {
+      return m_pReadOnly;
+    }
+
+  private:
+    std::string m_name;
+    GazeRing_t *m_pWritable;
+    const GazeRing_t *m_pReadOnly;
+  };
+
+  // Every field is derived from the sequence, so a sample mixing two publishes doesn't add up.
+  GazeRingSample_t MakeSample(uint64_t sequence) {
+    float value = static_cast<float>(sequence % 1000003);
+
+    GazeRingSample_t sample = {};
+    sample.sequence = sequence;
+    sample.hmdTimestampUs = sequence * 4167;
+    sample.hostTimestampUs = static_cast<int64_t>(sequence) * 4167 + 23;
+    sample.leftEye.gazeDirNorm = { value, value + 1.0f, value + 2.0f };
+    sample.leftEye.pupilDiaMm = value + 3.0f;
+    sample.rightEye.gazeDirNorm = { -value, -value - 1.0f, -value - 2.0f };
+    sample.rightEye.pupilDiaMm = -value - 3.0f;
+    sample.combined.gazeDirNorm = { value, -value, value };
+    return sample;
+  }
+
+  bool IsConsistent(const GazeRingSample_t &sample) {
+    GazeRingSample_t expected = MakeSample(sample.sequence);
+    return memcmp(&sample, &expected, sizeof(sample)) == 0;
+  }
+
+} // namespace
+
+TEST_CASE(ValidOnceInitialized) {
+  SharedGazeRing ring;
+  CHECK(ring.Mapped());
+  if (!ring.Mapped()) {
+    return;
+  }
+
+  // A freshly created section is all zeroes, which a client must not take for a ring.
+  GazeRingReader reader(ring.ReadOnly());
+  CHECK(!reader.Valid());
+
+  GazeRingWriter writer(ring.Writable());
+  writer.Initialize();
+  CHECK(reader.Valid());
+
+  GazeRingSample_t sample;
+  CHECK(reader.LatestSequence() == 0);
+  CHECK(!reader.ReadLatest(sample));
+}
+
+TEST_CASE(ReadLatestReturnsNewest) {
+  SharedGazeRing ring;
+  CHECK(ring.Mapped());
+  if (!ring.Mapped()) {
+    return;
+  }
+
+  GazeRingWriter writer(ring.Writable());
+  GazeRingReader reader(ring.ReadOnly());
+  writer.Initialize();
+
+  // Gaps are allowed, the driver skips sequence numbers it dropped.
+  for (uint64_t sequence : { 1, 2, 3, 5 }) {
+    writer.Publish(MakeSample(sequence));
+  }
+
+  GazeRingSample_t sample;
+  CHECK(reader.ReadLatest(sample));
+  CHECK(sample.sequence == 5);
+  CHECK(IsConsistent(sample));
+
+  CHECK(reader.Read(2, sample));
+  CHECK(sample.sequence == 2);
+  CHECK(IsConsistent(sample));
+  CHECK(!reader.Read(4, sample));
+  CHECK(!reader.Read(6, sample));
+}
+
+TEST_CASE(DetectsOverwrittenSamples) {
+  SharedGazeRing ring;
+  CHECK(ring.Mapped());
+  if (!ring.Mapped()) {
+    return;
+  }
+
+  GazeRingWriter writer(ring.Writable());
+  GazeRingReader reader(ring.ReadOnly());
+  writer.Initialize();
+
+  uint64_t lastSequence = k_unGazeRingCapacity + 10;
+  for (uint64_t sequence = 1; sequence <= lastSequence; sequence++) {
+    writer.Publish(MakeSample(sequence));
+  }
+
+  // The first ten entries have been lapped, the rest of the first pass is still there.
+  GazeRingSample_t sample;
+  for (uint64_t sequence = 1; sequence <= 10; sequence++) {
+    CHECK(!reader.Read(sequence, sample));
+  }
+  CHECK(reader.Read(11, sample));
+  CHECK(sample.sequence == 11);
+  CHECK(reader.Read(lastSequence, sample));
+  CHECK(IsConsistent(sample));
+  CHECK(!reader.Read(lastSequence + 1, sample));
+
+  CHECK(reader.ReadLatest(sample));
+  CHECK(sample.sequence == lastSequence);
+}
+
+TEST_CASE(ConcurrentWriterAndReadersNeverTear) {
+  SharedGazeRing ring;
+  CHECK(ring.Mapped());
+  if (!ring.Mapped()) {
+    return;
+  }
+
+  GazeRingWriter writer(ring.Writable());
+  writer.Initialize();
+
+  std::atomic<bool> running = true;
+  std::atomic<uint64_t> readCount = 0;
+  std::atomic<uint64_t> tornCount = 0;
+  std::atomic<uint64_t> backwardsCount = 0;
+
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() {
+    for (uint64_t sequence = 1; running.load(std::memory_order_relaxed); sequence++) {
+      writer.Publish(MakeSample(sequence));
+    }
+  });
+
+  int readerCount = static_cast<int>((std::max)(std::thread::hardware_concurrency(), 4u));
+  for (int i = 0; i < readerCount; i++) {
+    threads.emplace_back([&]() {
+      GazeRingReader reader(ring.ReadOnly());
+      uint64_t lastSequence = 0;
+      uint64_t reads = 0;
+      GazeRingSample_t sample;
+      while (running.load(std::memory_order_relaxed)) {
+        if (!reader.ReadLatest(sample)) {
+          continue;
+        }
+
+        reads++;
+        if (!IsConsistent(sample)) {
+          tornCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (sample.sequence < lastSequence) {
+          backwardsCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        lastSequence = sample.sequence;
+
+        // Catching up on older samples races the writer lapping them, which must fail rather than tear.
+        uint64_t olderSequence = sample.sequence > k_unGazeRingCapacity / 2 ? sample.sequence - k_unGazeRingCapacity / 2 : 1;
+        if (reader.Read(olderSequence, sample) && (sample.sequence != olderSequence || !IsConsistent(sample))) {
+          tornCount.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      readCount.fetch_add(reads, std::memory_order_relaxed);
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  running = false;
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  printf("  %llu reads\n", static_cast<unsigned long long>(readCount.load()));
+  CHECK(readCount.load() > 0);
+  CHECK(tornCount.load() == 0);
+  CHECK(backwardsCount.load() == 0);
+}
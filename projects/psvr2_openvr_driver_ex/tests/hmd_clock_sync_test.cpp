@@ -0,0 +1,174 @@
+#include "test_harness.h"
+
+#include "hmd_clock_sync.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  constexpr int64_t k_sampleIntervalUs = 4167;
+  constexpr int64_t k_wrapUs = int64_t(1) << 32;
+
+  // A headset whose 32-bit microsecond clock runs driftPpm off the host's. The PS VR2 driver converts its timestamps
+  // with a couple of microseconds of noise and the odd outlier, and doesn't account for the 32-bit wrap.
+  class SimulatedHeadset {
+  public:
+    SimulatedHeadset(uint32_t seed, double driftPpm, int64_t hmdStartUs, int64_t hostStartUs, double outlierFraction)
+      : m_random(seed)
+      , m_noise(0.0, 2.0)
+      , m_outlierUs(200.0, 2000.0)
+      , m_isOutlier(outlierFraction)
+      , m_isNegative(0.5)
+      , m_drift(driftPpm * 1e-6)
+      , m_hmdBaseUs(hmdStartUs)
+      , m_hostBaseUs(hostStartUs)
+      , m_hmdUs(hmdStartUs)
+    {}
+
+    void Advance(int64_t us) {
+      m_hmdUs += us;
+    }
+
+    // The HMD clock restarts from hmdUs, e.g. after a reconnect, the host clock carries on.
+    void ResetHmdClock(int64_t hmdUs) {
+      m_hostBaseUs = GetTrueHostUs();
+      m_hmdBaseUs = hmdUs;
+      m_hmdUs = hmdUs;
+    }
+
+    // The host clock steps by us, as the PS VR2 driver's offset does when it resynchronizes.
+    void StepHostClock(int64_t us) {
+      m_hostBaseUs += us;
+    }
+
+    uint32_t GetHmdTimestamp() const {
+      return static_cast<uint32_t>(m_hmdUs);
+    }
+
+    double GetTrueHostUs() const {
+      return static_cast<double>(m_hostBaseUs) + static_cast<double>(m_hmdUs - m_hmdBaseUs) * (1.0 + m_drift);
+    }
+
+    // What HmdDeviceHooks::HmdToHostTimestamp would return.
+    int64_t HmdToHostTimestamp() {
+      double offsetUs = GetTrueHostUs() - static_cast<double>(m_hmdUs) + m_noise(m_random);
+      if (m_isOutlier(m_random)) {
+        offsetUs += m_isNegative(m_random) ? -m_outlierUs(m_random) : m_outlierUs(m_random);
+      }
+
+      // Added to the 32-bit timestamp, so a wrap comes out 2^32 short.
+      return static_cast<int64_t>(GetHmdTimestamp()) + std::llround(offsetUs);
+    }
+
+  private:
+    std::mt19937 m_random;
+    std::normal_distribution<double> m_noise;
+    std::uniform_real_distribution<double> m_outlierUs;
+    std::bernoulli_distribution m_isOutlier;
+    std::bernoulli_distribution m_isNegative;
+
+    double m_drift;
+    int64_t m_hmdBaseUs;
+    int64_t m_hostBaseUs;
+    int64_t m_hmdUs;
+  };
+
+  struct SimulationResult_t {
+    uint32_t offsetSampleCount;
+    double maxErrorUs; // Once settled.
+  };
+
+  // Runs the clock sync the way GazePipeline::ProcessLive does, for durationUs of gaze samples.
+  // Conversions are only scored settleUs after the start.
+  SimulationResult_t Simulate(HmdClockSync &clockSync, SimulatedHeadset &headset, int64_t durationUs, int64_t settleUs) {
+    SimulationResult_t result = {};
+    for (int64_t elapsedUs = 0; elapsedUs < durationUs; elapsedUs += k_sampleIntervalUs) {
+      uint64_t hmdTimestampUs = clockSync.Unwrap(headset.GetHmdTimestamp());
+      if (clockSync.IsOffsetSampleDue(hmdTimestampUs)) {
+        clockSync.AddOffsetSample(hmdTimestampUs, headset.HmdToHostTimestamp());
+        result.offsetSampleCount++;
+      }
+
+      if (elapsedUs >= settleUs) {
+        double errorUs = static_cast<double>(clockSync.ToHost(hmdTimestampUs)) - headset.GetTrueHostUs();
+        result.maxErrorUs = (std::max)(result.maxErrorUs, std::abs(errorUs));
+      }
+
+      headset.Advance(k_sampleIntervalUs);
+    }
+
+    return result;
+  }
+
+} // namespace
+
+TEST_CASE(TracksDriftThroughAWrap) {
+  for (double driftPpm : { 30.0, -30.0 }) {
+    // The HMD clock wraps a minute in.
+    HmdClockSync clockSync;
+    SimulatedHeadset headset(22, driftPpm, k_wrapUs - 60000000, 123456789012, 0.05);
+
+    SimulationResult_t result = Simulate(clockSync, headset, 120000000, 5000000);
+    CHECK(result.maxErrorUs <= 9.0);
+
+    // Sampled every 250 ms, not every sample.
+    CHECK(result.offsetSampleCount >= 470 && result.offsetSampleCount <= 490);
+
+    CommandDataServerGazeClockStatus_t status;
+    clockSync.GetStatus(&status);
+    CHECK(status.isSynchronized);
+    CHECK_NEAR(status.driftPpm, driftPpm, 3.0);
+    // Outliers are left out of the fit.
+    CHECK(status.offsetSampleCount < 64);
+    CHECK(status.offsetResidualMaxUs < 20.0f);
+  }
+}
+
+TEST_CASE(FollowsAWrapStraightAway) {
+  // Wraps before the fit has seen more than a couple of samples.
+  HmdClockSync clockSync;
+  SimulatedHeadset headset(23, 30.0, k_wrapUs - 600000, 5000000, 0.0);
+
+  SimulationResult_t result = Simulate(clockSync, headset, 30000000, 0);
+  CHECK(result.maxErrorUs <= 20.0);
+}
+
+TEST_CASE(StartsOverAfterTheHmdClockResets) {
+  HmdClockSync clockSync;
+  SimulatedHeadset headset(24, 30.0, 1000000000, 123456789012, 0.05);
+  SimulationResult_t result = Simulate(clockSync, headset, 20000000, 5000000);
+  CHECK(result.maxErrorUs <= 9.0);
+
+  // A reconnect takes the HMD clock back to where it started, the old fit must not carry over.
+  headset.ResetHmdClock(1000000);
+  result = Simulate(clockSync, headset, 2000000, 0);
+  CHECK(result.maxErrorUs <= 3000.0);
+  result = Simulate(clockSync, headset, 20000000, 3000000);
+  CHECK(result.maxErrorUs <= 9.0);
+}
+
+TEST_CASE(StartsOverAfterTheOffsetJumps) {
+  HmdClockSync clockSync;
+  SimulatedHeadset headset(25, -30.0, 2000000000, 98765432100, 0.05);
+  SimulationResult_t result = Simulate(clockSync, headset, 20000000, 5000000);
+  CHECK(result.maxErrorUs <= 9.0);
+
+  // A second's step is taken on the next offset sample, instead of being rejected as an outlier forever.
+  headset.StepHostClock(1000000);
+  result = Simulate(clockSync, headset, 2000000, 300000);
+  CHECK(result.maxErrorUs <= 3000.0);
+  result = Simulate(clockSync, headset, 20000000, 3000000);
+  CHECK(result.maxErrorUs <= 9.0);
+
+  // A step under the jump threshold is an outlier at first, then the fit moves over to it.
+  headset.StepHostClock(20000);
+  result = Simulate(clockSync, headset, 30000000, 25000000);
+  CHECK(result.maxErrorUs <= 9.0);
+}
@@ -0,0 +1,287 @@
+#include "test_harness.h"
+
+#include "ipc_ping_server.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  struct SocketPair_t {
+    int loopSide;
+    int peerSide;
+  };
+
+  SocketPair_t MakeSocketPair() {
+    int sockets[2] = { -1, -1 };
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+    return { sockets[0], sockets[1] };
+  }
+
+  template <typename Condition>
+  bool WaitFor(Condition &&condition) {
+    for (int i = 0; i < 5000 && !condition(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+  }
+
+} // namespace
+
+TEST_CASE(WakeCarriesReasonAndData) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  int data = 0;
+  std::thread waker([&]() {
+    eventLoop.Wake(7, &data);
+  });
+
+  IpcEvent_t event;
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Wake);
+  CHECK(event.wakeReason == 7);
+  CHECK(event.pKey == &data);
+  CHECK(event.pContext == nullptr);
+  waker.join();
+}
+
+TEST_CASE(WakesAreNotCoalesced) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  for (uint32_t i = 0; i < 100; i++) {
+    CHECK(eventLoop.Wake(i));
+  }
+  for (uint32_t i = 0; i < 100; i++) {
+    IpcEvent_t event;
+    CHECK(eventLoop.Wait(event));
+    CHECK(event.type == IpcEvent_Wake && event.wakeReason == i);
+  }
+}
+
+TEST_CASE(RecvCompletesWhetherDataIsThereOrNot) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  SocketPair_t pair = MakeSocketPair();
+  int key = 0;
+  CHECK(eventLoop.Associate(pair.loopSide, &key));
+
+  // Already there when the receive is posted.
+  CHECK(write(pair.peerSide, "abc", 3) == 3);
+
+  char pBuffer[16];
+  IpcIoContext_t context = {};
+  CHECK(eventLoop.PostRecv(pair.loopSide, &context, pBuffer, sizeof(pBuffer)));
+
+  IpcEvent_t event;
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Recv);
+  CHECK(event.pKey == &key);
+  CHECK(event.pContext == &context);
+  CHECK(event.succeeded);
+  CHECK(event.bytesTransferred == 3);
+  CHECK(std::string(pBuffer, 3) == "abc");
+
+  // Arrives while the receive is pending.
+  CHECK(eventLoop.PostRecv(pair.loopSide, &context, pBuffer, sizeof(pBuffer)));
+  std::thread writer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(write(pair.peerSide, "defg", 4) == 4);
+  });
+
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Recv);
+  CHECK(event.succeeded);
+  CHECK(event.bytesTransferred == 4);
+  CHECK(std::string(pBuffer, 4) == "defg");
+  writer.join();
+
+  // A second receive can't be posted while one is outstanding.
+  CHECK(eventLoop.PostRecv(pair.loopSide, &context, pBuffer, sizeof(pBuffer)));
+  IpcIoContext_t otherContext = {};
+  CHECK(!eventLoop.PostRecv(pair.loopSide, &otherContext, pBuffer, sizeof(pBuffer)));
+
+  // A graceful close is a successful empty receive, like on a completion port.
+  close(pair.peerSide);
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Recv);
+  CHECK(event.succeeded);
+  CHECK(event.bytesTransferred == 0);
+
+  eventLoop.Close(pair.loopSide);
+}
+
+TEST_CASE(CloseFailsOutstandingIo) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  SocketPair_t pair = MakeSocketPair();
+  int key = 0;
+  CHECK(eventLoop.Associate(pair.loopSide, &key));
+
+  char pBuffer[16];
+  IpcIoContext_t context = {};
+  CHECK(eventLoop.PostRecv(pair.loopSide, &context, pBuffer, sizeof(pBuffer)));
+
+  eventLoop.Close(pair.loopSide);
+
+  IpcEvent_t event;
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Recv);
+  CHECK(event.pKey == &key);
+  CHECK(event.pContext == &context);
+  CHECK(!event.succeeded);
+
+  // The socket is gone from the loop.
+  CHECK(!eventLoop.PostRecv(pair.loopSide, &context, pBuffer, sizeof(pBuffer)));
+  close(pair.peerSide);
+}
+
+TEST_CASE(GatherSendCompletesOnceEverythingIsWritten) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  SocketPair_t pair = MakeSocketPair();
+  CHECK(eventLoop.Associate(pair.loopSide, nullptr));
+
+  // Far more than the socket buffer holds, so the send has to wait for the peer to drain it several times.
+  static constexpr uint32_t k_unBufferLen = 64 * 1024;
+  std::vector<std::string> buffers;
+  std::vector<IpcBuffer_t> ipcBuffers;
+  std::string expected;
+  for (uint32_t i = 0; i < k_unMaxIpcBuffers; i++) {
+    buffers.push_back(std::string(k_unBufferLen + i, static_cast<char>('a' + i % 26)));
+    expected += buffers.back();
+  }
+  for (std::string &buffer : buffers) {
+    ipcBuffers.push_back({ static_cast<unsigned long>(buffer.size()), buffer.data() });
+  }
+
+  IpcIoContext_t context = {};
+  CHECK(eventLoop.PostSend(pair.loopSide, &context, ipcBuffers.data(), static_cast<uint32_t>(ipcBuffers.size())));
+  CHECK(!eventLoop.PostSend(pair.loopSide, &context, ipcBuffers.data(), k_unMaxIpcBuffers + 1));
+
+  std::string received;
+  std::thread reader([&]() {
+    char pBuffer[4096];
+    while (received.size() < expected.size()) {
+      ssize_t len = read(pair.peerSide, pBuffer, sizeof(pBuffer));
+      if (len <= 0) {
+        break;
+      }
+      received.append(pBuffer, len);
+    }
+  });
+
+  IpcEvent_t event;
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Send);
+  CHECK(event.pContext == &context);
+  CHECK(event.succeeded);
+  CHECK(event.bytesTransferred == expected.size());
+
+  reader.join();
+  CHECK(received == expected);
+
+  eventLoop.Close(pair.loopSide);
+  close(pair.peerSide);
+}
+
+TEST_CASE(SendToClosedPeerFails) {
+  IpcEventLoop eventLoop;
+  CHECK(eventLoop.Create());
+
+  SocketPair_t pair = MakeSocketPair();
+  CHECK(eventLoop.Associate(pair.loopSide, nullptr));
+  close(pair.peerSide);
+
+  char pData[] = "ping";
+  IpcBuffer_t buffer = { sizeof(pData), pData };
+  IpcIoContext_t context = {};
+  CHECK(eventLoop.PostSend(pair.loopSide, &context, &buffer, 1)); // No SIGPIPE either.
+
+  IpcEvent_t event;
+  CHECK(eventLoop.Wait(event));
+  CHECK(event.type == IpcEvent_Send);
+  CHECK(!event.succeeded);
+
+  eventLoop.Close(pair.loopSide);
+}
+
+TEST_CASE(ServerAnswersMoreThan64Clients) {
+  static constexpr uint32_t k_unClientCount = 100;
+
+  IpcPingServer<256> server;
+  CHECK(server.Start());
+
+  std::vector<IpcSocket_t> clients;
+  for (uint32_t i = 0; i < k_unClientCount; i++) {
+    clients.push_back(ConnectPingClient(server.Port()));
+    CHECK(clients.back() != -1);
+  }
+
+  for (int round = 0; round < 3; round++) {
+    for (IpcSocket_t client : clients) {
+      CHECK(PingRoundTrip(client, 1 + round * 7));
+    }
+  }
+  CHECK(server.ConnectionCount() == k_unClientCount);
+  CHECK(server.RejectedCount() == 0);
+
+  // Half of them leave, the rest are still served.
+  for (uint32_t i = 0; i < k_unClientCount / 2; i++) {
+    close(clients[i]);
+  }
+  CHECK(WaitFor([&]() { return server.ConnectionCount() == k_unClientCount / 2; }));
+  for (uint32_t i = k_unClientCount / 2; i < k_unClientCount; i++) {
+    CHECK(PingRoundTrip(clients[i]));
+  }
+
+  server.Stop();
+  CHECK(server.ConnectionCount() == 0);
+
+  for (uint32_t i = k_unClientCount / 2; i < k_unClientCount; i++) {
+    char byte;
+    CHECK(recv(clients[i], &byte, 1, 0) == 0); // Closed by the server on shutdown.
+    close(clients[i]);
+  }
+}
+
+TEST_CASE(FullRegistryRejectsClient) {
+  IpcPingServer<4> server;
+  CHECK(server.Start());
+
+  std::vector<IpcSocket_t> clients;
+  for (uint32_t i = 0; i < 4; i++) {
+    clients.push_back(ConnectPingClient(server.Port()));
+    CHECK(PingRoundTrip(clients.back()));
+  }
+
+  IpcSocket_t rejected = ConnectPingClient(server.Port());
+  CHECK(rejected != -1);
+  char byte;
+  CHECK(recv(rejected, &byte, 1, 0) <= 0);
+  CHECK(server.RejectedCount() == 1);
+  close(rejected);
+
+  // A slot freed by a client leaving is handed to the next one.
+  close(clients[0]);
+  CHECK(WaitFor([&]() { return server.ConnectionCount() == 3; }));
+  clients[0] = ConnectPingClient(server.Port());
+  CHECK(PingRoundTrip(clients[0]));
+
+  server.Stop();
+  for (IpcSocket_t client : clients) {
+    close(client);
+  }
+}
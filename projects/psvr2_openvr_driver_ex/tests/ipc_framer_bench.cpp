@@ -0,0 +1,67 @@
+#include "bench_harness.h"
+
+#include "ipc_framer.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  template <typename T>
+  void AppendCommand(std::string &stream, ECommandType type, const T &data) {
+    CommandHeader_t header = { type, static_cast<int32_t>(sizeof(T)) };
+    stream.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.append(reinterpret_cast<const char *>(&data), sizeof(T));
+  }
+
+} // namespace
+
+// Commands per second through the framer for a burst of trigger effects, as a game sends when a weapon changes,
+// arriving in reads of various sizes: small ones where every command is split, one TCP segment, and a full buffer.
+int main() {
+  std::string burst;
+  for (int i = 0; i < 64; i++) {
+    AppendCommand(burst, Command_ClientTriggerEffectWeapon, CommandDataClientTriggerEffectWeapon_t{ VRController_Left, 2, 6, 8 });
+    AppendCommand(burst, Command_ClientTriggerEffectMultiplePositionFeedback, CommandDataClientTriggerEffectMultiplePositionFeedback_t{ VRController_Right, { 1, 2, 3, 4, 5, 6, 7, 8, 8, 8 } });
+    AppendCommand(burst, Command_ClientTriggerEffectOff, CommandDataClientTriggerEffectOff_t{ VRController_Both });
+  }
+  constexpr uint64_t k_unCommandsPerBurst = 64 * 3;
+
+  printf("burst of %llu commands, %zu bytes\n", static_cast<unsigned long long>(k_unCommandsPerBurst), burst.size());
+  printf("%10s %16s %12s\n", "read size", "commands/s", "MB/s");
+
+  for (size_t readSize : { static_cast<size_t>(7), static_cast<size_t>(64), static_cast<size_t>(1460), IpcFramer::k_unBufferSize }) {
+    IpcFramer framer;
+    uint64_t commands = 0;
+    uint64_t bytes = 0;
+
+    int64_t startNs = GetBenchTimestampNs();
+    int64_t elapsedNs = 0;
+    while (elapsedNs < 500000000) {
+      for (int i = 0; i < 100; i++) {
+        size_t offset = 0;
+        while (offset < burst.size()) {
+          size_t len = (std::min)({ readSize, burst.size() - offset, static_cast<size_t>(framer.WritableSize()) });
+          memcpy(framer.WritePointer(), burst.data() + offset, len);
+          framer.Commit(static_cast<int>(len));
+          offset += len;
+
+          framer.Dispatch([&](const CommandHeader_t &header, void *pData) {
+            DoNotOptimize(pData);
+            commands += header.type != Command_ClientPing;
+          });
+        }
+        bytes += burst.size();
+      }
+      elapsedNs = GetBenchTimestampNs() - startNs;
+    }
+
+    double seconds = elapsedNs / 1e9;
+    printf("%10zu %16.0f %12.1f\n", readSize, commands / seconds, bytes / seconds / 1e6);
+  }
+
+  return 0;
+}
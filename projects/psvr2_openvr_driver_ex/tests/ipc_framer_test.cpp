@@ -0,0 +1,159 @@
+#include "test_harness.h"
+
+#include "ipc_framer.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace {
+
+  struct Received_t {
+    ECommandType type;
+    std::string data;
+  };
+
+  void AppendCommand(std::string &stream, ECommandType type, const std::string &data) {
+    CommandHeader_t header = { type, static_cast<int32_t>(data.size()) };
+    stream.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.append(data);
+  }
+
+  // Feeds the stream in reads of at most readSize bytes, like recv would hand it over.
+  bool Feed(IpcFramer &framer, const std::string &stream, size_t readSize, std::vector<Received_t> &received) {
+    size_t offset = 0;
+    while (offset < stream.size()) {
+      size_t len = (std::min)({ readSize, stream.size() - offset, static_cast<size_t>(framer.WritableSize()) });
+      memcpy(framer.WritePointer(), stream.data() + offset, len);
+      framer.Commit(static_cast<int>(len));
+      offset += len;
+
+      bool valid = framer.Dispatch([&](const CommandHeader_t &header, void *pData) {
+        received.push_back({ header.type, std::string(static_cast<char *>(pData), header.dataLen) });
+      });
+      if (!valid) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace
+
+TEST_CASE(SingleCommand) {
+  IpcFramer framer;
+  std::string stream;
+  AppendCommand(stream, Command_ClientTriggerEffectWeapon, std::string("\x01\x02\x03\x04", 4));
+
+  std::vector<Received_t> received;
+  CHECK(Feed(framer, stream, stream.size(), received));
+  CHECK(received.size() == 1);
+  CHECK(received[0].type == Command_ClientTriggerEffectWeapon);
+  CHECK(received[0].data == std::string("\x01\x02\x03\x04", 4));
+}
+
+TEST_CASE(CommandSplitAcrossReads) {
+  std::string stream;
+  AppendCommand(stream, Command_ClientTriggerEffectMultiplePositionFeedback, std::string(11, 'a'));
+
+  // Every possible split point, down to a byte at a time.
+  for (size_t readSize = 1; readSize < stream.size(); readSize++) {
+    IpcFramer framer;
+    std::vector<Received_t> received;
+    CHECK(Feed(framer, stream, readSize, received));
+    CHECK(received.size() == 1);
+    CHECK(received[0].data == std::string(11, 'a'));
+  }
+}
+
+TEST_CASE(HeaderSplitAcrossReads) {
+  IpcFramer framer;
+  std::string stream;
+  AppendCommand(stream, Command_ClientPing, "");
+
+  std::vector<Received_t> received;
+  CHECK(Feed(framer, stream.substr(0, 3), 3, received));
+  CHECK(received.empty());
+  CHECK(Feed(framer, stream.substr(3), 64, received));
+  CHECK(received.size() == 1);
+  CHECK(received[0].type == Command_ClientPing);
+}
+
+TEST_CASE(CoalescedCommandsDispatchedInOrder) {
+  IpcFramer framer;
+  std::string stream;
+  for (int i = 0; i < 100; i++) {
+    AppendCommand(stream, i % 2 ? Command_ClientTriggerEffectOff : Command_ClientTriggerEffectFeedback, std::string(i % 7, static_cast<char>(i)));
+  }
+
+  std::vector<Received_t> received;
+  CHECK(Feed(framer, stream, stream.size(), received));
+  CHECK(received.size() == 100);
+  for (int i = 0; i < 100 && i < static_cast<int>(received.size()); i++) {
+    CHECK(received[i].type == (i % 2 ? Command_ClientTriggerEffectOff : Command_ClientTriggerEffectFeedback));
+    CHECK(received[i].data == std::string(i % 7, static_cast<char>(i)));
+  }
+}
+
+TEST_CASE(PartialCommandKeptAfterCoalescedOnes) {
+  IpcFramer framer;
+  std::string stream;
+  AppendCommand(stream, Command_ClientPing, "");
+  AppendCommand(stream, Command_ClientTriggerEffectWeapon, "wxyz");
+  AppendCommand(stream, Command_ClientTriggerEffectVibration, "abcd");
+
+  // Everything but the last two bytes, then the rest.
+  std::vector<Received_t> received;
+  CHECK(Feed(framer, stream.substr(0, stream.size() - 2), stream.size(), received));
+  CHECK(received.size() == 2);
+  CHECK(Feed(framer, stream.substr(stream.size() - 2), stream.size(), received));
+  CHECK(received.size() == 3);
+  CHECK(received.back().data == "abcd");
+}
+
+TEST_CASE(LargestCommandFitsBehindPartial) {
+  IpcFramer framer;
+  std::string stream;
+  AppendCommand(stream, Command_ClientPing, "");
+  AppendCommand(stream, Command_ClientTriggerEffectOff, std::string(IpcFramer::k_nMaxDataLen, 'm'));
+
+  std::vector<Received_t> received;
+  CHECK(Feed(framer, stream, 1000, received));
+  CHECK(received.size() == 2);
+  CHECK(received.back().data.size() == static_cast<size_t>(IpcFramer::k_nMaxDataLen));
+}
+
+TEST_CASE(NegativeDataLenRejected) {
+  IpcFramer framer;
+  CommandHeader_t header = { Command_ClientPing, -1 };
+  std::string stream(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<Received_t> received;
+  CHECK(!Feed(framer, stream, stream.size(), received));
+  CHECK(received.empty());
+}
+
+TEST_CASE(OversizedDataLenRejected) {
+  IpcFramer framer;
+  CommandHeader_t header = { Command_ClientPing, IpcFramer::k_nMaxDataLen + 1 };
+  std::string stream(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  // Rejected from the header alone, without waiting for a payload that could never fit.
+  std::vector<Received_t> received;
+  CHECK(!Feed(framer, stream, stream.size(), received));
+  CHECK(received.empty());
+}
+
+TEST_CASE(InvalidHeaderAfterValidCommands) {
+  IpcFramer framer;
+  std::string stream;
+  AppendCommand(stream, Command_ClientPing, "");
+  CommandHeader_t header = { Command_ClientPing, INT32_MIN };
+  stream.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<Received_t> received;
+  CHECK(!Feed(framer, stream, stream.size(), received));
+  CHECK(received.size() == 1);
+}
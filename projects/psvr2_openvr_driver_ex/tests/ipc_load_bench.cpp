@@ -0,0 +1,92 @@
+#include "bench_harness.h"
+
+#include "ipc_ping_server.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  // Every client pings back to back for the whole run, each round trip is one sample.
+  void RunClients(uint16_t port, uint32_t clientCount, int64_t durationNs) {
+    std::vector<std::vector<int64_t>> roundTrips(clientCount);
+    std::atomic<uint32_t> failureCount = 0;
+    std::atomic<bool> go = false;
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < clientCount; i++) {
+      threads.emplace_back([&, i]() {
+        IpcSocket_t client = ConnectPingClient(port);
+        if (client == -1) {
+          failureCount++;
+          return;
+        }
+
+        while (!go) {
+          std::this_thread::yield();
+        }
+
+        int64_t endNs = GetBenchTimestampNs() + durationNs;
+        while (true) {
+          int64_t startNs = GetBenchTimestampNs();
+          if (startNs >= endNs) {
+            break;
+          }
+          if (!PingRoundTrip(client)) {
+            failureCount++;
+            break;
+          }
+          roundTrips[i].push_back(GetBenchTimestampNs() - startNs);
+        }
+        close(client);
+      });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let every client connect first.
+    go = true;
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<int64_t> all;
+    for (const std::vector<int64_t> &samples : roundTrips) {
+      all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    if (all.empty()) {
+      printf("%3u clients: no round trips, %u failures\n", clientCount, failureCount.load());
+      return;
+    }
+
+    auto percentileUs = [&](double percentile) {
+      return all[static_cast<size_t>(percentile * (all.size() - 1))] / 1000.0;
+    };
+    printf("%3u clients: %8.0f pings/s, RTT p50 %7.1f us, p99 %7.1f us, max %8.1f us, %u failures\n",
+           clientCount, all.size() * 1e9 / durationNs, percentileUs(0.5), percentileUs(0.99), all.back() / 1000.0,
+           failureCount.load());
+  }
+
+} // namespace
+
+int main() {
+  static constexpr int64_t k_durationNs = 2000000000;
+
+  IpcPingServer<256> server;
+  if (!server.Start()) {
+    printf("Starting the ping server failed.\n");
+    return 1;
+  }
+
+  for (uint32_t clientCount : { 1u, 8u, 64u }) {
+    RunClients(server.Port(), clientCount, k_durationNs);
+  }
+
+  server.Stop();
+  return 0;
+}
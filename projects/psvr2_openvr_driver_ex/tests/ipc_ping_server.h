@@ -0,0 +1,375 @@
+#pragma once
+
+#include "ipc_connection_registry.h"
+#include "ipc_event_loop.h"
+#include "ipc_framer.h"
+#include "ipc_send_queue.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // Cut-down IpcServer on the same event loop, framer, send queue and registry, that answers every ping with a pong.
+    // Connections go through the same lifecycle, so the loop and the load tests exercise the real I/O paths.
+    template <uint32_t MaxConnections>
+    class IpcPingServer {
+    public:
+      IpcPingServer()
+        : m_listenSocket(-1)
+        , m_port(0)
+        , m_running(false)
+        , m_rejectedCount(0)
+      {}
+
+      ~IpcPingServer() {
+        Stop();
+      }
+
+      bool Start() {
+        if (!m_eventLoop.Create()) {
+          return false;
+        }
+
+        m_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenSocket == -1) {
+          return false;
+        }
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+
+        socklen_t addrLen = sizeof(addr);
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(m_listenSocket, SOMAXCONN) != 0 ||
+            getsockname(m_listenSocket, reinterpret_cast<sockaddr *>(&addr), &addrLen) != 0) {
+          return false;
+        }
+        m_port = ntohs(addr.sin_port);
+
+        m_running = true;
+        m_acceptThread = std::thread(&IpcPingServer::AcceptLoop, this);
+        m_eventLoopThread = std::thread(&IpcPingServer::EventLoop, this);
+        return true;
+      }
+
+      void Stop() {
+        if (!m_running.exchange(false)) {
+          return;
+        }
+
+        shutdown(m_listenSocket, SHUT_RDWR);
+        close(m_listenSocket);
+        m_acceptThread.join();
+
+        m_eventLoop.Wake(WakeReason_Shutdown);
+        m_eventLoopThread.join();
+      }
+
+      uint16_t Port() const {
+        return m_port;
+      }
+
+      uint32_t ConnectionCount() const {
+        return m_connections.Count();
+      }
+
+      uint32_t RejectedCount() const {
+        return m_rejectedCount.load();
+      }
+
+    private:
+      enum EWakeReason : uint32_t {
+        WakeReason_NewConnection,
+        WakeReason_Shutdown,
+      };
+
+      struct Connection_t {
+        ipc::ConnectionHandle_t handle;
+        ipc::IpcSocket_t clientSocket;
+        bool closing;
+        bool recvPending;
+        ipc::IpcIoContext_t recvContext;
+        ipc::IpcFramer framer;
+        ipc::IpcSendQueue sendQueue;
+      };
+
+      ipc::IpcEventLoop m_eventLoop;
+      ipc::ConnectionRegistry<Connection_t, MaxConnections> m_connections;
+      ipc::IpcSocket_t m_listenSocket;
+      uint16_t m_port;
+      std::atomic<bool> m_running;
+      std::atomic<uint32_t> m_rejectedCount;
+      std::thread m_acceptThread;
+      std::thread m_eventLoopThread;
+
+      void AcceptLoop() {
+        while (m_running) {
+          ipc::IpcSocket_t clientSocket = accept(m_listenSocket, nullptr, nullptr);
+          if (clientSocket == -1) {
+            continue;
+          }
+
+          int noDelay = 1;
+          setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+          Connection_t *pConnection = new Connection_t {
+            .handle = ipc::k_invalidConnectionHandle,
+            .clientSocket = clientSocket,
+            .closing = false,
+            .recvPending = false,
+            .recvContext = {},
+            .framer = {},
+            .sendQueue = {},
+          };
+          if (!m_eventLoop.Wake(WakeReason_NewConnection, pConnection)) {
+            close(clientSocket);
+            delete pConnection;
+          }
+        }
+      }
+
+      void EventLoop() {
+        bool shuttingDown = false;
+
+        while (!shuttingDown || !m_connections.Empty()) {
+          ipc::IpcEvent_t event;
+          if (!m_eventLoop.Wait(event)) {
+            break;
+          }
+
+          switch (event.type) {
+            case ipc::IpcEvent_Wake: {
+              if (event.wakeReason == WakeReason_NewConnection) {
+                Connection_t *pConnection = static_cast<Connection_t *>(event.pKey);
+                if (shuttingDown) {
+                  close(pConnection->clientSocket);
+                  delete pConnection;
+                } else {
+                  OpenConnection(pConnection);
+                }
+              } else {
+                shuttingDown = true;
+                m_connections.ForEach([&](ipc::ConnectionHandle_t, Connection_t *pConnection) {
+                  CloseConnection(pConnection);
+                });
+              }
+              break;
+            }
+
+            case ipc::IpcEvent_Recv: {
+              OnReceive(static_cast<Connection_t *>(event.pKey), event);
+              break;
+            }
+
+            case ipc::IpcEvent_Send: {
+              OnSend(static_cast<Connection_t *>(event.pKey), event);
+              break;
+            }
+          }
+        }
+      }
+
+      void OpenConnection(Connection_t *pConnection) {
+        if (!m_eventLoop.Associate(pConnection->clientSocket, pConnection)) {
+          close(pConnection->clientSocket);
+          delete pConnection;
+          return;
+        }
+
+        pConnection->handle = m_connections.Add(pConnection);
+        if (pConnection->handle == ipc::k_invalidConnectionHandle) {
+          m_rejectedCount++;
+          m_eventLoop.Close(pConnection->clientSocket);
+          delete pConnection;
+          return;
+        }
+
+        PostReceive(pConnection);
+      }
+
+      void CloseConnection(Connection_t *pConnection) {
+        if (pConnection->closing) {
+          return;
+        }
+
+        pConnection->closing = true;
+        m_eventLoop.Close(pConnection->clientSocket);
+        TryReleaseConnection(pConnection);
+      }
+
+      void TryReleaseConnection(Connection_t *pConnection) {
+        if (!pConnection->closing || pConnection->recvPending || pConnection->sendQueue.SendPending()) {
+          return;
+        }
+
+        m_connections.Remove(pConnection->handle);
+        delete pConnection;
+      }
+
+      void PostReceive(Connection_t *pConnection) {
+        pConnection->recvPending = true;
+
+        ipc::IpcFramer &framer = pConnection->framer;
+        if (!m_eventLoop.PostRecv(pConnection->clientSocket, &pConnection->recvContext, framer.WritePointer(), framer.WritableSize())) {
+          pConnection->recvPending = false;
+          CloseConnection(pConnection);
+        }
+      }
+
+      // gcc can't tell that CloseConnection never frees the connection while recvPending is set.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
+      void OnReceive(Connection_t *pConnection, const ipc::IpcEvent_t &event) {
+        if (!pConnection->closing) {
+          if (!event.succeeded || event.bytesTransferred == 0) {
+            CloseConnection(pConnection);
+          } else {
+            pConnection->framer.Commit(event.bytesTransferred);
+
+            bool valid = pConnection->framer.Dispatch([&](const ipc::CommandHeader_t &header, void *) {
+              if (header.type == ipc::Command_ClientPing) {
+                pConnection->sendQueue.Enqueue(ipc::Command_ServerPong, nullptr, 0, false);
+              }
+            });
+            if (!valid) {
+              CloseConnection(pConnection);
+            }
+          }
+        }
+
+        FlushSendQueue(pConnection);
+
+        pConnection->recvPending = false;
+
+        if (pConnection->closing) {
+          TryReleaseConnection(pConnection);
+          return;
+        }
+
+        PostReceive(pConnection);
+      }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+      void FlushSendQueue(Connection_t *pConnection) {
+        if (pConnection->closing) {
+          return;
+        }
+
+        ipc::IpcSendQueue &sendQueue = pConnection->sendQueue;
+        ipc::IpcBuffer_t pBuffers[ipc::IpcSendQueue::k_unSlotCount];
+
+        uint32_t bufferCount = sendQueue.BeginSend(pBuffers);
+        if (bufferCount == 0) {
+          return;
+        }
+
+        if (!m_eventLoop.PostSend(pConnection->clientSocket, &sendQueue.SendContext(), pBuffers, bufferCount)) {
+          sendQueue.EndSend(0);
+          CloseConnection(pConnection);
+        }
+      }
+
+      void OnSend(Connection_t *pConnection, const ipc::IpcEvent_t &event) {
+        pConnection->sendQueue.EndSend(event.succeeded ? event.bytesTransferred : 0);
+
+        if (pConnection->closing) {
+          TryReleaseConnection(pConnection);
+          return;
+        }
+
+        if (!event.succeeded) {
+          CloseConnection(pConnection);
+          return;
+        }
+
+        FlushSendQueue(pConnection);
+      }
+    };
+
+    // Blocking client side of the ping protocol.
+    inline ipc::IpcSocket_t ConnectPingClient(uint16_t port) {
+      ipc::IpcSocket_t clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+      if (clientSocket == -1) {
+        return -1;
+      }
+
+      int noDelay = 1;
+      setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+      sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = htons(port);
+      if (connect(clientSocket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(clientSocket);
+        return -1;
+      }
+      return clientSocket;
+    }
+
+    inline bool SendAll(ipc::IpcSocket_t clientSocket, const void *pData, size_t len) {
+      const char *pBytes = static_cast<const char *>(pData);
+      while (len > 0) {
+        ssize_t sent = send(clientSocket, pBytes, len, MSG_NOSIGNAL);
+        if (sent <= 0) {
+          return false;
+        }
+        pBytes += sent;
+        len -= sent;
+      }
+      return true;
+    }
+
+    inline bool RecvAll(ipc::IpcSocket_t clientSocket, void *pData, size_t len) {
+      char *pBytes = static_cast<char *>(pData);
+      while (len > 0) {
+        ssize_t received = recv(clientSocket, pBytes, len, 0);
+        if (received <= 0) {
+          return false;
+        }
+        pBytes += received;
+        len -= received;
+      }
+      return true;
+    }
+
+    // Sends pingCount pings in one write and waits for every pong.
+    inline bool PingRoundTrip(ipc::IpcSocket_t clientSocket, uint32_t pingCount = 1) {
+      static constexpr uint32_t k_unMaxPings = 16;
+
+      ipc::CommandHeader_t pHeaders[k_unMaxPings];
+      for (uint32_t i = 0; i < pingCount && i < k_unMaxPings; i++) {
+        pHeaders[i] = { ipc::Command_ClientPing, 0 };
+      }
+      if (pingCount > k_unMaxPings || !SendAll(clientSocket, pHeaders, pingCount * sizeof(ipc::CommandHeader_t))) {
+        return false;
+      }
+
+      if (!RecvAll(clientSocket, pHeaders, pingCount * sizeof(ipc::CommandHeader_t))) {
+        return false;
+      }
+      for (uint32_t i = 0; i < pingCount; i++) {
+        if (pHeaders[i].type != ipc::Command_ServerPong || pHeaders[i].dataLen != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  } // test
+} // psvr2_toolkit
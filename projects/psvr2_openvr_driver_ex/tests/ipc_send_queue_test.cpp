@@ -0,0 +1,151 @@
+#include "test_harness.h"
+
+#include "ipc_send_queue.h"
+
+#include <cstddef>
+#include <string>
+
+using namespace psvr2_toolkit::ipc;
+
+namespace {
+
+  // What the client would read from a gather write of the buffers, as if all of them went out.
+  std::string Concatenate(const IpcBuffer_t *pBuffers, uint32_t bufferCount) {
+    std::string stream;
+    for (uint32_t i = 0; i < bufferCount; i++) {
+      stream.append(pBuffers[i].buf, pBuffers[i].len);
+    }
+    return stream;
+  }
+
+  // Zeroes the header padding after the 16-bit type, which the queue leaves unspecified, so streams compare by value.
+  std::string Normalize(std::string stream) {
+    size_t offset = 0;
+    while (offset + sizeof(CommandHeader_t) <= stream.size()) {
+      CommandHeader_t header;
+      memcpy(&header, stream.data() + offset, sizeof(header));
+      for (size_t i = sizeof(header.type); i < offsetof(CommandHeader_t, dataLen); i++) {
+        stream[offset + i] = 0;
+      }
+      offset += sizeof(header) + header.dataLen;
+    }
+    return stream;
+  }
+
+  std::string Message(ECommandType type, uint8_t tag) {
+    CommandHeader_t header = { type, 1 };
+    std::string message(reinterpret_cast<const char *>(&header), sizeof(header));
+    message.push_back(static_cast<char>(tag));
+    return Normalize(message);
+  }
+
+} // namespace
+
+TEST_CASE(MessagesGoOutInOrderInOneWrite) {
+  IpcSendQueue queue;
+  std::string expected;
+  for (uint8_t i = 0; i < 5; i++) {
+    CHECK(queue.Enqueue(Command_ServerGazeEvents, &i, 1, false));
+    expected += Message(Command_ServerGazeEvents, i);
+  }
+  CHECK(queue.FreeCount() == IpcSendQueue::k_unSlotCount - 5);
+
+  IpcBuffer_t pBuffers[IpcSendQueue::k_unSlotCount];
+  uint32_t bufferCount = queue.BeginSend(pBuffers);
+  CHECK(bufferCount == 5);
+  CHECK(queue.SendPending());
+  CHECK(Normalize(Concatenate(pBuffers, bufferCount)) == expected);
+
+  // Only one write at a time.
+  CHECK(queue.BeginSend(pBuffers) == 0);
+
+  queue.EndSend(static_cast<uint32_t>(expected.size()));
+  CHECK(!queue.SendPending());
+  CHECK(queue.FreeCount() == IpcSendQueue::k_unSlotCount);
+  CHECK(queue.BeginSend(pBuffers) == 0);
+}
+
+TEST_CASE(PartialWriteResumesWhereItStopped) {
+  IpcSendQueue queue;
+  std::string expected;
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(queue.Enqueue(Command_ServerGazeEvents, &i, 1, false));
+    expected += Message(Command_ServerGazeEvents, i);
+  }
+
+  IpcBuffer_t pBuffers[IpcSendQueue::k_unSlotCount];
+  uint32_t bufferCount = queue.BeginSend(pBuffers);
+  uint32_t firstLen = static_cast<uint32_t>(expected.size() / 3);
+  queue.EndSend(firstLen + 2); // The first message and 2 bytes of the second.
+  CHECK(queue.FreeCount() == IpcSendQueue::k_unSlotCount - 2);
+
+  bufferCount = queue.BeginSend(pBuffers);
+  CHECK(bufferCount == 2);
+  CHECK(Normalize(expected.substr(0, firstLen + 2) + Concatenate(pBuffers, bufferCount)) == expected);
+
+  // A failed write releases nothing.
+  queue.EndSend(0);
+  CHECK(queue.FreeCount() == IpcSendQueue::k_unSlotCount - 2);
+  bufferCount = queue.BeginSend(pBuffers);
+  CHECK(Normalize(expected.substr(0, firstLen + 2) + Concatenate(pBuffers, bufferCount)) == expected);
+}
+
+TEST_CASE(FullQueueDropsOldestDroppable) {
+  IpcSendQueue queue;
+
+  uint8_t tag = 0;
+  CHECK(queue.Enqueue(Command_ServerGazeEvents, &tag, 1, false));
+  for (tag = 1; tag < IpcSendQueue::k_unSlotCount; tag++) {
+    CHECK(queue.Enqueue(Command_ServerGazeDataResult, &tag, 1, true));
+  }
+  CHECK(queue.FreeCount() == 0);
+
+  // Makes room by dropping the oldest gaze frame, tag 1.
+  tag = 100;
+  CHECK(queue.Enqueue(Command_ServerGazeEvents, &tag, 1, false));
+
+  IpcBuffer_t pBuffers[IpcSendQueue::k_unSlotCount];
+  uint32_t bufferCount = queue.BeginSend(pBuffers);
+  CHECK(bufferCount == IpcSendQueue::k_unSlotCount);
+  std::string stream = Normalize(Concatenate(pBuffers, bufferCount));
+  CHECK(stream.substr(0, 2 * Message(Command_ServerGazeEvents, 0).size()) ==
+        Message(Command_ServerGazeEvents, 0) + Message(Command_ServerGazeDataResult, 2));
+  CHECK(stream.substr(stream.size() - Message(Command_ServerGazeEvents, 100).size()) == Message(Command_ServerGazeEvents, 100));
+}
+
+TEST_CASE(FullQueueRejectsWhenNothingCanBeDropped) {
+  IpcSendQueue queue;
+
+  for (uint8_t i = 0; i < IpcSendQueue::k_unSlotCount; i++) {
+    CHECK(queue.Enqueue(Command_ServerGazeHistoryResult, &i, 1, false));
+  }
+
+  uint8_t tag = 0;
+  CHECK(!queue.Enqueue(Command_ServerGazeEvents, &tag, 1, false));
+  CHECK(!queue.Enqueue(Command_ServerGazeDataResult, &tag, 1, true));
+}
+
+TEST_CASE(InFlightDroppableIsNeverDropped) {
+  IpcSendQueue queue;
+
+  uint8_t tag = 0;
+  for (uint32_t i = 0; i < IpcSendQueue::k_unSlotCount; i++) {
+    CHECK(queue.Enqueue(Command_ServerGazeDataResult, &tag, 1, true));
+  }
+
+  // Everything is being written, so there is nothing left to drop.
+  IpcBuffer_t pBuffers[IpcSendQueue::k_unSlotCount];
+  CHECK(queue.BeginSend(pBuffers) == IpcSendQueue::k_unSlotCount);
+  CHECK(!queue.Enqueue(Command_ServerGazeEvents, &tag, 1, false));
+}
+
+TEST_CASE(OversizedMessageIsRejected) {
+  IpcSendQueue queue;
+
+  static char pData[IpcSendQueue::k_unMaxMessageLen] = {};
+  int maxDataLen = static_cast<int>(IpcSendQueue::k_unMaxMessageLen - sizeof(CommandHeader_t));
+  CHECK(queue.Enqueue(Command_ServerGazeEvents, pData, maxDataLen, false));
+  CHECK(!queue.Enqueue(Command_ServerGazeEvents, pData, maxDataLen + 1, false));
+  CHECK(!queue.Enqueue(Command_ServerGazeEvents, pData, -1, false));
+  CHECK(queue.FreeCount() == IpcSendQueue::k_unSlotCount - 1);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gaze_calibration.h"
+
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // The per-call polygon search GazeCalibrationProfile::Remap used before the segment table, kept verbatim
+    // (apart from taking the profile as arguments) so the table can be checked against it.
+    class PolygonRemapReference {
+    public:
+      PolygonRemapReference(const Vec2d &center, const std::vector<double> &calibration)
+        : m_center(center)
+        , m_calibration(calibration)
+      {}
+
+      Hmd2Vector3 Remap(const Hmd2Vector3 &raw_gaze_dir) const {
+        // 1. Apply the center offset to the raw gaze coordinates.
+        double x = raw_gaze_dir.x - m_center.x;
+        double y = raw_gaze_dir.y - m_center.y;
+
+        // If no calibration data is loaded, return the centered position as a fallback.
+        if (m_calibration.empty()) {
+          return { (float)x, (float)y, raw_gaze_dir.z };
+        }
+
+        // 2. Convert the centered Cartesian coordinates to polar coordinates.
+        double angle = std::atan2(y, x);
+        if (angle < 0) angle += k_tau; // Ensure angle is in the [0, 2PI] range.
+
+        const double raw_distance = std::sqrt(x * x + y * y);
+
+        // 3. Get the expected raw distance (radius) from the calibration polygon at this angle.
+        const double calibrated_radius = GetInterpolatedRadiusAtAngle(angle);
+
+        // 4. Normalize the raw distance by the expected distance from calibration.
+        const double scale = (calibrated_radius > 1e-6) ? calibrated_radius : 1.0;
+        const double normalized_distance = raw_distance / scale;
+
+        // 5. Convert the remapped polar coordinates back to Cartesian coordinates.
+        const auto final_x = static_cast<float>(std::cos(angle) * normalized_distance);
+        const auto final_y = static_cast<float>(std::sin(angle) * normalized_distance);
+
+        return { final_x, final_y, raw_gaze_dir.z };
+      }
+
+    private:
+      static constexpr double k_tau = 2.0 * 3.14159265358979323846;
+
+      Vec2d m_center;
+      std::vector<double> m_calibration;
+
+      static std::optional<double> FindRaySegmentIntersection(Vec2d ray_dir, Vec2d p1, Vec2d p2) {
+        const auto segment_vec = Vec2d{ p1.x - p2.x, p1.y - p2.y };
+        const auto ray_normal = Vec2d{ -ray_dir.y, ray_dir.x };
+        const double dot = (segment_vec.x * ray_normal.x) + (segment_vec.y * ray_normal.y);
+
+        if (std::abs(dot) < 1e-5) return std::nullopt; // Parallel lines
+
+        const double t = ((p1.x * ray_normal.x) + (p1.y * ray_normal.y)) / dot;
+        if (t < -1e-5 || t > 1.0 + 1e-5) return std::nullopt; // Intersection is outside the segment
+
+        const double cross_product = p2.x * p1.y - p2.y * p1.x;
+        return cross_product / dot;
+      }
+
+      static Vec2d PolarToCartesian(double angle, double length) {
+        return { std::cos(angle) * length, std::sin(angle) * length };
+      }
+
+      double GetInterpolatedRadiusAtAngle(double angle) const {
+        const size_t num_samples = m_calibration.size();
+        if (num_samples == 0) return 1.0;
+
+        // Determine which two calibration points the current angle falls between.
+        const double angular_pos = angle / k_tau * num_samples;
+        const size_t prev_index = static_cast<size_t>(angular_pos) % num_samples;
+        if (num_samples == 1) return m_calibration[prev_index];
+
+        const size_t next_index = (prev_index + 1) % num_samples;
+
+        // Get the positions of these two calibration points.
+        const double prev_angle = prev_index * k_tau / num_samples;
+        const double next_angle = next_index * k_tau / num_samples;
+        const Vec2d p1 = PolarToCartesian(prev_angle, m_calibration[prev_index]);
+        const Vec2d p2 = PolarToCartesian(next_angle, m_calibration[next_index]);
+
+        // Find the radius by intersecting a ray with the line segment between the points.
+        const Vec2d ray_dir = PolarToCartesian(angle, 1.0);
+        const auto intersection = FindRaySegmentIntersection(ray_dir, p1, p2);
+
+        // As a fallback, use the nearest point if intersection fails.
+        return intersection.value_or(m_calibration[prev_index]);
+      }
+    };
+
+  } // test
+} // psvr2_toolkit
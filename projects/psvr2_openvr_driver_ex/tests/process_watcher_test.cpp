@@ -0,0 +1,155 @@
+#include "test_harness.h"
+
+#include "fake_process_watcher.h"
+#include "ipc_connection_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+namespace {
+
+  struct ExitLog_t {
+    std::mutex mutex;
+    std::vector<uint32_t> cookies;
+  };
+
+  void OnProcessExited(void *pUserData, uint32_t cookie) {
+    ExitLog_t *pLog = static_cast<ExitLog_t *>(pUserData);
+    std::scoped_lock<std::mutex> lock(pLog->mutex);
+    pLog->cookies.push_back(cookie);
+  }
+
+} // namespace
+
+TEST_CASE(ExitNotifiesEveryWatchOnce) {
+  ExitLog_t log;
+  FakeProcessWatcher watcher(&OnProcessExited, &log);
+  ProcessWatcher *pWatcher = &watcher;
+
+  watcher.StartProcess(100);
+  watcher.StartProcess(200);
+  CHECK(pWatcher->IsProcessRunning(100));
+  CHECK(pWatcher->Watch(100, 1));
+  CHECK(pWatcher->Watch(100, 2)); // Two clients in the same process.
+  CHECK(pWatcher->Watch(200, 3));
+
+  watcher.ExitProcess(100);
+  CHECK(!pWatcher->IsProcessRunning(100));
+  CHECK(log.cookies.size() == 2);
+  CHECK((log.cookies[0] == 1 && log.cookies[1] == 2) || (log.cookies[0] == 2 && log.cookies[1] == 1));
+
+  // Nothing fires twice.
+  watcher.ExitProcess(100);
+  CHECK(log.cookies.size() == 2);
+
+  watcher.ExitProcess(200);
+  CHECK(log.cookies.size() == 3 && log.cookies[2] == 3);
+  CHECK(watcher.WatchCount() == 0);
+}
+
+TEST_CASE(ExitedProcessCantBeWatched) {
+  ExitLog_t log;
+  FakeProcessWatcher watcher(&OnProcessExited, &log);
+
+  CHECK(!watcher.Watch(100, 1));
+  watcher.StartProcess(100);
+  watcher.ExitProcess(100);
+  CHECK(!watcher.Watch(100, 1));
+  CHECK(log.cookies.empty());
+}
+
+TEST_CASE(UnwatchedCookieNeverFires) {
+  ExitLog_t log;
+  FakeProcessWatcher watcher(&OnProcessExited, &log);
+
+  watcher.StartProcess(100);
+  CHECK(watcher.Watch(100, 1));
+  CHECK(watcher.Watch(100, 2));
+  watcher.Unwatch(1);
+  watcher.Unwatch(1); // Unwatching twice is harmless.
+  watcher.Unwatch(7); // So is an unknown cookie.
+
+  watcher.ExitProcess(100);
+  CHECK(log.cookies.size() == 1 && log.cookies[0] == 2);
+}
+
+TEST_CASE(RewatchReplacesTheOldWatch) {
+  ExitLog_t log;
+  FakeProcessWatcher watcher(&OnProcessExited, &log);
+
+  watcher.StartProcess(100);
+  watcher.StartProcess(200);
+  CHECK(watcher.Watch(100, 1));
+  CHECK(watcher.Watch(200, 1));
+
+  watcher.ExitProcess(100);
+  CHECK(log.cookies.empty());
+  watcher.ExitProcess(200);
+  CHECK(log.cookies.size() == 1 && log.cookies[0] == 1);
+}
+
+TEST_CASE(UnwatchWaitsForRunningCallback) {
+  struct State_t {
+    std::atomic<bool> inCallback = false;
+    std::atomic<bool> callbackDone = false;
+  } state;
+
+  FakeProcessWatcher watcher([](void *pUserData, uint32_t) {
+    State_t *pState = static_cast<State_t *>(pUserData);
+    pState->inCallback = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pState->callbackDone = true;
+  }, &state);
+
+  watcher.StartProcess(100);
+  CHECK(watcher.Watch(100, 1));
+
+  std::thread exiter([&]() {
+    watcher.ExitProcess(100);
+  });
+  while (!state.inCallback) {
+    std::this_thread::yield();
+  }
+
+  watcher.Unwatch(1);
+  CHECK(state.callbackDone);
+  exiter.join();
+}
+
+// The server watches with the connection handle as the cookie. An exit that arrives after the connection closed and
+// its slot was reused must resolve to nothing, rather than to the new connection.
+TEST_CASE(LateExitOfReusedSlotIsStale) {
+  struct Connection_t {
+    uint32_t processId;
+  };
+
+  ExitLog_t log;
+  FakeProcessWatcher watcher(&OnProcessExited, &log);
+  ConnectionRegistry<Connection_t, 1> connections;
+
+  Connection_t first = { 100 };
+  watcher.StartProcess(100);
+  ConnectionHandle_t firstHandle = connections.Add(&first);
+  CHECK(watcher.Watch(first.processId, firstHandle));
+
+  // The exit is reported, but the event loop closes the connection on its own before it gets to the wake.
+  watcher.ExitProcess(100);
+  connections.Remove(firstHandle);
+  watcher.Unwatch(firstHandle);
+
+  Connection_t second = { 200 };
+  watcher.StartProcess(200);
+  ConnectionHandle_t secondHandle = connections.Add(&second);
+  CHECK(watcher.Watch(second.processId, secondHandle));
+
+  CHECK(log.cookies.size() == 1);
+  CHECK(connections.Find(log.cookies[0]) == nullptr);
+  CHECK(connections.Find(secondHandle) == &second);
+}
@@ -0,0 +1,64 @@
+#include "bench_harness.h"
+
+#include "seqlock.h"
+#include "../shared/ipc_protocol.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+using namespace psvr2_toolkit::test;
+
+// Throughput of the gaze snapshot IpcServer publishes, with the writer running flat out against 0 to 8 readers.
+// The driver writes at most 240 times a second, so this is about the readers never slowing the USB thread down.
+int main() {
+  constexpr int64_t k_durationNs = 500000000;
+
+  printf("%8s %16s %16s\n", "readers", "writes/s", "reads/s");
+
+  for (int readerCount : { 0, 1, 2, 4, 8 }) {
+    SeqLock<CommandDataServerGazeDataResult2_t> seqLock;
+    std::atomic<bool> running = true;
+    std::atomic<uint64_t> totalReads = 0;
+    uint64_t writes = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < readerCount; i++) {
+      readers.emplace_back([&]() {
+        uint64_t reads = 0;
+        CommandDataServerGazeDataResult2_t frame;
+        while (running.load(std::memory_order_relaxed)) {
+          if (seqLock.Read(frame)) {
+            DoNotOptimize(frame);
+            reads++;
+          }
+        }
+        totalReads.fetch_add(reads);
+      });
+    }
+
+    CommandDataServerGazeDataResult2_t frame = {};
+    int64_t startNs = GetBenchTimestampNs();
+    int64_t elapsedNs = 0;
+    while (elapsedNs < k_durationNs) {
+      for (int i = 0; i < 1024; i++) {
+        frame.sequence++;
+        seqLock.Write(frame);
+      }
+      writes += 1024;
+      elapsedNs = GetBenchTimestampNs() - startNs;
+    }
+
+    running = false;
+    for (std::thread &reader : readers) {
+      reader.join();
+    }
+
+    double seconds = elapsedNs / 1e9;
+    printf("%8d %16.0f %16.0f\n", readerCount, writes / seconds, totalReads.load() / seconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+#include "test_harness.h"
+
+#include "seqlock.h"
+#include "../shared/ipc_protocol.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace psvr2_toolkit;
+using namespace psvr2_toolkit::ipc;
+
+namespace {
+
+  // Every field is derived from the sequence, so a frame mixing two writes doesn't add up.
+  CommandDataServerGazeDataResult2_t MakeFrame(uint64_t sequence) {
+    float value = static_cast<float>(sequence % 1000003);
+
+    CommandDataServerGazeDataResult2_t frame = {};
+    frame.sequence = sequence;
+    frame.hmdTimestampUs = sequence * 4000;
+    frame.hostTimestampUs = static_cast<int64_t>(sequence) * 4000 + 17;
+    frame.leftEye.gazeOriginMm = { value, value + 1.0f, value + 2.0f };
+    frame.leftEye.gazeDirNorm = { value + 3.0f, value + 4.0f, value + 5.0f };
+    frame.leftEye.pupilDiaMm = value + 6.0f;
+    frame.leftEye.isGazeDirValid = sequence % 2 == 0;
+    frame.rightEye.gazeOriginMm = { -value, -value - 1.0f, -value - 2.0f };
+    frame.rightEye.gazeDirNorm = { -value - 3.0f, -value - 4.0f, -value - 5.0f };
+    frame.rightEye.pupilDiaMm = -value - 6.0f;
+    frame.rightEye.isGazeDirValid = sequence % 2 == 0;
+    frame.combined.gazeDirNorm = { value, -value, value };
+    return frame;
+  }
+
+  bool IsConsistent(const CommandDataServerGazeDataResult2_t &frame) {
+    CommandDataServerGazeDataResult2_t expected = MakeFrame(frame.sequence);
+    return memcmp(&frame, &expected, sizeof(frame)) == 0;
+  }
+
+  struct StressResult_t {
+    uint64_t readCount;
+    uint64_t tornCount;
+    uint64_t backwardsCount;
+    uint64_t versionMismatchCount;
+  };
+
+  // writerCount threads take turns writing under a mutex, as SeqLock allows only one writer at a time.
+  StressResult_t RunStress(int writerCount, int readerCount, std::chrono::milliseconds duration) {
+    SeqLock<CommandDataServerGazeDataResult2_t> seqLock;
+    std::mutex writeMutex;
+    std::atomic<bool> running = true;
+    std::atomic<uint64_t> nextSequence = 1;
+    std::atomic<uint64_t> readCount = 0;
+    std::atomic<uint64_t> tornCount = 0;
+    std::atomic<uint64_t> backwardsCount = 0;
+    std::atomic<uint64_t> versionMismatchCount = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < writerCount; i++) {
+      threads.emplace_back([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+          if (writerCount == 1) {
+            seqLock.Write(MakeFrame(nextSequence.fetch_add(1, std::memory_order_relaxed)));
+          } else {
+            std::scoped_lock<std::mutex> lock(writeMutex);
+            seqLock.Write(MakeFrame(nextSequence.fetch_add(1, std::memory_order_relaxed)));
+          }
+        }
+      });
+    }
+
+    for (int i = 0; i < readerCount; i++) {
+      threads.emplace_back([&]() {
+        uint64_t lastSequence = 0;
+        uint64_t reads = 0;
+        CommandDataServerGazeDataResult2_t frame;
+        uint32_t version;
+        while (running.load(std::memory_order_relaxed)) {
+          if (!seqLock.Read(frame, &version)) {
+            continue;
+          }
+
+          reads++;
+          if (!IsConsistent(frame)) {
+            tornCount.fetch_add(1, std::memory_order_relaxed);
+          }
+          // Writes are serialized, so each reader sees sequences that never go back.
+          if (frame.sequence < lastSequence) {
+            backwardsCount.fetch_add(1, std::memory_order_relaxed);
+          }
+          lastSequence = frame.sequence;
+
+          // Sequences are handed out in the order they are written, so the version read is the frame's own.
+          if (version != static_cast<uint32_t>(frame.sequence)) {
+            versionMismatchCount.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+        readCount.fetch_add(reads, std::memory_order_relaxed);
+      });
+    }
+
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    return { readCount.load(), tornCount.load(), backwardsCount.load(), versionMismatchCount.load() };
+  }
+
+  int GetStressThreadCount() {
+    return static_cast<int>((std::max)(std::thread::hardware_concurrency(), 4u));
+  }
+
+} // namespace
+
+TEST_CASE(ReadBeforeFirstWriteFails) {
+  SeqLock<CommandDataServerGazeDataResult2_t> seqLock;
+  CommandDataServerGazeDataResult2_t frame = MakeFrame(5);
+
+  CHECK(!seqLock.Read(frame));
+  CHECK(seqLock.Version() == 0);
+}
+
+TEST_CASE(ReadReturnsLatestWrite) {
+  SeqLock<CommandDataServerGazeDataResult2_t> seqLock;
+  CommandDataServerGazeDataResult2_t frame;
+
+  seqLock.Write(MakeFrame(1));
+  seqLock.Write(MakeFrame(2));
+
+  uint32_t version = 0;
+  CHECK(seqLock.Read(frame, &version));
+  CHECK(frame.sequence == 2);
+  CHECK(IsConsistent(frame));
+  CHECK(version == 2);
+  CHECK(seqLock.Version() == 2);
+}
+
+TEST_CASE(PayloadNotMultipleOfWordSize) {
+  struct Odd_t {
+    uint8_t bytes[13];
+  };
+
+  SeqLock<Odd_t> seqLock;
+  Odd_t value;
+  for (int i = 0; i < 13; i++) {
+    value.bytes[i] = static_cast<uint8_t>(i * 7);
+  }
+  seqLock.Write(value);
+
+  Odd_t readValue = {};
+  CHECK(seqLock.Read(readValue));
+  CHECK(memcmp(&readValue, &value, sizeof(value)) == 0);
+}
+
+TEST_CASE(OneWriterManyReadersNeverTear) {
+  StressResult_t result = RunStress(1, GetStressThreadCount(), std::chrono::milliseconds(500));
+
+  printf("  %llu reads\n", static_cast<unsigned long long>(result.readCount));
+  CHECK(result.readCount > 0);
+  CHECK(result.tornCount == 0);
+  CHECK(result.backwardsCount == 0);
+  CHECK(result.versionMismatchCount == 0);
+}
+
+TEST_CASE(SerializedWritersManyReadersNeverTear) {
+  StressResult_t result = RunStress(GetStressThreadCount() / 2, GetStressThreadCount(), std::chrono::milliseconds(500));
+
+  printf("  %llu reads\n", static_cast<unsigned long long>(result.readCount));
+  CHECK(result.readCount > 0);
+  CHECK(result.tornCount == 0);
+  CHECK(result.backwardsCount == 0);
+  CHECK(result.versionMismatchCount == 0);
+}
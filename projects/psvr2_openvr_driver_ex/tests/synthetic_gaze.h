@@ -0,0 +1,198 @@
+#pragma once
+
+#include "hmd2_gaze.h"
+#include "../../shared/gaze_recording.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    constexpr uint64_t k_ulSyntheticSampleIntervalUs = 4167;
+
+    struct SyntheticGazeSample_t {
+      uint64_t hmdTimestampUs;
+      Hmd2Vector3 target; // Where both eyes look, before their bias and noise.
+      Hmd2GazeState state; // As the headset would send it.
+    };
+
+    inline Hmd2Vector3 MakeSyntheticDirection(float x, float y) {
+      return { x, y, -std::sqrt(1.0f - x * x - y * y) };
+    }
+
+    inline Hmd2Vector3 NormalizeSyntheticDirection(const Hmd2Vector3 &direction) {
+      float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+      return { direction.x / length, direction.y / length, direction.z / length };
+    }
+
+    // Fixations with tracker noise, joined by minimum jerk saccades, with the odd blink in between.
+    // Each eye has a bias of its own and the right one is noisier. After a fixation, one eye may be lost for a while
+    // with the given probability. Like the headset, the combined ray is only valid while both eyes are.
+    inline std::vector<SyntheticGazeSample_t> MakeSyntheticGaze(std::mt19937 &random, size_t sampleCount, float singleEyeDropoutProbability) {
+      std::uniform_real_distribution<float> position(-0.4f, 0.4f);
+      std::uniform_int_distribution<uint64_t> fixationUs(150000, 450000);
+      std::uniform_int_distribution<uint64_t> dropoutUs(20000, 200000);
+      std::normal_distribution<float> noise(0.0f, 1.0f);
+      std::bernoulli_distribution isBlink(0.05);
+      std::bernoulli_distribution isDropout(singleEyeDropoutProbability);
+      std::bernoulli_distribution isLeftEye(0.5);
+
+      const float leftBias[2] = { 0.004f, -0.002f };
+      const float rightBias[2] = { -0.004f, 0.003f };
+      const float leftNoise = 0.002f;
+      const float rightNoise = 0.004f;
+
+      std::vector<SyntheticGazeSample_t> samples;
+      samples.reserve(sampleCount);
+
+      uint64_t timestampUs = 1000000;
+      float x = 0.0f;
+      float y = 0.0f;
+      float targetX = 0.0f;
+      float targetY = 0.0f;
+      uint64_t phaseStartUs = timestampUs;
+      uint64_t phaseEndUs = timestampUs + fixationUs(random);
+      bool isSaccade = false;
+      bool leftValid = true;
+      bool rightValid = true;
+
+      while (samples.size() < sampleCount) {
+        if (timestampUs >= phaseEndUs) {
+          leftValid = true;
+          rightValid = true;
+          phaseStartUs = timestampUs;
+
+          if (isSaccade) {
+            x = targetX;
+            y = targetY;
+            isSaccade = false;
+            phaseEndUs = timestampUs + fixationUs(random);
+          } else if (isBlink(random)) {
+            leftValid = false;
+            rightValid = false;
+            phaseEndUs = timestampUs + 80000;
+          } else if (isDropout(random)) {
+            (isLeftEye(random) ? leftValid : rightValid) = false;
+            phaseEndUs = timestampUs + dropoutUs(random);
+          } else {
+            // Far enough that even the shortest saccade is clearly one.
+            do {
+              targetX = position(random);
+              targetY = position(random);
+            } while (std::hypot(targetX - x, targetY - y) < 0.1f);
+
+            // About 21 ms plus 2.2 ms per degree, the usual main sequence.
+            isSaccade = true;
+            phaseEndUs = timestampUs + 21000 + static_cast<uint64_t>(2200.0f * std::hypot(targetX - x, targetY - y) * 57.3f);
+          }
+        }
+
+        float gazeX = x;
+        float gazeY = y;
+        if (isSaccade) {
+          float t = static_cast<float>(timestampUs - phaseStartUs) / static_cast<float>(phaseEndUs - phaseStartUs);
+          float s = t * t * t * (10.0f - 15.0f * t + 6.0f * t * t);
+          gazeX = x + (targetX - x) * s;
+          gazeY = y + (targetY - y) * s;
+        }
+
+        SyntheticGazeSample_t sample = {};
+        sample.hmdTimestampUs = timestampUs;
+        sample.target = MakeSyntheticDirection(gazeX, gazeY);
+
+        Hmd2GazeState &state = sample.state;
+        state.leftEye.isGazeOriginValid = leftValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.leftEye.gazeOriginMm = { -32.0f, 0.0f, -27.0f };
+        state.leftEye.isGazeDirValid = leftValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.leftEye.gazeDirNorm = MakeSyntheticDirection(gazeX + leftBias[0] + leftNoise * noise(random), gazeY + leftBias[1] + leftNoise * noise(random));
+        state.rightEye.isGazeOriginValid = rightValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.rightEye.gazeOriginMm = { 32.0f, 0.0f, -27.0f };
+        state.rightEye.isGazeDirValid = rightValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.rightEye.gazeDirNorm = MakeSyntheticDirection(gazeX + rightBias[0] + rightNoise * noise(random), gazeY + rightBias[1] + rightNoise * noise(random));
+
+        bool combinedValid = leftValid && rightValid;
+        state.combined.isGazeOriginValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.combined.gazeOriginMm = { 0.0f, 0.0f, -27.0f };
+        state.combined.isGazeDirValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        state.combined.isValid = combinedValid ? HMD2_BOOL_TRUE : HMD2_BOOL_FALSE;
+        if (combinedValid) {
+          const Hmd2Vector3 &left = state.leftEye.gazeDirNorm;
+          const Hmd2Vector3 &right = state.rightEye.gazeDirNorm;
+          state.combined.gazeDirNorm = NormalizeSyntheticDirection({ left.x + right.x, left.y + right.y, left.z + right.z });
+        }
+        state.combined.timestamp = static_cast<uint32_t>(timestampUs);
+
+        samples.push_back(sample);
+        timestampUs += k_ulSyntheticSampleIntervalUs;
+      }
+
+      return samples;
+    }
+
+    // A recording like GazeRecorder leaves behind when stopped cleanly, with the raw state as both copies.
+    // Host timestamps keep the HMD spacing, starting at firstHostTimestampUs.
+    inline bool WriteSyntheticRecording(const std::string &path, const std::vector<SyntheticGazeSample_t> &samples, int64_t firstHostTimestampUs) {
+      const size_t framesPerChunk = k_unGazeRecordingChunkSize / sizeof(GazeRecordingFrame_t);
+      size_t chunkCount = (samples.size() + framesPerChunk - 1) / framesPerChunk;
+      if (chunkCount > k_unGazeRecordingMaxChunks) {
+        return false;
+      }
+
+      std::vector<uint8_t> headerRegion(k_unGazeRecordingHeaderSize);
+      GazeRecordingHeader_t *pHeader = reinterpret_cast<GazeRecordingHeader_t *>(headerRegion.data());
+      pHeader->magic = k_unGazeRecordingMagic;
+      pHeader->version = k_unGazeRecordingVersion;
+      pHeader->headerSize = k_unGazeRecordingHeaderSize;
+      pHeader->chunkSize = k_unGazeRecordingChunkSize;
+      pHeader->frameSize = sizeof(GazeRecordingFrame_t);
+      pHeader->stateSize = k_unGazeRecordingStateSize;
+      pHeader->chunkCount = static_cast<uint32_t>(chunkCount);
+      pHeader->frameCount = samples.size();
+      pHeader->isComplete = true;
+
+      auto toHost = [&](const SyntheticGazeSample_t &sample) {
+        return firstHostTimestampUs + static_cast<int64_t>(sample.hmdTimestampUs - samples[0].hmdTimestampUs);
+      };
+
+      for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        size_t first = chunk * framesPerChunk;
+        pHeader->chunks[chunk].fileOffset = k_unGazeRecordingHeaderSize + static_cast<uint64_t>(chunk) * k_unGazeRecordingChunkSize;
+        pHeader->chunks[chunk].firstSequence = first + 1;
+        pHeader->chunks[chunk].firstHostTimestampUs = toHost(samples[first]);
+        pHeader->chunks[chunk].frameCount = static_cast<uint32_t>((std::min)(framesPerChunk, samples.size() - first));
+      }
+
+      FILE *pFile = fopen(path.c_str(), "wb");
+      if (!pFile) {
+        return false;
+      }
+
+      bool success = fwrite(headerRegion.data(), 1, headerRegion.size(), pFile) == headerRegion.size();
+      std::vector<uint8_t> padding(k_unGazeRecordingChunkSize % sizeof(GazeRecordingFrame_t));
+      for (size_t i = 0; i < samples.size() && success; i++) {
+        // Chunks are padded out to their full size, except the last one.
+        if (i != 0 && i % framesPerChunk == 0) {
+          success = fwrite(padding.data(), 1, padding.size(), pFile) == padding.size();
+        }
+
+        GazeRecordingFrame_t frame = {};
+        frame.sequence = i + 1;
+        frame.hmdTimestampUs = samples[i].hmdTimestampUs;
+        frame.hostTimestampUs = toHost(samples[i]);
+        frame.rawPacketSize = k_unGazeRecordingStateSize;
+        memcpy(frame.rawState, &samples[i].state, sizeof(Hmd2GazeState));
+        memcpy(frame.calibratedState, &samples[i].state, sizeof(Hmd2GazeState));
+        success = success && fwrite(&frame, sizeof(frame), 1, pFile) == 1;
+      }
+
+      return fclose(pFile) == 0 && success;
+    }
+
+  } // test
+} // psvr2_toolkit
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace psvr2_toolkit {
+  namespace test {
+
+    // A test executable is a set of TEST_CASE functions, run in order by test_main.cpp.
+    // A failed CHECK is reported and the test carries on, the executable fails if any check did.
+    struct TestCase_t {
+      const char *pchName;
+      void (*pfnRun)();
+    };
+
+    inline std::vector<TestCase_t> &GetTestCases() {
+      static std::vector<TestCase_t> testCases;
+      return testCases;
+    }
+
+    inline int &GetFailureCount() {
+      static int failureCount = 0;
+      return failureCount;
+    }
+
+    struct TestCaseRegistrar {
+      TestCaseRegistrar(const char *pchName, void (*pfnRun)()) {
+        GetTestCases().push_back({ pchName, pfnRun });
+      }
+    };
+
+    inline void ReportFailure(const char *pchFile, int line, const char *pchExpression) {
+      printf("%s:%d: check failed: %s\n", pchFile, line, pchExpression);
+      GetFailureCount()++;
+    }
+
+  } // test
+} // psvr2_toolkit
+
+#define TEST_CASE(name) \
+  static void name(); \
+  static psvr2_toolkit::test::TestCaseRegistrar name##Registrar(#name, name); \
+  static void name()
+
+#define CHECK(expression) \
+  do { \
+    if (!(expression)) { \
+      psvr2_toolkit::test::ReportFailure(__FILE__, __LINE__, #expression); \
+    } \
+  } while (false)
+
+#define CHECK_NEAR(a, b, tolerance) \
+  do { \
+    double checkA = (a); \
+    double checkB = (b); \
+    if (!(std::abs(checkA - checkB) <= (tolerance))) { \
+      printf("%s:%d: %s = %.9g, %s = %.9g, more than %s apart\n", __FILE__, __LINE__, #a, checkA, #b, checkB, #tolerance); \
+      psvr2_toolkit::test::GetFailureCount()++; \
+    } \
+  } while (false)
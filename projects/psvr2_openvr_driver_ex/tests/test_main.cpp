@@ -0,0 +1,25 @@
+#include "test_harness.h"
+
+#include <cstring>
+
+using namespace psvr2_toolkit::test;
+
+// Runs every test case, or only those whose name contains the first argument.
+int main(int argc, char **argv) {
+  const char *pchFilter = argc > 1 ? argv[1] : nullptr;
+
+  int runCount = 0;
+  for (const TestCase_t &testCase : GetTestCases()) {
+    if (pchFilter && !strstr(testCase.pchName, pchFilter)) {
+      continue;
+    }
+
+    int failuresBefore = GetFailureCount();
+    testCase.pfnRun();
+    printf("%s %s\n", GetFailureCount() == failuresBefore ? "[ OK ]" : "[FAIL]", testCase.pchName);
+    runCount++;
+  }
+
+  printf("%d test cases, %d failed checks\n", runCount, GetFailureCount());
+  return GetFailureCount() == 0 && runCount > 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace psvr2_toolkit {
+
+  // Extends a wrapping 32-bit timestamp to 64 bits.
+  // Steps of less than half the 32-bit range are taken as is, so small backwards jitter doesn't count as a wrap.
+  class TimestampUnwrapper {
+  public:
+    TimestampUnwrapper()
+      : m_initialized(false)
+      , m_lastTimestamp(0)
+      , m_unwrappedTimestamp(0)
+    {}
+
+    uint64_t Unwrap(uint32_t timestamp) {
+      if (!m_initialized) {
+        m_initialized = true;
+        m_unwrappedTimestamp = timestamp;
+      } else {
+        m_unwrappedTimestamp += static_cast<int32_t>(timestamp - m_lastTimestamp);
+      }
+
+      m_lastTimestamp = timestamp;
+      return m_unwrappedTimestamp;
+    }
+
+  private:
+    bool m_initialized;
+    uint32_t m_lastTimestamp;
+    uint64_t m_unwrappedTimestamp;
+  };
+
+} // psvr2_toolkit
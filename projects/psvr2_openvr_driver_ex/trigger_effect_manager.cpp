@@ -23,6 +23,7 @@ namespace psvr2_toolkit {
 
   TriggerEffectManager::TriggerEffectManager()
     : m_initialized(false)
+    , m_triggerOwners{}
   {}
 
   TriggerEffectManager *TriggerEffectManager::Instance() {
@@ -50,7 +51,7 @@ namespace psvr2_toolkit {
     m_initialized = true;
   }
 
-  void TriggerEffectManager::HandleIpcCommand(uint32_t processId, ipc::CommandHeader_t *pHeader, void *pData) {
+  void TriggerEffectManager::HandleIpcCommand(uint32_t ownerId, const ipc::CommandHeader_t *pHeader, void *pData) {
     if (!pData || !pHeader)
       return;
     ScePadTriggerEffectCommand command = {};
@@ -59,7 +60,7 @@ namespace psvr2_toolkit {
         if (pHeader->dataLen == sizeof(ipc::CommandDataClientTriggerEffectOff_t)) {
           ipc::CommandDataClientTriggerEffectOff_t *pRequest = reinterpret_cast<ipc::CommandDataClientTriggerEffectOff_t *>(pData);
           command.mode = SCE_PAD_TRIGGER_EFFECT_MODE_OFF;
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -69,7 +70,7 @@ namespace psvr2_toolkit {
           command.mode = SCE_PAD_TRIGGER_EFFECT_MODE_FEEDBACK;
           command.commandData.feedbackParam.position = pRequest->position;
           command.commandData.feedbackParam.strength = pRequest->strength;
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -80,7 +81,7 @@ namespace psvr2_toolkit {
           command.commandData.weaponParam.startPosition = pRequest->startPosition;
           command.commandData.weaponParam.endPosition = pRequest->endPosition;
           command.commandData.weaponParam.strength = pRequest->strength;
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -91,7 +92,7 @@ namespace psvr2_toolkit {
           command.commandData.vibrationParam.position = pRequest->position;
           command.commandData.vibrationParam.amplitude = pRequest->amplitude;
           command.commandData.vibrationParam.frequency = pRequest->frequency;
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -102,7 +103,7 @@ namespace psvr2_toolkit {
           for (int i = 0; i < ipc::k_unTriggerEffectControlPoint; i++) {
             command.commandData.multiplePositionFeedbackParam.strength[i] = pRequest->strength[i];
           }
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -114,7 +115,7 @@ namespace psvr2_toolkit {
           command.commandData.slopeFeedbackParam.endPosition = pRequest->endPosition;
           command.commandData.slopeFeedbackParam.startStrength = pRequest->startStrength;
           command.commandData.slopeFeedbackParam.endStrength = pRequest->endStrength;
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
@@ -126,17 +127,40 @@ namespace psvr2_toolkit {
           for (int i = 0; i < ipc::k_unTriggerEffectControlPoint; i++) {
             command.commandData.multiplePositionVibrationParam.amplitude[i] = pRequest->amplitude[i];
           }
-          SetTriggerEffectCommand(processId, pRequest->controllerType, command);
+          SetTriggerEffectCommand(ownerId, pRequest->controllerType, command);
         }
         break;
       }
     }
   }
 
-  void TriggerEffectManager::SetTriggerEffectCommand(uint32_t processId, ipc::EVRControllerType controllerType, ScePadTriggerEffectCommand command) {
+  void TriggerEffectManager::ReleaseOwner(uint32_t ownerId) {
+    ScePadTriggerEffectCommand command = {};
+    command.mode = SCE_PAD_TRIGGER_EFFECT_MODE_OFF;
+
+    bool ownsLeft = ownerId != 0 && m_triggerOwners[0] == ownerId;
+    bool ownsRight = ownerId != 0 && m_triggerOwners[1] == ownerId;
+
+    if (ownsLeft && ownsRight) {
+      SetTriggerEffectCommand(0, ipc::VRController_Both, command);
+    } else if (ownsLeft) {
+      SetTriggerEffectCommand(0, ipc::VRController_Left, command);
+    } else if (ownsRight) {
+      SetTriggerEffectCommand(0, ipc::VRController_Right, command);
+    }
+  }
+
+  void TriggerEffectManager::SetTriggerEffectCommand(uint32_t ownerId, ipc::EVRControllerType controllerType, ScePadTriggerEffectCommand command) {
     static AstonManager_t *pAstonManager = getAstonManager();
 
-    (void)processId;
+    // The last client to set an effect owns the trigger until it turns it off or goes away.
+    uint32_t newOwner = command.mode == SCE_PAD_TRIGGER_EFFECT_MODE_OFF ? 0 : ownerId;
+    if (controllerType == ipc::VRController_Left || controllerType == ipc::VRController_Both) {
+      m_triggerOwners[0] = newOwner;
+    }
+    if (controllerType == ipc::VRController_Right || controllerType == ipc::VRController_Both) {
+      m_triggerOwners[1] = newOwner;
+    }
 
     ScePadTriggerEffectParam param = {};
     switch (controllerType) {
@@ -14,14 +14,17 @@ namespace psvr2_toolkit {
     bool Initialized();
     void Initialize();
 
-    void HandleIpcCommand(uint32_t processId, ipc::CommandHeader_t *pHeader, void *pData);
+    // ownerId identifies the client sending the command, effects it leaves behind are turned off by ReleaseOwner.
+    void HandleIpcCommand(uint32_t ownerId, const ipc::CommandHeader_t *pHeader, void *pData);
+    void ReleaseOwner(uint32_t ownerId);
 
   private:
     static psvr2_toolkit::TriggerEffectManager *m_pInstance;
 
     bool m_initialized;
+    uint32_t m_triggerOwners[2]; // 0 = Left, 1 = Right. 0 if no effect is set.
 
-    void SetTriggerEffectCommand(uint32_t processId, ipc::EVRControllerType controllerType, ScePadTriggerEffectCommand command);
+    void SetTriggerEffectCommand(uint32_t ownerId, ipc::EVRControllerType controllerType, ScePadTriggerEffectCommand command);
   };
 
 } // psvr2_toolkit
@@ -1,30 +1,12 @@
 #include "usb_thread_gaze.h"
 
 #include "hmd_driver_loader.h"
-#include "hmd_device_hooks.h"
 #include "hmd2_gaze.h"
-#include "ipc_server.h"
-
-#include "gaze_calibration.h"
+#include "gaze_metrics.h"
+#include "gaze_pipeline.h"
 
 #include "util.h"
 
-namespace {
-    GazeCalibrationProfile g_leftEyeCalibration;
-    GazeCalibrationProfile g_rightEyeCalibration;
-    bool g_calibrationLoaded = false;
-
-    void LoadCalibrationProfiles()
-    {
-        if (g_calibrationLoaded) return;
-
-        g_leftEyeCalibration.LoadConfig("LeftEye");
-        g_rightEyeCalibration.LoadConfig("RightEye");
-
-        g_calibrationLoaded = true;
-    }
-}
-
 #include <cstdlib>
 
 #include <winusb.h>
@@ -35,7 +17,6 @@ namespace {
 #define GAZE_MAGIC_1_STATE 0x53
 
 using namespace psvr2_toolkit;
-using namespace psvr2_toolkit::ipc;
 
 void **ppVTable = nullptr; // We need to keep track of our customized CaesarUsbThread VTable here, so we may restore it.
 
@@ -142,34 +123,20 @@ uint8_t CaesarUsbThreadGaze::getReadPipeId() {
 }
 
 int CaesarUsbThreadGaze::poll() {
-  static IpcServer *pIpcServer = IpcServer::Instance();
-  LoadCalibrationProfiles();
+  static GazeMetrics *pGazeMetrics = GazeMetrics::Instance();
+  static GazePipeline *pGazePipeline = GazePipeline::Instance();
 
   static char buffer[0x200000];
+  uint64_t readStartTicks = GazeMetrics::Now();
   int result = CaesarUsbThread__read(this, 0x85, buffer, sizeof(buffer));
+  uint64_t readEndTicks = GazeMetrics::Now();
   if (result < 0) {
     return -1;
   }
 
   if (buffer[0] == GAZE_MAGIC_0 && buffer[1] == GAZE_MAGIC_1_STATE) {
-
-    Hmd2GazeState* pGazeState = reinterpret_cast<Hmd2GazeState*>(buffer);
-    Hmd2GazeState calibratedGazeState = *pGazeState;
-
-    if (calibratedGazeState.leftEye.isGazeDirValid) {
-        calibratedGazeState.leftEye.gazeDirNorm = g_leftEyeCalibration.Remap(
-            pGazeState->leftEye.gazeDirNorm
-        );
-    }
-
-    if (calibratedGazeState.rightEye.isGazeDirValid) {
-        calibratedGazeState.rightEye.gazeDirNorm = g_rightEyeCalibration.Remap(
-            pGazeState->rightEye.gazeDirNorm
-        );
-    }
-
-    HmdDeviceHooks::UpdateGaze(&calibratedGazeState, sizeof(Hmd2GazeState));
-    pIpcServer->UpdateGazeState(&calibratedGazeState);
+    pGazeMetrics->Record(ipc::GazeStage_UsbRead, readStartTicks, readEndTicks);
+    pGazePipeline->ProcessLive(*reinterpret_cast<Hmd2GazeState *>(buffer), static_cast<uint32_t>(result), readEndTicks);
   }
 
   return 0;
@@ -2,12 +2,15 @@
 
 #include "config.h"
 
+#ifdef _WIN32
 #include <windows.h>
-#include <tlhelp32.h>
+#endif
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <openvr_driver.h>
 
+#include <chrono>
 #include <format>
 #include <iostream>
 
@@ -19,6 +22,7 @@ namespace psvr2_toolkit {
       return strncmp(a, b, strlen(b)) == 0;
     }
 
+#ifdef _WIN32
     static bool IsRunningOnWine() {
 #if !MOCK_IS_RUNNING_ON_WINE
       HMODULE hModule = GetModuleHandleW(L"ntdll.dll");
@@ -31,27 +35,40 @@ namespace psvr2_toolkit {
 #endif
     }
 
+    // Direct handle query, cheap enough to call on every handshake.
     static bool IsProcessRunning(DWORD dwProcessId) {
-      HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-      if (hSnapshot == INVALID_HANDLE_VALUE) {
-        return false;
+      HANDLE hProcess = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, dwProcessId);
+      if (!hProcess) {
+        // The process exists, we just aren't allowed to look at it.
+        return GetLastError() == ERROR_ACCESS_DENIED;
       }
 
-      PROCESSENTRY32W pe;
-      pe.dwSize = sizeof(pe);
+      bool running = WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT;
+      CloseHandle(hProcess);
+      return running;
+    }
 
-      if (Process32FirstW(hSnapshot, &pe)) {
-        do {
-          if (pe.th32ProcessID == dwProcessId) {
-            CloseHandle(hSnapshot);
-            return true;
-          }
-        } while (Process32NextW(hSnapshot, &pe));
+    // Host QPC time in microseconds.
+    static int64_t GetHostTimestamp() {
+      static LARGE_INTEGER frequency{};
+      if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
       }
 
-      CloseHandle(hSnapshot);
-      return false;
+      LARGE_INTEGER now;
+      QueryPerformanceCounter(&now);
+
+      // Whole seconds and the remainder apart, so it stays exact and can't overflow however long the host has been up.
+      int64_t seconds = now.QuadPart / frequency.QuadPart;
+      int64_t remainder = now.QuadPart % frequency.QuadPart;
+      return seconds * 1000000 + remainder * 1000000 / frequency.QuadPart;
     }
+#else
+    // Only the tests build on other platforms, where the steady clock stands in for QPC.
+    static int64_t GetHostTimestamp() {
+      return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+#endif
 
     template <typename... Args>
     static void DriverLog(const char *format, const Args&... args) {
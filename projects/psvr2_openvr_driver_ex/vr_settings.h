@@ -9,12 +9,36 @@
 #define STEAMVR_SETTINGS_DISABLE_DIALOG "disableDialog"
 #define STEAMVR_SETTINGS_DISABLE_SENSE "disableSense"
 #define STEAMVR_SETTINGS_DISABLE_GAZE "disableGaze"
+#define STEAMVR_SETTINGS_ENABLE_GAZE_SHARED_MEMORY "enableGazeSharedMemory"
+#define STEAMVR_SETTINGS_GAZE_CALIBRATION_MODEL "gazeCalibrationModel"
+#define STEAMVR_SETTINGS_ENABLE_GAZE_FILTER "enableGazeFilter"
+#define STEAMVR_SETTINGS_GAZE_FILTER_MIN_CUTOFF "gazeFilterMinCutoff"
+#define STEAMVR_SETTINGS_GAZE_FILTER_BETA "gazeFilterBeta"
+#define STEAMVR_SETTINGS_GAZE_FILTER_DERIVATIVE_CUTOFF "gazeFilterDerivativeCutoff"
+#define STEAMVR_SETTINGS_ENABLE_GAZE_FUSION "enableGazeFusion"
+#define STEAMVR_SETTINGS_GAZE_FUSION_TIME_CONSTANT "gazeFusionTimeConstant"
+#define STEAMVR_SETTINGS_ENABLE_GAZE_PREDICTION "enableGazePrediction"
+#define STEAMVR_SETTINGS_GAZE_FOVEA_RADIUS "gazeFoveaRadius"
+#define STEAMVR_SETTINGS_ENABLE_GAZE_RECORDING "enableGazeRecording"
+#define STEAMVR_SETTINGS_GAZE_RECORDING_DIRECTORY "gazeRecordingDirectory"
 
 #define SETTING_DISABLE_CHAPERONE_DEFAULT_VALUE false
 #define SETTING_DISABLE_OVERLAY_DEFAULT_VALUE false
 #define SETTING_DISABLE_DIALOG_DEFAULT_VALUE false
 #define SETTING_DISABLE_SENSE_DEFAULT_VALUE false
 #define SETTING_DISABLE_GAZE_DEFAULT_VALUE false
+#define SETTING_ENABLE_GAZE_SHARED_MEMORY_DEFAULT_VALUE false
+#define SETTING_GAZE_CALIBRATION_MODEL_DEFAULT_VALUE "polygon" // "polygon" or "grid".
+#define SETTING_ENABLE_GAZE_FILTER_DEFAULT_VALUE false
+#define SETTING_GAZE_FILTER_MIN_CUTOFF_DEFAULT_VALUE 1.0f // Hz, at fixation.
+#define SETTING_GAZE_FILTER_BETA_DEFAULT_VALUE 10.0f // Hz added per unit per second of gaze speed.
+#define SETTING_GAZE_FILTER_DERIVATIVE_CUTOFF_DEFAULT_VALUE 10.0f // Hz, high enough to catch a saccade within a few samples.
+#define SETTING_ENABLE_GAZE_FUSION_DEFAULT_VALUE false
+#define SETTING_GAZE_FUSION_TIME_CONSTANT_DEFAULT_VALUE 0.5f // Seconds over which eye validity, noise and offsets are averaged.
+#define SETTING_ENABLE_GAZE_PREDICTION_DEFAULT_VALUE false
+#define SETTING_GAZE_FOVEA_RADIUS_DEFAULT_VALUE 10.0f // Degrees of the foveal rectangle either side of the gaze, with room for tracking error.
+#define SETTING_ENABLE_GAZE_RECORDING_DEFAULT_VALUE false
+#define SETTING_GAZE_RECORDING_DIRECTORY_DEFAULT_VALUE "" // Empty records to %LOCALAPPDATA%\PSVR2Toolkit\GazeRecordings.
 
 namespace psvr2_toolkit {
 
@@ -49,10 +73,13 @@ namespace psvr2_toolkit {
         return value;
     }
 
+    // Longest string GetString reads back, including the terminator. Longer values come back truncated.
+    static constexpr size_t k_unMaxStringSize = 4096;
+
     static std::string GetString(const char* pchSettingsKey, const std::string& defaultValue)
     {
         vr::EVRSettingsError error;
-        char buffer[1024];
+        char buffer[k_unMaxStringSize];
         vr::VRSettings()->GetString(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, pchSettingsKey, buffer, sizeof(buffer), &error);
 
         if (error != vr::EVRSettingsError::VRSettingsError_None)
@@ -63,6 +90,12 @@ namespace psvr2_toolkit {
         return std::string(buffer);
     }
 
+    static void SetString(const char* pchSettingsKey, const std::string& value)
+    {
+        vr::EVRSettingsError error;
+        vr::VRSettings()->SetString(STEAMVR_SETTINGS_SECTION_PLAYSTATION_VR2_EX, pchSettingsKey, value.c_str(), &error);
+    }
+
   };
 
 } // psvr2_toolkit
@@ -0,0 +1,71 @@
+#include "win32_process_watcher.h"
+
+#include "util.h"
+
+namespace psvr2_toolkit {
+
+  Win32ProcessWatcher::Win32ProcessWatcher(ProcessExitCallback_t pCallback, void *pUserData)
+    : m_pCallback(pCallback)
+    , m_pUserData(pUserData)
+    , m_watches()
+  {}
+
+  Win32ProcessWatcher::~Win32ProcessWatcher() {
+    while (!m_watches.empty()) {
+      Unwatch(m_watches.begin()->first);
+    }
+  }
+
+  bool Win32ProcessWatcher::IsProcessRunning(uint32_t processId) {
+    return Util::IsProcessRunning(processId);
+  }
+
+  bool Win32ProcessWatcher::Watch(uint32_t processId, uint32_t cookie) {
+    Unwatch(cookie);
+
+    HANDLE hProcess = OpenProcess(SYNCHRONIZE, FALSE, processId);
+    if (!hProcess) {
+      return false;
+    }
+
+    Watch_t *pWatch = new Watch_t {
+      .pWatcher = this,
+      .cookie = cookie,
+      .hProcess = hProcess,
+      .hWait = nullptr,
+    };
+
+    // If the process already exited, the callback simply fires right away.
+    if (!RegisterWaitForSingleObject(&pWatch->hWait, hProcess, &Win32ProcessWatcher::WaitCallback, pWatch, INFINITE, WT_EXECUTEONLYONCE)) {
+      CloseHandle(hProcess);
+      delete pWatch;
+      return false;
+    }
+
+    m_watches[cookie] = pWatch;
+    return true;
+  }
+
+  void Win32ProcessWatcher::Unwatch(uint32_t cookie) {
+    auto it = m_watches.find(cookie);
+    if (it == m_watches.end()) {
+      return;
+    }
+
+    Watch_t *pWatch = it->second;
+    m_watches.erase(it);
+
+    // Waits for a callback that is already running, so pWatch can't be freed under it.
+    UnregisterWaitEx(pWatch->hWait, INVALID_HANDLE_VALUE);
+    CloseHandle(pWatch->hProcess);
+    delete pWatch;
+  }
+
+  void CALLBACK Win32ProcessWatcher::WaitCallback(PVOID pContext, BOOLEAN timedOut) {
+    Watch_t *pWatch = static_cast<Watch_t *>(pContext);
+    if (!timedOut) {
+      pWatch->pWatcher->m_pCallback(pWatch->pWatcher->m_pUserData, pWatch->cookie);
+    }
+  }
+
+} // psvr2_toolkit
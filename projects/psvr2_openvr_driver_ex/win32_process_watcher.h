@@ -0,0 +1,37 @@
+#pragma once
+
+#include "process_watcher.h"
+
+#include <windows.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace psvr2_toolkit {
+
+  // Holds a process handle per watch and lets the thread pool wait on all of them.
+  class Win32ProcessWatcher : public ProcessWatcher {
+  public:
+    Win32ProcessWatcher(ProcessExitCallback_t pCallback, void *pUserData);
+    ~Win32ProcessWatcher() override;
+
+    bool IsProcessRunning(uint32_t processId) override;
+    bool Watch(uint32_t processId, uint32_t cookie) override;
+    void Unwatch(uint32_t cookie) override;
+
+  private:
+    struct Watch_t {
+      Win32ProcessWatcher *pWatcher;
+      uint32_t cookie;
+      HANDLE hProcess;
+      HANDLE hWait;
+    };
+
+    ProcessExitCallback_t m_pCallback;
+    void *m_pUserData;
+    std::unordered_map<uint32_t, Watch_t *> m_watches;
+
+    static void CALLBACK WaitCallback(PVOID pContext, BOOLEAN timedOut);
+  };
+
+} // psvr2_toolkit
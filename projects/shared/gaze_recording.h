@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+// Extension of the gaze recordings the driver writes, see GazeRecorder.
+#define GAZE_RECORDING_FILE_EXTENSION ".pvgr"
+
+namespace psvr2_toolkit {
+
+  static constexpr uint32_t k_unGazeRecordingMagic = 0x4C475650; // 'PVGL'
+  static constexpr uint32_t k_unGazeRecordingVersion = 1;
+
+  // The header region is followed by fixed size chunks of frames. Both sizes are multiples of the 64 KiB
+  // allocation granularity, so every chunk can be mapped on its own.
+  static constexpr uint32_t k_unGazeRecordingHeaderSize = 0x10000;
+  static constexpr uint32_t k_unGazeRecordingChunkSize = 0x1000000;
+  static constexpr uint32_t k_unGazeRecordingMaxChunks = 256;
+
+  // Size of the Hmd2GazeState the PS VR2 sends, both copies in a frame are stored verbatim.
+  static constexpr uint32_t k_unGazeRecordingStateSize = 328;
+
+  struct GazeRecordingChunk_t {
+    uint64_t fileOffset;
+    uint64_t firstSequence;
+    int64_t firstHostTimestampUs;
+    uint32_t frameCount; // Only filled in once the chunk is full or the recording stops.
+    uint32_t reserved;
+  };
+
+  // isComplete is only set once the recording was stopped cleanly. Otherwise the chunk frame counts can't be trusted,
+  // and a reader has to scan the chunks for frames instead, the unwritten rest of a chunk is all zeroes.
+  struct GazeRecordingHeader_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t chunkSize;
+    uint32_t frameSize;
+    uint32_t stateSize;
+    uint32_t chunkCount; // Chunks holding at least one frame.
+    uint32_t droppedFrameCount; // Frames that arrived while no chunk was ready to take them.
+    uint64_t frameCount;
+    int64_t startHostTimestampUs;
+    int64_t stopHostTimestampUs;
+    bool isComplete;
+    GazeRecordingChunk_t chunks[k_unGazeRecordingMaxChunks];
+  };
+
+  struct GazeRecordingFrame_t {
+    uint64_t sequence; // Same sequence number IPC clients see, never 0 for a written frame.
+    uint64_t hmdTimestampUs;
+    int64_t hostTimestampUs;
+    uint32_t rawPacketSize; // Bytes the USB read returned, only the state at the start of the packet is kept.
+    uint32_t reserved;
+    uint8_t rawState[k_unGazeRecordingStateSize]; // As read from USB.
+    uint8_t calibratedState[k_unGazeRecordingStateSize]; // After calibration and filtering, as passed on to SteamVR.
+  };
+
+  static_assert(sizeof(GazeRecordingHeader_t) <= k_unGazeRecordingHeaderSize);
+  static_assert(sizeof(GazeRecordingFrame_t) % 8 == 0);
+
+} // psvr2_toolkit
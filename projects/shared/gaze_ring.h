@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ipc_protocol.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Names of the shared memory section and wakeup events the driver creates when the gaze ring is enabled.
+// Event 0 is signaled when an even sequence number is published, event 1 for odd sequence numbers.
+#define GAZE_RING_SHARED_MEMORY_NAME L"Local\\PSVR2ToolkitGazeRing"
+#define GAZE_RING_EVENT_0_NAME L"Local\\PSVR2ToolkitGazeRingEvent0"
+#define GAZE_RING_EVENT_1_NAME L"Local\\PSVR2ToolkitGazeRingEvent1"
+
+namespace psvr2_toolkit {
+  namespace ipc {
+
+    static constexpr uint32_t k_unGazeRingMagic = 0x52475650; // 'PVGR'
+    static constexpr uint32_t k_unGazeRingVersion = 2;
+    static constexpr uint32_t k_unGazeRingCapacity = 256; // Must be a power of two, ~2 seconds of samples.
+
+    // The ring is indexed by the sample sequence number, the same one IPC clients see.
+    typedef CommandDataServerGazeDataResult2_t GazeRingSample_t;
+
+    static_assert(std::is_trivially_copyable_v<GazeRingSample_t>);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Gaze ring atomics must be address-free to be shared across processes.");
+
+    struct alignas(64) GazeRingHeader_t {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t capacity;
+      uint32_t entrySize;
+      std::atomic<uint64_t> latestSequence; // Sequence number of the newest fully written sample, 0 if none.
+    };
+
+    struct alignas(64) GazeRingEntry_t {
+      static constexpr size_t k_unWordCount = (sizeof(GazeRingSample_t) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+      std::atomic<uint64_t> committedSequence; // 0 while the entry is being written.
+      std::atomic<uint64_t> words[k_unWordCount];
+    };
+
+    struct GazeRing_t {
+      GazeRingHeader_t header;
+      GazeRingEntry_t entries[k_unGazeRingCapacity];
+    };
+
+    // Only the driver writes to the ring. Each entry is its own sequence lock, so the writer never waits on readers.
+    class GazeRingWriter {
+    public:
+      explicit GazeRingWriter(GazeRing_t *pRing)
+        : m_pRing(pRing)
+      {}
+
+      void Initialize() {
+        memset(static_cast<void *>(m_pRing), 0, sizeof(GazeRing_t));
+        m_pRing->header.version = k_unGazeRingVersion;
+        m_pRing->header.capacity = k_unGazeRingCapacity;
+        m_pRing->header.entrySize = sizeof(GazeRingEntry_t);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_pRing->header.magic = k_unGazeRingMagic; // Readers treat the ring as valid once the magic is set.
+      }
+
+      // Sequence numbers must be non-zero and increasing, gaps are allowed.
+      void Publish(const GazeRingSample_t &sample) {
+        uint64_t sequence = sample.sequence;
+
+        uint64_t pWords[GazeRingEntry_t::k_unWordCount] = {};
+        memcpy(pWords, &sample, sizeof(GazeRingSample_t));
+
+        GazeRingEntry_t &entry = m_pRing->entries[sequence & (k_unGazeRingCapacity - 1)];
+        entry.committedSequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < GazeRingEntry_t::k_unWordCount; i++) {
+          entry.words[i].store(pWords[i], std::memory_order_relaxed);
+        }
+
+        entry.committedSequence.store(sequence, std::memory_order_release);
+        m_pRing->header.latestSequence.store(sequence, std::memory_order_release);
+      }
+
+    private:
+      GazeRing_t *m_pRing;
+    };
+
+    // Readers never write to the ring, so it may be mapped read-only.
+    class GazeRingReader {
+    public:
+      explicit GazeRingReader(const GazeRing_t *pRing)
+        : m_pRing(pRing)
+      {}
+
+      bool Valid() const {
+        return m_pRing->header.magic == k_unGazeRingMagic &&
+               m_pRing->header.version == k_unGazeRingVersion &&
+               m_pRing->header.capacity == k_unGazeRingCapacity &&
+               m_pRing->header.entrySize == sizeof(GazeRingEntry_t);
+      }
+
+      uint64_t LatestSequence() const {
+        return m_pRing->header.latestSequence.load(std::memory_order_acquire);
+      }
+
+      // Returns false if the sample has not been written yet, or was already overwritten.
+      bool Read(uint64_t sequence, GazeRingSample_t &sample) const {
+        const GazeRingEntry_t &entry = m_pRing->entries[sequence & (k_unGazeRingCapacity - 1)];
+        uint64_t pWords[GazeRingEntry_t::k_unWordCount];
+
+        if (entry.committedSequence.load(std::memory_order_acquire) != sequence) {
+          return false;
+        }
+
+        for (size_t i = 0; i < GazeRingEntry_t::k_unWordCount; i++) {
+          pWords[i] = entry.words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.committedSequence.load(std::memory_order_relaxed) != sequence) {
+          return false;
+        }
+
+        memcpy(&sample, pWords, sizeof(GazeRingSample_t));
+        return true;
+      }
+
+      // Reads the newest sample, retrying if the writer laps us mid-read.
+      bool ReadLatest(GazeRingSample_t &sample) const {
+        while (true) {
+          uint64_t sequence = LatestSequence();
+          if (sequence == 0) {
+            return false;
+          }
+          if (Read(sequence, sample)) {
+            return true;
+          }
+        }
+      }
+
+    private:
+      const GazeRing_t *m_pRing;
+    };
+
+  } // ipc
+} // psvr2_toolkit
@@ -7,8 +7,14 @@
 namespace psvr2_toolkit {
   namespace ipc {
 
-    static constexpr uint16_t k_unIpcVersion = 1;
+    // 2: Clients can subscribe to have gaze pushed to them, see Command_ClientSubscribeGaze.
+    // 3: Gaze results are sent as CommandDataServerGazeDataResult2_t to clients that handshake with version 3 or later, gaze history.
+    static constexpr uint16_t k_unIpcVersion = 3;
     static constexpr uint32_t k_unTriggerEffectControlPoint = 10;
+    static constexpr uint32_t k_unGazeHistoryMaxSamples = 8; // Keeps a history result message within 1 KiB.
+    static constexpr uint32_t k_unGazeEventsMaxEvents = 16;
+    static constexpr uint32_t k_unGazeReplayMaxPath = 260;
+    static constexpr uint32_t k_unGazeStatsMaxStages = 16;
 
     enum ECommandType : uint16_t {
       Command_ClientPing, // No command data.
@@ -18,7 +24,7 @@ namespace psvr2_toolkit {
       Command_ServerHandshakeResult, // CommandDataServerHandshakeResult_t
 
       Command_ClientRequestGazeData, // No command data.
-      Command_ServerGazeDataResult, // CommandDataServerGazeDataResult_t
+      Command_ServerGazeDataResult, // CommandDataServerGazeDataResult_t, or CommandDataServerGazeDataResult2_t from IPC version 3. Also pushed to clients subscribed to gaze.
 
       Command_ClientTriggerEffectOff, // CommandDataClientTriggerEffectOff_t
       Command_ClientTriggerEffectFeedback, // CommandDataClientTriggerEffectFeedback_t
@@ -27,6 +33,53 @@ namespace psvr2_toolkit {
       Command_ClientTriggerEffectMultiplePositionFeedback, // CommandDataClientTriggerEffectMultiplePositionFeedback_t
       Command_ClientTriggerEffectSlopeFeedback, // CommandDataClientTriggerEffectSlopeFeedback_t
       Command_ClientTriggerEffectMultiplePositionVibration, // CommandDataClientTriggerEffectMultiplePositionVibration_t
+
+      Command_ClientSubscribeGaze, // CommandDataClientSubscribeGaze_t, or no command data to receive every sample. Requires IPC version 2.
+      Command_ClientUnsubscribeGaze, // No command data.
+
+      Command_ClientRequestGazeHistory, // CommandDataClientRequestGazeHistory_t, requires IPC version 3.
+      Command_ServerGazeHistoryResult, // CommandDataServerGazeHistoryResult_t, one or more per request.
+
+      // Calibration session, each command is answered with Command_ServerGazeCalibrationStatus.
+      // Only one client can run a session at a time, it is cancelled if that client disconnects.
+      Command_ClientStartGazeCalibration, // No command data.
+      Command_ClientSetGazeCalibrationPoint, // CommandDataClientSetGazeCalibrationPoint_t, no command data means the origin.
+      Command_ClientStopGazeCalibration, // CommandDataClientStopGazeCalibration_t, no command data means discard.
+      Command_ServerGazeCalibrationStatus, // CommandDataServerGazeCalibrationStatus_t
+
+      Command_ClientRequestGazePrediction, // CommandDataClientRequestGazePrediction_t, no command data means the next vsync.
+      Command_ServerGazePredictionResult, // CommandDataServerGazePredictionResult_t
+
+      Command_ClientSubscribeGazeEvents, // No command data.
+      Command_ClientUnsubscribeGazeEvents, // No command data.
+      Command_ServerGazeEvents, // CommandDataServerGazeEvents_t, pushed to clients subscribed to gaze events.
+
+      // Each command is answered with Command_ServerGazeRecordingStatus, start and stop once the file is opened or finalized.
+      Command_ClientStartGazeRecording, // No command data.
+      Command_ClientStopGazeRecording, // No command data.
+      Command_ClientRequestGazeRecordingStatus, // No command data.
+      Command_ServerGazeRecordingStatus, // CommandDataServerGazeRecordingStatus_t
+
+      // Feeds a recording through the gaze pipeline in place of the headset, live gaze is ignored while it runs.
+      // Each command is answered with Command_ServerGazeReplayStatus.
+      Command_ClientStartGazeReplay, // CommandDataClientStartGazeReplay_t
+      Command_ClientStopGazeReplay, // No command data.
+      Command_ClientRequestGazeReplayStatus, // No command data.
+      Command_ServerGazeReplayStatus, // CommandDataServerGazeReplayStatus_t
+
+      // Latency of every gaze pipeline stage, both commands are answered with Command_ServerGazeStats.
+      Command_ClientRequestGazeStats, // CommandDataClientRequestGazeStats_t, no command data means keep the histograms.
+      Command_ClientDumpGazeStats, // No command data. Writes the full histograms next to the gaze recordings.
+      Command_ServerGazeStats, // CommandDataServerGazeStats_t
+
+      Command_ClientRequestGazeClockStatus, // No command data.
+      Command_ServerGazeClockStatus, // CommandDataServerGazeClockStatus_t
+
+      Command_ClientRequestGazeVergence, // No command data.
+      Command_ServerGazeVergenceResult, // CommandDataServerGazeVergenceResult_t
+
+      Command_ClientRequestGazeFoveation, // No command data.
+      Command_ServerGazeFoveationResult, // CommandDataServerGazeFoveationResult_t
     };
 
     enum EHandshakeResultType : uint8_t {
@@ -41,6 +94,44 @@ namespace psvr2_toolkit {
       VRController_Both,
     };
 
+    enum EGazeCalibrationState : uint8_t {
+      GazeCalibrationState_Idle,
+      GazeCalibrationState_Running,
+      GazeCalibrationState_Busy, // Another client is running a session, the command was ignored.
+    };
+
+    enum EGazeEventType : uint8_t {
+      GazeEventType_FixationStart, // Sent once the fixation has lasted the minimum fixation duration.
+      GazeEventType_FixationEnd,
+      GazeEventType_SaccadeStart,
+      GazeEventType_SaccadeEnd,
+    };
+
+    enum EGazeEventSource : uint8_t {
+      GazeEventSource_LeftEye,
+      GazeEventSource_RightEye,
+      GazeEventSource_Combined,
+    };
+
+    // In the order a gaze state passes through them.
+    enum EGazeStage : uint8_t {
+      GazeStage_UsbRead, // Waiting in the USB read for the next packet, mostly the time between packets.
+      GazeStage_Parse, // From the read returning to the pipeline starting, timestamp unwrapping and conversion.
+      GazeStage_Remap, // Calibration sampling and remap.
+      GazeStage_Fusion,
+      GazeStage_Filter,
+      GazeStage_Record, // Stamping the sequence number and recording.
+      GazeStage_Predict,
+      GazeStage_Vergence,
+      GazeStage_Foveation, // Projecting the gaze into each eye's image.
+      GazeStage_OpenVrUpdate, // Passing the state on to SteamVR, including the eye tracking component update.
+      GazeStage_Publish, // Handing the sample to the IPC server and the shared memory ring.
+      GazeStage_Pipeline, // From the read returning, or a replayed frame starting, to the sample being published.
+      GazeStage_IpcWake, // From the sample being published to the IPC event loop picking it up.
+      GazeStage_IpcFanOut, // Sending the sample and any gaze events to every subscribed client.
+      GazeStage_Count,
+    };
+
     struct CommandDataClientRequestHandshake_t {
       uint16_t ipcVersion; // The IPC version this client is using.
       uint32_t processId;
@@ -72,13 +163,197 @@ namespace psvr2_toolkit {
     };
 
     struct CommandDataServerGazeDataResult_t {
-      // TODO: Include timestamp, etc.
+      GazeEyeResult leftEye;
+      GazeEyeResult rightEye;
+    };
+
+    struct GazeCombinedResult {
+      bool isGazeOriginValid;
+      GazeVector3 gazeOriginMm;
+
+      bool isGazeDirValid;
+      GazeVector3 gazeDirNorm;
+    };
+
+    struct CommandDataServerGazeDataResult2_t {
+      uint64_t sequence; // Starts at 1, increases by one for every gaze sample. A repeated sequence is a repeated sample.
+      uint64_t hmdTimestampUs; // HMD clock, unwrapped to 64 bits.
+      int64_t hostTimestampUs; // The HMD timestamp converted to host QPC time, in microseconds.
 
       GazeEyeResult leftEye;
       GazeEyeResult rightEye;
+      GazeCombinedResult combined;
     };
     #pragma pack(pop)
 
+    struct CommandDataClientSubscribeGaze_t {
+      uint16_t decimation; // Only every Nth gaze sample is pushed to the client, 0 and 1 both mean every sample.
+    };
+
+    struct CommandDataClientRequestGazeHistory_t {
+      uint64_t afterSequence; // Requests every sample newer than this, 0 for everything still in the history.
+    };
+
+    // A request is answered by consecutive result messages, all but the last have hasMore set.
+    // If the newest returned sequence is still behind latestSequence, the response was capped and the client should ask again.
+    struct CommandDataServerGazeHistoryResult_t {
+      uint64_t latestSequence; // Newest sample in the history when the response was built.
+      uint32_t missedCount; // Requested samples skipped before this message's samples, because they were already overwritten.
+      uint8_t sampleCount;
+      bool hasMore;
+      CommandDataServerGazeDataResult2_t samples[k_unGazeHistoryMaxSamples];
+    };
+
+    // Finishes the previous point and starts collecting samples for this one.
+    // Show the target before sending this, the first moments after are skipped while the eye settles.
+    struct CommandDataClientSetGazeCalibrationPoint_t {
+      float targetX, targetY; // Where the target is, in calibrated gaze direction coordinates.
+    };
+
+    // Finishes the last point and ends the session.
+    struct CommandDataClientStopGazeCalibration_t {
+      bool apply; // Applies the fit right away and saves it to the settings, otherwise it is discarded.
+    };
+
+    struct GazeCalibrationEyeStatus_t {
+      uint16_t pointCount; // Points fitted so far.
+      uint16_t lastPointSamples; // Samples kept for the last point, 0 if it was rejected.
+      uint16_t lastPointRejected; // Samples of the last point dropped as blinks or outliers.
+      bool isFitValid;
+      float rmsError; // Distance between the fit and the targets, in calibrated gaze units.
+    };
+
+    struct CommandDataServerGazeCalibrationStatus_t {
+      EGazeCalibrationState state;
+      bool isApplied; // Only set in the answer to a stop that applied the fit.
+      GazeCalibrationEyeStatus_t leftEye;
+      GazeCalibrationEyeStatus_t rightEye;
+    };
+
+    struct CommandDataClientRequestGazePrediction_t {
+      int64_t targetHostTimestampUs; // Host QPC time in microseconds to predict the gaze for, 0 for the next vsync.
+    };
+
+    struct CommandDataServerGazePredictionResult_t {
+      int64_t targetHostTimestampUs; // The time predicted for. Falls back to now if 0 was requested and no vsync has been seen.
+      int64_t sampleHostTimestampUs; // Host time of the newest sample the prediction is based on.
+      uint64_t sequence; // Sequence number of that sample.
+      GazeVector3 gazeOriginMm;
+      GazeVector3 gazeDirNorm; // The combined gaze ray, extrapolated at most 50 ms past the sample. Always unit length.
+      bool isValid; // Whether there was a valid combined gaze to predict from.
+      bool isSaccade; // A saccade is in progress, the direction is held instead of extrapolated.
+    };
+
+    // Positions are in calibrated gaze direction coordinates, like the x and y of gazeDirNorm.
+    // A blink or lost tracking ends whatever event was in progress.
+    struct GazeEvent_t {
+      uint64_t sequence; // Gaze sample the event started at.
+      int64_t hostTimestampUs; // Host time of that sample.
+      uint32_t durationUs; // Only set for end events.
+      EGazeEventType type;
+      EGazeEventSource source;
+      uint16_t sampleCount; // Samples the fixation or saccade spans so far.
+      float x, y; // Fixation centroid, or where the saccade started or landed.
+      float amplitude; // Saccade end events only, distance between launch and landing.
+    };
+
+    struct CommandDataServerGazeEvents_t {
+      uint8_t eventCount;
+      GazeEvent_t events[k_unGazeEventsMaxEvents]; // Oldest first.
+    };
+
+    struct CommandDataServerGazeRecordingStatus_t {
+      bool isRecording;
+      uint32_t droppedFrameCount; // Frames of the current or last recording that didn't make it into the file.
+      uint64_t frameCount; // Frames recorded so far, or in total once stopped.
+    };
+
+    struct CommandDataClientStartGazeReplay_t {
+      bool asFastAsPossible; // Otherwise frames are fed at the pace they were recorded at.
+      char path[k_unGazeReplayMaxPath]; // A full path, or the file name of a recording in the recording directory.
+    };
+
+    struct CommandDataServerGazeReplayStatus_t {
+      bool isReplaying;
+      uint64_t frameCount; // Frames in the recording being replayed, or the last one.
+      uint64_t replayedFrameCount;
+      uint64_t processingTimeUs; // Time spent in the pipeline, for the throughput without any pacing.
+    };
+
+    struct CommandDataClientRequestGazeStats_t {
+      bool reset; // Clears the histograms once they have been read.
+    };
+
+    // Percentiles are the upper bound of the histogram bucket they fall into, within about 6% of the real value.
+    struct GazeStageStats_t {
+      uint64_t count;
+      uint32_t meanNs;
+      uint32_t p50Ns;
+      uint32_t p90Ns;
+      uint32_t p99Ns;
+      uint32_t p999Ns;
+      uint32_t maxNs;
+    };
+
+    struct CommandDataServerGazeStats_t {
+      uint8_t stageCount;
+      GazeStageStats_t stages[k_unGazeStatsMaxStages]; // Indexed by EGazeStage.
+    };
+
+    // How HMD timestamps are mapped to host time, and how well the mapped times line up with when samples arrive.
+    // Latency and interval statistics cover the last complete window of 1024 samples, they are 0 until the first one.
+    struct CommandDataServerGazeClockStatus_t {
+      bool isSynchronized; // At least two HMD offset samples have been fitted.
+      uint32_t offsetSampleCount; // Offset samples in the fit, outliers excluded.
+      int64_t offsetUs; // Host minus HMD time at the newest offset sample.
+      float driftPpm; // How much faster the host clock runs than the HMD's.
+      float offsetResidualRmsUs; // Of the offset samples around the fit.
+      float offsetResidualMaxUs;
+      uint32_t jitterSampleCount;
+      float latencyMeanUs; // From the mapped sample time to the USB read returning.
+      float latencyStdDevUs;
+      float latencyMinUs;
+      float latencyMaxUs;
+      float intervalMeanUs; // Between consecutive HMD timestamps.
+      float intervalStdDevUs;
+    };
+
+    // Where the eyes are fixating in 3D, from where the left and right gaze rays pass closest to each other.
+    // Positions are in the same coordinates as gazeOriginMm, depths are measured from midway between the eye origins.
+    struct CommandDataServerGazeVergenceResult_t {
+      uint64_t sequence; // Gaze sample it was computed from.
+      int64_t hostTimestampUs; // Host time of that sample.
+      bool isValid; // Both eyes were tracked and open.
+      float confidence; // 0 to 1, falls as the rays miss each other by more than about a degree.
+      GazeVector3 fixationPointMm; // Along this sample's direction, at the smoothed depth.
+      float fixationDepthMm; // Smoothed over confident samples, at most 10 m.
+      float rawFixationDepthMm; // From this sample alone.
+      float vergenceAngleDeg; // Angle between the rays, negative if they diverge.
+      float rayGapMm; // How far apart the rays pass at their closest.
+    };
+
+    struct GazeVector2 {
+      float x, y;
+    };
+
+    // Where one eye's gaze lands on that eye's image, in normalized image coordinates from 0,0 at the top left to 1,1 at the bottom right.
+    struct GazeFoveationEye_t {
+      bool isValid; // The eye, or failing that the combined gaze, was tracked, and the display geometry is known.
+      bool isInView; // gazePoint is within the image.
+      GazeVector2 gazePoint; // Outside 0 to 1 when looking past the edge of the image.
+      GazeVector2 foveaMin; // foveaRadiusDeg either side of the gaze along each axis, clamped to the image.
+      GazeVector2 foveaMax;
+    };
+
+    // The gaze projected through the eye to head transforms and raw projections the headset reports to SteamVR.
+    struct CommandDataServerGazeFoveationResult_t {
+      uint64_t sequence; // Gaze sample it was computed from.
+      int64_t hostTimestampUs; // Host time of that sample.
+      float foveaRadiusDeg;
+      GazeFoveationEye_t leftEye;
+      GazeFoveationEye_t rightEye;
+    };
+
     struct CommandDataClientTriggerEffectOff_t {
       EVRControllerType controllerType;
     };